@@ -0,0 +1,385 @@
+#include "arrow_exporter.h"
+
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "sapdecf.h"
+#include "decfloat_batch.h"
+#include "rfc_error.h"
+#include "sapuc_utils.h"
+#include "utf8_transcoder.h"
+
+namespace nwrfc {
+
+namespace {
+
+struct ArrayData
+{
+    std::vector<SAP_RAW> values;    // fixed width values or binary data
+    std::string chars;              // utf8 data
+    std::vector<int32_t> offsets32;
+    std::vector<int64_t> offsets64;
+    std::vector<uint8_t> validity;
+    const void* buffers[3];
+    std::vector<ArrowArray> children;
+    std::vector<ArrowArray*> childPointers;
+};
+
+struct SchemaData
+{
+    std::string format;
+    std::string name;
+    std::vector<ArrowSchema> children;
+    std::vector<ArrowSchema*> childPointers;
+};
+
+void releaseArray(ArrowArray* array)
+{
+    ArrayData* data = static_cast<ArrayData*>(array->private_data);
+    for (size_t i = 0; i < data->children.size(); ++i)
+    {
+        if (data->children[i].release != NULL)
+            data->children[i].release(&data->children[i]);
+    }
+    delete data;
+    array->release = NULL;
+}
+
+void releaseSchema(ArrowSchema* schema)
+{
+    SchemaData* data = static_cast<SchemaData*>(schema->private_data);
+    for (size_t i = 0; i < data->children.size(); ++i)
+    {
+        if (data->children[i].release != NULL)
+            data->children[i].release(&data->children[i]);
+    }
+    delete data;
+    schema->release = NULL;
+}
+
+ArrayData* initArray(ArrowArray* array, int64_t length)
+{
+    ArrayData* data = new ArrayData();
+    data->buffers[0] = data->buffers[1] = data->buffers[2] = NULL;
+    array->length = length;
+    array->null_count = 0;
+    array->offset = 0;
+    array->n_buffers = 0;
+    array->n_children = 0;
+    array->buffers = data->buffers;
+    array->children = NULL;
+    array->dictionary = NULL;
+    array->release = releaseArray;
+    array->private_data = data;
+    return data;
+}
+
+SchemaData* initSchema(ArrowSchema* schema, const std::string& format, const std::string& name)
+{
+    SchemaData* data = new SchemaData();
+    data->format = format;
+    data->name = name;
+    schema->format = data->format.c_str();
+    schema->name = data->name.c_str();
+    schema->metadata = NULL;
+    schema->flags = ARROW_FLAG_NULLABLE;
+    schema->n_children = 0;
+    schema->children = NULL;
+    schema->dictionary = NULL;
+    schema->release = releaseSchema;
+    schema->private_data = data;
+    return data;
+}
+
+std::string toString(unsigned value)
+{
+    char buffer[16];
+    snprintf(buffer, sizeof(buffer), "%u", value);
+    return buffer;
+}
+
+void setNull(ArrayData* data, ArrowArray* array, unsigned row)
+{
+    if (data->validity.empty())
+        data->validity.assign((static_cast<size_t>(array->length) + 7) / 8, 0xFF);
+    data->validity[row / 8] &= static_cast<uint8_t>(~(1u << (row % 8)));
+    ++array->null_count;
+}
+
+void appendAscii(const SAP_UC* chars, std::string& target)
+{
+    for (; *chars != 0; ++chars)
+        target += static_cast<char>(*chars);
+}
+
+// DecFloat columns are formatted in blocks of rows, so that the strings stay on the stack.
+const unsigned DECFLOAT_BLOCK = 64;
+
+void toStrings(const RFC_DECF16* values, unsigned count, DecFloat16Buff* strings)
+{
+    decFloat16ToStrings(values, count, strings, NULL);
+}
+
+void toStrings(const RFC_DECF34* values, unsigned count, DecFloat34Buff* strings)
+{
+    decFloat34ToStrings(values, count, strings, NULL);
+}
+
+template <class Value, class Buffer>
+void appendDecFloatStrings(const Value* values, unsigned rows, ArrayData* data)
+{
+    Buffer buffers[DECFLOAT_BLOCK];
+    for (unsigned first = 0; first < rows; first += DECFLOAT_BLOCK)
+    {
+        const unsigned count = rows - first < DECFLOAT_BLOCK ? rows - first : DECFLOAT_BLOCK;
+        toStrings(values + first, count, buffers);
+        for (unsigned i = 0; i < count; ++i)
+        {
+            appendAscii(buffers[i], data->chars);
+            data->offsets64.push_back(static_cast<int64_t>(data->chars.size()));
+        }
+    }
+}
+
+void finishOffsets(ArrayData* data, ArrowArray* array, size_t dataSize, std::string& format,
+                   const char* smallFormat, const char* largeFormat)
+{
+    if (dataSize <= static_cast<size_t>(INT_MAX))
+    {
+        data->offsets32.assign(data->offsets64.begin(), data->offsets64.end());
+        data->offsets64.clear();
+        data->buffers[1] = data->offsets32.data();
+        format = smallFormat;
+    }
+    else
+    {
+        data->buffers[1] = data->offsets64.data();
+        format = largeFormat;
+    }
+    array->n_buffers = 3;
+}
+
+RFC_RC exportColumn(Column& column, unsigned rows, const ArrowExportOptions& options,
+                    ArrowArray* array, std::string& format, RFC_ERROR_INFO* errorInfo)
+{
+    ArrayData* data = initArray(array, rows);
+    array->n_buffers = 2;
+
+    switch (column.desc.type)
+    {
+    case RFCTYPE_INT1:
+    case RFCTYPE_INT2:
+    case RFCTYPE_INT:
+    case RFCTYPE_INT8:
+    case RFCTYPE_UTCLONG:
+    case RFCTYPE_UTCSECOND:
+    case RFCTYPE_UTCMINUTE:
+    case RFCTYPE_FLOAT:
+    case RFCTYPE_BYTE:
+        format = column.desc.type == RFCTYPE_INT1 ? "C"
+               : column.desc.type == RFCTYPE_INT2 ? "s"
+               : column.desc.type == RFCTYPE_INT ? "i"
+               : column.desc.type == RFCTYPE_FLOAT ? "g"
+               : column.desc.type == RFCTYPE_BYTE ? "w:" + toString(column.width)
+               : "l";
+        data->values.swap(column.data);
+        data->buffers[1] = data->values.data();
+        break;
+
+    case RFCTYPE_DECF16:
+    case RFCTYPE_DECF34:
+        if (options.decfloatAsString)
+        {
+            data->offsets64.reserve(static_cast<size_t>(rows) + 1);
+            data->offsets64.push_back(0);
+            if (column.desc.type == RFCTYPE_DECF16)
+                appendDecFloatStrings<RFC_DECF16, DecFloat16Buff>(column.values<RFC_DECF16>(), rows, data);
+            else
+                appendDecFloatStrings<RFC_DECF34, DecFloat34Buff>(column.values<RFC_DECF34>(), rows, data);
+            data->buffers[2] = data->chars.data();
+            finishOffsets(data, array, data->chars.size(), format, "u", "U");
+        }
+        else
+        {
+            format = "g";
+            data->values.resize(static_cast<size_t>(rows) * sizeof(RFC_FLOAT));
+            RFC_FLOAT* values = reinterpret_cast<RFC_FLOAT*>(data->values.data());
+            std::vector<DECF_RETURN> codes(rows);
+            if (column.desc.type == RFCTYPE_DECF16)
+                decFloat16ToDoubles(column.values<RFC_DECF16>(), rows, values, codes.data(), NULL);
+            else
+                decFloat34ToDoubles(column.values<RFC_DECF34>(), rows, values, codes.data(), NULL);
+            for (unsigned row = 0; row < rows; ++row)
+            {
+                if (codes[row] != DECF_OK && codes[row] != DECF_INEXACT)
+                    setNull(data, array, row);
+            }
+            data->buffers[1] = data->values.data();
+        }
+        break;
+
+    case RFCTYPE_BCD:
+    {
+        unsigned precision = column.desc.nucLength * 2 - 1;
+        if (precision > 38)
+            precision = 38;
+        format = "d:" + toString(precision) + "," + toString(column.desc.decimals);
+        data->values.resize(static_cast<size_t>(rows) * 16);
+        uint64_t* values = reinterpret_cast<uint64_t*>(data->values.data());
+        DecFloat34Buff buffers[DECFLOAT_BLOCK];
+        for (unsigned first = 0; first < rows; first += DECFLOAT_BLOCK)
+        {
+            const unsigned count = rows - first < DECFLOAT_BLOCK ? rows - first : DECFLOAT_BLOCK;
+            decFloat34ToStrings(column.values<RFC_DECF34>() + first, count, buffers, NULL);
+            for (unsigned i = 0; i < count; ++i)
+            {
+                const unsigned row = first + i;
+                if (!decimalToInt128(buffers[i], column.desc.decimals, values + 2 * row))
+                {
+                    values[2 * row] = values[2 * row + 1] = 0;
+                    setNull(data, array, row);
+                }
+            }
+        }
+        data->buffers[1] = data->values.data();
+        break;
+    }
+
+    case RFCTYPE_DATE:
+    case RFCTYPE_TIME:
+    {
+        const bool isDate = column.desc.type == RFCTYPE_DATE;
+        format = isDate ? "tdD" : "tts";
+        data->values.resize(static_cast<size_t>(rows) * sizeof(int32_t));
+        int32_t* values = reinterpret_cast<int32_t*>(data->values.data());
+        for (unsigned row = 0; row < rows; ++row)
+        {
+            const SAP_UC* chars = column.charsAt(row);
+            if (!(isDate ? parseDate(chars, &values[row]) : parseTime(chars, &values[row])))
+            {
+                values[row] = 0;
+                setNull(data, array, row);
+            }
+        }
+        data->buffers[1] = data->values.data();
+        break;
+    }
+
+    case RFCTYPE_CHAR:
+    case RFCTYPE_NUM:
+    case RFCTYPE_STRING:
+    {
+        std::vector<size_t> ends;
+        RFC_RC rc = appendUtf8Column(column, rows, options.trimChars, data->chars, ends, errorInfo);
+        if (rc != RFC_OK)
+            return rc;
+        data->offsets64.assign(ends.begin(), ends.end());
+        data->buffers[2] = data->chars.data();
+        finishOffsets(data, array, data->chars.size(), format, "u", "U");
+        break;
+    }
+
+    case RFCTYPE_XSTRING:
+        data->offsets64.assign(column.offsets.begin(), column.offsets.end());
+        data->values.swap(column.data);
+        data->buffers[2] = data->values.data();
+        finishOffsets(data, array, data->values.size(), format, "z", "Z");
+        break;
+
+    default:
+        return setError(errorInfo, RFC_NOT_SUPPORTED, cU("Column type cannot be exported to Arrow"));
+    }
+
+    if (!data->validity.empty())
+        data->buffers[0] = data->validity.data();
+    return RFC_OK;
+}
+
+} // namespace
+
+ArrowExporter::ArrowExporter(const ArrowExportOptions& options)
+    : options_(options)
+{
+}
+
+RFC_RC ArrowExporter::exportBatch(ColumnarTableReader& reader, ArrowArray* array, ArrowSchema* schema,
+                                  RFC_ERROR_INFO* errorInfo) const
+{
+    if (array == NULL)
+        return setError(errorInfo, RFC_INVALID_PARAMETER, cU("No target ArrowArray given"));
+
+    const unsigned rows = reader.rowCount();
+    std::vector<unsigned> exported;
+    for (unsigned i = 0; i < reader.columnCount(); ++i)
+    {
+        if (reader.column(i).layout != COLUMN_SKIPPED)
+            exported.push_back(i);
+    }
+
+    ArrayData* data = initArray(array, rows);
+    array->n_buffers = 1;
+    data->children.resize(exported.size());
+    for (size_t i = 0; i < exported.size(); ++i)
+    {
+        data->children[i].release = NULL;
+        data->childPointers.push_back(&data->children[i]);
+    }
+    array->n_children = static_cast<int64_t>(exported.size());
+    array->children = data->childPointers.data();
+
+    SchemaData* schemaData = NULL;
+    if (schema != NULL)
+    {
+        schemaData = initSchema(schema, "+s", "");
+        schema->flags = 0;
+        schemaData->children.resize(exported.size());
+        for (size_t i = 0; i < exported.size(); ++i)
+        {
+            schemaData->children[i].release = NULL;
+            schemaData->childPointers.push_back(&schemaData->children[i]);
+        }
+        schema->n_children = static_cast<int64_t>(exported.size());
+        schema->children = schemaData->childPointers.data();
+    }
+
+    for (size_t i = 0; i < exported.size(); ++i)
+    {
+        Column& column = reader.column(exported[i]);
+        std::string format;
+        std::string name;
+        RFC_RC rc = exportColumn(column, rows, options_, &data->children[i], format, errorInfo);
+        if (rc == RFC_OK && schemaData != NULL)
+            rc = appendUtf8(column.desc.name, static_cast<unsigned>(strlenU(column.desc.name)), name, errorInfo);
+        if (rc != RFC_OK)
+        {
+            array->release(array);
+            if (schema != NULL)
+                schema->release(schema);
+            return rc;
+        }
+        if (schemaData != NULL)
+            initSchema(&schemaData->children[i], format, name);
+    }
+    return clearError(errorInfo);
+}
+
+RFC_RC ArrowExporter::exportTable(RFC_TABLE_HANDLE tableHandle, RFC_TYPE_DESC_HANDLE typeDescHandle,
+                                  unsigned fromRow, unsigned numberOfRows,
+                                  ArrowArray* array, ArrowSchema* schema, RFC_ERROR_INFO* errorInfo) const
+{
+    ColumnarTableReader reader(tableHandle, typeDescHandle);
+    RFC_RC rc = reader.read(fromRow, numberOfRows, errorInfo);
+    if (rc != RFC_OK)
+        return rc;
+    return exportBatch(reader, array, schema, errorInfo);
+}
+
+RFC_RC ArrowExporter::exportTable(RFC_TABLE_HANDLE tableHandle, RFC_TYPE_DESC_HANDLE typeDescHandle,
+                                  ArrowArray* array, ArrowSchema* schema, RFC_ERROR_INFO* errorInfo) const
+{
+    return exportTable(tableHandle, typeDescHandle, 0, UINT_MAX, array, schema, errorInfo);
+}
+
+} // namespace nwrfc
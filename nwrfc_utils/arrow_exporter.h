@@ -0,0 +1,131 @@
+#ifndef NWRFC_UTILS_ARROW_EXPORTER_H
+#define NWRFC_UTILS_ARROW_EXPORTER_H
+
+#include <stdint.h>
+#include "sapnwrfc.h"
+#include "columnar_table_reader.h"
+
+/*
+ * Apache Arrow C Data Interface, see https://arrow.apache.org/docs/format/CDataInterface.html
+ * The definitions are ABI-stable and guarded, so this header can be combined with arrow/c/abi.h.
+ */
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+extern "C" {
+
+struct ArrowSchema
+{
+    const char* format;
+    const char* name;
+    const char* metadata;
+    int64_t flags;
+    int64_t n_children;
+    struct ArrowSchema** children;
+    struct ArrowSchema* dictionary;
+    void (*release)(struct ArrowSchema*);
+    void* private_data;
+};
+
+struct ArrowArray
+{
+    int64_t length;
+    int64_t null_count;
+    int64_t offset;
+    int64_t n_buffers;
+    int64_t n_children;
+    const void** buffers;
+    struct ArrowArray** children;
+    struct ArrowArray* dictionary;
+    void (*release)(struct ArrowArray*);
+    void* private_data;
+};
+
+} // extern "C"
+
+#endif // ARROW_C_DATA_INTERFACE
+
+namespace nwrfc {
+
+/** \struct ArrowExportOptions
+ *
+ * Controls the type mapping of ArrowExporter.
+ */
+struct ArrowExportOptions
+{
+    bool trimChars;         ///< Strip trailing blanks of RFCTYPE_CHAR fields. Default: true
+    bool decfloatAsString;  ///< Export DECF16/34 as exact utf8 strings instead of float64. Default: true
+
+    ArrowExportOptions() : trimChars(true), decfloatAsString(true) {}
+};
+
+/**
+ * \brief  Exports RFC tables as Arrow record batches through the Arrow C Data Interface.
+ *
+ * The batch is a struct array with one child per extracted column. Type mapping:
+ * - RFCTYPE_INT1, INT2, INT, INT8: uint8, int16, int32, int64
+ * - RFCTYPE_UTCLONG, UTCSECOND, UTCMINUTE: int64
+ * - RFCTYPE_FLOAT: float64
+ * - RFCTYPE_DECF16, DECF34: utf8, or float64 if ArrowExportOptions::decfloatAsString is false
+ * - RFCTYPE_BCD: decimal128 with the precision and scale of the field
+ * - RFCTYPE_DATE: date32, initial or invalid dates are null
+ * - RFCTYPE_TIME: time32[s], invalid times are null
+ * - RFCTYPE_CHAR, NUM, STRING: utf8 (large_utf8 beyond 2 GB)
+ * - RFCTYPE_BYTE: fixed_size_binary, RFCTYPE_XSTRING: binary (large_binary beyond 2 GB)
+ * Nested structures and tables are not exported.
+ *
+ * Fixed width numeric columns are handed over without copying: the buffers of the
+ * ColumnarTableReader are moved into the ArrowArray and freed by its release callback.
+ * The consumer owns the exported ArrowArray/ArrowSchema and must call their release callbacks.
+ */
+class ArrowExporter
+{
+public:
+    explicit ArrowExporter(const ArrowExportOptions& options = ArrowExportOptions());
+
+    /**
+     * \brief  Exports the rows currently held by a reader.
+     *
+     * The column buffers of the reader are consumed, call ColumnarTableReader::read() again
+     * before the next export.
+     *
+     * \inout &reader Reader after a successful read().
+     * \out *array Receives the record batch.
+     * \out *schema Receives the schema of the record batch. May be NULL.
+     * \out *errorInfo More information in case a column cannot be converted.
+     * \return RFC_RC
+     */
+    RFC_RC exportBatch(ColumnarTableReader& reader, ArrowArray* array, ArrowSchema* schema,
+                       RFC_ERROR_INFO* errorInfo) const;
+
+    /**
+     * \brief  Extracts the rows [fromRow, fromRow + numberOfRows) of a table and exports them.
+     *
+     * \in tableHandle Table to export.
+     * \in typeDescHandle Row type of the table.
+     * \in fromRow First row to export.
+     * \in numberOfRows Maximum number of rows to export, clipped to the table size.
+     * \out *array Receives the record batch.
+     * \out *schema Receives the schema of the record batch. May be NULL.
+     * \out *errorInfo More information in case the table cannot be exported.
+     * \return RFC_RC
+     */
+    RFC_RC exportTable(RFC_TABLE_HANDLE tableHandle, RFC_TYPE_DESC_HANDLE typeDescHandle,
+                       unsigned fromRow, unsigned numberOfRows,
+                       ArrowArray* array, ArrowSchema* schema, RFC_ERROR_INFO* errorInfo) const;
+
+    /** \brief  Exports the complete table. */
+    RFC_RC exportTable(RFC_TABLE_HANDLE tableHandle, RFC_TYPE_DESC_HANDLE typeDescHandle,
+                       ArrowArray* array, ArrowSchema* schema, RFC_ERROR_INFO* errorInfo) const;
+
+private:
+    ArrowExportOptions options_;
+};
+
+} // namespace nwrfc
+
+#endif // NWRFC_UTILS_ARROW_EXPORTER_H
@@ -0,0 +1,108 @@
+#include "byte_sink.h"
+
+#include <errno.h>
+#include <unistd.h>
+#include <algorithm>
+#include <ostream>
+#include "rfc_error.h"
+
+namespace nwrfc {
+
+RFC_RC ByteSink::flush(RFC_ERROR_INFO* errorInfo)
+{
+    return clearError(errorInfo);
+}
+
+RFC_RC FdSink::write(const char* data, size_t length, RFC_ERROR_INFO* errorInfo)
+{
+    while (length > 0)
+    {
+        ssize_t written = ::write(fd_, data, length);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return setError(errorInfo, RFC_EXTERNAL_FAILURE, cU("Writing to the file descriptor failed"));
+        }
+        data += written;
+        length -= static_cast<size_t>(written);
+    }
+    return clearError(errorInfo);
+}
+
+RFC_RC OstreamSink::write(const char* data, size_t length, RFC_ERROR_INFO* errorInfo)
+{
+    if (!stream_.write(data, static_cast<std::streamsize>(length)))
+        return setError(errorInfo, RFC_EXTERNAL_FAILURE, cU("Writing to the output stream failed"));
+    return clearError(errorInfo);
+}
+
+RFC_RC OstreamSink::flush(RFC_ERROR_INFO* errorInfo)
+{
+    if (!stream_.flush())
+        return setError(errorInfo, RFC_EXTERNAL_FAILURE, cU("Flushing the output stream failed"));
+    return clearError(errorInfo);
+}
+
+RingBufferSink::RingBufferSink(size_t capacity)
+    : buffer_(std::max<size_t>(capacity, 1)), head_(0), size_(0), closed_(false), canceled_(false)
+{
+}
+
+RFC_RC RingBufferSink::write(const char* data, size_t length, RFC_ERROR_INFO* errorInfo)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (length > 0)
+    {
+        writable_.wait(lock, [this] { return canceled_ || size_ < buffer_.size(); });
+        if (canceled_)
+            return setError(errorInfo, RFC_CANCELED, cU("The consumer of the ring buffer has cancelled"));
+
+        const size_t tail = (head_ + size_) % buffer_.size();
+        const size_t count = std::min(length, std::min(buffer_.size() - size_, buffer_.size() - tail));
+        std::copy(data, data + count, buffer_.begin() + static_cast<std::ptrdiff_t>(tail));
+        size_ += count;
+        data += count;
+        length -= count;
+        readable_.notify_one();
+    }
+    return clearError(errorInfo);
+}
+
+size_t RingBufferSink::read(char* buffer, size_t maxLength)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    readable_.wait(lock, [this] { return canceled_ || closed_ || size_ > 0; });
+    if (canceled_)
+        return 0;
+
+    size_t copied = 0;
+    while (copied < maxLength && size_ > 0)
+    {
+        const size_t count = std::min(maxLength - copied, std::min(size_, buffer_.size() - head_));
+        std::copy(buffer_.begin() + static_cast<std::ptrdiff_t>(head_),
+                  buffer_.begin() + static_cast<std::ptrdiff_t>(head_ + count), buffer + copied);
+        head_ = (head_ + count) % buffer_.size();
+        size_ -= count;
+        copied += count;
+    }
+    writable_.notify_one();
+    return copied;
+}
+
+void RingBufferSink::close()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = true;
+    readable_.notify_all();
+}
+
+void RingBufferSink::cancel()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    canceled_ = true;
+    readable_.notify_all();
+    writable_.notify_all();
+}
+
+} // namespace nwrfc
@@ -0,0 +1,125 @@
+#ifndef NWRFC_UTILS_BYTE_SINK_H
+#define NWRFC_UTILS_BYTE_SINK_H
+
+#include <stddef.h>
+#include <condition_variable>
+#include <iosfwd>
+#include <mutex>
+#include <vector>
+#include "sapnwrfc.h"
+
+namespace nwrfc {
+
+/**
+ * \brief  Destination of the byte streams produced by the serializers (JSON, CSV, ...).
+ *
+ * Serializers hand over their output in chunks of bounded size, a sink never sees the
+ * complete document at once.
+ */
+class ByteSink
+{
+public:
+    virtual ~ByteSink() {}
+
+    /**
+     * \brief  Writes a chunk of bytes.
+     *
+     * \in *data Bytes to write.
+     * \in length Number of bytes to write.
+     * \out *errorInfo More information in case the data cannot be written.
+     * \return RFC_RC
+     */
+    virtual RFC_RC write(const char* data, size_t length, RFC_ERROR_INFO* errorInfo) = 0;
+
+    /**
+     * \brief  Called once after the last chunk of a document.
+     *
+     * \out *errorInfo More information in case buffered data cannot be written.
+     * \return RFC_RC
+     */
+    virtual RFC_RC flush(RFC_ERROR_INFO* errorInfo);
+};
+
+/**
+ * \brief  Writes to a file descriptor (file, pipe, socket). The descriptor is not closed.
+ */
+class FdSink : public ByteSink
+{
+public:
+    explicit FdSink(int fd) : fd_(fd) {}
+
+    RFC_RC write(const char* data, size_t length, RFC_ERROR_INFO* errorInfo);
+
+private:
+    int fd_;
+};
+
+/**
+ * \brief  Writes to a std::ostream.
+ */
+class OstreamSink : public ByteSink
+{
+public:
+    explicit OstreamSink(std::ostream& stream) : stream_(stream) {}
+
+    RFC_RC write(const char* data, size_t length, RFC_ERROR_INFO* errorInfo);
+    RFC_RC flush(RFC_ERROR_INFO* errorInfo);
+
+private:
+    std::ostream& stream_;
+};
+
+/**
+ * \brief  Bounded single-producer/single-consumer ring buffer.
+ *
+ * The serializer writes from one thread and blocks while the ring is full, a consumer thread
+ * drains it with read(). Memory use is fixed to the capacity given at construction, however
+ * large the serialized table is.
+ *
+ * \code
+ * nwrfc::RingBufferSink ring(1 << 20);
+ * std::thread producer([&] { writer.write(table, rowType, ring, &errorInfo); ring.close(); });
+ * char chunk[65536];
+ * size_t n;
+ * while ((n = ring.read(chunk, sizeof(chunk))) > 0)
+ *     send(socket, chunk, n, 0);
+ * producer.join();
+ * \endcode
+ */
+class RingBufferSink : public ByteSink
+{
+public:
+    explicit RingBufferSink(size_t capacity);
+
+    /** \brief  Blocks until all bytes are in the ring. Fails with RFC_CANCELED after cancel(). */
+    RFC_RC write(const char* data, size_t length, RFC_ERROR_INFO* errorInfo);
+
+    /**
+     * \brief  Consumer side: blocks until data is available and copies up to maxLength bytes.
+     *
+     * \return Number of bytes copied, 0 once the ring is closed and drained, or cancelled.
+     */
+    size_t read(char* buffer, size_t maxLength);
+
+    /** \brief  Producer side: no more data will follow. Pending data can still be read. */
+    void close();
+
+    /** \brief  Consumer side: stop consuming, pending and further writes fail. */
+    void cancel();
+
+    size_t capacity() const { return buffer_.size(); }
+
+private:
+    std::vector<char> buffer_;
+    size_t head_;   // next byte to read
+    size_t size_;   // bytes currently stored
+    bool closed_;
+    bool canceled_;
+    std::mutex mutex_;
+    std::condition_variable readable_;
+    std::condition_variable writable_;
+};
+
+} // namespace nwrfc
+
+#endif // NWRFC_UTILS_BYTE_SINK_H
@@ -0,0 +1,161 @@
+#include "char_column_views.h"
+
+#include <stdint.h>
+#include <string>
+#include "rfc_error.h"
+#include "sapuc_utils.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define NWRFC_SSE2_KERNELS 1
+#include <emmintrin.h>
+#endif
+
+namespace nwrfc {
+
+namespace {
+
+inline bool isDigit(SAP_UC c)
+{
+    return c >= cU('0') && c <= cU('9');
+}
+
+/* Value of 8 digits, false if one of them is not a digit. */
+inline bool parseEightDigits(const SAP_UC* value, uint64_t* number)
+{
+#ifdef NWRFC_SSE2_KERNELS
+    const __m128i digits = _mm_sub_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(value)), _mm_set1_epi16('0'));
+    // Characters below '0' wrap around, so one unsigned comparison catches both ends.
+    const __m128i excess = _mm_subs_epu16(digits, _mm_set1_epi16(9));
+    if (_mm_movemask_epi8(_mm_cmpeq_epi16(excess, _mm_setzero_si128())) != 0xFFFF)
+        return false;
+    // Pairs of digits, then pairs of pairs: d0*10+d1, ..., then (d0d1)*100+(d2d3), ...
+    const __m128i pairs = _mm_madd_epi16(digits, _mm_setr_epi16(10, 1, 10, 1, 10, 1, 10, 1));
+    const __m128i quads = _mm_madd_epi16(_mm_packs_epi32(pairs, pairs), _mm_setr_epi16(100, 1, 100, 1, 100, 1, 100, 1));
+    *number = static_cast<uint64_t>(_mm_cvtsi128_si32(quads)) * 10000 + static_cast<uint64_t>(_mm_cvtsi128_si32(_mm_srli_si128(quads, 4)));
+    return true;
+#else
+    uint64_t result = 0;
+    for (unsigned i = 0; i < 8; ++i)
+    {
+        if (!isDigit(value[i]))
+            return false;
+        result = result * 10 + (value[i] - cU('0'));
+    }
+    *number = result;
+    return true;
+#endif
+}
+
+bool isCharLike(RFCTYPE type)
+{
+    return isCharLikeType(type) || type == RFCTYPE_STRING;
+}
+
+} // namespace
+
+unsigned leadingZeros(const SAP_UC* value, unsigned length)
+{
+    if (length == 0)
+        return 0;
+    const unsigned last = length - 1;
+    unsigned position = 0;
+#ifdef NWRFC_SSE2_KERNELS
+    const __m128i zero = _mm_set1_epi16('0');
+    for (; position + 8 <= last; position += 8)
+    {
+        const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(value + position));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(chars, zero)) != 0xFFFF)
+            break;
+    }
+#endif
+    while (position < last && value[position] == cU('0'))
+        ++position;
+    return position;
+}
+
+bool parseNumc(const SAP_UC* value, unsigned length, RFC_INT8* number)
+{
+    // 18 digits always fit into RFC_INT8; longer fields need leading zeros.
+    for (; length > 18; ++value, --length)
+    {
+        if (*value != cU('0'))
+            return false;
+    }
+    uint64_t result = 0;
+    const unsigned head = length % 8;
+    for (unsigned i = 0; i < head; ++i)
+    {
+        if (!isDigit(value[i]))
+            return false;
+        result = result * 10 + (value[i] - cU('0'));
+    }
+    for (unsigned i = head; i < length; i += 8)
+    {
+        uint64_t digits;
+        if (!parseEightDigits(value + i, &digits))
+            return false;
+        result = result * 100000000 + digits;
+    }
+    *number = static_cast<RFC_INT8>(result);
+    return true;
+}
+
+CharColumnViews::CharColumnViews(bool trimChars, bool stripZeros, bool parseNum)
+    : trimChars_(trimChars),
+      stripZeros_(stripZeros),
+      parseNum_(parseNum)
+{
+}
+
+RFC_RC CharColumnViews::apply(const ColumnarTableReader& reader, RFC_ERROR_INFO* errorInfo)
+{
+    spans_.assign(reader.columnCount(), std::vector<CharSpan>());
+    numbers_.assign(reader.columnCount(), std::vector<RFC_INT8>());
+    const unsigned rows = reader.rowCount();
+    for (unsigned i = 0; i < reader.columnCount(); ++i)
+    {
+        const Column& column = reader.column(i);
+        if (column.layout == COLUMN_SKIPPED || !isCharLike(column.desc.type))
+            continue;
+
+        const bool trim = trimChars_ && (column.desc.type == RFCTYPE_CHAR || column.desc.type == RFCTYPE_STRING);
+        const bool strip = stripZeros_ && column.desc.type == RFCTYPE_NUM;
+        std::vector<CharSpan>& spans = spans_[i];
+        spans.resize(rows);
+        for (unsigned row = 0; row < rows; ++row)
+        {
+            const SAP_UC* chars = column.charsAt(row);
+            CharSpan& span = spans[row];
+            span.offset = (column.layout == COLUMN_FIXED ? static_cast<size_t>(row) * column.width : column.offsets[row])
+                / sizeof(SAP_UC);
+            span.length = column.charLength(row);
+            if (trim)
+                span.length = trimmedLength(chars, span.length);
+            else if (strip)
+            {
+                const unsigned zeros = leadingZeros(chars, span.length);
+                span.offset += zeros;
+                span.length -= zeros;
+            }
+        }
+
+        if (parseNum_ && column.desc.type == RFCTYPE_NUM)
+        {
+            std::vector<RFC_INT8>& numbers = numbers_[i];
+            numbers.resize(rows);
+            for (unsigned row = 0; row < rows; ++row)
+            {
+                if (!parseNumc(column.charsAt(row), column.charLength(row), &numbers[row]))
+                {
+                    spans_.clear();
+                    numbers_.clear();
+                    return setError(errorInfo, RFC_CONVERSION_FAILURE,
+                                    (std::basic_string<SAP_UC>(cU("NUM field ")) + column.desc.name + cU(" holds a value that is not numeric")).c_str());
+                }
+            }
+        }
+    }
+    return clearError(errorInfo);
+}
+
+} // namespace nwrfc
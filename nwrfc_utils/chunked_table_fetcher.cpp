@@ -0,0 +1,205 @@
+#include "chunked_table_fetcher.h"
+
+#include <algorithm>
+#include "rfc_error.h"
+
+namespace nwrfc {
+
+namespace {
+
+/* Cumulated counters of a throughput object, stored in the fields of a ChunkStatistics. */
+RFC_RC readCounters(RFC_THROUGHPUT_HANDLE throughput, ChunkStatistics& counters, RFC_ERROR_INFO* errorInfo)
+{
+    RFC_RC rc = RfcGetTotalTime(throughput, &counters.totalTime, errorInfo);
+    if (rc == RFC_OK)
+        rc = RfcGetDeserializationTime(throughput, &counters.deserializationTime, errorInfo);
+    if (rc == RFC_OK)
+        rc = RfcGetNetworkReadingTime(throughput, &counters.networkReadingTime, errorInfo);
+    if (rc == RFC_OK)
+        rc = RfcGetReceivedBytes(throughput, &counters.receivedBytes, errorInfo);
+    return rc;
+}
+
+} // namespace
+
+ChunkedTableFetcher::ChunkedTableFetcher(RFC_CONNECTION_HANDLE connection, RFC_FUNCTION_DESC_HANDLE funcDescHandle,
+                                         const ChunkedFetchOptions& options)
+    : connection_(connection),
+      funcDescHandle_(funcDescHandle),
+      options_(options),
+      chunkRows_(0),
+      rowsFetched_(0),
+      rowLength_(0)
+{
+    options_.minRows = std::max(options_.minRows, 1u);
+    options_.maxRows = std::max(options_.maxRows, options_.minRows);
+    chunkRows_ = std::min(std::max(options_.initialRows, options_.minRows), options_.maxRows);
+}
+
+RFC_RC ChunkedTableFetcher::fetch(const PrepareFunction& prepare, const ChunkFunction& consume, RFC_ERROR_INFO* errorInfo)
+{
+    rowsFetched_ = 0;
+    statistics_.clear();
+
+    RFC_PARAMETER_DESC tableDesc;
+    RFC_RC rc = RfcGetParameterDescByName(funcDescHandle_, options_.tableParameter, &tableDesc, errorInfo);
+    if (rc != RFC_OK)
+        return rc;
+    unsigned nucLength = 0;
+    unsigned ucLength = 0;
+    rc = RfcGetTypeLength(tableDesc.typeDescHandle, &nucLength, &ucLength, errorInfo);
+    if (rc != RFC_OK)
+        return rc;
+    rowLength_ = ucLength;
+
+    RFC_ERROR_INFO cleanupError;
+    RFC_THROUGHPUT_HANDLE throughput = RfcGetThroughputFromConnection(connection_, &cleanupError);
+    const bool ownThroughput = throughput == NULL;
+    if (ownThroughput)
+    {
+        throughput = RfcCreateThroughput(errorInfo);
+        if (throughput == NULL)
+            return errorInfo != NULL ? errorInfo->code : RFC_EXTERNAL_FAILURE;
+        rc = RfcSetThroughputOnConnection(connection_, throughput, errorInfo);
+        if (rc != RFC_OK)
+        {
+            RfcDestroyThroughput(throughput, &cleanupError);
+            return rc;
+        }
+    }
+
+    RFC_FUNCTION_HANDLE functions[2] = { NULL, NULL };
+    for (unsigned i = 0; i < 2 && rc == RFC_OK; ++i)
+    {
+        functions[i] = RfcCreateFunction(funcDescHandle_, errorInfo);
+        if (functions[i] == NULL)
+            rc = errorInfo != NULL ? errorInfo->code : RFC_EXTERNAL_FAILURE;
+    }
+    if (rc == RFC_OK)
+        rc = fetchChunks(throughput, functions, prepare, consume, errorInfo);
+
+    for (unsigned i = 0; i < 2; ++i)
+    {
+        if (functions[i] != NULL)
+            RfcDestroyFunction(functions[i], &cleanupError);
+    }
+    if (ownThroughput)
+    {
+        RfcRemoveThroughputFromConnection(connection_, &cleanupError);
+        RfcDestroyThroughput(throughput, &cleanupError);
+    }
+    return rc;
+}
+
+RFC_RC ChunkedTableFetcher::fetchChunks(RFC_THROUGHPUT_HANDLE throughput, RFC_FUNCTION_HANDLE functions[2],
+                                        const PrepareFunction& prepare, const ChunkFunction& consume,
+                                        RFC_ERROR_INFO* errorInfo)
+{
+    RFC_ERROR_INFO consumerError;
+    for (unsigned chunk = 0;; ++chunk)
+    {
+        unsigned requested = chunkRows_;
+        if (options_.maxTotalRows > 0)
+            requested = std::min(requested, options_.maxTotalRows - rowsFetched_);
+        if (requested == 0)
+            break;
+
+        // The consumer of the chunk before the previous one, which used this handle, is done.
+        RFC_FUNCTION_HANDLE function = functions[chunk % 2];
+        RFC_TABLE_HANDLE rows = NULL;
+        RFC_RC rc = RfcGetTable(function, options_.tableParameter, &rows, errorInfo);
+        if (rc == RFC_OK)
+            rc = RfcDeleteAllRows(rows, errorInfo);
+        if (rc == RFC_OK && prepare)
+            rc = prepare(function, errorInfo);
+        if (rc == RFC_OK)
+            rc = RfcSetInt(function, options_.skipParameter, static_cast<RFC_INT>(rowsFetched_), errorInfo);
+        if (rc == RFC_OK)
+            rc = RfcSetInt(function, options_.countParameter, static_cast<RFC_INT>(requested), errorInfo);
+
+        ChunkStatistics before = ChunkStatistics();
+        ChunkStatistics statistics = ChunkStatistics();
+        if (rc == RFC_OK)
+            rc = readCounters(throughput, before, errorInfo);
+        if (rc == RFC_OK)
+            rc = RfcInvoke(connection_, function, errorInfo);
+        if (rc == RFC_OK)
+            rc = readCounters(throughput, statistics, errorInfo);
+        if (rc == RFC_OK)
+            rc = RfcGetTable(function, options_.tableParameter, &rows, errorInfo);
+        if (rc == RFC_OK)
+            rc = RfcGetRowCount(rows, &statistics.rowCount, errorInfo);
+        if (rc != RFC_OK)
+        {
+            waitForConsumer(&consumerError);
+            return rc;
+        }
+
+        rc = waitForConsumer(errorInfo);
+        if (rc != RFC_OK)
+            return rc;
+
+        statistics.firstRow = rowsFetched_;
+        statistics.requestedRows = requested;
+        statistics.totalTime -= before.totalTime;
+        statistics.deserializationTime -= before.deserializationTime;
+        statistics.networkReadingTime -= before.networkReadingTime;
+        statistics.receivedBytes -= before.receivedBytes;
+        statistics_.push_back(statistics);
+
+        if (statistics.rowCount > 0)
+        {
+            const unsigned firstRow = rowsFetched_;
+            pending_ = std::async(std::launch::async, [consume, rows, firstRow]() {
+                Consumed result;
+                result.rc = consume(rows, firstRow, &result.errorInfo);
+                return result;
+            });
+        }
+        rowsFetched_ += statistics.rowCount;
+        if (statistics.rowCount < requested)
+            break;
+        adapt(statistics);
+    }
+    RFC_RC rc = waitForConsumer(errorInfo);
+    return rc == RFC_OK ? clearError(errorInfo) : rc;
+}
+
+void ChunkedTableFetcher::adapt(const ChunkStatistics& statistics)
+{
+    const double rows = statistics.rowCount;
+    if (rows == 0)
+        return;
+
+    // Round trip model: a fixed part (latency, server) plus network reading and deserialization,
+    // which grow with the rows.
+    double next = 2.0 * chunkRows_;
+    const double perRow = static_cast<double>(statistics.deserializationTime + statistics.networkReadingTime) / rows;
+    const double total = static_cast<double>(statistics.totalTime);
+    const double fixed = total - perRow * rows;
+    if (perRow > 0 && options_.targetMillis > fixed)
+        next = (options_.targetMillis - fixed) / perRow;
+    else if (total > 0 && fixed >= options_.targetMillis)
+        next = rows * options_.targetMillis / total;
+
+    next = std::min(std::max(next, chunkRows_ / 2.0), chunkRows_ * 2.0);
+    next = std::min(std::max(next, static_cast<double>(options_.minRows)), static_cast<double>(options_.maxRows));
+
+    // The memory ceiling wins over minRows: two chunks of the larger of wire and row size each.
+    const double bytesPerRow = std::max(static_cast<double>(rowLength_), statistics.receivedBytes / rows);
+    if (bytesPerRow > 0)
+        next = std::min(next, options_.memoryBudget / (2.0 * bytesPerRow));
+    chunkRows_ = std::max(static_cast<unsigned>(next), 1u);
+}
+
+RFC_RC ChunkedTableFetcher::waitForConsumer(RFC_ERROR_INFO* errorInfo)
+{
+    if (!pending_.valid())
+        return RFC_OK;
+    Consumed result = pending_.get();
+    if (result.rc != RFC_OK && errorInfo != NULL)
+        *errorInfo = result.errorInfo;
+    return result.rc;
+}
+
+} // namespace nwrfc
@@ -0,0 +1,137 @@
+#ifndef NWRFC_UTILS_CHUNKED_TABLE_FETCHER_H
+#define NWRFC_UTILS_CHUNKED_TABLE_FETCHER_H
+
+#include <stddef.h>
+#include <functional>
+#include <future>
+#include <vector>
+#include "sapnwrfc.h"
+
+namespace nwrfc {
+
+/** \struct ChunkedFetchOptions
+ *
+ * Paging parameters and limits of ChunkedTableFetcher. The defaults match RFC_READ_TABLE.
+ */
+struct ChunkedFetchOptions
+{
+    const SAP_UC* skipParameter;    ///< INT importing parameter with the rows to skip. Default: ROWSKIPS
+    const SAP_UC* countParameter;   ///< INT importing parameter with the rows to return. Default: ROWCOUNT
+    const SAP_UC* tableParameter;   ///< Table parameter receiving the rows. Default: DATA
+    size_t memoryBudget;            ///< Bytes the two chunks in flight may occupy. Default: 256 MB
+    unsigned initialRows;           ///< Rows of the first chunk. Default: 10000
+    unsigned minRows;               ///< Lower limit of the chunk size. Default: 1000
+    unsigned maxRows;               ///< Upper limit of the chunk size. Default: 1000000
+    unsigned targetMillis;          ///< Round trip time a chunk should take. Default: 2000 ms
+    unsigned maxTotalRows;          ///< Stop after this many rows, 0 for all rows. Default: 0
+
+    ChunkedFetchOptions()
+        : skipParameter(cU("ROWSKIPS")), countParameter(cU("ROWCOUNT")), tableParameter(cU("DATA")),
+          memoryBudget(256 * 1024 * 1024), initialRows(10000), minRows(1000), maxRows(1000000),
+          targetMillis(2000), maxTotalRows(0) {}
+};
+
+/** \struct ChunkStatistics
+ *
+ * Measurements of one chunk, taken from the throughput object of the connection.
+ */
+struct ChunkStatistics
+{
+    unsigned firstRow;                  ///< Rows skipped for this chunk
+    unsigned requestedRows;             ///< ROWCOUNT of the call
+    unsigned rowCount;                  ///< Rows received
+    SAP_ULLONG totalTime;               ///< Milliseconds, see RfcGetTotalTime()
+    SAP_ULLONG deserializationTime;     ///< Milliseconds, see RfcGetDeserializationTime()
+    SAP_ULLONG networkReadingTime;      ///< Milliseconds, see RfcGetNetworkReadingTime()
+    SAP_ULLONG receivedBytes;           ///< See RfcGetReceivedBytes()
+};
+
+/**
+ * \brief  Fetches a large result in chunks of ROWSKIPS/ROWCOUNT calls, pipelined with decoding.
+ *
+ * Replaces hand-written paging loops around RFC_READ_TABLE-style function modules. Every call
+ * asks for the next chunkRows() rows. The chunk size adapts after every call:
+ * - it aims at options.targetMillis per round trip, using the times a throughput object records
+ *   for the call (RfcGetTotalTime(), RfcGetDeserializationTime(), RfcGetNetworkReadingTime()),
+ * - it never exceeds the rows that fit into options.memoryBudget, with the observed received
+ *   bytes per row or the row length, whichever is larger, for each of the two chunks in flight,
+ * - it changes at most by a factor of two per call.
+ *
+ * Two function handles are used alternately: while the sink consumes chunk n on a worker thread,
+ * chunk n + 1 is fetched on the calling thread. So at most two chunks are held at any time.
+ *
+ * \code
+ * nwrfc::ChunkedTableFetcher fetcher(connection, RfcGetFunctionDesc(connection, cU("RFC_READ_TABLE"), &errorInfo));
+ * rc = fetcher.fetch(
+ *     [](RFC_FUNCTION_HANDLE function, RFC_ERROR_INFO* errorInfo) {
+ *         return RfcSetChars(function, cU("QUERY_TABLE"), cU("MARA"), 4, errorInfo);
+ *     },
+ *     [&](RFC_TABLE_HANDLE rows, unsigned firstRow, RFC_ERROR_INFO* errorInfo) {
+ *         return writer.write(rows, rowType, sink, errorInfo);
+ *     },
+ *     &errorInfo);
+ * \endcode
+ *
+ * The fetch ends with the first chunk returning fewer rows than requested. If no throughput
+ * object is attached to the connection, one is attached for the duration of fetch(). The fetcher
+ * does not own the connection or the function description.
+ */
+class ChunkedTableFetcher
+{
+public:
+    /** Sets the importing parameters of a call, except skip and count. Called before every call. */
+    typedef std::function<RFC_RC(RFC_FUNCTION_HANDLE function, RFC_ERROR_INFO* errorInfo)> PrepareFunction;
+
+    /**
+     * Consumes the rows of one chunk; firstRow is the number of rows in the chunks before. Called
+     * on a worker thread, one chunk at a time, in chunk order.
+     */
+    typedef std::function<RFC_RC(RFC_TABLE_HANDLE rows, unsigned firstRow, RFC_ERROR_INFO* errorInfo)> ChunkFunction;
+
+    ChunkedTableFetcher(RFC_CONNECTION_HANDLE connection, RFC_FUNCTION_DESC_HANDLE funcDescHandle,
+                        const ChunkedFetchOptions& options = ChunkedFetchOptions());
+
+    /**
+     * \brief  Fetches all chunks and hands them to consume.
+     *
+     * \in &prepare Sets the remaining importing parameters.
+     * \in &consume Receives the rows of every non-empty chunk.
+     * \out *errorInfo Error of the call, of the sink or of the throughput API.
+     * \return RFC_RC
+     */
+    RFC_RC fetch(const PrepareFunction& prepare, const ChunkFunction& consume, RFC_ERROR_INFO* errorInfo);
+
+    /** \brief  Chunk size for the next call. */
+    unsigned chunkRows() const { return chunkRows_; }
+
+    /** \brief  Rows received by the last fetch(). */
+    unsigned rowsFetched() const { return rowsFetched_; }
+
+    /** \brief  Measurements of every chunk of the last fetch(). */
+    const std::vector<ChunkStatistics>& statistics() const { return statistics_; }
+
+private:
+    struct Consumed
+    {
+        RFC_RC rc;
+        RFC_ERROR_INFO errorInfo;
+    };
+
+    RFC_RC fetchChunks(RFC_THROUGHPUT_HANDLE throughput, RFC_FUNCTION_HANDLE functions[2], const PrepareFunction& prepare,
+                       const ChunkFunction& consume, RFC_ERROR_INFO* errorInfo);
+    void adapt(const ChunkStatistics& statistics);
+    RFC_RC waitForConsumer(RFC_ERROR_INFO* errorInfo);
+
+    RFC_CONNECTION_HANDLE connection_;
+    RFC_FUNCTION_DESC_HANDLE funcDescHandle_;
+    ChunkedFetchOptions options_;
+    unsigned chunkRows_;
+    unsigned rowsFetched_;
+    size_t rowLength_;
+    std::vector<ChunkStatistics> statistics_;
+    std::future<Consumed> pending_;
+};
+
+} // namespace nwrfc
+
+#endif // NWRFC_UTILS_CHUNKED_TABLE_FETCHER_H
@@ -0,0 +1,110 @@
+#ifndef NWRFC_UTILS_CODEGEN_SUPPORT_H
+#define NWRFC_UTILS_CODEGEN_SUPPORT_H
+
+#include <string>
+#include <vector>
+#include "sapnwrfc.h"
+
+/*
+ * Runtime helpers used by the headers generated by struct_codegen. Scalar fields are accessed
+ * with direct RfcGet*ByIndex()/RfcSet*ByIndex() calls in the generated code, only STRING, XSTRING
+ * and nested tables need a helper.
+ */
+
+namespace nwrfc {
+namespace codegen {
+
+typedef std::basic_string<SAP_UC> ucstring;
+
+/** \struct FieldInfo
+ *
+ * Compile-time description of a generated field.
+ */
+struct FieldInfo
+{
+    const char* name;
+    RFCTYPE type;
+    unsigned nucLength;
+    unsigned ucLength;
+    unsigned decimals;
+};
+
+inline RFC_RC getString(DATA_CONTAINER_HANDLE handle, unsigned index, ucstring& value, RFC_ERROR_INFO* errorInfo)
+{
+    unsigned length = 0;
+    RFC_RC rc = RfcGetStringLengthByIndex(handle, index, &length, errorInfo);
+    if (rc != RFC_OK)
+        return rc;
+    value.resize(length + 1);
+    rc = RfcGetStringByIndex(handle, index, &value[0], length + 1, &length, errorInfo);
+    value.resize(rc == RFC_OK ? length : 0);
+    return rc;
+}
+
+inline RFC_RC setString(DATA_CONTAINER_HANDLE handle, unsigned index, const ucstring& value, RFC_ERROR_INFO* errorInfo)
+{
+    return RfcSetStringByIndex(handle, index, value.c_str(), static_cast<unsigned>(value.size()), errorInfo);
+}
+
+inline RFC_RC getXString(DATA_CONTAINER_HANDLE handle, unsigned index, std::vector<SAP_RAW>& value, RFC_ERROR_INFO* errorInfo)
+{
+    unsigned length = 0;
+    RFC_RC rc = RfcGetStringLengthByIndex(handle, index, &length, errorInfo);
+    if (rc != RFC_OK)
+        return rc;
+    value.resize(length);
+    if (length == 0)
+        return RFC_OK;
+    rc = RfcGetXStringByIndex(handle, index, &value[0], length, &length, errorInfo);
+    value.resize(rc == RFC_OK ? length : 0);
+    return rc;
+}
+
+inline RFC_RC setXString(DATA_CONTAINER_HANDLE handle, unsigned index, const std::vector<SAP_RAW>& value, RFC_ERROR_INFO* errorInfo)
+{
+    return RfcSetXStringByIndex(handle, index, value.empty() ? NULL : &value[0], static_cast<unsigned>(value.size()), errorInfo);
+}
+
+/** \brief  Reads all rows of a table, using the generated unmarshal() of the row type. */
+template <class Row>
+RFC_RC getTable(RFC_TABLE_HANDLE table, std::vector<Row>& rows, RFC_ERROR_INFO* errorInfo)
+{
+    unsigned rowCount = 0;
+    RFC_RC rc = RfcGetRowCount(table, &rowCount, errorInfo);
+    if (rc != RFC_OK)
+        return rc;
+    rows.resize(rowCount);
+    for (unsigned r = 0; r < rowCount; ++r)
+    {
+        rc = RfcMoveTo(table, r, errorInfo);
+        if (rc == RFC_OK)
+            rc = unmarshal(table, rows[r], errorInfo);
+        if (rc != RFC_OK)
+            return rc;
+    }
+    return RFC_OK;
+}
+
+/** \brief  Appends rows to a table, using the generated marshal() of the row type. */
+template <class Row>
+RFC_RC setTable(RFC_TABLE_HANDLE table, const std::vector<Row>& rows, RFC_ERROR_INFO* errorInfo)
+{
+    if (rows.empty())
+        return RFC_OK;
+    unsigned firstRow = 0;
+    RFC_RC rc = RfcGetRowCount(table, &firstRow, errorInfo);
+    if (rc == RFC_OK)
+        rc = RfcAppendNewRows(table, static_cast<unsigned>(rows.size()), errorInfo);
+    for (size_t r = 0; r < rows.size() && rc == RFC_OK; ++r)
+    {
+        rc = RfcMoveTo(table, firstRow + static_cast<unsigned>(r), errorInfo);
+        if (rc == RFC_OK)
+            rc = marshal(table, rows[r], errorInfo);
+    }
+    return rc;
+}
+
+} // namespace codegen
+} // namespace nwrfc
+
+#endif // NWRFC_UTILS_CODEGEN_SUPPORT_H
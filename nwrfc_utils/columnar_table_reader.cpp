@@ -0,0 +1,417 @@
+#include "columnar_table_reader.h"
+
+#include <limits.h>
+#include <string.h>
+#include "sapnwrfccloud.h"
+#include "rfc_error.h"
+#include "sapuc_utils.h"
+
+namespace nwrfc {
+
+namespace {
+
+/*
+ * Callbacks for the RfcGet*ColumnByIndex() family. Fixed width columns are written into the
+ * external buffer handed to the library, variable width columns are appended to the Column
+ * passed as customPtr, since their total size is not known upfront.
+ */
+
+template <class T>
+RFC_RC SAP_API storeScalar(RFC_TABLE_HANDLE, RFCTYPE, void*, T value, unsigned,
+                           SAP_RAW* externalBuffer, unsigned* position, unsigned bufferSize,
+                           unsigned, RFC_ERROR_INFO* errorInfo)
+{
+    if (bufferSize - *position < sizeof(T))
+        return setError(errorInfo, RFC_BUFFER_TOO_SMALL, cU("Column buffer exhausted"));
+    memcpy(externalBuffer + *position, &value, sizeof(T));
+    *position += sizeof(T);
+    return RFC_OK;
+}
+
+RFC_RC SAP_API storeFixedChars(RFC_TABLE_HANDLE, RFCTYPE, void* customPtr, const SAP_UC* const value,
+                               unsigned valueLength, SAP_RAW* externalBuffer, unsigned* position,
+                               unsigned bufferSize, unsigned, RFC_ERROR_INFO* errorInfo)
+{
+    const Column* column = static_cast<const Column*>(customPtr);
+    if (bufferSize - *position < column->width)
+        return setError(errorInfo, RFC_BUFFER_TOO_SMALL, cU("Column buffer exhausted"));
+
+    SAP_UC* target = reinterpret_cast<SAP_UC*>(externalBuffer + *position);
+    const unsigned width = column->width / sizeof(SAP_UC);
+    const unsigned length = valueLength < width ? valueLength : width;
+    memcpy(target, value, length * sizeof(SAP_UC));
+    for (unsigned i = length; i < width; ++i)
+        target[i] = cU(' ');
+    *position += column->width;
+    return RFC_OK;
+}
+
+RFC_RC SAP_API storeFixedBytes(RFC_TABLE_HANDLE, RFCTYPE, void* customPtr, const SAP_RAW* const value,
+                               unsigned valueLength, SAP_RAW* externalBuffer, unsigned* position,
+                               unsigned bufferSize, unsigned, RFC_ERROR_INFO* errorInfo)
+{
+    const Column* column = static_cast<const Column*>(customPtr);
+    if (bufferSize - *position < column->width)
+        return setError(errorInfo, RFC_BUFFER_TOO_SMALL, cU("Column buffer exhausted"));
+
+    SAP_RAW* target = externalBuffer + *position;
+    const unsigned length = valueLength < column->width ? valueLength : column->width;
+    memcpy(target, value, length);
+    memset(target + length, 0, column->width - length);
+    *position += column->width;
+    return RFC_OK;
+}
+
+RFC_RC appendVariable(Column* column, const void* value, size_t byteLength)
+{
+    const SAP_RAW* begin = static_cast<const SAP_RAW*>(value);
+    column->data.insert(column->data.end(), begin, begin + byteLength);
+    column->offsets.push_back(column->data.size());
+    return RFC_OK;
+}
+
+RFC_RC SAP_API storeVariableChars(RFC_TABLE_HANDLE, RFCTYPE, void* customPtr, const SAP_UC* const value,
+                                  unsigned valueLength, SAP_RAW*, unsigned*, unsigned, unsigned,
+                                  RFC_ERROR_INFO*)
+{
+    return appendVariable(static_cast<Column*>(customPtr), value, valueLength * sizeof(SAP_UC));
+}
+
+RFC_RC SAP_API storeVariableBytes(RFC_TABLE_HANDLE, RFCTYPE, void* customPtr, const SAP_RAW* const value,
+                                  unsigned valueLength, SAP_RAW*, unsigned*, unsigned, unsigned,
+                                  RFC_ERROR_INFO*)
+{
+    return appendVariable(static_cast<Column*>(customPtr), value, valueLength);
+}
+
+} // namespace
+
+void classifyColumn(Column& column)
+{
+    column.layout = COLUMN_FIXED;
+    switch (column.desc.type)
+    {
+    case RFCTYPE_INT1:      column.width = sizeof(RFC_INT1); break;
+    case RFCTYPE_INT2:      column.width = sizeof(RFC_INT2); break;
+    case RFCTYPE_INT:       column.width = sizeof(RFC_INT); break;
+    case RFCTYPE_INT8:
+    case RFCTYPE_UTCLONG:
+    case RFCTYPE_UTCSECOND:
+    case RFCTYPE_UTCMINUTE: column.width = sizeof(RFC_INT8); break;
+    case RFCTYPE_FLOAT:     column.width = sizeof(RFC_FLOAT); break;
+    case RFCTYPE_DECF16:    column.width = sizeof(RFC_DECF16); break;
+    case RFCTYPE_DECF34:
+    case RFCTYPE_BCD:       column.width = sizeof(RFC_DECF34); break;
+    case RFCTYPE_DATE:      column.width = sizeof(RFC_DATE); break;
+    case RFCTYPE_TIME:      column.width = sizeof(RFC_TIME); break;
+    case RFCTYPE_CHAR:
+    case RFCTYPE_NUM:
+    case RFCTYPE_BYTE:      column.width = column.desc.ucLength; break;
+    case RFCTYPE_STRING:
+    case RFCTYPE_XSTRING:
+        column.layout = COLUMN_VARIABLE;
+        column.width = 0;
+        break;
+    default:
+        column.layout = COLUMN_SKIPPED;
+        column.width = 0;
+        break;
+    }
+    if (column.layout == COLUMN_FIXED && column.width == 0)
+        column.layout = COLUMN_SKIPPED;
+}
+
+RFC_RC findKeyColumns(const ColumnarTableReader& reader, const std::vector<std::basic_string<SAP_UC> >& keyFields,
+                      std::vector<unsigned>& columns, RFC_ERROR_INFO* errorInfo)
+{
+    columns.clear();
+    for (size_t k = 0; k < keyFields.size(); ++k)
+    {
+        unsigned i = 0;
+        while (i < reader.columnCount() && keyFields[k] != reader.column(i).desc.name)
+            ++i;
+        if (i == reader.columnCount() || reader.column(i).layout == COLUMN_SKIPPED)
+            return setError(errorInfo, RFC_INVALID_PARAMETER,
+                            (std::basic_string<SAP_UC>(cU("Key field ")) + keyFields[k] + cU(" is not extracted")).c_str());
+        if (!isCharLikeType(reader.column(i).desc.type))
+            return setError(errorInfo, RFC_INVALID_PARAMETER,
+                            (std::basic_string<SAP_UC>(cU("Key field ")) + keyFields[k] + cU(" is not char-like")).c_str());
+        columns.push_back(i);
+    }
+    return clearError(errorInfo);
+}
+
+const SAP_RAW* Column::valueAt(unsigned row) const
+{
+    if (layout == COLUMN_VARIABLE)
+        return data.data() + offsets[row];
+    return data.data() + static_cast<size_t>(row) * width;
+}
+
+unsigned Column::byteLength(unsigned row) const
+{
+    if (layout == COLUMN_VARIABLE)
+        return static_cast<unsigned>(offsets[row + 1] - offsets[row]);
+    return width;
+}
+
+ColumnarTableReader::ColumnarTableReader(RFC_TABLE_HANDLE tableHandle, RFC_TYPE_DESC_HANDLE typeDescHandle)
+    : tableHandle_(tableHandle),
+      typeDescHandle_(typeDescHandle),
+      described_(false),
+      tableRowCount_(0),
+      firstRow_(0),
+      rowCount_(0)
+{
+}
+
+RFC_RC ColumnarTableReader::describe(RFC_ERROR_INFO* errorInfo)
+{
+    RFC_RC rc = RfcGetRowCount(tableHandle_, &tableRowCount_, errorInfo);
+    if (rc != RFC_OK)
+        return rc;
+    if (described_)
+        return RFC_OK;
+
+    unsigned fieldCount = 0;
+    rc = RfcGetFieldCount(typeDescHandle_, &fieldCount, errorInfo);
+    if (rc != RFC_OK)
+        return rc;
+
+    columns_.clear();
+    columns_.resize(fieldCount);
+    for (unsigned i = 0; i < fieldCount; ++i)
+    {
+        Column& column = columns_[i];
+        rc = RfcGetFieldDescByIndex(typeDescHandle_, i, &column.desc, errorInfo);
+        if (rc != RFC_OK)
+            return rc;
+        column.index = i;
+        classifyColumn(column);
+    }
+    described_ = true;
+    return RFC_OK;
+}
+
+RFC_RC ColumnarTableReader::selectColumns(const std::vector<std::basic_string<SAP_UC> >& names,
+                                          RFC_ERROR_INFO* errorInfo)
+{
+    RFC_RC rc = describe(errorInfo);
+    if (rc != RFC_OK)
+        return rc;
+
+    std::vector<bool> selected(columns_.size(), names.empty());
+    for (size_t n = 0; n < names.size(); ++n)
+    {
+        size_t i = 0;
+        while (i < columns_.size() && names[n] != columns_[i].desc.name)
+            ++i;
+        if (i == columns_.size())
+        {
+            std::basic_string<SAP_UC> message(cU("Field "));
+            message += names[n];
+            message += cU(" not found");
+            return setError(errorInfo, RFC_INVALID_PARAMETER, message.c_str());
+        }
+        selected[i] = true;
+    }
+    bool added = false;
+    for (size_t i = 0; i < columns_.size(); ++i)
+    {
+        Column& column = columns_[i];
+        added = added || (selected[i] && column.layout == COLUMN_SKIPPED);
+        classifyColumn(column);
+        if (!selected[i])
+        {
+            column.layout = COLUMN_SKIPPED;
+            column.width = 0;
+            std::vector<SAP_RAW>().swap(column.data);
+            std::vector<size_t>().swap(column.offsets);
+        }
+    }
+    if (added && rowCount_ > 0)
+    {
+        // The added columns hold no values for the rows read so far, so these rows are dropped.
+        for (size_t i = 0; i < columns_.size(); ++i)
+        {
+            Column& column = columns_[i];
+            column.data.clear();
+            column.offsets.clear();
+            if (column.layout == COLUMN_VARIABLE)
+                column.offsets.push_back(0);
+        }
+        rowCount_ = 0;
+    }
+    return clearError(errorInfo);
+}
+
+void ColumnarTableReader::retainRows(const std::vector<unsigned>& rows)
+{
+    const size_t count = rows.size();
+    for (size_t c = 0; c < columns_.size(); ++c)
+    {
+        Column& column = columns_[c];
+        if (column.layout == COLUMN_FIXED)
+        {
+            // rows is ascending, so row i never moves behind its origin.
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (rows[i] != i)
+                    memmove(column.data.data() + i * column.width,
+                            column.data.data() + static_cast<size_t>(rows[i]) * column.width, column.width);
+            }
+            column.data.resize(count * column.width);
+        }
+        else if (column.layout == COLUMN_VARIABLE)
+        {
+            // offsets[i] is only overwritten after offsets[rows[i]] and offsets[rows[i] + 1] are read.
+            size_t position = 0;
+            for (size_t i = 0; i < count; ++i)
+            {
+                const size_t begin = column.offsets[rows[i]];
+                const size_t length = column.offsets[rows[i] + 1] - begin;
+                if (begin != position)
+                    memmove(column.data.data() + position, column.data.data() + begin, length);
+                column.offsets[i] = position;
+                position += length;
+            }
+            column.data.resize(position);
+            column.offsets.resize(count + 1);
+            column.offsets[count] = position;
+        }
+    }
+    rowCount_ = static_cast<unsigned>(count);
+}
+
+RFC_RC ColumnarTableReader::read(RFC_ERROR_INFO* errorInfo)
+{
+    return read(0, UINT_MAX, errorInfo);
+}
+
+RFC_RC ColumnarTableReader::read(unsigned fromRow, unsigned numberOfRows, RFC_ERROR_INFO* errorInfo)
+{
+    RFC_RC rc = describe(errorInfo);
+    if (rc != RFC_OK)
+        return rc;
+
+    if (fromRow > tableRowCount_)
+        fromRow = tableRowCount_;
+    if (numberOfRows > tableRowCount_ - fromRow)
+        numberOfRows = tableRowCount_ - fromRow;
+
+    firstRow_ = fromRow;
+    rowCount_ = 0;
+    for (size_t i = 0; i < columns_.size(); ++i)
+    {
+        rc = readColumn(columns_[i], fromRow, numberOfRows, errorInfo);
+        if (rc != RFC_OK)
+            return rc;
+    }
+    rowCount_ = numberOfRows;
+    return clearError(errorInfo);
+}
+
+RFC_RC ColumnarTableReader::readColumn(Column& column, unsigned fromRow, unsigned numberOfRows,
+                                       RFC_ERROR_INFO* errorInfo)
+{
+    column.data.clear();
+    column.offsets.clear();
+
+    if (column.layout == COLUMN_SKIPPED)
+        return RFC_OK;
+
+    RFC_RC rc = RFC_OK;
+    unsigned rowsFetched = 0;
+
+    if (column.layout == COLUMN_VARIABLE)
+    {
+        column.offsets.reserve(static_cast<size_t>(numberOfRows) + 1);
+        column.offsets.push_back(0);
+
+        // The callbacks append to the column directly, the external buffer is not used.
+        SAP_RAW unused = 0;
+        unsigned position = 0;
+        if (column.desc.type == RFCTYPE_STRING)
+            rc = RfcGetStringColumnByIndex(tableHandle_, column.index, &unused, &position, 0, storeVariableChars,
+                                           &column, fromRow, numberOfRows, &rowsFetched, errorInfo);
+        else
+            rc = RfcGetByteColumnByIndex(tableHandle_, column.index, &unused, &position, 0, storeVariableBytes,
+                                         &column, fromRow, numberOfRows, &rowsFetched, errorInfo);
+        if (rc == RFC_OK && rowsFetched != numberOfRows)
+            rc = setError(errorInfo, RFC_ILLEGAL_STATE, cU("Table changed during column extraction"));
+        return rc;
+    }
+
+    column.data.resize(static_cast<size_t>(numberOfRows) * column.width);
+
+    // externalBufferSizeInBytes is an unsigned, so very large columns are fetched in slices.
+    const unsigned rowsPerCall = UINT_MAX / column.width;
+    for (unsigned done = 0; done < numberOfRows; done += rowsFetched)
+    {
+        const unsigned rows = numberOfRows - done < rowsPerCall ? numberOfRows - done : rowsPerCall;
+        SAP_RAW* buffer = column.data.data() + static_cast<size_t>(done) * column.width;
+        const unsigned size = rows * column.width;
+        const unsigned row = fromRow + done;
+        unsigned position = 0;
+        rowsFetched = 0;
+
+        switch (column.desc.type)
+        {
+        case RFCTYPE_INT1:
+            rc = RfcGetInt1ColumnByIndex(tableHandle_, column.index, buffer, &position, size, storeScalar<RFC_INT1>,
+                                         &column, row, rows, &rowsFetched, errorInfo);
+            break;
+        case RFCTYPE_INT2:
+            rc = RfcGetInt2ColumnByIndex(tableHandle_, column.index, buffer, &position, size, storeScalar<RFC_INT2>,
+                                         &column, row, rows, &rowsFetched, errorInfo);
+            break;
+        case RFCTYPE_INT:
+            rc = RfcGetInt4ColumnByIndex(tableHandle_, column.index, buffer, &position, size, storeScalar<RFC_INT>,
+                                         &column, row, rows, &rowsFetched, errorInfo);
+            break;
+        case RFCTYPE_INT8:
+        case RFCTYPE_UTCLONG:
+        case RFCTYPE_UTCSECOND:
+        case RFCTYPE_UTCMINUTE:
+            rc = RfcGetInt8ColumnByIndex(tableHandle_, column.index, buffer, &position, size, storeScalar<RFC_INT8>,
+                                         &column, row, rows, &rowsFetched, errorInfo);
+            break;
+        case RFCTYPE_FLOAT:
+            rc = RfcGetDoubleColumnByIndex(tableHandle_, column.index, buffer, &position, size, storeScalar<RFC_FLOAT>,
+                                           &column, row, rows, &rowsFetched, errorInfo);
+            break;
+        case RFCTYPE_DECF16:
+            rc = RfcGetDec16ColumnByIndex(tableHandle_, column.index, buffer, &position, size, storeScalar<RFC_DECF16>,
+                                          &column, row, rows, &rowsFetched, errorInfo);
+            break;
+        case RFCTYPE_DECF34:
+        case RFCTYPE_BCD:
+            rc = RfcGetDec34ColumnByIndex(tableHandle_, column.index, buffer, &position, size, storeScalar<RFC_DECF34>,
+                                          &column, row, rows, &rowsFetched, errorInfo);
+            break;
+        case RFCTYPE_DATE:
+            rc = RfcGetDateColumnByIndex(tableHandle_, column.index, buffer, &position, size, storeFixedChars,
+                                         &column, row, rows, &rowsFetched, errorInfo);
+            break;
+        case RFCTYPE_TIME:
+            rc = RfcGetTimeColumnByIndex(tableHandle_, column.index, buffer, &position, size, storeFixedChars,
+                                         &column, row, rows, &rowsFetched, errorInfo);
+            break;
+        case RFCTYPE_BYTE:
+            rc = RfcGetByteColumnByIndex(tableHandle_, column.index, buffer, &position, size, storeFixedBytes,
+                                         &column, row, rows, &rowsFetched, errorInfo);
+            break;
+        default: // RFCTYPE_CHAR, RFCTYPE_NUM
+            rc = RfcGetStringColumnByIndex(tableHandle_, column.index, buffer, &position, size, storeFixedChars,
+                                           &column, row, rows, &rowsFetched, errorInfo);
+            break;
+        }
+        if (rc != RFC_OK)
+            return rc;
+        if (rowsFetched != rows)
+            return setError(errorInfo, RFC_ILLEGAL_STATE, cU("Table changed during column extraction"));
+    }
+    return RFC_OK;
+}
+
+} // namespace nwrfc
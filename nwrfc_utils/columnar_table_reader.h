@@ -0,0 +1,196 @@
+#ifndef NWRFC_UTILS_COLUMNAR_TABLE_READER_H
+#define NWRFC_UTILS_COLUMNAR_TABLE_READER_H
+
+#include <string>
+#include <vector>
+#include "sapnwrfc.h"
+
+namespace nwrfc {
+
+/** \enum ColumnLayout
+ *
+ * Describes how the values of a Column are laid out in Column::data.
+ */
+enum ColumnLayout
+{
+    COLUMN_FIXED,       ///< Every row occupies Column::width bytes, row i starts at i * width.
+    COLUMN_VARIABLE,    ///< Row i occupies bytes [offsets[i], offsets[i+1]) of the data buffer.
+    COLUMN_SKIPPED      ///< Nested structures/tables and unsupported types are not extracted.
+};
+
+/** \struct Column
+ *
+ * One extracted table column. Values are stored contiguously in their native
+ * representation:
+ * - RFCTYPE_INT1, INT2, INT, INT8, UTCxxx: RFC_INT1, RFC_INT2, RFC_INT, RFC_INT8
+ * - RFCTYPE_FLOAT: RFC_FLOAT
+ * - RFCTYPE_DECF16: RFC_DECF16
+ * - RFCTYPE_DECF34 and RFCTYPE_BCD: RFC_DECF34
+ * - RFCTYPE_CHAR, NUM, DATE, TIME: fixed width SAP_UC, blank padded, not null-terminated
+ * - RFCTYPE_BYTE: fixed width SAP_RAW, zero padded
+ * - RFCTYPE_STRING (SAP_UC) and RFCTYPE_XSTRING (SAP_RAW): variable layout
+ */
+struct Column
+{
+    RFC_FIELD_DESC desc;            ///< Field description as returned by RfcGetFieldDescByIndex()
+    unsigned index;                 ///< Field index within the row type
+    ColumnLayout layout;            ///< Layout of data
+    unsigned width;                 ///< Bytes per row for COLUMN_FIXED, 0 otherwise
+    std::vector<SAP_RAW> data;      ///< Column values
+    std::vector<size_t> offsets;    ///< rowCount + 1 byte offsets into data for COLUMN_VARIABLE
+
+    /** \brief  Typed view of the value buffer, e.g. values<RFC_INT>() for an RFCTYPE_INT column. */
+    template <class T> const T* values() const { return reinterpret_cast<const T*>(data.data()); }
+
+    /** \brief  Start of the value of the given row (fixed and variable layout). */
+    const SAP_RAW* valueAt(unsigned row) const;
+
+    /** \brief  Length of the value of the given row in bytes. */
+    unsigned byteLength(unsigned row) const;
+
+    /** \brief  Value of a char-like column (CHAR, NUM, DATE, TIME, STRING) at the given row. */
+    const SAP_UC* charsAt(unsigned row) const { return reinterpret_cast<const SAP_UC*>(valueAt(row)); }
+
+    /** \brief  Length of a char-like value in SAP_UC. */
+    unsigned charLength(unsigned row) const { return byteLength(row) / sizeof(SAP_UC); }
+};
+
+/**
+ * \brief  Sets Column::layout and Column::width from Column::desc.
+ *
+ * \in &column Column with a filled desc.
+ */
+void classifyColumn(Column& column);
+
+class ColumnarTableReader;
+
+/**
+ * \brief  Looks up the columns of key fields, which must be extracted and fixed-length char-like.
+ *
+ * \in &reader Reader of the table.
+ * \in &keyFields Field names of the key, in key order.
+ * \out &columns Column index of every key field.
+ * \out *errorInfo RFC_INVALID_PARAMETER if a key field is not extracted or not char-like.
+ * \return RFC_RC
+ */
+RFC_RC findKeyColumns(const ColumnarTableReader& reader, const std::vector<std::basic_string<SAP_UC> >& keyFields,
+                      std::vector<unsigned>& columns, RFC_ERROR_INFO* errorInfo);
+
+/**
+ * \brief  Extracts whole table columns into contiguous, typed buffers.
+ *
+ * Instead of walking the table with RfcMoveToNextRow() and reading every cell with RfcGetChars()
+ * & co, the reader issues one RfcGet*ColumnByIndex() call per column. The per-row callbacks only
+ * copy the value into the column buffer, there is no table cursor involved.
+ *
+ * \code
+ * nwrfc::ColumnarTableReader reader(table, RfcGetRowType(table, &errorInfo));
+ * if (reader.read(&errorInfo) == RFC_OK)
+ * {
+ *     const nwrfc::Column& amounts = reader.column(3);
+ *     const RFC_DECF34* values = amounts.values<RFC_DECF34>();
+ *     ...
+ * }
+ * \endcode
+ *
+ * The reader does not own the table or type description handle. Buffers are reused between
+ * read() calls, a reader is not thread-safe.
+ */
+class ColumnarTableReader
+{
+public:
+    ColumnarTableReader(RFC_TABLE_HANDLE tableHandle, RFC_TYPE_DESC_HANDLE typeDescHandle);
+
+    /**
+     * \brief  Extracts all rows of the table.
+     *
+     * \out *errorInfo More information in case a column cannot be extracted.
+     * \return RFC_RC
+     */
+    RFC_RC read(RFC_ERROR_INFO* errorInfo);
+
+    /**
+     * \brief  Extracts the rows [fromRow, fromRow + numberOfRows) of the table.
+     *
+     * numberOfRows is clipped to the end of the table. Column buffers only hold the
+     * requested window afterwards, i.e. row 0 of a column is table row fromRow.
+     *
+     * \in fromRow First table row to extract.
+     * \in numberOfRows Maximum number of rows to extract.
+     * \out *errorInfo More information in case a column cannot be extracted.
+     * \return RFC_RC
+     */
+    RFC_RC read(unsigned fromRow, unsigned numberOfRows, RFC_ERROR_INFO* errorInfo);
+
+    /**
+     * \brief  Reads the field descriptions and table size without extracting any data.
+     *
+     * Called implicitly by read(). Can be used to inspect the columns upfront.
+     *
+     * \out *errorInfo More information in case the metadata cannot be read.
+     * \return RFC_RC
+     */
+    RFC_RC describe(RFC_ERROR_INFO* errorInfo);
+
+    /**
+     * \brief  Restricts the extraction to the given fields.
+     *
+     * All other columns become COLUMN_SKIPPED and keep empty buffers, so a read() of 5 out of 300
+     * fields issues 5 RfcGet*ColumnByIndex() calls. Column indices stay field indices. An empty
+     * list selects all fields again. Takes effect with the next read(). If fields are added to the
+     * selection, the rows held from the last read() are dropped and rowCount() becomes 0, since the
+     * added columns have no values for them.
+     *
+     * \in &names Field names of the row type.
+     * \out *errorInfo RFC_INVALID_PARAMETER if a field does not exist.
+     * \return RFC_RC
+     */
+    RFC_RC selectColumns(const std::vector<std::basic_string<SAP_UC> >& names, RFC_ERROR_INFO* errorInfo);
+
+    /**
+     * \brief  Compacts the column buffers to the given rows, e.g. the rows accepted by a RowFilter.
+     *
+     * Afterwards row i of every column is the former row rows[i] and rowCount() is rows.size().
+     *
+     * \in &rows Ascending row numbers within the column buffers.
+     */
+    void retainRows(const std::vector<unsigned>& rows);
+
+    /** \brief  Number of rows in the table, valid after describe(). */
+    unsigned tableRowCount() const { return tableRowCount_; }
+
+    /** \brief  Number of rows held in the column buffers after the last read(). */
+    unsigned rowCount() const { return rowCount_; }
+
+    /** \brief  First table row held in the column buffers. */
+    unsigned firstRow() const { return firstRow_; }
+
+    unsigned columnCount() const { return static_cast<unsigned>(columns_.size()); }
+    const Column& column(unsigned index) const { return columns_[index]; }
+
+    /** \brief  Mutable access, e.g. to move a column buffer out instead of copying it. */
+    Column& column(unsigned index) { return columns_[index]; }
+    const std::vector<Column>& columns() const { return columns_; }
+
+    RFC_TABLE_HANDLE tableHandle() const { return tableHandle_; }
+
+    /** \brief  Switches to another table of the same row type, e.g. the next nested table. */
+    void setTableHandle(RFC_TABLE_HANDLE tableHandle) { tableHandle_ = tableHandle; }
+
+    RFC_TYPE_DESC_HANDLE typeDescHandle() const { return typeDescHandle_; }
+
+private:
+    RFC_RC readColumn(Column& column, unsigned fromRow, unsigned numberOfRows, RFC_ERROR_INFO* errorInfo);
+
+    RFC_TABLE_HANDLE tableHandle_;
+    RFC_TYPE_DESC_HANDLE typeDescHandle_;
+    std::vector<Column> columns_;
+    bool described_;
+    unsigned tableRowCount_;
+    unsigned firstRow_;
+    unsigned rowCount_;
+};
+
+} // namespace nwrfc
+
+#endif // NWRFC_UTILS_COLUMNAR_TABLE_READER_H
@@ -0,0 +1,234 @@
+#include "columnar_table_writer.h"
+
+#include <string.h>
+#include "rfc_error.h"
+#include "sapuc_utils.h"
+
+namespace nwrfc {
+
+namespace {
+
+// Rows assembled per block of the char buffer path.
+const unsigned CHAR_BUFFER_BLOCK = 256;
+
+/* Bytes per value of a fixed width source column. */
+unsigned sourceWidth(const ColumnSource& column, const RFC_FIELD_DESC& field)
+{
+    switch (field.type)
+    {
+    case RFCTYPE_DATE: return sizeof(RFC_DATE);
+    case RFCTYPE_TIME: return sizeof(RFC_TIME);
+    case RFCTYPE_CHAR:
+    case RFCTYPE_NUM:
+    case RFCTYPE_BYTE: return column.width != 0 ? column.width : field.ucLength;
+    default:           return 0;
+    }
+}
+
+template <class T>
+const T& valueAt(const ColumnSource& column, unsigned row)
+{
+    return static_cast<const T*>(column.data)[row];
+}
+
+} // namespace
+
+ColumnSource ColumnSource::fromColumn(const Column& column)
+{
+    return ColumnSource(column.index, column.data.data(), column.width,
+                        column.layout == COLUMN_VARIABLE ? column.offsets.data() : NULL);
+}
+
+ColumnarTableWriter::ColumnarTableWriter(RFC_TABLE_HANDLE tableHandle, RFC_TYPE_DESC_HANDLE typeDescHandle)
+    : tableHandle_(tableHandle),
+      typeDescHandle_(typeDescHandle),
+      codec_(typeDescHandle),
+      useCharBuffer_(true),
+      described_(false)
+{
+}
+
+RFC_RC ColumnarTableWriter::describe(RFC_ERROR_INFO* errorInfo)
+{
+    if (described_)
+        return RFC_OK;
+
+    unsigned fieldCount = 0;
+    RFC_RC rc = RfcGetFieldCount(typeDescHandle_, &fieldCount, errorInfo);
+    if (rc != RFC_OK)
+        return rc;
+    fields_.resize(fieldCount);
+    for (unsigned i = 0; i < fieldCount; ++i)
+    {
+        rc = RfcGetFieldDescByIndex(typeDescHandle_, i, &fields_[i], errorInfo);
+        if (rc != RFC_OK)
+            return rc;
+    }
+
+    rc = codec_.describe(errorInfo);
+    if (rc != RFC_OK)
+        return rc;
+    described_ = true;
+    return RFC_OK;
+}
+
+RFC_RC ColumnarTableWriter::append(const ColumnSource* columns, unsigned columnCount, unsigned rowCount,
+                                   RFC_ERROR_INFO* errorInfo)
+{
+    RFC_RC rc = describe(errorInfo);
+    if (rc != RFC_OK)
+        return rc;
+
+    for (unsigned i = 0; i < columnCount; ++i)
+    {
+        if (columns[i].index >= fields_.size())
+            return setError(errorInfo, RFC_INVALID_PARAMETER, cU("Column index out of range"));
+        if (columns[i].data == NULL && rowCount > 0)
+            return setError(errorInfo, RFC_INVALID_PARAMETER, cU("Column without data"));
+        const RFCTYPE type = fields_[columns[i].index].type;
+        if ((type == RFCTYPE_STRING || type == RFCTYPE_XSTRING) && columns[i].offsets == NULL)
+            return setError(errorInfo, RFC_INVALID_PARAMETER, cU("STRING/XSTRING column without offsets"));
+    }
+    if (rowCount == 0)
+        return clearError(errorInfo);
+
+    unsigned firstRow = 0;
+    rc = RfcGetRowCount(tableHandle_, &firstRow, errorInfo);
+    if (rc == RFC_OK)
+        rc = RfcReserveCapacity(tableHandle_, rowCount, errorInfo);
+    if (rc == RFC_OK)
+        rc = RfcAppendNewRows(tableHandle_, rowCount, errorInfo);
+    if (rc != RFC_OK)
+        return rc;
+
+    if (useCharBuffer_ && canUseCharBuffer(columns, columnCount))
+        return appendCharBuffer(columns, columnCount, firstRow, rowCount, errorInfo);
+
+    for (unsigned i = 0; i < columnCount; ++i)
+    {
+        rc = appendColumn(columns[i], firstRow, rowCount, errorInfo);
+        if (rc != RFC_OK)
+            return rc;
+    }
+    return clearError(errorInfo);
+}
+
+bool ColumnarTableWriter::canUseCharBuffer(const ColumnSource* columns, unsigned columnCount) const
+{
+    if (!codec_.isCharLike() || codec_.rowLength() == 0)
+        return false;
+    for (unsigned i = 0; i < columnCount; ++i)
+    {
+        const RFC_FIELD_DESC& field = fields_[columns[i].index];
+        if (sourceWidth(columns[i], field) != field.ucLength)
+            return false;
+    }
+    return true;
+}
+
+RFC_RC ColumnarTableWriter::appendCharBuffer(const ColumnSource* columns, unsigned columnCount, unsigned firstRow,
+                                             unsigned rowCount, RFC_ERROR_INFO* errorInfo)
+{
+    // All fields are char-like, so field i of the row type is field i of the codec.
+    const size_t rowLength = codec_.rowLength();
+    std::vector<SAP_UC> rows(static_cast<size_t>(CHAR_BUFFER_BLOCK) * rowLength);
+    for (unsigned blockStart = 0; blockStart < rowCount; blockStart += CHAR_BUFFER_BLOCK)
+    {
+        const unsigned blockRows = rowCount - blockStart < CHAR_BUFFER_BLOCK ? rowCount - blockStart : CHAR_BUFFER_BLOCK;
+        codec_.initRows(&rows[0], blockRows);
+        for (unsigned i = 0; i < columnCount; ++i)
+        {
+            const size_t offset = static_cast<size_t>(blockStart) * codec_.fields()[columns[i].index].length;
+            codec_.insertColumn(static_cast<const SAP_UC*>(columns[i].data) + offset, blockRows, columns[i].index, &rows[0]);
+        }
+
+        for (unsigned r = 0; r < blockRows; ++r)
+        {
+            RFC_RC rc = RfcMoveTo(tableHandle_, firstRow + blockStart + r, errorInfo);
+            if (rc == RFC_OK)
+                rc = codec_.encodeRow(tableHandle_, &rows[r * rowLength], errorInfo);
+            if (rc != RFC_OK)
+                return rc;
+        }
+    }
+    return clearError(errorInfo);
+}
+
+RFC_RC ColumnarTableWriter::appendColumn(const ColumnSource& column, unsigned firstRow, unsigned rowCount,
+                                         RFC_ERROR_INFO* errorInfo)
+{
+    const RFC_FIELD_DESC& field = fields_[column.index];
+    const unsigned index = column.index;
+    const unsigned width = sourceWidth(column, field);
+    const SAP_RAW* bytes = static_cast<const SAP_RAW*>(column.data);
+
+    for (unsigned r = 0; r < rowCount; ++r)
+    {
+        RFC_RC rc = RfcMoveTo(tableHandle_, firstRow + r, errorInfo);
+        if (rc != RFC_OK)
+            return rc;
+
+        const SAP_RAW* fixed = bytes + static_cast<size_t>(r) * width;
+        switch (field.type)
+        {
+        case RFCTYPE_INT1:
+            rc = RfcSetInt1ByIndex(tableHandle_, index, valueAt<RFC_INT1>(column, r), errorInfo);
+            break;
+        case RFCTYPE_INT2:
+            rc = RfcSetInt2ByIndex(tableHandle_, index, valueAt<RFC_INT2>(column, r), errorInfo);
+            break;
+        case RFCTYPE_INT:
+            rc = RfcSetIntByIndex(tableHandle_, index, valueAt<RFC_INT>(column, r), errorInfo);
+            break;
+        case RFCTYPE_INT8:
+        case RFCTYPE_UTCLONG:
+        case RFCTYPE_UTCSECOND:
+        case RFCTYPE_UTCMINUTE:
+            rc = RfcSetInt8ByIndex(tableHandle_, index, valueAt<RFC_INT8>(column, r), errorInfo);
+            break;
+        case RFCTYPE_FLOAT:
+            rc = RfcSetFloatByIndex(tableHandle_, index, valueAt<RFC_FLOAT>(column, r), errorInfo);
+            break;
+        case RFCTYPE_DECF16:
+            rc = RfcSetDecF16ByIndex(tableHandle_, index, valueAt<RFC_DECF16>(column, r), errorInfo);
+            break;
+        case RFCTYPE_DECF34:
+        case RFCTYPE_BCD:
+            rc = RfcSetDecF34ByIndex(tableHandle_, index, valueAt<RFC_DECF34>(column, r), errorInfo);
+            break;
+        case RFCTYPE_CHAR:
+            rc = RfcSetCharsByIndex(tableHandle_, index, reinterpret_cast<const SAP_UC*>(fixed),
+                                    width / sizeof(SAP_UC), errorInfo);
+            break;
+        case RFCTYPE_NUM:
+            rc = RfcSetNumByIndex(tableHandle_, index, reinterpret_cast<const SAP_UC*>(fixed),
+                                  width / sizeof(SAP_UC), errorInfo);
+            break;
+        case RFCTYPE_DATE:
+            rc = RfcSetDateByIndex(tableHandle_, index, reinterpret_cast<const SAP_UC*>(fixed), errorInfo);
+            break;
+        case RFCTYPE_TIME:
+            rc = RfcSetTimeByIndex(tableHandle_, index, reinterpret_cast<const SAP_UC*>(fixed), errorInfo);
+            break;
+        case RFCTYPE_BYTE:
+            rc = RfcSetBytesByIndex(tableHandle_, index, fixed, width, errorInfo);
+            break;
+        case RFCTYPE_STRING:
+            rc = RfcSetStringByIndex(tableHandle_, index, reinterpret_cast<const SAP_UC*>(bytes + column.offsets[r]),
+                                     static_cast<unsigned>((column.offsets[r + 1] - column.offsets[r]) / sizeof(SAP_UC)),
+                                     errorInfo);
+            break;
+        case RFCTYPE_XSTRING:
+            rc = RfcSetXStringByIndex(tableHandle_, index, bytes + column.offsets[r],
+                                      static_cast<unsigned>(column.offsets[r + 1] - column.offsets[r]), errorInfo);
+            break;
+        default:
+            return setError(errorInfo, RFC_INVALID_PARAMETER, cU("Unsupported field type for columnar input"));
+        }
+        if (rc != RFC_OK)
+            return rc;
+    }
+    return RFC_OK;
+}
+
+} // namespace nwrfc
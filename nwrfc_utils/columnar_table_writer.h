@@ -0,0 +1,96 @@
+#ifndef NWRFC_UTILS_COLUMNAR_TABLE_WRITER_H
+#define NWRFC_UTILS_COLUMNAR_TABLE_WRITER_H
+
+#include <stddef.h>
+#include <vector>
+#include "sapnwrfc.h"
+#include "columnar_table_reader.h"
+#include "flat_structure_codec.h"
+
+namespace nwrfc {
+
+/** \struct ColumnSource
+ *
+ * Values of one field for all rows to append. The values use the representation of Column:
+ * - RFCTYPE_INT1, INT2, INT, INT8, UTCxxx: arrays of RFC_INT1, RFC_INT2, RFC_INT, RFC_INT8
+ * - RFCTYPE_FLOAT: RFC_FLOAT, RFCTYPE_DECF16: RFC_DECF16, RFCTYPE_DECF34 and BCD: RFC_DECF34
+ * - RFCTYPE_CHAR, NUM, DATE, TIME: fixed width SAP_UC, not null-terminated
+ * - RFCTYPE_BYTE: fixed width SAP_RAW
+ * - RFCTYPE_STRING (SAP_UC) and RFCTYPE_XSTRING (SAP_RAW): concatenated values plus offsets
+ */
+struct ColumnSource
+{
+    unsigned index;         ///< Field index within the row type
+    const void* data;       ///< Column values
+    unsigned width;         ///< Bytes per value of CHAR, NUM, BYTE. 0: the field length. Ignored for other types
+    const size_t* offsets;  ///< rowCount + 1 byte offsets into data for STRING/XSTRING, NULL otherwise
+
+    ColumnSource() : index(0), data(NULL), width(0), offsets(NULL) {}
+    ColumnSource(unsigned index, const void* data, unsigned width = 0, const size_t* offsets = NULL)
+        : index(index), data(data), width(width), offsets(offsets) {}
+
+    /** \brief  Source reading the buffers of an extracted Column, e.g. to copy a table. */
+    static ColumnSource fromColumn(const Column& column);
+};
+
+/**
+ * \brief  Appends rows to an RFC table from columnar buffers.
+ *
+ * Replaces the RfcAppendNewRow() + RfcSetChars()/RfcSetInt() per cell pattern for large import
+ * tables. All rows are allocated at once with RfcReserveCapacity() and RfcAppendNewRows(), then
+ * the cells are filled column by column, so every source buffer is read sequentially.
+ *
+ * If the row type only consists of char-like fields (CHAR, NUM, DATE, TIME) and all given columns
+ * have the field width, the rows are assembled in the ABAP layout by a FlatStructureCodec and
+ * every row is set with a single RfcSetStructureFromCharBuffer() call instead of one setter call
+ * per field.
+ *
+ * \code
+ * std::vector<SAP_UC> matnr(rows * 40);
+ * std::vector<RFC_INT> quantity(rows);
+ * ...
+ * nwrfc::ColumnSource sources[] = { nwrfc::ColumnSource(0, &matnr[0]), nwrfc::ColumnSource(3, &quantity[0]) };
+ * nwrfc::ColumnarTableWriter writer(table, rowType);
+ * rc = writer.append(sources, 2, rows, &errorInfo);
+ * \endcode
+ *
+ * Fields without a ColumnSource keep their initial value. If append() fails, the rows appended
+ * so far stay in the table. The writer does not own the table or type description handle.
+ */
+class ColumnarTableWriter
+{
+public:
+    ColumnarTableWriter(RFC_TABLE_HANDLE tableHandle, RFC_TYPE_DESC_HANDLE typeDescHandle);
+
+    /**
+     * \brief  Appends rowCount rows filled from the given columns.
+     *
+     * \in *columns Values per field.
+     * \in columnCount Number of entries in columns.
+     * \in rowCount Number of rows to append.
+     * \out *errorInfo More information in case a value cannot be set.
+     * \return RFC_RC
+     */
+    RFC_RC append(const ColumnSource* columns, unsigned columnCount, unsigned rowCount, RFC_ERROR_INFO* errorInfo);
+
+    /** \brief  Enables or disables the RfcSetStructureFromCharBuffer() path. Default: enabled. */
+    void setUseCharBuffer(bool useCharBuffer) { useCharBuffer_ = useCharBuffer; }
+
+private:
+    RFC_RC describe(RFC_ERROR_INFO* errorInfo);
+    bool canUseCharBuffer(const ColumnSource* columns, unsigned columnCount) const;
+    RFC_RC appendCharBuffer(const ColumnSource* columns, unsigned columnCount, unsigned firstRow,
+                            unsigned rowCount, RFC_ERROR_INFO* errorInfo);
+    RFC_RC appendColumn(const ColumnSource& column, unsigned firstRow, unsigned rowCount, RFC_ERROR_INFO* errorInfo);
+
+    RFC_TABLE_HANDLE tableHandle_;
+    RFC_TYPE_DESC_HANDLE typeDescHandle_;
+    std::vector<RFC_FIELD_DESC> fields_;
+    FlatStructureCodec codec_;
+    bool useCharBuffer_;
+    bool described_;
+};
+
+} // namespace nwrfc
+
+#endif // NWRFC_UTILS_COLUMNAR_TABLE_WRITER_H
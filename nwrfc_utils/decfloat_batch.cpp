@@ -0,0 +1,886 @@
+#include "decfloat_batch.h"
+
+#include <float.h>
+#include <limits.h>
+#include <string.h>
+#include <string>
+#include "char_column_views.h"
+#include "rfc_error.h"
+
+#if defined(__SIZEOF_INT128__) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define NWRFC_DECFLOAT_KERNELS 1
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define NWRFC_SSE2_KERNELS 1
+#include <emmintrin.h>
+#endif
+
+namespace nwrfc {
+
+namespace {
+
+/* The sapdecf.h functions of one format, so that the batch loops exist once. */
+struct Format16
+{
+    typedef RFC_DECF16 Value;
+    typedef DecFloat16Buff Buffer;
+    enum { DIGITS = 16, MIN_EXPONENT = -398, MAX_EXPONENT = 369 };
+
+    static DECF_RETURN toString(const Value& value, Buffer* buffer) { return DecFloat16ToString(value, buffer); }
+    static DECF_RETURN fromString(const SAP_UC* text, Value* value) { return StringToDecFloat16(text, value); }
+    static DECF_RETURN toDouble(RFC_FLOAT* number, const Value& value) { return DecFloat16ToSAP_DOUBLE(number, value); }
+    static DECF_RETURN fromDouble(Value* value, RFC_FLOAT number) { return SAP_DOUBLEToDecFloat16(value, number); }
+    static DECF_RETURN fromInt(Value* value, SAP_INT number) { return SAP_INTToDecFloat16(value, number); }
+    static DECF_RETURN toBcd(SAP_RAW* bcd, const Value& value, unsigned length, unsigned decimals)
+    { return DecFloat16ToBCD(bcd, value, static_cast<intR>(length), static_cast<intR>(decimals)); }
+    static DECF_RETURN fromBcd(Value* value, const SAP_RAW* bcd, unsigned length, unsigned decimals)
+    { return BCDToDecFloat16(value, const_cast<SAP_RAW*>(bcd), static_cast<intR>(length), static_cast<intR>(decimals)); }
+};
+
+struct Format34
+{
+    typedef RFC_DECF34 Value;
+    typedef DecFloat34Buff Buffer;
+    enum { DIGITS = 34, MIN_EXPONENT = -6176, MAX_EXPONENT = 6111 };
+
+    static DECF_RETURN toString(const Value& value, Buffer* buffer) { return DecFloat34ToString(value, buffer); }
+    static DECF_RETURN fromString(const SAP_UC* text, Value* value) { return StringToDecFloat34(text, value); }
+    static DECF_RETURN toDouble(RFC_FLOAT* number, const Value& value) { return DecFloat34ToSAP_DOUBLE(number, value); }
+    static DECF_RETURN fromDouble(Value* value, RFC_FLOAT number) { return SAP_DOUBLEToDecFloat34(value, number); }
+    static DECF_RETURN fromInt(Value* value, SAP_INT number) { return SAP_INTToDecFloat34(value, number); }
+    static DECF_RETURN toBcd(SAP_RAW* bcd, const Value& value, unsigned length, unsigned decimals)
+    { return DecFloat34ToBCD(bcd, value, static_cast<intR>(length), static_cast<intR>(decimals)); }
+    static DECF_RETURN fromBcd(Value* value, const SAP_RAW* bcd, unsigned length, unsigned decimals)
+    { return BCDToDecFloat34(value, const_cast<SAP_RAW*>(bcd), static_cast<intR>(length), static_cast<intR>(decimals)); }
+};
+
+void appendNumber(std::basic_string<SAP_UC>& target, long long number)
+{
+    SAP_UC digits[24];
+    unsigned position = sizeof(digits) / sizeof(SAP_UC);
+    unsigned long long magnitude = number < 0 ? 0 - static_cast<unsigned long long>(number) : static_cast<unsigned long long>(number);
+    do
+    {
+        digits[--position] = static_cast<SAP_UC>(cU('0') + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+    if (number < 0)
+        digits[--position] = cU('-');
+    target.append(digits + position, sizeof(digits) / sizeof(SAP_UC) - position);
+}
+
+/* Collects the return codes of a batch and reports the first one that is not "almost fine". */
+class Outcome
+{
+public:
+    explicit Outcome(DECF_RETURN* codes) : codes_(codes), failed_(false), index_(0), code_(DECF_OK) {}
+
+    void record(size_t index, DECF_RETURN code)
+    {
+        if (codes_ != NULL)
+            codes_[index] = code;
+        if (!failed_ && code != DECF_OK && code != DECF_INEXACT && code != DECF_UNDERFLOW)
+        {
+            failed_ = true;
+            index_ = index;
+            code_ = code;
+        }
+    }
+
+    RFC_RC finish(RFC_ERROR_INFO* errorInfo) const
+    {
+        if (!failed_)
+            return clearError(errorInfo);
+        std::basic_string<SAP_UC> message(cU("DecFloat conversion of value "));
+        appendNumber(message, static_cast<long long>(index_));
+        message += cU(" failed with DECF_RETURN ");
+        appendNumber(message, code_);
+        return setError(errorInfo, RFC_CONVERSION_FAILURE, message.c_str());
+    }
+
+private:
+    DECF_RETURN* codes_;
+    bool failed_;
+    size_t index_;
+    DECF_RETURN code_;
+};
+
+#ifdef NWRFC_DECFLOAT_KERNELS
+
+typedef unsigned __int128 uint128;
+
+const uint64_t POW10[20] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL,
+    10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL, 100000000000000ULL,
+    1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL, 1000000000000000000ULL,
+    10000000000000000000ULL
+};
+
+// Exact powers of ten, the largest is 10^22.
+const double POW10_DOUBLE[23] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+struct Decoded
+{
+    uint128 coefficient;
+    int exponent;
+    bool negative;
+    bool canonical;         // finite with a coefficient within the precision; everything else goes to the library
+    DecFloatClass valueClass;
+};
+
+const uint64_t SPECIAL = 0x7800000000000000ULL;
+const uint64_t NAN_BITS = 0x7C00000000000000ULL;
+const uint64_t SIGNALING_NAN_BITS = 0x7E00000000000000ULL;
+const uint64_t LARGE_COEFFICIENT = 0x6000000000000000ULL;
+
+/* Infinity and NaN, identified by the combination field of the most significant word. */
+bool decodeSpecial(uint64_t bits, Decoded* decoded)
+{
+    decoded->negative = (bits >> 63) != 0;
+    if ((bits & SPECIAL) != SPECIAL)
+        return false;
+    decoded->coefficient = 0;
+    decoded->exponent = 0;
+    decoded->canonical = false;
+    decoded->valueClass = (bits & NAN_BITS) != NAN_BITS ? DECFLOAT_INFINITY
+                        : (bits & SIGNALING_NAN_BITS) == SIGNALING_NAN_BITS ? DECFLOAT_SIGNALING_NAN
+                        : DECFLOAT_QUIET_NAN;
+    return true;
+}
+
+/* BID64: sign, 10 exponent bits with bias 398 and a coefficient of 53 bits, or 51 bits below an implicit 0b100. */
+Decoded decode(const RFC_DECF16& value)
+{
+    uint64_t bits;
+    memcpy(&bits, value.bytes, sizeof(bits));
+    Decoded decoded;
+    if (decodeSpecial(bits, &decoded))
+        return decoded;
+    uint64_t coefficient;
+    if ((bits & LARGE_COEFFICIENT) == LARGE_COEFFICIENT)
+    {
+        decoded.exponent = static_cast<int>((bits >> 51) & 0x3FF) - 398;
+        coefficient = (bits & 0x0007FFFFFFFFFFFFULL) | 0x0020000000000000ULL;
+    }
+    else
+    {
+        decoded.exponent = static_cast<int>((bits >> 53) & 0x3FF) - 398;
+        coefficient = bits & 0x001FFFFFFFFFFFFFULL;
+    }
+    decoded.canonical = coefficient < POW10[16];
+    decoded.coefficient = decoded.canonical ? coefficient : 0;
+    decoded.valueClass = DECFLOAT_FINITE;
+    return decoded;
+}
+
+/* BID128: sign, 14 exponent bits with bias 6176 and a coefficient of 113 bits; the large form is never canonical. */
+Decoded decode(const RFC_DECF34& value)
+{
+    uint64_t low, high;
+    memcpy(&low, value.bytes, sizeof(low));
+    memcpy(&high, value.bytes + 8, sizeof(high));
+    Decoded decoded;
+    if (decodeSpecial(high, &decoded))
+        return decoded;
+    decoded.valueClass = DECFLOAT_FINITE;
+    if ((high & LARGE_COEFFICIENT) == LARGE_COEFFICIENT)
+    {
+        decoded.exponent = static_cast<int>((high >> 47) & 0x3FFF) - 6176;
+        decoded.coefficient = 0;
+        decoded.canonical = false;
+        return decoded;
+    }
+    decoded.exponent = static_cast<int>((high >> 49) & 0x3FFF) - 6176;
+    const uint128 coefficient = (static_cast<uint128>(high & 0x0001FFFFFFFFFFFFULL) << 64) | low;
+    decoded.canonical = coefficient < static_cast<uint128>(POW10[17]) * POW10[17];
+    decoded.coefficient = decoded.canonical ? coefficient : 0;
+    return decoded;
+}
+
+/* Inverse of decode() for canonical values; the caller checks precision and exponent range. */
+void encode(uint128 coefficient, int exponent, bool negative, RFC_DECF16* value)
+{
+    const uint64_t sign = static_cast<uint64_t>(negative) << 63;
+    const uint64_t biased = static_cast<uint64_t>(exponent + 398);
+    const uint64_t small = static_cast<uint64_t>(coefficient);
+    const uint64_t bits = small < (1ULL << 53)
+        ? sign | biased << 53 | small
+        : sign | LARGE_COEFFICIENT | biased << 51 | (small & 0x0007FFFFFFFFFFFFULL);
+    memcpy(value->bytes, &bits, sizeof(bits));
+}
+
+void encode(uint128 coefficient, int exponent, bool negative, RFC_DECF34* value)
+{
+    const uint64_t low = static_cast<uint64_t>(coefficient);
+    const uint64_t high = static_cast<uint64_t>(negative) << 63 | static_cast<uint64_t>(exponent + 6176) << 49
+        | static_cast<uint64_t>(coefficient >> 64);
+    memcpy(value->bytes, &low, sizeof(low));
+    memcpy(value->bytes + 8, &high, sizeof(high));
+}
+
+/* Writes the 8 decimal digits of a value below 10^8, with leading zeros. */
+inline void writeEightDigits(uint32_t value, SAP_UC* target)
+{
+#ifdef NWRFC_SSE2_KERNELS
+    // abcdefgh -> abcd, efgh -> a, ab, abc, abcd, e, ef, efg, efgh -> a, b, ..., h in 16-bit lanes
+    const __m128i abcdefgh = _mm_cvtsi32_si128(static_cast<int>(value));
+    const __m128i abcd = _mm_srli_epi64(_mm_mul_epu32(abcdefgh, _mm_set1_epi32(static_cast<int>(0xd1b71759))), 45);
+    const __m128i efgh = _mm_sub_epi32(abcdefgh, _mm_mul_epu32(abcd, _mm_set1_epi32(10000)));
+    const __m128i v1 = _mm_slli_epi64(_mm_unpacklo_epi16(abcd, efgh), 2);
+    const __m128i v2 = _mm_unpacklo_epi32(_mm_unpacklo_epi16(v1, v1), _mm_unpacklo_epi16(v1, v1));
+    const __m128i divisors = _mm_setr_epi16(8389, 5243, 13108, static_cast<short>(32768), 8389, 5243, 13108, static_cast<short>(32768));
+    const __m128i shifts = _mm_setr_epi16(1 << 7, 1 << 11, 1 << 13, static_cast<short>(1 << 15), 1 << 7, 1 << 11, 1 << 13, static_cast<short>(1 << 15));
+    const __m128i prefixes = _mm_mulhi_epu16(_mm_mulhi_epu16(v2, divisors), shifts);
+    const __m128i digits = _mm_sub_epi16(prefixes, _mm_slli_epi64(_mm_mullo_epi16(prefixes, _mm_set1_epi16(10)), 16));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(target), _mm_add_epi16(digits, _mm_set1_epi16('0')));
+#else
+    for (int i = 7; i >= 0; --i)
+    {
+        target[i] = static_cast<SAP_UC>(cU('0') + value % 10);
+        value /= 10;
+    }
+#endif
+}
+
+unsigned digitCount(uint32_t value)
+{
+    unsigned count = 1;
+    while (count < 8 && value >= POW10[count])
+        ++count;
+    return count;
+}
+
+/* Decimal digits of a coefficient below 10^34 into the end of digits; returns their number, 1 for 0. */
+unsigned writeDigits(uint128 coefficient, SAP_UC (&digits)[40])
+{
+    uint64_t high, low;
+    uint32_t top = 0;
+    if ((coefficient >> 64) == 0)
+    {
+        const uint64_t value = static_cast<uint64_t>(coefficient);
+        high = value / POW10[16];
+        low = value % POW10[16];
+    }
+    else
+    {
+        const uint128 quotient = coefficient / POW10[16];
+        low = static_cast<uint64_t>(coefficient - quotient * POW10[16]);
+        high = static_cast<uint64_t>(quotient % POW10[16]);
+        top = static_cast<uint32_t>(quotient / POW10[16]);
+    }
+    // Base 10^8 chunks, most significant first; only those from the first non-zero one are written.
+    const uint32_t chunks[5] = {
+        top,
+        static_cast<uint32_t>(high / POW10[8]), static_cast<uint32_t>(high % POW10[8]),
+        static_cast<uint32_t>(low / POW10[8]), static_cast<uint32_t>(low % POW10[8])
+    };
+    unsigned first = 0;
+    while (first < 4 && chunks[first] == 0)
+        ++first;
+    for (unsigned i = first; i < 5; ++i)
+        writeEightDigits(chunks[i], digits + 8 * i);
+    return (4 - first) * 8 + digitCount(chunks[first]);
+}
+
+/* decNumber to-scientific-string of a canonical value; at most 42 characters plus the terminator. */
+void formatDecoded(const Decoded& decoded, SAP_UC* target)
+{
+    SAP_UC digits[40];
+    const unsigned count = writeDigits(decoded.coefficient, digits);
+    const SAP_UC* first = digits + 40 - count;
+    SAP_UC* p = target;
+    if (decoded.negative)
+        *p++ = cU('-');
+    const int adjusted = decoded.exponent + static_cast<int>(count) - 1;
+    if (decoded.exponent <= 0 && adjusted >= -6)
+    {
+        const int point = static_cast<int>(count) + decoded.exponent;
+        if (decoded.exponent == 0)
+        {
+            memcpy(p, first, count * sizeof(SAP_UC));
+            p += count;
+        }
+        else if (point > 0)
+        {
+            memcpy(p, first, point * sizeof(SAP_UC));
+            p += point;
+            *p++ = cU('.');
+            memcpy(p, first + point, (count - point) * sizeof(SAP_UC));
+            p += count - point;
+        }
+        else
+        {
+            *p++ = cU('0');
+            *p++ = cU('.');
+            for (int i = point; i < 0; ++i)
+                *p++ = cU('0');
+            memcpy(p, first, count * sizeof(SAP_UC));
+            p += count;
+        }
+    }
+    else
+    {
+        *p++ = first[0];
+        if (count > 1)
+        {
+            *p++ = cU('.');
+            memcpy(p, first + 1, (count - 1) * sizeof(SAP_UC));
+            p += count - 1;
+        }
+        *p++ = cU('E');
+        *p++ = adjusted < 0 ? cU('-') : cU('+');
+        const unsigned magnitude = static_cast<unsigned>(adjusted < 0 ? -adjusted : adjusted);
+        const unsigned length = digitCount(magnitude);
+        for (unsigned i = length, rest = magnitude; i > 0; --i, rest /= 10)
+            p[i - 1] = static_cast<SAP_UC>(cU('0') + rest % 10);
+        p += length;
+    }
+    *p = 0;
+}
+
+inline bool isDigit(SAP_UC c)
+{
+    return c >= cU('0') && c <= cU('9');
+}
+
+/* Appends a run of digits to value, 16 at a time through parseNumc(). */
+void accumulate(const SAP_UC* digits, unsigned count, uint128* value)
+{
+    while (count > 0)
+    {
+        const unsigned chunk = count < 16 ? count : 16;
+        RFC_INT8 number = 0;
+        parseNumc(digits, chunk, &number);
+        *value = *value * POW10[chunk] + static_cast<uint64_t>(number);
+        digits += chunk;
+        count -= chunk;
+    }
+}
+
+/*
+ * Parses [+-]digits[.digits][(E|e)[+-]digits] if the value is exact in the format, i.e. has at most
+ * DIGITS significant digits and an exponent in range. Anything else is left to the library.
+ */
+template <class Format>
+bool parseExact(const SAP_UC* text, typename Format::Value* value)
+{
+    const SAP_UC* p = text;
+    const bool negative = *p == cU('-');
+    if (*p == cU('-') || *p == cU('+'))
+        ++p;
+    const SAP_UC* integer = p;
+    while (isDigit(*p))
+        ++p;
+    unsigned integerLength = static_cast<unsigned>(p - integer);
+    const SAP_UC* fraction = p;
+    unsigned fractionLength = 0;
+    if (*p == cU('.'))
+    {
+        fraction = ++p;
+        while (isDigit(*p))
+            ++p;
+        fractionLength = static_cast<unsigned>(p - fraction);
+    }
+    if (integerLength + fractionLength == 0)
+        return false;
+    int exponent = 0;
+    if (*p == cU('E') || *p == cU('e'))
+    {
+        ++p;
+        const bool negativeExponent = *p == cU('-');
+        if (*p == cU('-') || *p == cU('+'))
+            ++p;
+        const SAP_UC* start = p;
+        while (isDigit(*p) && p - start < 6)
+            exponent = exponent * 10 + (*p++ - cU('0'));
+        if (p == start || isDigit(*p))
+            return false;
+        if (negativeExponent)
+            exponent = -exponent;
+    }
+    if (*p != 0)
+        return false;
+
+    exponent -= static_cast<int>(fractionLength);
+    while (integerLength > 0 && *integer == cU('0'))
+    {
+        ++integer;
+        --integerLength;
+    }
+    if (integerLength == 0)
+    {
+        while (fractionLength > 0 && *fraction == cU('0'))
+        {
+            ++fraction;
+            --fractionLength;
+        }
+    }
+    if (integerLength + fractionLength > static_cast<unsigned>(Format::DIGITS)
+        || exponent < Format::MIN_EXPONENT || exponent > Format::MAX_EXPONENT)
+        return false;
+    uint128 coefficient = 0;
+    accumulate(integer, integerLength, &coefficient);
+    accumulate(fraction, fractionLength, &coefficient);
+    encode(coefficient, exponent, negative, value);
+    return true;
+}
+
+/*
+ * Both operands are exact doubles, so the product or quotient is the correctly rounded value.
+ * With excess precision (x87) it would be rounded twice.
+ */
+bool toDoubleExact(const Decoded& decoded, RFC_FLOAT* number)
+{
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+    if (!decoded.canonical || (decoded.coefficient >> 53) != 0 || decoded.exponent < -22 || decoded.exponent > 22)
+        return false;
+    const double coefficient = static_cast<double>(static_cast<uint64_t>(decoded.coefficient));
+    const double magnitude = decoded.exponent >= 0 ? coefficient * POW10_DOUBLE[decoded.exponent]
+                                                   : coefficient / POW10_DOUBLE[-decoded.exponent];
+    *number = decoded.negative ? -magnitude : magnitude;
+    return true;
+#else
+    (void)decoded;
+    (void)number;
+    return false;
+#endif
+}
+
+/* Packs a value that fits into the packed number without rounding; nibbles are 2*length-1 digits and the sign. */
+bool packExact(const Decoded& decoded, SAP_RAW* bcd, unsigned length, unsigned decimals)
+{
+    if (!decoded.canonical || length == 0 || length > 16 || decimals > 31)
+        return false;
+    const bool zero = decoded.coefficient == 0;
+    const int shift = decoded.exponent + static_cast<int>(decimals);
+    if (shift < 0 || (zero && decoded.negative))
+        return false;
+    SAP_UC digits[40];
+    const unsigned count = zero ? 0 : writeDigits(decoded.coefficient, digits);
+    const unsigned digitNibbles = 2 * length - 1;
+    if (!zero && count + static_cast<unsigned>(shift) > digitNibbles)
+        return false;
+
+    memset(bcd, 0, length);
+    // Digit k from the right goes to nibble digitNibbles - 1 - k; the shift digits below the coefficient stay 0.
+    for (unsigned k = 0; k < count; ++k)
+    {
+        const unsigned nibble = digitNibbles - 1 - (static_cast<unsigned>(shift) + k);
+        const unsigned digit = static_cast<unsigned>(digits[39 - k] - cU('0'));
+        bcd[nibble / 2] |= static_cast<SAP_RAW>(nibble % 2 != 0 ? digit : digit << 4);
+    }
+    bcd[length - 1] |= static_cast<SAP_RAW>(decoded.negative ? 0x0D : 0x0C);
+    return true;
+}
+
+/* Unpacks a packed number with sign C or D whose value is exact in the format; -0 is left to the library. */
+template <class Format>
+bool unpackExact(const SAP_RAW* bcd, unsigned length, unsigned decimals, typename Format::Value* value)
+{
+    if (length == 0 || length > 16)
+        return false;
+    const unsigned sign = bcd[length - 1] & 0x0F;
+    if (sign != 0x0C && sign != 0x0D)
+        return false;
+    const unsigned digitNibbles = 2 * length - 1;
+    unsigned first = digitNibbles;
+    uint128 coefficient = 0;
+    for (unsigned i = 0; i < digitNibbles; ++i)
+    {
+        const unsigned digit = i % 2 == 0 ? bcd[i / 2] >> 4 : bcd[i / 2] & 0x0F;
+        if (digit > 9)
+            return false;
+        if (digit != 0 && first == digitNibbles)
+            first = i;
+        coefficient = coefficient * 10 + digit;
+    }
+    const int exponent = -static_cast<int>(decimals);
+    if ((coefficient == 0 && sign == 0x0D) || digitNibbles - first > static_cast<unsigned>(Format::DIGITS)
+        || exponent < Format::MIN_EXPONENT)
+        return false;
+    encode(coefficient, exponent, sign == 0x0D, value);
+    return true;
+}
+
+/* Kernels that agreed with the library on all probes. */
+struct Kernels
+{
+    bool encoding;      // the library stores BID encoding, the precondition for all others
+    bool toString;
+    bool fromString;
+    bool toDouble;
+    bool toBcd;
+    bool fromBcd;
+};
+
+struct Probe
+{
+    uint64_t coefficient;
+    int exponent;
+    bool negative;
+};
+
+const Probe PROBES[] = {
+    { 0, 0, false }, { 0, 0, true }, { 0, -2, false }, { 0, 2, false }, { 0, -9, true }, { 1, 0, false },
+    { 7, 0, true }, { 123, -1, false }, { 123, -2, true }, { 123, -3, false }, { 123, -8, false },
+    { 123, -9, false }, { 1, -6, false }, { 1, -7, false }, { 5, 1, false }, { 5, 3, true },
+    { 1234567890123456ULL, -5, false }, { 1234567890123456ULL, -21, false }, { 1234567890123456ULL, 3, true },
+    { 100, -2, false }, { 10, -30, false }, { 9007199254740991ULL, 22, false }, { 9007199254740991ULL, -22, true },
+    { 4503599627370497ULL, -1, false }, { 3, -1, false }, { 1, 22, false }, { 1, -22, false },
+    { 99, 300, false }, { 99, -300, true }, { 12345678, 0, false }, { 123456789, -4, true }
+};
+
+const char* const PROBE_STRINGS[] = {
+    "0", "-0", "+0", "0.00", "-0.000E+3", "1", "+1", "-1", "1.", "-.5", ".5", "1.50", "007", "0.0000001",
+    "1e5", "1E-3", "1E+3", "-12.345E+2", "123456789012345", "1234567890123456", "0001234567890123456",
+    "9999999999999999E369", "1E-398", "1.000000000000000E+10", "1234567890123456789012345678901234",
+    "-0.000001234567890123456789012345678901234", "1E-6176", "9E6111", "1E000010", "0E-400"
+};
+
+const unsigned BCD_SHAPES[][2] = { { 1, 0 }, { 2, 1 }, { 4, 2 }, { 8, 2 }, { 8, 0 }, { 12, 3 }, { 16, 0 }, { 16, 14 } };
+
+template <class Format>
+void probeString(const SAP_UC* text, Kernels* kernels)
+{
+    typename Format::Value mine, theirs;
+    if (parseExact<Format>(text, &mine)
+        && (Format::fromString(text, &theirs) != DECF_OK || memcmp(mine.bytes, theirs.bytes, sizeof(mine.bytes)) != 0))
+        kernels->fromString = false;
+}
+
+template <class Format>
+void probeValue(uint128 coefficient, int exponent, bool negative, Kernels* kernels)
+{
+    typedef typename Format::Value Value;
+    Value value;
+    encode(coefficient, exponent, negative, &value);
+    const Decoded decoded = decode(value);
+
+    typename Format::Buffer mine, theirs;
+    formatDecoded(decoded, mine);
+    Format::toString(value, &theirs);
+    size_t length = 0;
+    while (mine[length] != 0 && mine[length] == theirs[length])
+        ++length;
+    if (mine[length] != theirs[length])
+        kernels->toString = false;
+    probeString<Format>(theirs, kernels);
+
+    RFC_FLOAT myDouble, theirDouble;
+    if (toDoubleExact(decoded, &myDouble)
+        && (Format::toDouble(&theirDouble, value) != DECF_OK || memcmp(&myDouble, &theirDouble, sizeof(RFC_FLOAT)) != 0))
+        kernels->toDouble = false;
+
+    for (size_t i = 0; i < sizeof(BCD_SHAPES) / sizeof(BCD_SHAPES[0]); ++i)
+    {
+        const unsigned bcdLength = BCD_SHAPES[i][0];
+        const unsigned decimals = BCD_SHAPES[i][1];
+        SAP_RAW myBcd[16], theirBcd[16];
+        if (!packExact(decoded, myBcd, bcdLength, decimals))
+            continue;
+        if (Format::toBcd(theirBcd, value, bcdLength, decimals) != DECF_OK || memcmp(myBcd, theirBcd, bcdLength) != 0)
+            kernels->toBcd = false;
+        Value myValue, theirValue;
+        if (unpackExact<Format>(myBcd, bcdLength, decimals, &myValue)
+            && (Format::fromBcd(&theirValue, myBcd, bcdLength, decimals) != DECF_OK
+                || memcmp(myValue.bytes, theirValue.bytes, sizeof(myValue.bytes)) != 0))
+            kernels->fromBcd = false;
+    }
+}
+
+template <class Format>
+Kernels calibrate()
+{
+    Kernels kernels = { false, false, false, false, false, false };
+    const SAP_INT integers[] = { 0, 1, 7, -42, 123456789, INT_MAX, INT_MIN };
+    for (size_t i = 0; i < sizeof(integers) / sizeof(integers[0]); ++i)
+    {
+        typename Format::Value expected, actual;
+        const int64_t integer = integers[i];
+        encode(static_cast<uint128>(integer < 0 ? -integer : integer), 0, integer < 0, &expected);
+        if (Format::fromInt(&actual, integers[i]) != DECF_OK || memcmp(expected.bytes, actual.bytes, sizeof(actual.bytes)) != 0)
+            return kernels;
+    }
+    kernels.encoding = kernels.toString = kernels.fromString = kernels.toDouble = kernels.toBcd = kernels.fromBcd = true;
+
+    for (size_t i = 0; i < sizeof(PROBES) / sizeof(PROBES[0]); ++i)
+        probeValue<Format>(PROBES[i].coefficient, PROBES[i].exponent, PROBES[i].negative, &kernels);
+    // The extremes of the format, and the large coefficient form of BID64 and the high word of BID128.
+    uint128 largest = 1;
+    for (int i = 0; i < Format::DIGITS; ++i)
+        largest *= 10;
+    --largest;
+    probeValue<Format>(largest, Format::MIN_EXPONENT, false, &kernels);
+    probeValue<Format>(largest, Format::MAX_EXPONENT, true, &kernels);
+    probeValue<Format>(largest, 0, false, &kernels);
+    probeValue<Format>((static_cast<uint128>(1) << 53) + 1, -3, false, &kernels);
+    if (Format::DIGITS > 20)
+        probeValue<Format>((static_cast<uint128>(1) << 64) + 1, -5, true, &kernels);
+
+    for (size_t i = 0; i < sizeof(PROBE_STRINGS) / sizeof(PROBE_STRINGS[0]); ++i)
+    {
+        SAP_UC text[64];
+        size_t length = 0;
+        for (; PROBE_STRINGS[i][length] != 0; ++length)
+            text[length] = static_cast<SAP_UC>(PROBE_STRINGS[i][length]);
+        text[length] = 0;
+        probeString<Format>(text, &kernels);
+    }
+    return kernels;
+}
+
+template <class Format>
+const Kernels& kernels()
+{
+    static const Kernels calibrated = calibrate<Format>();
+    return calibrated;
+}
+
+template <class Format>
+RFC_RC decodeValues(const typename Format::Value* values, size_t count, DecFloatParts* parts, RFC_ERROR_INFO* errorInfo)
+{
+    if (!kernels<Format>().encoding)
+        return setError(errorInfo, RFC_NOT_SUPPORTED, cU("DecFloat values are not BID encoded on this platform"));
+    for (size_t i = 0; i < count; ++i)
+    {
+        const Decoded decoded = decode(values[i]);
+        parts[i].coefficientHigh = static_cast<uint64_t>(decoded.coefficient >> 64);
+        parts[i].coefficient = static_cast<uint64_t>(decoded.coefficient);
+        parts[i].exponent = decoded.exponent;
+        parts[i].negative = decoded.negative;
+        parts[i].valueClass = decoded.valueClass;
+    }
+    return clearError(errorInfo);
+}
+
+#else
+
+template <class Format>
+RFC_RC decodeValues(const typename Format::Value*, size_t, DecFloatParts*, RFC_ERROR_INFO* errorInfo)
+{
+    return setError(errorInfo, RFC_NOT_SUPPORTED, cU("DecFloat decoding needs a 128-bit integer type"));
+}
+
+#endif // NWRFC_DECFLOAT_KERNELS
+
+template <class Format>
+RFC_RC toStrings(const typename Format::Value* values, size_t count, typename Format::Buffer* strings,
+                 RFC_ERROR_INFO* errorInfo)
+{
+#ifdef NWRFC_DECFLOAT_KERNELS
+    const bool kernel = kernels<Format>().toString;
+#endif
+    for (size_t i = 0; i < count; ++i)
+    {
+#ifdef NWRFC_DECFLOAT_KERNELS
+        if (kernel)
+        {
+            const Decoded decoded = decode(values[i]);
+            if (decoded.canonical)
+            {
+                formatDecoded(decoded, strings[i]);
+                continue;
+            }
+        }
+#endif
+        Format::toString(values[i], &strings[i]);
+    }
+    return clearError(errorInfo);
+}
+
+template <class Format>
+RFC_RC fromStrings(const SAP_UC* const* strings, size_t count, typename Format::Value* values, DECF_RETURN* codes,
+                   RFC_ERROR_INFO* errorInfo)
+{
+#ifdef NWRFC_DECFLOAT_KERNELS
+    const bool kernel = kernels<Format>().fromString;
+#endif
+    Outcome outcome(codes);
+    for (size_t i = 0; i < count; ++i)
+    {
+#ifdef NWRFC_DECFLOAT_KERNELS
+        if (kernel && parseExact<Format>(strings[i], &values[i]))
+        {
+            outcome.record(i, DECF_OK);
+            continue;
+        }
+#endif
+        outcome.record(i, Format::fromString(strings[i], &values[i]));
+    }
+    return outcome.finish(errorInfo);
+}
+
+template <class Format>
+RFC_RC toDoubles(const typename Format::Value* values, size_t count, RFC_FLOAT* doubles, DECF_RETURN* codes,
+                 RFC_ERROR_INFO* errorInfo)
+{
+#ifdef NWRFC_DECFLOAT_KERNELS
+    const bool kernel = kernels<Format>().toDouble;
+#endif
+    Outcome outcome(codes);
+    for (size_t i = 0; i < count; ++i)
+    {
+#ifdef NWRFC_DECFLOAT_KERNELS
+        if (kernel && toDoubleExact(decode(values[i]), &doubles[i]))
+        {
+            outcome.record(i, DECF_OK);
+            continue;
+        }
+#endif
+        outcome.record(i, Format::toDouble(&doubles[i], values[i]));
+    }
+    return outcome.finish(errorInfo);
+}
+
+template <class Format>
+RFC_RC fromDoubles(const RFC_FLOAT* doubles, size_t count, typename Format::Value* values, DECF_RETURN* codes,
+                   RFC_ERROR_INFO* errorInfo)
+{
+    Outcome outcome(codes);
+    for (size_t i = 0; i < count; ++i)
+        outcome.record(i, Format::fromDouble(&values[i], doubles[i]));
+    return outcome.finish(errorInfo);
+}
+
+template <class Format>
+RFC_RC toBcd(const typename Format::Value* values, size_t count, SAP_RAW* bcd, unsigned length, unsigned decimals,
+             DECF_RETURN* codes, RFC_ERROR_INFO* errorInfo)
+{
+#ifdef NWRFC_DECFLOAT_KERNELS
+    const bool kernel = kernels<Format>().toBcd;
+#endif
+    Outcome outcome(codes);
+    for (size_t i = 0; i < count; ++i)
+    {
+        SAP_RAW* target = bcd + i * length;
+#ifdef NWRFC_DECFLOAT_KERNELS
+        if (kernel && packExact(decode(values[i]), target, length, decimals))
+        {
+            outcome.record(i, DECF_OK);
+            continue;
+        }
+#endif
+        outcome.record(i, Format::toBcd(target, values[i], length, decimals));
+    }
+    return outcome.finish(errorInfo);
+}
+
+template <class Format>
+RFC_RC fromBcd(const SAP_RAW* bcd, size_t count, unsigned length, unsigned decimals, typename Format::Value* values,
+               DECF_RETURN* codes, RFC_ERROR_INFO* errorInfo)
+{
+#ifdef NWRFC_DECFLOAT_KERNELS
+    const bool kernel = kernels<Format>().fromBcd;
+#endif
+    Outcome outcome(codes);
+    for (size_t i = 0; i < count; ++i)
+    {
+        const SAP_RAW* source = bcd + i * length;
+#ifdef NWRFC_DECFLOAT_KERNELS
+        if (kernel && unpackExact<Format>(source, length, decimals, &values[i]))
+        {
+            outcome.record(i, DECF_OK);
+            continue;
+        }
+#endif
+        outcome.record(i, Format::fromBcd(&values[i], source, length, decimals));
+    }
+    return outcome.finish(errorInfo);
+}
+
+} // namespace
+
+bool decFloatKernelsAvailable()
+{
+#ifdef NWRFC_DECFLOAT_KERNELS
+    return kernels<Format16>().encoding && kernels<Format34>().encoding;
+#else
+    return false;
+#endif
+}
+
+RFC_RC decodeDecFloat16(const RFC_DECF16* values, size_t count, DecFloatParts* parts, RFC_ERROR_INFO* errorInfo)
+{
+    return decodeValues<Format16>(values, count, parts, errorInfo);
+}
+
+RFC_RC decodeDecFloat34(const RFC_DECF34* values, size_t count, DecFloatParts* parts, RFC_ERROR_INFO* errorInfo)
+{
+    return decodeValues<Format34>(values, count, parts, errorInfo);
+}
+
+RFC_RC decFloat16ToStrings(const RFC_DECF16* values, size_t count, DecFloat16Buff* strings, RFC_ERROR_INFO* errorInfo)
+{
+    return toStrings<Format16>(values, count, strings, errorInfo);
+}
+
+RFC_RC decFloat34ToStrings(const RFC_DECF34* values, size_t count, DecFloat34Buff* strings, RFC_ERROR_INFO* errorInfo)
+{
+    return toStrings<Format34>(values, count, strings, errorInfo);
+}
+
+RFC_RC stringsToDecFloat16(const SAP_UC* const* strings, size_t count, RFC_DECF16* values, DECF_RETURN* codes,
+                           RFC_ERROR_INFO* errorInfo)
+{
+    return fromStrings<Format16>(strings, count, values, codes, errorInfo);
+}
+
+RFC_RC stringsToDecFloat34(const SAP_UC* const* strings, size_t count, RFC_DECF34* values, DECF_RETURN* codes,
+                           RFC_ERROR_INFO* errorInfo)
+{
+    return fromStrings<Format34>(strings, count, values, codes, errorInfo);
+}
+
+RFC_RC decFloat16ToDoubles(const RFC_DECF16* values, size_t count, RFC_FLOAT* doubles, DECF_RETURN* codes,
+                           RFC_ERROR_INFO* errorInfo)
+{
+    return toDoubles<Format16>(values, count, doubles, codes, errorInfo);
+}
+
+RFC_RC decFloat34ToDoubles(const RFC_DECF34* values, size_t count, RFC_FLOAT* doubles, DECF_RETURN* codes,
+                           RFC_ERROR_INFO* errorInfo)
+{
+    return toDoubles<Format34>(values, count, doubles, codes, errorInfo);
+}
+
+RFC_RC doublesToDecFloat16(const RFC_FLOAT* doubles, size_t count, RFC_DECF16* values, DECF_RETURN* codes,
+                           RFC_ERROR_INFO* errorInfo)
+{
+    return fromDoubles<Format16>(doubles, count, values, codes, errorInfo);
+}
+
+RFC_RC doublesToDecFloat34(const RFC_FLOAT* doubles, size_t count, RFC_DECF34* values, DECF_RETURN* codes,
+                           RFC_ERROR_INFO* errorInfo)
+{
+    return fromDoubles<Format34>(doubles, count, values, codes, errorInfo);
+}
+
+RFC_RC decFloat16ToBCD(const RFC_DECF16* values, size_t count, SAP_RAW* bcd, unsigned length, unsigned decimals,
+                       DECF_RETURN* codes, RFC_ERROR_INFO* errorInfo)
+{
+    return toBcd<Format16>(values, count, bcd, length, decimals, codes, errorInfo);
+}
+
+RFC_RC decFloat34ToBCD(const RFC_DECF34* values, size_t count, SAP_RAW* bcd, unsigned length, unsigned decimals,
+                       DECF_RETURN* codes, RFC_ERROR_INFO* errorInfo)
+{
+    return toBcd<Format34>(values, count, bcd, length, decimals, codes, errorInfo);
+}
+
+RFC_RC bcdToDecFloat16(const SAP_RAW* bcd, size_t count, unsigned length, unsigned decimals, RFC_DECF16* values,
+                       DECF_RETURN* codes, RFC_ERROR_INFO* errorInfo)
+{
+    return fromBcd<Format16>(bcd, count, length, decimals, values, codes, errorInfo);
+}
+
+RFC_RC bcdToDecFloat34(const SAP_RAW* bcd, size_t count, unsigned length, unsigned decimals, RFC_DECF34* values,
+                       DECF_RETURN* codes, RFC_ERROR_INFO* errorInfo)
+{
+    return fromBcd<Format34>(bcd, count, length, decimals, values, codes, errorInfo);
+}
+
+} // namespace nwrfc
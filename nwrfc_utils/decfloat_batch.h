@@ -0,0 +1,189 @@
+#ifndef NWRFC_UTILS_DECFLOAT_BATCH_H
+#define NWRFC_UTILS_DECFLOAT_BATCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "sapnwrfc.h"
+#include "sapdecf.h"
+
+/*
+ * Conversions of whole arrays of RFC_DECF16/RFC_DECF34 values, the batch counterparts of the
+ * per-value functions of sapdecf.h.
+ *
+ * The values are decoded from their BID encoding (IEEE 754-2008 binary integer decimal) directly,
+ * and the conversions whose result is fully determined by the value, e.g. the to-scientific-string
+ * of a finite value or an exact double, are done by the kernels here: digits are produced 8 at a
+ * time with SSE2 on x86-64. Every other value (NaN, infinity, non-canonical encodings, anything
+ * that needs rounding or is out of range) is passed to the sapdecf.h function, so results and
+ * return codes are those of the library.
+ *
+ * Before the first conversion, each kernel is compared with the library on a set of probe values
+ * that covers all of its branches. A kernel that disagrees, e.g. because the platform stores
+ * DecFloats in DPD encoding, is not used, and all values of that conversion go to the library.
+ * The kernels need a 128-bit integer type (GCC and Clang on 64-bit targets); elsewhere all values
+ * go to the library.
+ *
+ * All functions convert every value, also after a failure. The optional codes array receives the
+ * DECF_RETURN of each value. The functions return RFC_OK if every value returned DECF_OK,
+ * DECF_INEXACT or DECF_UNDERFLOW ("almost fine" in sapdecf.h), RFC_CONVERSION_FAILURE otherwise,
+ * with the position of the first failing value in errorInfo.
+ */
+
+namespace nwrfc {
+
+/** \enum DecFloatClass
+ *
+ * Kind of a decoded DecFloat value.
+ */
+enum DecFloatClass
+{
+    DECFLOAT_FINITE,
+    DECFLOAT_INFINITY,
+    DECFLOAT_QUIET_NAN,
+    DECFLOAT_SIGNALING_NAN
+};
+
+/** \struct DecFloatParts
+ *
+ * A DecFloat value split into its fields: value = (-1)^negative * coefficient * 10^exponent.
+ */
+struct DecFloatParts
+{
+    uint64_t coefficientHigh;   ///< Upper 64 bits of the coefficient, always 0 for RFC_DECF16
+    uint64_t coefficient;       ///< Lower 64 bits of the coefficient; 0 for non-canonical encodings, infinity and NaN
+    int exponent;               ///< Exponent of the last digit of the coefficient; 0 for infinity and NaN
+    bool negative;              ///< Sign bit, also set for -0
+    DecFloatClass valueClass;
+};
+
+/** \brief  True if the library stores DecFloats in BID encoding and the kernels are used. */
+bool decFloatKernelsAvailable();
+
+/**
+ * \brief  Splits RFC_DECF16 values into sign, coefficient and exponent.
+ *
+ * \in *values Values to decode.
+ * \in count Number of values.
+ * \out *parts count decoded values.
+ * \out *errorInfo RFC_NOT_SUPPORTED if the library does not use BID encoding.
+ * \return RFC_RC
+ */
+RFC_RC decodeDecFloat16(const RFC_DECF16* values, size_t count, DecFloatParts* parts, RFC_ERROR_INFO* errorInfo);
+
+/** \brief  Splits RFC_DECF34 values into sign, coefficient and exponent, see decodeDecFloat16(). */
+RFC_RC decodeDecFloat34(const RFC_DECF34* values, size_t count, DecFloatParts* parts, RFC_ERROR_INFO* errorInfo);
+
+/**
+ * \brief  DecFloat16ToString() for count values.
+ *
+ * \in *values Values to convert.
+ * \in count Number of values.
+ * \out *strings count null-terminated strings.
+ * \out *errorInfo Always RFC_OK, as the conversion cannot fail.
+ * \return RFC_RC
+ */
+RFC_RC decFloat16ToStrings(const RFC_DECF16* values, size_t count, DecFloat16Buff* strings, RFC_ERROR_INFO* errorInfo);
+
+/** \brief  DecFloat34ToString() for count values, see decFloat16ToStrings(). */
+RFC_RC decFloat34ToStrings(const RFC_DECF34* values, size_t count, DecFloat34Buff* strings, RFC_ERROR_INFO* errorInfo);
+
+/**
+ * \brief  StringToDecFloat16() for count values.
+ *
+ * \in *strings count null-terminated numeric strings.
+ * \in count Number of values.
+ * \out *values count converted values.
+ * \out *codes Return code of each value. May be NULL.
+ * \out *errorInfo RFC_CONVERSION_FAILURE if a string cannot be converted.
+ * \return RFC_RC
+ */
+RFC_RC stringsToDecFloat16(const SAP_UC* const* strings, size_t count, RFC_DECF16* values, DECF_RETURN* codes,
+                           RFC_ERROR_INFO* errorInfo);
+
+/** \brief  StringToDecFloat34() for count values, see stringsToDecFloat16(). */
+RFC_RC stringsToDecFloat34(const SAP_UC* const* strings, size_t count, RFC_DECF34* values, DECF_RETURN* codes,
+                           RFC_ERROR_INFO* errorInfo);
+
+/**
+ * \brief  DecFloat16ToSAP_DOUBLE() for count values.
+ *
+ * Values with a coefficient below 2^53 and an exponent of at most 22 in magnitude are converted
+ * with one correctly rounded multiplication or division, the others by the library.
+ *
+ * \in *values Values to convert.
+ * \in count Number of values.
+ * \out *doubles count converted values.
+ * \out *codes Return code of each value. May be NULL.
+ * \out *errorInfo RFC_CONVERSION_FAILURE if a value is out of range.
+ * \return RFC_RC
+ */
+RFC_RC decFloat16ToDoubles(const RFC_DECF16* values, size_t count, RFC_FLOAT* doubles, DECF_RETURN* codes,
+                           RFC_ERROR_INFO* errorInfo);
+
+/** \brief  DecFloat34ToSAP_DOUBLE() for count values, see decFloat16ToDoubles(). */
+RFC_RC decFloat34ToDoubles(const RFC_DECF34* values, size_t count, RFC_FLOAT* doubles, DECF_RETURN* codes,
+                           RFC_ERROR_INFO* errorInfo);
+
+/**
+ * \brief  SAP_DOUBLEToDecFloat16() for count values.
+ *
+ * The rounding of this conversion is platform dependent according to sapdecf.h, so every value is
+ * converted by the library; the function only saves the loop.
+ *
+ * \in *doubles Values to convert.
+ * \in count Number of values.
+ * \out *values count converted values.
+ * \out *codes Return code of each value, normally DECF_INEXACT. May be NULL.
+ * \out *errorInfo RFC_CONVERSION_FAILURE if a value cannot be converted.
+ * \return RFC_RC
+ */
+RFC_RC doublesToDecFloat16(const RFC_FLOAT* doubles, size_t count, RFC_DECF16* values, DECF_RETURN* codes,
+                           RFC_ERROR_INFO* errorInfo);
+
+/** \brief  SAP_DOUBLEToDecFloat34() for count values, see doublesToDecFloat16(). */
+RFC_RC doublesToDecFloat34(const RFC_FLOAT* doubles, size_t count, RFC_DECF34* values, DECF_RETURN* codes,
+                           RFC_ERROR_INFO* errorInfo);
+
+/**
+ * \brief  DecFloat16ToBCD() for count values, into ABAP type P fields of the same length and decimals.
+ *
+ * Values that fit without rounding are packed by the kernel, the others by the library.
+ *
+ * \in *values Values to convert.
+ * \in count Number of values.
+ * \out *bcd count packed numbers of length bytes each, back to back.
+ * \in length Length of one packed number in bytes, 1 to 16.
+ * \in decimals Number of decimal places of the packed numbers.
+ * \out *codes Return code of each value. May be NULL.
+ * \out *errorInfo RFC_CONVERSION_FAILURE if a value does not fit.
+ * \return RFC_RC
+ */
+RFC_RC decFloat16ToBCD(const RFC_DECF16* values, size_t count, SAP_RAW* bcd, unsigned length, unsigned decimals,
+                       DECF_RETURN* codes, RFC_ERROR_INFO* errorInfo);
+
+/** \brief  DecFloat34ToBCD() for count values, see decFloat16ToBCD(). */
+RFC_RC decFloat34ToBCD(const RFC_DECF34* values, size_t count, SAP_RAW* bcd, unsigned length, unsigned decimals,
+                       DECF_RETURN* codes, RFC_ERROR_INFO* errorInfo);
+
+/**
+ * \brief  BCDToDecFloat16() for count packed numbers of the same length and decimals.
+ *
+ * \in *bcd count packed numbers of length bytes each, back to back.
+ * \in count Number of values.
+ * \in length Length of one packed number in bytes, 1 to 16.
+ * \in decimals Number of decimal places of the packed numbers.
+ * \out *values count converted values.
+ * \out *codes Return code of each value. May be NULL.
+ * \out *errorInfo RFC_CONVERSION_FAILURE if a packed number is invalid.
+ * \return RFC_RC
+ */
+RFC_RC bcdToDecFloat16(const SAP_RAW* bcd, size_t count, unsigned length, unsigned decimals, RFC_DECF16* values,
+                       DECF_RETURN* codes, RFC_ERROR_INFO* errorInfo);
+
+/** \brief  BCDToDecFloat34() for count packed numbers, see bcdToDecFloat16(). */
+RFC_RC bcdToDecFloat34(const SAP_RAW* bcd, size_t count, unsigned length, unsigned decimals, RFC_DECF34* values,
+                       DECF_RETURN* codes, RFC_ERROR_INFO* errorInfo);
+
+} // namespace nwrfc
+
+#endif // NWRFC_UTILS_DECFLOAT_BATCH_H
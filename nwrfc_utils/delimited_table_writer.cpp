@@ -0,0 +1,310 @@
+#include "delimited_table_writer.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include "rfc_error.h"
+#include "sapuc_utils.h"
+
+namespace nwrfc {
+
+namespace {
+
+const char hexDigits[] = "0123456789ABCDEF";
+
+// SWAR helpers over four SAP_UC in a 64 bit word.
+const uint64_t lanes = 0x0001000100010001ULL;
+const uint64_t laneHighBits = 0x8000800080008000ULL;
+const uint64_t nonAsciiBits = 0xFF80FF80FF80FF80ULL;
+
+// Nonzero if at least one 16 bit lane of word is zero.
+inline uint64_t zeroLane(uint64_t word)
+{
+    return (word - lanes) & ~word & laneHighBits;
+}
+
+enum TextClass
+{
+    TEXT_NON_ASCII = 1,     // needs a real UTF-8 conversion
+    TEXT_SPECIAL = 2        // needs quoting or escaping
+};
+
+/* Classifies a value against four special characters. */
+unsigned classify(const SAP_UC* chars, unsigned length, const SAP_UC special[4])
+{
+    const uint64_t s0 = lanes * special[0];
+    const uint64_t s1 = lanes * special[1];
+    const uint64_t s2 = lanes * special[2];
+    const uint64_t s3 = lanes * special[3];
+    uint64_t nonAscii = 0;
+    uint64_t specials = 0;
+    unsigned i = 0;
+    for (; i + 4 <= length; i += 4)
+    {
+        uint64_t word;
+        memcpy(&word, chars + i, sizeof(word));
+        nonAscii |= word & nonAsciiBits;
+        specials |= zeroLane(word ^ s0) | zeroLane(word ^ s1) | zeroLane(word ^ s2) | zeroLane(word ^ s3);
+    }
+    for (; i < length; ++i)
+    {
+        nonAscii |= chars[i] & 0xFF80;
+        specials |= chars[i] == special[0] || chars[i] == special[1] || chars[i] == special[2] || chars[i] == special[3];
+    }
+    return (nonAscii != 0 ? TEXT_NON_ASCII : 0) | (specials != 0 ? TEXT_SPECIAL : 0);
+}
+
+/* Appends a value that classify() found to be ASCII only. */
+void appendAscii(const SAP_UC* chars, unsigned length, std::string& target)
+{
+    const size_t oldSize = target.size();
+    target.resize(oldSize + length);
+    char* out = &target[oldSize];
+    for (unsigned i = 0; i < length; ++i)
+        out[i] = static_cast<char>(chars[i]);
+}
+
+void appendInteger(long long value, std::string& target)
+{
+    char digits[24];
+    char* end = digits + sizeof(digits);
+    char* begin = end;
+    unsigned long long magnitude = value < 0 ? 0ULL - static_cast<unsigned long long>(value)
+                                             : static_cast<unsigned long long>(value);
+    do
+    {
+        *--begin = static_cast<char>('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+    if (value < 0)
+        *--begin = '-';
+    target.append(begin, end);
+}
+
+} // namespace
+
+DelimitedTableWriter::DelimitedTableWriter(ByteSink& sink, const DelimitedWriterOptions& options)
+    : sink_(sink),
+      options_(options),
+      delimiter_(options.format == DELIMITED_TSV ? cU('\t') : static_cast<SAP_UC>(options.delimiter))
+{
+}
+
+RFC_RC DelimitedTableWriter::begin(const std::vector<Column>& columns, RFC_ERROR_INFO* errorInfo)
+{
+    out_.clear();
+    out_.reserve(options_.flushSize + 1024);
+    if (!options_.header)
+        return clearError(errorInfo);
+
+    bool first = true;
+    for (size_t i = 0; i < columns.size(); ++i)
+    {
+        if (columns[i].layout == COLUMN_SKIPPED)
+            continue;
+        if (!first)
+            out_ += static_cast<char>(delimiter_);
+        first = false;
+        RFC_RC rc = writeText(columns[i].desc.name, static_cast<unsigned>(strlenU(columns[i].desc.name)), errorInfo);
+        if (rc != RFC_OK)
+            return rc;
+    }
+    endLine();
+    return flushIfFull(errorInfo);
+}
+
+RFC_RC DelimitedTableWriter::write(const ColumnarTableReader& batch, RFC_ERROR_INFO* errorInfo)
+{
+    for (unsigned row = 0; row < batch.rowCount(); ++row)
+    {
+        bool first = true;
+        for (unsigned i = 0; i < batch.columnCount(); ++i)
+        {
+            const Column& column = batch.column(i);
+            if (column.layout == COLUMN_SKIPPED)
+                continue;
+            if (!first)
+                out_ += static_cast<char>(delimiter_);
+            first = false;
+            RFC_RC rc = writeValue(column, row, errorInfo);
+            if (rc != RFC_OK)
+                return rc;
+        }
+        endLine();
+        RFC_RC rc = flushIfFull(errorInfo);
+        if (rc != RFC_OK)
+            return rc;
+    }
+    return clearError(errorInfo);
+}
+
+RFC_RC DelimitedTableWriter::finish(RFC_ERROR_INFO* errorInfo)
+{
+    RFC_RC rc = sink_.write(out_.data(), out_.size(), errorInfo);
+    out_.clear();
+    if (rc != RFC_OK)
+        return rc;
+    return sink_.flush(errorInfo);
+}
+
+RFC_RC DelimitedTableWriter::writeValue(const Column& column, unsigned row, RFC_ERROR_INFO* errorInfo)
+{
+    char number[64];
+    size_t length = 0;
+
+    switch (column.desc.type)
+    {
+    case RFCTYPE_INT1:
+        appendInteger(column.values<RFC_INT1>()[row], out_);
+        return RFC_OK;
+    case RFCTYPE_INT2:
+        appendInteger(column.values<RFC_INT2>()[row], out_);
+        return RFC_OK;
+    case RFCTYPE_INT:
+        appendInteger(column.values<RFC_INT>()[row], out_);
+        return RFC_OK;
+    case RFCTYPE_INT8:
+    case RFCTYPE_UTCLONG:
+    case RFCTYPE_UTCSECOND:
+    case RFCTYPE_UTCMINUTE:
+        appendInteger(column.values<RFC_INT8>()[row], out_);
+        return RFC_OK;
+    case RFCTYPE_FLOAT:
+        if (!isfinite(column.values<RFC_FLOAT>()[row]))
+            return RFC_OK;
+        length = formatDouble(column.values<RFC_FLOAT>()[row], number, sizeof(number));
+        break;
+    case RFCTYPE_DECF16:
+        length = formatDecFloat16(column.values<RFC_DECF16>()[row], number, sizeof(number));
+        break;
+    case RFCTYPE_DECF34:
+    case RFCTYPE_BCD:
+        length = formatDecFloat34(column.values<RFC_DECF34>()[row], number, sizeof(number));
+        break;
+    case RFCTYPE_CHAR:
+    {
+        unsigned charLength = column.charLength(row);
+        if (options_.trimChars)
+            charLength = trimmedLength(column.charsAt(row), charLength);
+        return writeText(column.charsAt(row), charLength, errorInfo);
+    }
+    case RFCTYPE_NUM:
+    case RFCTYPE_DATE:
+    case RFCTYPE_TIME:
+    case RFCTYPE_STRING:
+        return writeText(column.charsAt(row), column.charLength(row), errorInfo);
+    case RFCTYPE_BYTE:
+    case RFCTYPE_XSTRING:
+    {
+        const SAP_RAW* bytes = column.valueAt(row);
+        const unsigned byteLength = column.byteLength(row);
+        const size_t oldSize = out_.size();
+        out_.resize(oldSize + 2 * static_cast<size_t>(byteLength));
+        char* out = &out_[oldSize];
+        for (unsigned i = 0; i < byteLength; ++i)
+        {
+            out[2 * i] = hexDigits[bytes[i] >> 4];
+            out[2 * i + 1] = hexDigits[bytes[i] & 0x0F];
+        }
+        return RFC_OK;
+    }
+    default:
+        return RFC_OK;
+    }
+
+    // Numbers never contain quotes or line breaks, only a delimiter like '.' or '-' can collide.
+    scratch_.assign(number, length);
+    if (memchr(number, static_cast<char>(delimiter_), length) != NULL)
+        writeEscaped(scratch_);
+    else
+        out_ += scratch_;
+    return RFC_OK;
+}
+
+RFC_RC DelimitedTableWriter::writeText(const SAP_UC* chars, unsigned length, RFC_ERROR_INFO* errorInfo)
+{
+    const SAP_UC csvSpecial[4] = { delimiter_, cU('"'), cU('\r'), cU('\n') };
+    const SAP_UC tsvSpecial[4] = { cU('\t'), cU('\\'), cU('\r'), cU('\n') };
+    const unsigned textClass = classify(chars, length, options_.format == DELIMITED_TSV ? tsvSpecial : csvSpecial);
+
+    if ((textClass & TEXT_SPECIAL) == 0)
+    {
+        if ((textClass & TEXT_NON_ASCII) == 0)
+        {
+            appendAscii(chars, length, out_);
+            return RFC_OK;
+        }
+        return appendUtf8(chars, length, out_, errorInfo);
+    }
+
+    scratch_.clear();
+    if ((textClass & TEXT_NON_ASCII) == 0)
+    {
+        appendAscii(chars, length, scratch_);
+    }
+    else
+    {
+        RFC_RC rc = appendUtf8(chars, length, scratch_, errorInfo);
+        if (rc != RFC_OK)
+            return rc;
+    }
+    writeEscaped(scratch_);
+    return RFC_OK;
+}
+
+void DelimitedTableWriter::writeEscaped(const std::string& utf8)
+{
+    if (options_.format == DELIMITED_CSV)
+    {
+        out_ += '"';
+        size_t plain = 0;   // start of the bytes not yet copied
+        for (size_t i = 0; i < utf8.size(); ++i)
+        {
+            if (utf8[i] != '"')
+                continue;
+            out_.append(utf8, plain, i + 1 - plain);
+            out_ += '"';
+            plain = i + 1;
+        }
+        out_.append(utf8, plain, utf8.size() - plain);
+        out_ += '"';
+        return;
+    }
+
+    size_t plain = 0;
+    for (size_t i = 0; i < utf8.size(); ++i)
+    {
+        char escape;
+        switch (utf8[i])
+        {
+        case '\t': escape = 't'; break;
+        case '\n': escape = 'n'; break;
+        case '\r': escape = 'r'; break;
+        case '\\': escape = '\\'; break;
+        default: continue;
+        }
+        out_.append(utf8, plain, i - plain);
+        out_ += '\\';
+        out_ += escape;
+        plain = i + 1;
+    }
+    out_.append(utf8, plain, utf8.size() - plain);
+}
+
+void DelimitedTableWriter::endLine()
+{
+    if (options_.crlf)
+        out_ += '\r';
+    out_ += '\n';
+}
+
+RFC_RC DelimitedTableWriter::flushIfFull(RFC_ERROR_INFO* errorInfo)
+{
+    if (out_.size() < options_.flushSize)
+        return RFC_OK;
+    RFC_RC rc = sink_.write(out_.data(), out_.size(), errorInfo);
+    out_.clear();
+    return rc;
+}
+
+} // namespace nwrfc
@@ -0,0 +1,82 @@
+#ifndef NWRFC_UTILS_DELIMITED_TABLE_WRITER_H
+#define NWRFC_UTILS_DELIMITED_TABLE_WRITER_H
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+#include "sapnwrfc.h"
+#include "byte_sink.h"
+#include "table_sink.h"
+
+namespace nwrfc {
+
+/** \enum DelimitedFormat
+ *
+ * Quoting rules of DelimitedTableWriter.
+ */
+enum DelimitedFormat
+{
+    DELIMITED_CSV,  ///< RFC 4180: values containing the delimiter, '"', CR or LF are quoted, '"' is doubled
+    DELIMITED_TSV   ///< Tab separated, tab, LF, CR and backslash are escaped as \t, \n, \r and \\ .
+};
+
+/** \struct DelimitedWriterOptions
+ *
+ * Controls format and memory use of DelimitedTableWriter.
+ */
+struct DelimitedWriterOptions
+{
+    DelimitedFormat format; ///< Default: DELIMITED_CSV
+    char delimiter;         ///< Field delimiter of DELIMITED_CSV, e.g. ';'. TSV always uses tab. Default: ','
+    bool header;            ///< Start with a line of field names. Default: true
+    bool crlf;              ///< End lines with CR LF instead of LF. Default: false
+    bool trimChars;         ///< Strip trailing blanks of RFCTYPE_CHAR fields. Default: true
+    size_t flushSize;       ///< Output bytes collected before they are handed to the sink. Default: 64 KB
+
+    DelimitedWriterOptions()
+        : format(DELIMITED_CSV), delimiter(','), header(true), crlf(false), trimChars(true), flushSize(64 * 1024) {}
+};
+
+/**
+ * \brief  Writes table batches as UTF-8 CSV or TSV into a ByteSink.
+ *
+ * \code
+ * nwrfc::FdSink file(fd);
+ * nwrfc::DelimitedTableWriter csv(file);
+ * rc = nwrfc::writeTable(table, RfcGetRowType(table, &errorInfo), csv, &errorInfo);
+ * \endcode
+ *
+ * Values are converted from SAP_UC straight into the output buffer. Every value is scanned four
+ * SAP_UC at a time for non-ASCII characters and characters that need quoting; pure ASCII values
+ * without them, the common case, are narrowed without any further check. Other values are
+ * converted by sapucToUtf8(), which calls RfcSAPUCToUTF8() only for input that is not valid UTF-16.
+ *
+ * Integers, FLOAT, BCD and DECF16/34 are written as numbers, non-finite FLOAT values as empty
+ * fields. CHAR, NUM, DATE, TIME and STRING are written as text, BYTE and XSTRING as hex.
+ */
+class DelimitedTableWriter : public TableSink
+{
+public:
+    explicit DelimitedTableWriter(ByteSink& sink, const DelimitedWriterOptions& options = DelimitedWriterOptions());
+
+    RFC_RC begin(const std::vector<Column>& columns, RFC_ERROR_INFO* errorInfo);
+    RFC_RC write(const ColumnarTableReader& batch, RFC_ERROR_INFO* errorInfo);
+    RFC_RC finish(RFC_ERROR_INFO* errorInfo);
+
+private:
+    RFC_RC writeValue(const Column& column, unsigned row, RFC_ERROR_INFO* errorInfo);
+    RFC_RC writeText(const SAP_UC* chars, unsigned length, RFC_ERROR_INFO* errorInfo);
+    void writeEscaped(const std::string& utf8);
+    void endLine();
+    RFC_RC flushIfFull(RFC_ERROR_INFO* errorInfo);
+
+    ByteSink& sink_;
+    DelimitedWriterOptions options_;
+    SAP_UC delimiter_;
+    std::string out_;       // pending output
+    std::string scratch_;   // UTF-8 value before escaping
+};
+
+} // namespace nwrfc
+
+#endif // NWRFC_UTILS_DELIMITED_TABLE_WRITER_H
@@ -0,0 +1,403 @@
+#include "field_index.h"
+
+#include <string.h>
+#include <algorithm>
+#include <mutex>
+#include <string>
+#include "rfc_error.h"
+
+namespace nwrfc {
+
+namespace {
+
+/* Mixes the seed into nameHash() with a bijective 64-bit finalizer, so that all bits are mixed and
+   names with different hashes keep different hashes under every seed. */
+uint64_t seededHash(uint64_t hash, uint64_t seed)
+{
+    hash ^= seed;
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+unsigned bucketOf(uint64_t hash, size_t bucketCount)
+{
+    return static_cast<unsigned>((hash >> 32) % bucketCount);
+}
+
+/* The step is odd and the slot count a power of two, so displacements 0..slots-1 visit every slot. */
+unsigned slotFor(uint64_t hash, unsigned displacement, unsigned slotMask)
+{
+    const uint32_t start = static_cast<uint32_t>(hash);
+    const uint32_t step = static_cast<uint32_t>(hash >> 40) | 1u;
+    return (start + displacement * step) & slotMask;
+}
+
+} // namespace
+
+FieldIndex::FieldIndex()
+    : seed_(0),
+      slotMask_(0)
+{
+}
+
+RFC_RC FieldIndex::build(RFC_TYPE_DESC_HANDLE typeDescHandle, RFC_ERROR_INFO* errorInfo)
+{
+    unsigned fieldCount = 0;
+    RFC_RC rc = RfcGetFieldCount(typeDescHandle, &fieldCount, errorInfo);
+    if (rc != RFC_OK)
+        return rc;
+    names_.clear();
+    entries_.clear();
+    for (unsigned i = 0; i < fieldCount; ++i)
+    {
+        RFC_FIELD_DESC desc;
+        rc = RfcGetFieldDescByIndex(typeDescHandle, i, &desc, errorInfo);
+        if (rc != RFC_OK)
+            return rc;
+        add(desc.name, i);
+    }
+    return finish(errorInfo);
+}
+
+RFC_RC FieldIndex::build(RFC_FUNCTION_DESC_HANDLE funcDescHandle, RFC_ERROR_INFO* errorInfo)
+{
+    unsigned paramCount = 0;
+    RFC_RC rc = RfcGetParameterCount(funcDescHandle, &paramCount, errorInfo);
+    if (rc != RFC_OK)
+        return rc;
+    names_.clear();
+    entries_.clear();
+    for (unsigned i = 0; i < paramCount; ++i)
+    {
+        RFC_PARAMETER_DESC desc;
+        rc = RfcGetParameterDescByIndex(funcDescHandle, i, &desc, errorInfo);
+        if (rc != RFC_OK)
+            return rc;
+        add(desc.name, i);
+    }
+    return finish(errorInfo);
+}
+
+void FieldIndex::add(SAP_UC const* name, unsigned index)
+{
+    Entry entry;
+    entry.offset = static_cast<unsigned>(names_.size());
+    entry.length = 0;
+    while (name[entry.length] != 0)
+        ++entry.length;
+    entry.index = index;
+    names_.insert(names_.end(), name, name + entry.length);
+    entries_.push_back(entry);
+}
+
+RFC_RC FieldIndex::finish(RFC_ERROR_INFO* errorInfo)
+{
+    unsigned slotCount = 1;
+    while (slotCount < 2 * entries_.size())
+        slotCount <<= 1;
+    // A handful of seeds per table size is plenty at a load factor of at most 0.5. Only duplicate
+    // names can make all attempts fail.
+    for (unsigned grow = 0; grow < 4; ++grow, slotCount <<= 1)
+    {
+        slotMask_ = slotCount - 1;
+        for (uint64_t seed = 0; seed < 16; ++seed)
+        {
+            if (place(seed * 0x9e3779b97f4a7c15ULL))
+                return clearError(errorInfo);
+        }
+    }
+    entries_.clear();
+    slots_.clear();
+    return setError(errorInfo, RFC_INVALID_PARAMETER, cU("Duplicate field names, cannot build the field index"));
+}
+
+bool FieldIndex::place(uint64_t seed)
+{
+    const size_t bucketCount = std::max<size_t>(entries_.size(), 1);
+    std::vector<uint64_t> hashes(entries_.size());
+    std::vector<std::vector<unsigned> > buckets(bucketCount);
+    for (size_t e = 0; e < entries_.size(); ++e)
+    {
+        hashes[e] = seededHash(nameHash(&names_[0] + entries_[e].offset, entries_[e].length), seed);
+        buckets[bucketOf(hashes[e], bucketCount)].push_back(static_cast<unsigned>(e));
+    }
+
+    // Largest buckets first, while most slots are still free.
+    std::vector<unsigned> order(bucketCount);
+    for (unsigned b = 0; b < bucketCount; ++b)
+        order[b] = b;
+    std::stable_sort(order.begin(), order.end(),
+                     [&buckets](unsigned a, unsigned b) { return buckets[a].size() > buckets[b].size(); });
+
+    const unsigned slotCount = slotMask_ + 1;
+    slots_.assign(slotCount, npos);
+    displacements_.assign(bucketCount, 0);
+    std::vector<unsigned> candidate;
+    for (unsigned b : order)
+    {
+        const std::vector<unsigned>& bucket = buckets[b];
+        if (bucket.empty())
+            break;
+        unsigned displacement = 0;
+        for (; displacement < slotCount; ++displacement)
+        {
+            candidate.clear();
+            for (unsigned e : bucket)
+            {
+                const unsigned slot = slotFor(hashes[e], displacement, slotMask_);
+                if (slots_[slot] != npos || std::find(candidate.begin(), candidate.end(), slot) != candidate.end())
+                    break;
+                candidate.push_back(slot);
+            }
+            if (candidate.size() == bucket.size())
+                break;
+        }
+        if (displacement == slotCount)
+            return false;
+        displacements_[b] = displacement;
+        for (size_t k = 0; k < bucket.size(); ++k)
+            slots_[candidate[k]] = bucket[k];
+    }
+    seed_ = seed;
+    return true;
+}
+
+unsigned FieldIndex::slotOf(uint64_t hash) const
+{
+    return slotFor(hash, displacements_[bucketOf(hash, displacements_.size())], slotMask_);
+}
+
+unsigned FieldIndex::find(const FieldName& name) const
+{
+    if (name.chars == NULL || entries_.empty())
+        return npos;
+    const unsigned e = slots_[slotOf(seededHash(name.hash, seed_))];
+    if (e == npos)
+        return npos;
+    const Entry& entry = entries_[e];
+    if (entry.length != name.length || memcmp(&names_[entry.offset], name.chars, name.length * sizeof(SAP_UC)) != 0)
+        return npos;
+    return entry.index;
+}
+
+FieldIndexCache& FieldIndexCache::instance()
+{
+    static FieldIndexCache cache;
+    return cache;
+}
+
+template <class Handle>
+RFC_RC FieldIndexCache::lookup(Handle descHandle, std::shared_ptr<const FieldIndex>& index, RFC_ERROR_INFO* errorInfo)
+{
+    if (descHandle == NULL)
+        return setError(errorInfo, RFC_INVALID_PARAMETER, cU("No type description handle"));
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        std::unordered_map<const void*, std::shared_ptr<const FieldIndex> >::const_iterator it = indexes_.find(descHandle);
+        if (it != indexes_.end())
+        {
+            index = it->second;
+            return clearError(errorInfo);
+        }
+    }
+
+    // Built without holding the lock: if two threads race, both build and the first one wins.
+    std::shared_ptr<FieldIndex> built = std::make_shared<FieldIndex>();
+    RFC_RC rc = built->build(descHandle, errorInfo);
+    if (rc != RFC_OK)
+        return rc;
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    index = indexes_.emplace(descHandle, built).first->second;
+    return clearError(errorInfo);
+}
+
+RFC_RC FieldIndexCache::get(RFC_TYPE_DESC_HANDLE typeDescHandle, std::shared_ptr<const FieldIndex>& index,
+                            RFC_ERROR_INFO* errorInfo)
+{
+    return lookup(typeDescHandle, index, errorInfo);
+}
+
+RFC_RC FieldIndexCache::get(RFC_FUNCTION_DESC_HANDLE funcDescHandle, std::shared_ptr<const FieldIndex>& index,
+                            RFC_ERROR_INFO* errorInfo)
+{
+    return lookup(funcDescHandle, index, errorInfo);
+}
+
+void FieldIndexCache::invalidate(const void* descHandle)
+{
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    indexes_.erase(descHandle);
+}
+
+void FieldIndexCache::clear()
+{
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    indexes_.clear();
+}
+
+FieldAccessor::FieldAccessor(DATA_CONTAINER_HANDLE dataHandle, bool isFunction, FieldIndexCache& cache)
+    : dataHandle_(dataHandle),
+      cache_(&cache),
+      isFunction_(isFunction)
+{
+}
+
+FieldAccessor::FieldAccessor(DATA_CONTAINER_HANDLE dataHandle, const std::shared_ptr<const FieldIndex>& index)
+    : dataHandle_(dataHandle),
+      cache_(NULL),
+      index_(index),
+      isFunction_(false)
+{
+}
+
+RFC_RC FieldAccessor::resolveIndex(RFC_ERROR_INFO* errorInfo)
+{
+    if (cache_ == NULL)
+        return setError(errorInfo, RFC_ILLEGAL_STATE, cU("No field index"));
+    RFC_ERROR_INFO localErrorInfo;
+    RFC_ERROR_INFO* info = errorInfo != NULL ? errorInfo : &localErrorInfo;
+    if (isFunction_)
+    {
+        RFC_FUNCTION_DESC_HANDLE funcDesc = RfcDescribeFunction(dataHandle_, info);
+        return funcDesc == NULL ? info->code : cache_->get(funcDesc, index_, errorInfo);
+    }
+    RFC_TYPE_DESC_HANDLE typeDesc = RfcDescribeType(dataHandle_, info);
+    return typeDesc == NULL ? info->code : cache_->get(typeDesc, index_, errorInfo);
+}
+
+RFC_RC FieldAccessor::indexOf(const FieldName& name, unsigned* index, RFC_ERROR_INFO* errorInfo)
+{
+    if (!index_)
+    {
+        RFC_RC rc = resolveIndex(errorInfo);
+        if (rc != RFC_OK)
+            return rc;
+    }
+    *index = index_->find(name);
+    if (*index != FieldIndex::npos)
+        return RFC_OK;
+
+    std::basic_string<SAP_UC> message(cU("Field "));
+    if (name.chars != NULL)
+        message.append(name.chars, name.length);
+    message += cU(" not found");
+    return setError(errorInfo, RFC_INVALID_PARAMETER, message.c_str());
+}
+
+#define NWRFC_BY_INDEX(call) \
+    unsigned index = 0; \
+    RFC_RC rc = indexOf(name, &index, errorInfo); \
+    return rc != RFC_OK ? rc : call;
+
+RFC_RC FieldAccessor::getChars(const FieldName& name, RFC_CHAR* charBuffer, unsigned bufferLength, RFC_ERROR_INFO* errorInfo)
+{ NWRFC_BY_INDEX(RfcGetCharsByIndex(dataHandle_, index, charBuffer, bufferLength, errorInfo)) }
+
+RFC_RC FieldAccessor::getNum(const FieldName& name, RFC_NUM* charBuffer, unsigned bufferLength, RFC_ERROR_INFO* errorInfo)
+{ NWRFC_BY_INDEX(RfcGetNumByIndex(dataHandle_, index, charBuffer, bufferLength, errorInfo)) }
+
+RFC_RC FieldAccessor::getDate(const FieldName& name, RFC_DATE emptyDate, RFC_ERROR_INFO* errorInfo)
+{ NWRFC_BY_INDEX(RfcGetDateByIndex(dataHandle_, index, emptyDate, errorInfo)) }
+
+RFC_RC FieldAccessor::getTime(const FieldName& name, RFC_TIME emptyTime, RFC_ERROR_INFO* errorInfo)
+{ NWRFC_BY_INDEX(RfcGetTimeByIndex(dataHandle_, index, emptyTime, errorInfo)) }
+
+RFC_RC FieldAccessor::getString(const FieldName& name, SAP_UC* stringBuffer, unsigned bufferLength, unsigned* stringLength,
+                                RFC_ERROR_INFO* errorInfo)
+{ NWRFC_BY_INDEX(RfcGetStringByIndex(dataHandle_, index, stringBuffer, bufferLength, stringLength, errorInfo)) }
+
+RFC_RC FieldAccessor::getStringLength(const FieldName& name, unsigned* stringLength, RFC_ERROR_INFO* errorInfo)
+{ NWRFC_BY_INDEX(RfcGetStringLengthByIndex(dataHandle_, index, stringLength, errorInfo)) }
+
+RFC_RC FieldAccessor::getBytes(const FieldName& name, SAP_RAW* byteBuffer, unsigned bufferLength, RFC_ERROR_INFO* errorInfo)
+{ NWRFC_BY_INDEX(RfcGetBytesByIndex(dataHandle_, index, byteBuffer, bufferLength, errorInfo)) }
+
+RFC_RC FieldAccessor::getXString(const FieldName& name, SAP_RAW* byteBuffer, unsigned bufferLength, unsigned* xstringLength,
+                                 RFC_ERROR_INFO* errorInfo)
+{ NWRFC_BY_INDEX(RfcGetXStringByIndex(dataHandle_, index, byteBuffer, bufferLength, xstringLength, errorInfo)) }
+
+RFC_RC FieldAccessor::getInt(const FieldName& name, RFC_INT* value, RFC_ERROR_INFO* errorInfo)
+{ NWRFC_BY_INDEX(RfcGetIntByIndex(dataHandle_, index, value, errorInfo)) }
+
+RFC_RC FieldAccessor::getInt1(const FieldName& name, RFC_INT1* value, RFC_ERROR_INFO* errorInfo)
+{ NWRFC_BY_INDEX(RfcGetInt1ByIndex(dataHandle_, index, value, errorInfo)) }
+
+RFC_RC FieldAccessor::getInt2(const FieldName& name, RFC_INT2* value, RFC_ERROR_INFO* errorInfo)
+{ NWRFC_BY_INDEX(RfcGetInt2ByIndex(dataHandle_, index, value, errorInfo)) }
+
+RFC_RC FieldAccessor::getInt8(const FieldName& name, RFC_INT8* value, RFC_ERROR_INFO* errorInfo)
+{ NWRFC_BY_INDEX(RfcGetInt8ByIndex(dataHandle_, index, value, errorInfo)) }
+
+RFC_RC FieldAccessor::getFloat(const FieldName& name, RFC_FLOAT* value, RFC_ERROR_INFO* errorInfo)
+{ NWRFC_BY_INDEX(RfcGetFloatByIndex(dataHandle_, index, value, errorInfo)) }
+
+RFC_RC FieldAccessor::getDecF16(const FieldName& name, RFC_DECF16* value, RFC_ERROR_INFO* errorInfo)
+{ NWRFC_BY_INDEX(RfcGetDecF16ByIndex(dataHandle_, index, value, errorInfo)) }
+
+RFC_RC FieldAccessor::getDecF34(const FieldName& name, RFC_DECF34* value, RFC_ERROR_INFO* errorInfo)
+{ NWRFC_BY_INDEX(RfcGetDecF34ByIndex(dataHandle_, index, value, errorInfo)) }
+
+RFC_RC FieldAccessor::getStructure(const FieldName& name, RFC_STRUCTURE_HANDLE* structHandle, RFC_ERROR_INFO* errorInfo)
+{ NWRFC_BY_INDEX(RfcGetStructureByIndex(dataHandle_, index, structHandle, errorInfo)) }
+
+RFC_RC FieldAccessor::getTable(const FieldName& name, RFC_TABLE_HANDLE* tableHandle, RFC_ERROR_INFO* errorInfo)
+{ NWRFC_BY_INDEX(RfcGetTableByIndex(dataHandle_, index, tableHandle, errorInfo)) }
+
+RFC_RC FieldAccessor::getAbapObject(const FieldName& name, RFC_ABAP_OBJECT_HANDLE* objHandle, RFC_ERROR_INFO* errorInfo)
+{ NWRFC_BY_INDEX(RfcGetAbapObjectByIndex(dataHandle_, index, objHandle, errorInfo)) }
+
+RFC_RC FieldAccessor::setChars(const FieldName& name, const RFC_CHAR* charValue, unsigned valueLength, RFC_ERROR_INFO* errorInfo)
+{ NWRFC_BY_INDEX(RfcSetCharsByIndex(dataHandle_, index, charValue, valueLength, errorInfo)) }
+
+RFC_RC FieldAccessor::setNum(const FieldName& name, const RFC_NUM* charValue, unsigned valueLength, RFC_ERROR_INFO* errorInfo)
+{ NWRFC_BY_INDEX(RfcSetNumByIndex(dataHandle_, index, charValue, valueLength, errorInfo)) }
+
+RFC_RC FieldAccessor::setDate(const FieldName& name, const RFC_DATE date, RFC_ERROR_INFO* errorInfo)
+{ NWRFC_BY_INDEX(RfcSetDateByIndex(dataHandle_, index, date, errorInfo)) }
+
+RFC_RC FieldAccessor::setTime(const FieldName& name, const RFC_TIME time, RFC_ERROR_INFO* errorInfo)
+{ NWRFC_BY_INDEX(RfcSetTimeByIndex(dataHandle_, index, time, errorInfo)) }
+
+RFC_RC FieldAccessor::setString(const FieldName& name, const SAP_UC* stringValue, unsigned valueLength, RFC_ERROR_INFO* errorInfo)
+{ NWRFC_BY_INDEX(RfcSetStringByIndex(dataHandle_, index, stringValue, valueLength, errorInfo)) }
+
+RFC_RC FieldAccessor::setBytes(const FieldName& name, const SAP_RAW* byteValue, unsigned valueLength, RFC_ERROR_INFO* errorInfo)
+{ NWRFC_BY_INDEX(RfcSetBytesByIndex(dataHandle_, index, byteValue, valueLength, errorInfo)) }
+
+RFC_RC FieldAccessor::setXString(const FieldName& name, const SAP_RAW* byteValue, unsigned valueLength, RFC_ERROR_INFO* errorInfo)
+{ NWRFC_BY_INDEX(RfcSetXStringByIndex(dataHandle_, index, byteValue, valueLength, errorInfo)) }
+
+RFC_RC FieldAccessor::setInt(const FieldName& name, const RFC_INT value, RFC_ERROR_INFO* errorInfo)
+{ NWRFC_BY_INDEX(RfcSetIntByIndex(dataHandle_, index, value, errorInfo)) }
+
+RFC_RC FieldAccessor::setInt1(const FieldName& name, const RFC_INT1 value, RFC_ERROR_INFO* errorInfo)
+{ NWRFC_BY_INDEX(RfcSetInt1ByIndex(dataHandle_, index, value, errorInfo)) }
+
+RFC_RC FieldAccessor::setInt2(const FieldName& name, const RFC_INT2 value, RFC_ERROR_INFO* errorInfo)
+{ NWRFC_BY_INDEX(RfcSetInt2ByIndex(dataHandle_, index, value, errorInfo)) }
+
+RFC_RC FieldAccessor::setInt8(const FieldName& name, const RFC_INT8 value, RFC_ERROR_INFO* errorInfo)
+{ NWRFC_BY_INDEX(RfcSetInt8ByIndex(dataHandle_, index, value, errorInfo)) }
+
+RFC_RC FieldAccessor::setFloat(const FieldName& name, const RFC_FLOAT value, RFC_ERROR_INFO* errorInfo)
+{ NWRFC_BY_INDEX(RfcSetFloatByIndex(dataHandle_, index, value, errorInfo)) }
+
+RFC_RC FieldAccessor::setDecF16(const FieldName& name, const RFC_DECF16 value, RFC_ERROR_INFO* errorInfo)
+{ NWRFC_BY_INDEX(RfcSetDecF16ByIndex(dataHandle_, index, value, errorInfo)) }
+
+RFC_RC FieldAccessor::setDecF34(const FieldName& name, const RFC_DECF34 value, RFC_ERROR_INFO* errorInfo)
+{ NWRFC_BY_INDEX(RfcSetDecF34ByIndex(dataHandle_, index, value, errorInfo)) }
+
+RFC_RC FieldAccessor::setStructure(const FieldName& name, const RFC_STRUCTURE_HANDLE value, RFC_ERROR_INFO* errorInfo)
+{ NWRFC_BY_INDEX(RfcSetStructureByIndex(dataHandle_, index, value, errorInfo)) }
+
+RFC_RC FieldAccessor::setTable(const FieldName& name, const RFC_TABLE_HANDLE value, RFC_ERROR_INFO* errorInfo)
+{ NWRFC_BY_INDEX(RfcSetTableByIndex(dataHandle_, index, value, errorInfo)) }
+
+RFC_RC FieldAccessor::setAbapObject(const FieldName& name, const RFC_ABAP_OBJECT_HANDLE value, RFC_ERROR_INFO* errorInfo)
+{ NWRFC_BY_INDEX(RfcSetAbapObjectByIndex(dataHandle_, index, value, errorInfo)) }
+
+#undef NWRFC_BY_INDEX
+
+} // namespace nwrfc
@@ -0,0 +1,266 @@
+#ifndef NWRFC_UTILS_FIELD_INDEX_H
+#define NWRFC_UTILS_FIELD_INDEX_H
+
+#include <stdint.h>
+#include <limits.h>
+#include <memory>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+#include "sapnwrfc.h"
+#include "sapuc_literal.h"
+
+namespace nwrfc {
+
+/** \struct FieldName
+ *
+ * Name argument of FieldIndex and FieldAccessor: the characters with their length and nameHash().
+ * Made implicitly from a null-terminated SAP_UC string, which costs one pass over the name, or
+ * from a UcLiteral, whose length and hash are compile-time constants. Refers to the characters of
+ * the string or literal it was made from.
+ */
+struct FieldName
+{
+    SAP_UC const* chars;    ///< Start of the name, NULL for no name
+    size_t length;          ///< Length of the name in SAP_UC
+    uint64_t hash;          ///< nameHash() of the name
+
+    FieldName(SAP_UC const* name)
+        : chars(name),
+          length(0),
+          hash(0)
+    {
+        if (name == NULL)
+            return;
+        while (name[length] != 0)
+            ++length;
+        hash = nameHash(name, length);
+    }
+
+    template <size_t N>
+    constexpr FieldName(const UcLiteral<N>& name)
+        : chars(name.chars),
+          length(N),
+          hash(name.hash)
+    {
+    }
+};
+
+/**
+ * \brief  Immutable name to index map of the fields of a type or the parameters of a function module.
+ *
+ * Built once as a perfect hash (hash and displace): every name of the type maps
+ * to its own slot, so find() costs one hash over the name, one displacement lookup and one
+ * comparison to reject unknown names. The per-index seed is mixed into nameHash() afterwards,
+ * so names given as UcLiteral are not hashed at all. Names are compared exactly, as returned in
+ * RFC_FIELD_DESC::name / RFC_PARAMETER_DESC::name (upper case for DDIC objects).
+ *
+ * A built index is never modified and can be used by any number of threads.
+ */
+class FieldIndex
+{
+public:
+    /** Returned by find() for unknown names. */
+    static constexpr unsigned npos = UINT_MAX;
+
+    FieldIndex();
+
+    /**
+     * \brief  Builds the index over the fields of a structure or table row type.
+     *
+     * \in typeDescHandle Type to index.
+     * \out *errorInfo More information in case the metadata cannot be read.
+     * \return RFC_RC
+     */
+    RFC_RC build(RFC_TYPE_DESC_HANDLE typeDescHandle, RFC_ERROR_INFO* errorInfo);
+
+    /**
+     * \brief  Builds the index over the parameters of a function module.
+     *
+     * \in funcDescHandle Function module to index.
+     * \out *errorInfo More information in case the metadata cannot be read.
+     * \return RFC_RC
+     */
+    RFC_RC build(RFC_FUNCTION_DESC_HANDLE funcDescHandle, RFC_ERROR_INFO* errorInfo);
+
+    /**
+     * \brief  Field or parameter index of a name, as used by the RfcGet*ByIndex()/RfcSet*ByIndex() functions.
+     *
+     * \in &name Null-terminated name or UcLiteral.
+     * \return The index, or npos if the type has no such field.
+     */
+    unsigned find(const FieldName& name) const;
+
+    /** \brief  Number of indexed names. */
+    unsigned size() const { return static_cast<unsigned>(entries_.size()); }
+
+private:
+    struct Entry
+    {
+        unsigned offset;    ///< Start of the name in names_
+        unsigned length;    ///< Length of the name in SAP_UC
+        unsigned index;     ///< Field or parameter index
+    };
+
+    void add(SAP_UC const* name, unsigned index);
+    RFC_RC finish(RFC_ERROR_INFO* errorInfo);
+    bool place(uint64_t seed);
+    unsigned slotOf(uint64_t hash) const;
+
+    std::vector<SAP_UC> names_;
+    std::vector<Entry> entries_;
+    std::vector<unsigned> displacements_;   ///< Per bucket
+    std::vector<unsigned> slots_;           ///< Entry per slot, npos for empty slots
+    uint64_t seed_;
+    unsigned slotMask_;
+};
+
+/**
+ * \brief  Process-wide, thread-safe cache of FieldIndex objects per type or function description.
+ *
+ * Lookups take a shared lock only; an index is built outside the lock on the first request and
+ * published under an exclusive lock. Description handles are used as keys: after a description
+ * has been destroyed (RfcDestroyTypeDesc(), RfcDestroyFunctionDesc(), RfcClearRepository()) its
+ * entry must be dropped with invalidate() or clear(), as the library may reuse the address.
+ */
+class FieldIndexCache
+{
+public:
+    /** \brief  The shared instance used by FieldAccessor by default. */
+    static FieldIndexCache& instance();
+
+    /**
+     * \brief  Returns the index of a type, building it on first use.
+     *
+     * \in typeDescHandle Structure or table row type.
+     * \out &index Receives the shared index.
+     * \out *errorInfo More information in case the metadata cannot be read.
+     * \return RFC_RC
+     */
+    RFC_RC get(RFC_TYPE_DESC_HANDLE typeDescHandle, std::shared_ptr<const FieldIndex>& index, RFC_ERROR_INFO* errorInfo);
+
+    /** \brief  Returns the parameter index of a function module, building it on first use. */
+    RFC_RC get(RFC_FUNCTION_DESC_HANDLE funcDescHandle, std::shared_ptr<const FieldIndex>& index, RFC_ERROR_INFO* errorInfo);
+
+    /** \brief  Drops the index of a type or function description. */
+    void invalidate(const void* descHandle);
+
+    /** \brief  Drops all indexes. */
+    void clear();
+
+private:
+    template <class Handle>
+    RFC_RC lookup(Handle descHandle, std::shared_ptr<const FieldIndex>& index, RFC_ERROR_INFO* errorInfo);
+
+    std::shared_mutex mutex_;
+    std::unordered_map<const void*, std::shared_ptr<const FieldIndex> > indexes_;
+};
+
+/**
+ * \brief  Name-based access to a structure, table row or function handle through the *ByIndex functions.
+ *
+ * Drop-in replacement for the name-based getters and setters (RfcGetChars(), RfcSetString(),
+ * RfcGetTable(), ...): the name is resolved with the cached FieldIndex of the container's type and
+ * the call is forwarded to the corresponding RfcGet*ByIndex()/RfcSet*ByIndex() function.
+ *
+ * \code
+ * using namespace nwrfc::literals;
+ *
+ * nwrfc::FieldAccessor row(table);
+ * for (RFC_RC rc = RfcMoveToFirstRow(table, &errorInfo); rc == RFC_OK; rc = RfcMoveToNextRow(table, &errorInfo))
+ *     row.getChars("MATNR"_uc, matnr, 18, &errorInfo);
+ *
+ * nwrfc::FieldAccessor params(funcHandle, true);
+ * params.setChars(cU("MATERIAL"), matnr, 18, &errorInfo);
+ * \endcode
+ *
+ * The accessor resolves the type of the container on first use (RfcDescribeType() or
+ * RfcDescribeFunction()). setHandle() switches to another container of the same type without a
+ * new lookup. Names given as UcLiteral ("MATNR"_uc) are neither measured nor hashed at runtime,
+ * cU() literals and other strings are. Unknown names return RFC_INVALID_PARAMETER. An accessor is as thread-safe as the
+ * container it wraps.
+ */
+class FieldAccessor
+{
+public:
+    /**
+     * \in dataHandle Structure, table or function handle.
+     * \in isFunction dataHandle is an RFC_FUNCTION_HANDLE: names are parameter names.
+     * \in &cache Cache providing the index.
+     */
+    explicit FieldAccessor(DATA_CONTAINER_HANDLE dataHandle, bool isFunction = false,
+                           FieldIndexCache& cache = FieldIndexCache::instance());
+
+    /** \brief  Uses an index obtained beforehand, no type lookup is done. */
+    FieldAccessor(DATA_CONTAINER_HANDLE dataHandle, const std::shared_ptr<const FieldIndex>& index);
+
+    /** \brief  Switches to another container of the same type. */
+    void setHandle(DATA_CONTAINER_HANDLE dataHandle) { dataHandle_ = dataHandle; }
+
+    DATA_CONTAINER_HANDLE handle() const { return dataHandle_; }
+
+    /**
+     * \brief  Resolves a name to its field or parameter index.
+     *
+     * \in &name Field or parameter name, a null-terminated string or UcLiteral.
+     * \out *index Receives the index.
+     * \out *errorInfo RFC_INVALID_PARAMETER if the name is unknown.
+     * \return RFC_RC
+     */
+    RFC_RC indexOf(const FieldName& name, unsigned* index, RFC_ERROR_INFO* errorInfo);
+
+    /** \name Getters, same signatures and semantics as the SDK functions of the same name. */
+    ///@{
+    RFC_RC getChars(const FieldName& name, RFC_CHAR* charBuffer, unsigned bufferLength, RFC_ERROR_INFO* errorInfo);
+    RFC_RC getNum(const FieldName& name, RFC_NUM* charBuffer, unsigned bufferLength, RFC_ERROR_INFO* errorInfo);
+    RFC_RC getDate(const FieldName& name, RFC_DATE emptyDate, RFC_ERROR_INFO* errorInfo);
+    RFC_RC getTime(const FieldName& name, RFC_TIME emptyTime, RFC_ERROR_INFO* errorInfo);
+    RFC_RC getString(const FieldName& name, SAP_UC* stringBuffer, unsigned bufferLength, unsigned* stringLength, RFC_ERROR_INFO* errorInfo);
+    RFC_RC getStringLength(const FieldName& name, unsigned* stringLength, RFC_ERROR_INFO* errorInfo);
+    RFC_RC getBytes(const FieldName& name, SAP_RAW* byteBuffer, unsigned bufferLength, RFC_ERROR_INFO* errorInfo);
+    RFC_RC getXString(const FieldName& name, SAP_RAW* byteBuffer, unsigned bufferLength, unsigned* xstringLength, RFC_ERROR_INFO* errorInfo);
+    RFC_RC getInt(const FieldName& name, RFC_INT* value, RFC_ERROR_INFO* errorInfo);
+    RFC_RC getInt1(const FieldName& name, RFC_INT1* value, RFC_ERROR_INFO* errorInfo);
+    RFC_RC getInt2(const FieldName& name, RFC_INT2* value, RFC_ERROR_INFO* errorInfo);
+    RFC_RC getInt8(const FieldName& name, RFC_INT8* value, RFC_ERROR_INFO* errorInfo);
+    RFC_RC getFloat(const FieldName& name, RFC_FLOAT* value, RFC_ERROR_INFO* errorInfo);
+    RFC_RC getDecF16(const FieldName& name, RFC_DECF16* value, RFC_ERROR_INFO* errorInfo);
+    RFC_RC getDecF34(const FieldName& name, RFC_DECF34* value, RFC_ERROR_INFO* errorInfo);
+    RFC_RC getStructure(const FieldName& name, RFC_STRUCTURE_HANDLE* structHandle, RFC_ERROR_INFO* errorInfo);
+    RFC_RC getTable(const FieldName& name, RFC_TABLE_HANDLE* tableHandle, RFC_ERROR_INFO* errorInfo);
+    RFC_RC getAbapObject(const FieldName& name, RFC_ABAP_OBJECT_HANDLE* objHandle, RFC_ERROR_INFO* errorInfo);
+    ///@}
+
+    /** \name Setters, same signatures and semantics as the SDK functions of the same name. */
+    ///@{
+    RFC_RC setChars(const FieldName& name, const RFC_CHAR* charValue, unsigned valueLength, RFC_ERROR_INFO* errorInfo);
+    RFC_RC setNum(const FieldName& name, const RFC_NUM* charValue, unsigned valueLength, RFC_ERROR_INFO* errorInfo);
+    RFC_RC setDate(const FieldName& name, const RFC_DATE date, RFC_ERROR_INFO* errorInfo);
+    RFC_RC setTime(const FieldName& name, const RFC_TIME time, RFC_ERROR_INFO* errorInfo);
+    RFC_RC setString(const FieldName& name, const SAP_UC* stringValue, unsigned valueLength, RFC_ERROR_INFO* errorInfo);
+    RFC_RC setBytes(const FieldName& name, const SAP_RAW* byteValue, unsigned valueLength, RFC_ERROR_INFO* errorInfo);
+    RFC_RC setXString(const FieldName& name, const SAP_RAW* byteValue, unsigned valueLength, RFC_ERROR_INFO* errorInfo);
+    RFC_RC setInt(const FieldName& name, const RFC_INT value, RFC_ERROR_INFO* errorInfo);
+    RFC_RC setInt1(const FieldName& name, const RFC_INT1 value, RFC_ERROR_INFO* errorInfo);
+    RFC_RC setInt2(const FieldName& name, const RFC_INT2 value, RFC_ERROR_INFO* errorInfo);
+    RFC_RC setInt8(const FieldName& name, const RFC_INT8 value, RFC_ERROR_INFO* errorInfo);
+    RFC_RC setFloat(const FieldName& name, const RFC_FLOAT value, RFC_ERROR_INFO* errorInfo);
+    RFC_RC setDecF16(const FieldName& name, const RFC_DECF16 value, RFC_ERROR_INFO* errorInfo);
+    RFC_RC setDecF34(const FieldName& name, const RFC_DECF34 value, RFC_ERROR_INFO* errorInfo);
+    RFC_RC setStructure(const FieldName& name, const RFC_STRUCTURE_HANDLE value, RFC_ERROR_INFO* errorInfo);
+    RFC_RC setTable(const FieldName& name, const RFC_TABLE_HANDLE value, RFC_ERROR_INFO* errorInfo);
+    RFC_RC setAbapObject(const FieldName& name, const RFC_ABAP_OBJECT_HANDLE value, RFC_ERROR_INFO* errorInfo);
+    ///@}
+
+private:
+    RFC_RC resolveIndex(RFC_ERROR_INFO* errorInfo);
+
+    DATA_CONTAINER_HANDLE dataHandle_;
+    FieldIndexCache* cache_;
+    std::shared_ptr<const FieldIndex> index_;
+    bool isFunction_;
+};
+
+} // namespace nwrfc
+
+#endif // NWRFC_UTILS_FIELD_INDEX_H
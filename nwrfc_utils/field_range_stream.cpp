@@ -0,0 +1,253 @@
+#include "field_range_stream.h"
+
+#include <limits.h>
+#include "sapnwrfccloud.h"
+#include "rfc_error.h"
+#include "sapuc_utils.h"
+
+namespace nwrfc {
+
+FieldRangeReader::FieldRangeReader(DATA_CONTAINER_HANDLE dataHandle, unsigned index, RangeUnit unit)
+    : dataHandle_(dataHandle),
+      index_(index),
+      unit_(unit),
+      offset_(0),
+      length_(UINT_MAX),
+      lengthQueried_(false),
+      atEnd_(false)
+{
+}
+
+FieldRangeReader::FieldRangeReader(DATA_CONTAINER_HANDLE dataHandle, const SAP_UC* name, RangeUnit unit)
+    : dataHandle_(dataHandle),
+      index_(0),
+      name_(name),
+      unit_(unit),
+      offset_(0),
+      length_(UINT_MAX),
+      lengthQueried_(false),
+      atEnd_(false)
+{
+}
+
+RFC_RC FieldRangeReader::length(unsigned* length, RFC_ERROR_INFO* errorInfo)
+{
+    if (name_.empty())
+        return RfcGetStringLengthByIndex(dataHandle_, index_, length, errorInfo);
+    return RfcGetStringLength(dataHandle_, name_.c_str(), length, errorInfo);
+}
+
+void FieldRangeReader::seek(unsigned offset)
+{
+    offset_ = offset;
+    atEnd_ = offset_ >= length_;
+}
+
+RFC_RC FieldRangeReader::read(void* buffer, unsigned bufferLength, unsigned* unitsRead, RFC_ERROR_INFO* errorInfo)
+{
+    *unitsRead = 0;
+    if (!lengthQueried_)
+    {
+        // Known for STRING and XSTRING, so no range call starts behind the value. Other
+        // fields end with the first short read.
+        RFC_ERROR_INFO lengthError;
+        unsigned valueLength = 0;
+        if (length(&valueLength, &lengthError) == RFC_OK)
+            length_ = valueLength;
+        lengthQueried_ = true;
+        atEnd_ = offset_ >= length_;
+    }
+    if (atEnd_ || bufferLength == 0)
+        return clearError(errorInfo);
+
+    RFC_RC rc;
+    if (unit_ == RANGE_BYTES)
+    {
+        SAP_RAW* bytes = static_cast<SAP_RAW*>(buffer);
+        rc = name_.empty()
+            ? RfcGetByteRangeByIndex(dataHandle_, index_, bytes, bufferLength, offset_, unitsRead, errorInfo)
+            : RfcGetByteRange(dataHandle_, name_.c_str(), bytes, bufferLength, offset_, unitsRead, errorInfo);
+    }
+    else
+    {
+        RFC_CHAR* chars = static_cast<RFC_CHAR*>(buffer);
+        rc = name_.empty()
+            ? RfcGetCharRangeByIndex(dataHandle_, index_, chars, bufferLength, offset_, unitsRead, errorInfo)
+            : RfcGetCharRange(dataHandle_, name_.c_str(), chars, bufferLength, offset_, unitsRead, errorInfo);
+    }
+    if (rc != RFC_OK)
+        return rc;
+    offset_ += *unitsRead;
+    atEnd_ = *unitsRead < bufferLength || offset_ >= length_;
+    return RFC_OK;
+}
+
+FieldChunkCursor::FieldChunkCursor(DATA_CONTAINER_HANDLE dataHandle, unsigned index, RangeUnit unit, unsigned chunkSize)
+    : reader_(dataHandle, index, unit),
+      chunkSize_(chunkSize > 0 ? chunkSize : 1),
+      size_(0),
+      offset_(0)
+{
+}
+
+FieldChunkCursor::FieldChunkCursor(DATA_CONTAINER_HANDLE dataHandle, const SAP_UC* name, RangeUnit unit, unsigned chunkSize)
+    : reader_(dataHandle, name, unit),
+      chunkSize_(chunkSize > 0 ? chunkSize : 1),
+      size_(0),
+      offset_(0)
+{
+}
+
+RFC_RC FieldChunkCursor::next(RFC_ERROR_INFO* errorInfo)
+{
+    if (buffer_.empty())
+        buffer_.resize(static_cast<size_t>(chunkSize_) * (reader_.unit() == RANGE_CHARS ? sizeof(SAP_UC) : 1));
+
+    offset_ = reader_.offset();
+    size_ = 0;
+    RFC_RC rc = reader_.read(buffer_.data(), chunkSize_, &size_, errorInfo);
+    if (rc != RFC_OK)
+        return rc;
+    if (size_ == 0)
+        return setError(errorInfo, RFC_TABLE_MOVE_EOF, cU("No more data in the field"));
+    return RFC_OK;
+}
+
+FieldStreambuf::FieldStreambuf(DATA_CONTAINER_HANDLE dataHandle, unsigned index, RangeUnit unit, unsigned chunkSize)
+    : reader_(dataHandle, index, unit),
+      chunkSize_(chunkSize > 1 ? chunkSize : 2),
+      carry_(0),
+      bufferOffset_(0),
+      status_(RFC_OK)
+{
+    clearError(&errorInfo_);
+}
+
+FieldStreambuf::FieldStreambuf(DATA_CONTAINER_HANDLE dataHandle, const SAP_UC* name, RangeUnit unit, unsigned chunkSize)
+    : reader_(dataHandle, name, unit),
+      chunkSize_(chunkSize > 1 ? chunkSize : 2),
+      carry_(0),
+      bufferOffset_(0),
+      status_(RFC_OK)
+{
+    clearError(&errorInfo_);
+}
+
+RFC_RC FieldStreambuf::fill(RFC_ERROR_INFO* errorInfo)
+{
+    unsigned count = 0;
+    if (reader_.unit() == RANGE_BYTES)
+    {
+        bytes_.resize(chunkSize_);
+        bufferOffset_ = reader_.offset();
+        RFC_RC rc = reader_.read(bytes_.data(), chunkSize_, &count, errorInfo);
+        if (rc != RFC_OK)
+            return rc;
+        setg(bytes_.data(), bytes_.data(), bytes_.data() + count);
+        return RFC_OK;
+    }
+
+    chars_.resize(static_cast<size_t>(chunkSize_) + 1);
+    const unsigned carried = carry_ != 0 ? 1 : 0;
+    chars_[0] = carry_;
+    RFC_RC rc = reader_.read(chars_.data() + carried, chunkSize_, &count, errorInfo);
+    if (rc != RFC_OK)
+        return rc;
+    count += carried;
+
+    // A high surrogate at the end of the chunk is converted together with its low surrogate.
+    carry_ = 0;
+    if (!reader_.atEnd() && count > 0 && chars_[count - 1] >= 0xD800 && chars_[count - 1] <= 0xDBFF)
+        carry_ = chars_[--count];
+
+    utf8_.clear();
+    rc = appendUtf8(chars_.data(), count, utf8_, errorInfo);
+    if (rc != RFC_OK)
+        return rc;
+    char* data = utf8_.empty() ? NULL : &utf8_[0];
+    setg(data, data, data + utf8_.size());
+    return RFC_OK;
+}
+
+FieldStreambuf::int_type FieldStreambuf::underflow()
+{
+    while (gptr() == egptr())
+    {
+        if (status_ != RFC_OK || (reader_.atEnd() && carry_ == 0))
+            return traits_type::eof();
+        status_ = fill(&errorInfo_);
+    }
+    return traits_type::to_int_type(*gptr());
+}
+
+RFC_RC FieldStreambuf::copyTo(ByteSink& sink, RFC_ERROR_INFO* errorInfo)
+{
+    while (underflow() != traits_type::eof())
+    {
+        RFC_RC rc = sink.write(gptr(), static_cast<size_t>(egptr() - gptr()), errorInfo);
+        if (rc != RFC_OK)
+            return rc;
+        setg(eback(), egptr(), egptr());
+    }
+    if (status_ != RFC_OK && errorInfo != NULL)
+        *errorInfo = errorInfo_;
+    return status_ != RFC_OK ? status_ : clearError(errorInfo);
+}
+
+FieldStreambuf::pos_type FieldStreambuf::seekoff(off_type offset, std::ios_base::seekdir direction,
+                                                 std::ios_base::openmode which)
+{
+    // Offsets of the UTF-8 stream do not map to SAP_UC offsets of the field.
+    if (reader_.unit() != RANGE_BYTES || (which & std::ios_base::in) == 0)
+        return pos_type(off_type(-1));
+
+    off_type base = 0;
+    if (direction == std::ios_base::cur)
+    {
+        base = bufferOffset_ + (gptr() - eback());
+    }
+    else if (direction == std::ios_base::end)
+    {
+        unsigned length = 0;
+        RFC_ERROR_INFO lengthError;
+        if (reader_.length(&length, &lengthError) != RFC_OK)
+            return pos_type(off_type(-1));
+        base = length;
+    }
+    return seekpos(pos_type(base + offset), which);
+}
+
+FieldStreambuf::pos_type FieldStreambuf::seekpos(pos_type position, std::ios_base::openmode which)
+{
+    const off_type target = position;
+    if (reader_.unit() != RANGE_BYTES || (which & std::ios_base::in) == 0 || target < 0 || target > UINT_MAX)
+        return pos_type(off_type(-1));
+
+    // Within the current chunk only the get pointer moves.
+    if (eback() != NULL && target >= bufferOffset_ && target <= bufferOffset_ + (egptr() - eback()))
+    {
+        setg(eback(), eback() + (target - bufferOffset_), egptr());
+        return position;
+    }
+    reader_.seek(static_cast<unsigned>(target));
+    bufferOffset_ = static_cast<unsigned>(target);
+    setg(NULL, NULL, NULL);
+    status_ = RFC_OK;
+    return position;
+}
+
+FieldIstream::FieldIstream(DATA_CONTAINER_HANDLE dataHandle, unsigned index, RangeUnit unit, unsigned chunkSize)
+    : std::istream(NULL),
+      buffer_(dataHandle, index, unit, chunkSize)
+{
+    rdbuf(&buffer_);
+}
+
+FieldIstream::FieldIstream(DATA_CONTAINER_HANDLE dataHandle, const SAP_UC* name, RangeUnit unit, unsigned chunkSize)
+    : std::istream(NULL),
+      buffer_(dataHandle, name, unit, chunkSize)
+{
+    rdbuf(&buffer_);
+}
+
+} // namespace nwrfc
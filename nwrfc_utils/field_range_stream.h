@@ -0,0 +1,194 @@
+#ifndef NWRFC_UTILS_FIELD_RANGE_STREAM_H
+#define NWRFC_UTILS_FIELD_RANGE_STREAM_H
+
+#include <istream>
+#include <streambuf>
+#include <string>
+#include <vector>
+#include "sapnwrfc.h"
+#include "byte_sink.h"
+
+namespace nwrfc {
+
+/** \enum RangeUnit
+ *
+ * Selects the range function used to read a field, and the unit of offsets and lengths.
+ */
+enum RangeUnit
+{
+    RANGE_BYTES,    ///< XSTRING and BYTE fields via RfcGetByteRange(), offsets in bytes
+    RANGE_CHARS     ///< STRING, CHAR, NUM, DATE and TIME fields via RfcGetCharRange(), offsets in SAP_UC
+};
+
+/**
+ * \brief  Reads the value of one field piece by piece, at most one buffer at a time.
+ *
+ * Unlike RfcGetXString() or RfcGetString(), no buffer for the whole value is needed. If the data
+ * container is a table, the field of the current row is read. The reader does not own the handle.
+ */
+class FieldRangeReader
+{
+public:
+    FieldRangeReader(DATA_CONTAINER_HANDLE dataHandle, unsigned index, RangeUnit unit);
+    FieldRangeReader(DATA_CONTAINER_HANDLE dataHandle, const SAP_UC* name, RangeUnit unit);
+
+    /**
+     * \brief  Reads the next piece of the value and advances the offset.
+     *
+     * \out *buffer Receives up to bufferLength bytes or SAP_UC, depending on the unit.
+     * \in bufferLength Size of the buffer in units.
+     * \out *unitsRead Units written into the buffer, 0 at the end of the value.
+     * \out *errorInfo More information in case the field cannot be read.
+     * \return RFC_RC
+     */
+    RFC_RC read(void* buffer, unsigned bufferLength, unsigned* unitsRead, RFC_ERROR_INFO* errorInfo);
+
+    /**
+     * \brief  Total length of a STRING or XSTRING value in units, see RfcGetStringLength().
+     *
+     * \out *length Length of the value.
+     * \out *errorInfo More information in case the length cannot be determined.
+     * \return RFC_RC
+     */
+    RFC_RC length(unsigned* length, RFC_ERROR_INFO* errorInfo);
+
+    /** \brief  Continues reading at the given offset. */
+    void seek(unsigned offset);
+
+    unsigned offset() const { return offset_; }
+
+    /** \brief  True once a read() has reached the end of the value. */
+    bool atEnd() const { return atEnd_; }
+
+    RangeUnit unit() const { return unit_; }
+
+private:
+    DATA_CONTAINER_HANDLE dataHandle_;
+    unsigned index_;
+    std::basic_string<SAP_UC> name_;    ///< Empty if the field is addressed by index
+    RangeUnit unit_;
+    unsigned offset_;
+    unsigned length_;                   ///< UINT_MAX while unknown
+    bool lengthQueried_;
+    bool atEnd_;
+};
+
+/**
+ * \brief  Iterates the value of a field in chunks of fixed size.
+ *
+ * \code
+ * nwrfc::FieldChunkCursor cursor(function, cU("ATTACHMENT"), nwrfc::RANGE_BYTES);
+ * while (cursor.next(&errorInfo) == RFC_OK)
+ *     fwrite(cursor.bytes(), 1, cursor.size(), file);
+ * if (errorInfo.code != RFC_TABLE_MOVE_EOF)
+ *     ...
+ * \endcode
+ */
+class FieldChunkCursor
+{
+public:
+    FieldChunkCursor(DATA_CONTAINER_HANDLE dataHandle, unsigned index, RangeUnit unit, unsigned chunkSize = 1048576);
+    FieldChunkCursor(DATA_CONTAINER_HANDLE dataHandle, const SAP_UC* name, RangeUnit unit, unsigned chunkSize = 1048576);
+
+    /**
+     * \brief  Reads the next chunk. The data of the previous chunk is overwritten.
+     *
+     * \out *errorInfo More information in case the field cannot be read.
+     * \return RFC_OK, RFC_TABLE_MOVE_EOF after the last chunk, or the error of the range function.
+     */
+    RFC_RC next(RFC_ERROR_INFO* errorInfo);
+
+    /** \brief  Data of a RANGE_BYTES chunk. */
+    const SAP_RAW* bytes() const { return reinterpret_cast<const SAP_RAW*>(buffer_.data()); }
+
+    /** \brief  Data of a RANGE_CHARS chunk, not null-terminated. */
+    const SAP_UC* chars() const { return reinterpret_cast<const SAP_UC*>(buffer_.data()); }
+
+    /** \brief  Size of the current chunk in units. */
+    unsigned size() const { return size_; }
+
+    /** \brief  Offset of the current chunk within the value. */
+    unsigned offset() const { return offset_; }
+
+private:
+    FieldRangeReader reader_;
+    std::vector<SAP_RAW> buffer_;
+    unsigned chunkSize_;
+    unsigned size_;
+    unsigned offset_;
+};
+
+/**
+ * \brief  std::streambuf over the value of a field, for std::istream based consumers.
+ *
+ * RANGE_BYTES fields are streamed as they are and support seeking. RANGE_CHARS fields are
+ * streamed as UTF-8; a surrogate pair split by a chunk boundary is converted as a whole.
+ * Only one chunk is held in memory.
+ *
+ * Stream errors cannot carry an RFC_ERROR_INFO: after the stream reports end of file, status()
+ * tells whether the whole value was read.
+ */
+class FieldStreambuf : public std::streambuf
+{
+public:
+    FieldStreambuf(DATA_CONTAINER_HANDLE dataHandle, unsigned index, RangeUnit unit, unsigned chunkSize = 65536);
+    FieldStreambuf(DATA_CONTAINER_HANDLE dataHandle, const SAP_UC* name, RangeUnit unit, unsigned chunkSize = 65536);
+
+    /**
+     * \brief  Writes the remaining value to a sink chunk by chunk, without copying it.
+     *
+     * \in &sink Destination, e.g. an FdSink or a compressor.
+     * \out *errorInfo Error of the range function, the conversion or the sink.
+     * \return RFC_RC
+     */
+    RFC_RC copyTo(ByteSink& sink, RFC_ERROR_INFO* errorInfo);
+
+    /** \brief  RFC_OK, or the error that ended the stream early. */
+    RFC_RC status() const { return status_; }
+    const RFC_ERROR_INFO& errorInfo() const { return errorInfo_; }
+
+protected:
+    int_type underflow();
+    pos_type seekoff(off_type offset, std::ios_base::seekdir direction, std::ios_base::openmode which);
+    pos_type seekpos(pos_type position, std::ios_base::openmode which);
+
+private:
+    RFC_RC fill(RFC_ERROR_INFO* errorInfo);
+
+    FieldRangeReader reader_;
+    unsigned chunkSize_;
+    std::vector<char> bytes_;           ///< Chunk of a RANGE_BYTES field
+    std::vector<SAP_UC> chars_;         ///< Chunk of a RANGE_CHARS field, with room for a carried surrogate
+    std::string utf8_;                  ///< Converted chunk of a RANGE_CHARS field
+    SAP_UC carry_;                      ///< High surrogate held back from the previous chunk, 0 if none
+    unsigned bufferOffset_;             ///< Field offset of eback() for RANGE_BYTES
+    RFC_RC status_;
+    RFC_ERROR_INFO errorInfo_;
+};
+
+/**
+ * \brief  std::istream reading the value of a field, see FieldStreambuf.
+ *
+ * \code
+ * nwrfc::FieldIstream pdf(function, cU("CONTENT"), nwrfc::RANGE_BYTES);
+ * std::ofstream file("document.pdf", std::ios::binary);
+ * file << pdf.rdbuf();
+ * if (pdf.buffer().status() != RFC_OK)
+ *     ...
+ * \endcode
+ */
+class FieldIstream : public std::istream
+{
+public:
+    FieldIstream(DATA_CONTAINER_HANDLE dataHandle, unsigned index, RangeUnit unit, unsigned chunkSize = 65536);
+    FieldIstream(DATA_CONTAINER_HANDLE dataHandle, const SAP_UC* name, RangeUnit unit, unsigned chunkSize = 65536);
+
+    FieldStreambuf& buffer() { return buffer_; }
+
+private:
+    FieldStreambuf buffer_;
+};
+
+} // namespace nwrfc
+
+#endif // NWRFC_UTILS_FIELD_RANGE_STREAM_H
@@ -0,0 +1,225 @@
+#include "flat_structure_codec.h"
+
+#include <string.h>
+#include <algorithm>
+#include "rfc_error.h"
+#include "sapuc_utils.h"
+
+namespace nwrfc {
+
+namespace {
+
+/*
+ * Strided copy of fixed-length slices. For the short lengths typical of DDIC fields the length is
+ * a compile-time constant, so the memcpy becomes a few plain (vector) moves instead of a call.
+ */
+template <unsigned Length>
+void copySlices(const SAP_UC* source, size_t sourceStride, SAP_UC* target, size_t targetStride, unsigned count)
+{
+    for (unsigned i = 0; i < count; ++i)
+        memcpy(target + i * targetStride, source + i * sourceStride, Length * sizeof(SAP_UC));
+}
+
+void copySlices(const SAP_UC* source, size_t sourceStride, SAP_UC* target, size_t targetStride,
+                unsigned count, unsigned length)
+{
+    switch (length)
+    {
+#define NWRFC_COPY_SLICES(N) case N: copySlices<N>(source, sourceStride, target, targetStride, count); return;
+    NWRFC_COPY_SLICES(1)  NWRFC_COPY_SLICES(2)  NWRFC_COPY_SLICES(3)  NWRFC_COPY_SLICES(4)
+    NWRFC_COPY_SLICES(5)  NWRFC_COPY_SLICES(6)  NWRFC_COPY_SLICES(8)  NWRFC_COPY_SLICES(10)
+    NWRFC_COPY_SLICES(12) NWRFC_COPY_SLICES(16) NWRFC_COPY_SLICES(18) NWRFC_COPY_SLICES(20)
+    NWRFC_COPY_SLICES(30) NWRFC_COPY_SLICES(35) NWRFC_COPY_SLICES(40)
+#undef NWRFC_COPY_SLICES
+    default:
+        for (unsigned i = 0; i < count; ++i)
+            memcpy(target + i * targetStride, source + i * sourceStride, length * sizeof(SAP_UC));
+        return;
+    }
+}
+
+} // namespace
+
+FlatStructureCodec::FlatStructureCodec(RFC_TYPE_DESC_HANDLE typeDescHandle)
+    : typeDescHandle_(typeDescHandle),
+      rowLength_(0),
+      charLike_(false),
+      described_(false)
+{
+}
+
+RFC_RC FlatStructureCodec::describe(RFC_ERROR_INFO* errorInfo)
+{
+    if (described_)
+        return RFC_OK;
+
+    unsigned nucLength = 0;
+    unsigned ucLength = 0;
+    RFC_RC rc = RfcGetTypeLength(typeDescHandle_, &nucLength, &ucLength, errorInfo);
+    if (rc != RFC_OK)
+        return rc;
+    unsigned fieldCount = 0;
+    rc = RfcGetFieldCount(typeDescHandle_, &fieldCount, errorInfo);
+    if (rc != RFC_OK)
+        return rc;
+
+    fields_.clear();
+    charLike_ = fieldCount > 0;
+    rowLength_ = (ucLength + sizeof(SAP_UC) - 1) / sizeof(SAP_UC);
+    for (unsigned i = 0; i < fieldCount; ++i)
+    {
+        RFC_FIELD_DESC desc;
+        rc = RfcGetFieldDescByIndex(typeDescHandle_, i, &desc, errorInfo);
+        if (rc != RFC_OK)
+            return rc;
+        if (!isCharLikeType(desc.type))
+        {
+            charLike_ = false;
+            continue;
+        }
+        FlatField field;
+        field.index = i;
+        field.type = desc.type;
+        field.offset = desc.ucOffset / sizeof(SAP_UC);
+        field.length = desc.ucLength / sizeof(SAP_UC);
+        if (field.offset + field.length > rowLength_)
+            return setError(errorInfo, RFC_INVALID_PARAMETER, cU("Field exceeds the length of its row type"));
+        fields_.push_back(field);
+    }
+
+    initialRow_.assign(rowLength_, cU(' '));
+    for (size_t f = 0; f < fields_.size(); ++f)
+    {
+        if (fields_[f].type != RFCTYPE_CHAR)
+            std::fill_n(initialRow_.begin() + fields_[f].offset, fields_[f].length, cU('0'));
+    }
+    described_ = true;
+    return RFC_OK;
+}
+
+void FlatStructureCodec::initRows(SAP_UC* rows, unsigned rowCount) const
+{
+    for (unsigned r = 0; r < rowCount; ++r)
+        std::copy(initialRow_.begin(), initialRow_.end(), rows + static_cast<size_t>(r) * rowLength_);
+}
+
+RFC_RC FlatStructureCodec::getField(DATA_CONTAINER_HANDLE dataHandle, const FlatField& field, SAP_UC* target,
+                                    RFC_ERROR_INFO* errorInfo) const
+{
+    switch (field.type)
+    {
+    case RFCTYPE_NUM:  return RfcGetNumByIndex(dataHandle, field.index, target, field.length, errorInfo);
+    case RFCTYPE_DATE: return RfcGetDateByIndex(dataHandle, field.index, target, errorInfo);
+    case RFCTYPE_TIME: return RfcGetTimeByIndex(dataHandle, field.index, target, errorInfo);
+    default:           return RfcGetCharsByIndex(dataHandle, field.index, target, field.length, errorInfo);
+    }
+}
+
+RFC_RC FlatStructureCodec::setField(DATA_CONTAINER_HANDLE dataHandle, const FlatField& field, const SAP_UC* source,
+                                    RFC_ERROR_INFO* errorInfo) const
+{
+    switch (field.type)
+    {
+    case RFCTYPE_NUM:  return RfcSetNumByIndex(dataHandle, field.index, source, field.length, errorInfo);
+    case RFCTYPE_DATE: return RfcSetDateByIndex(dataHandle, field.index, source, errorInfo);
+    case RFCTYPE_TIME: return RfcSetTimeByIndex(dataHandle, field.index, source, errorInfo);
+    default:           return RfcSetCharsByIndex(dataHandle, field.index, source, field.length, errorInfo);
+    }
+}
+
+RFC_RC FlatStructureCodec::decodeRow(DATA_CONTAINER_HANDLE dataHandle, SAP_UC* row, RFC_ERROR_INFO* errorInfo)
+{
+    RFC_RC rc = describe(errorInfo);
+    if (rc != RFC_OK)
+        return rc;
+    if (charLike_)
+        return RfcGetStructureIntoCharBuffer(dataHandle, row, rowLength_, errorInfo);
+
+    initRows(row, 1);
+    for (size_t f = 0; f < fields_.size(); ++f)
+    {
+        rc = getField(dataHandle, fields_[f], row + fields_[f].offset, errorInfo);
+        if (rc != RFC_OK)
+            return rc;
+    }
+    return clearError(errorInfo);
+}
+
+RFC_RC FlatStructureCodec::encodeRow(DATA_CONTAINER_HANDLE dataHandle, const SAP_UC* row, RFC_ERROR_INFO* errorInfo)
+{
+    RFC_RC rc = describe(errorInfo);
+    if (rc != RFC_OK)
+        return rc;
+    // RfcSetStructureFromCharBuffer() only reads the buffer, it is just not declared const.
+    if (charLike_)
+        return RfcSetStructureFromCharBuffer(dataHandle, const_cast<SAP_UC*>(row), rowLength_, errorInfo);
+
+    for (size_t f = 0; f < fields_.size(); ++f)
+    {
+        rc = setField(dataHandle, fields_[f], row + fields_[f].offset, errorInfo);
+        if (rc != RFC_OK)
+            return rc;
+    }
+    return clearError(errorInfo);
+}
+
+RFC_RC FlatStructureCodec::decodeRows(RFC_TABLE_HANDLE tableHandle, unsigned fromRow, unsigned numberOfRows,
+                                      std::vector<SAP_UC>& rows, RFC_ERROR_INFO* errorInfo)
+{
+    RFC_RC rc = describe(errorInfo);
+    if (rc != RFC_OK)
+        return rc;
+    unsigned rowCount = 0;
+    rc = RfcGetRowCount(tableHandle, &rowCount, errorInfo);
+    if (rc != RFC_OK)
+        return rc;
+
+    fromRow = std::min(fromRow, rowCount);
+    numberOfRows = std::min(numberOfRows, rowCount - fromRow);
+    rows.resize(static_cast<size_t>(numberOfRows) * rowLength_);
+    for (unsigned r = 0; r < numberOfRows; ++r)
+    {
+        rc = RfcMoveTo(tableHandle, fromRow + r, errorInfo);
+        if (rc == RFC_OK)
+            rc = decodeRow(tableHandle, &rows[static_cast<size_t>(r) * rowLength_], errorInfo);
+        if (rc != RFC_OK)
+            return rc;
+    }
+    return clearError(errorInfo);
+}
+
+RFC_RC FlatStructureCodec::appendRows(RFC_TABLE_HANDLE tableHandle, const SAP_UC* rows, unsigned rowCount,
+                                      RFC_ERROR_INFO* errorInfo)
+{
+    RFC_RC rc = describe(errorInfo);
+    if (rc != RFC_OK || rowCount == 0)
+        return rc;
+
+    unsigned firstRow = 0;
+    rc = RfcGetRowCount(tableHandle, &firstRow, errorInfo);
+    if (rc == RFC_OK)
+        rc = RfcReserveCapacity(tableHandle, rowCount, errorInfo);
+    if (rc == RFC_OK)
+        rc = RfcAppendNewRows(tableHandle, rowCount, errorInfo);
+    for (unsigned r = 0; r < rowCount && rc == RFC_OK; ++r)
+    {
+        rc = RfcMoveTo(tableHandle, firstRow + r, errorInfo);
+        if (rc == RFC_OK)
+            rc = encodeRow(tableHandle, rows + static_cast<size_t>(r) * rowLength_, errorInfo);
+    }
+    return rc;
+}
+
+void FlatStructureCodec::extractColumn(const SAP_UC* rows, unsigned rowCount, unsigned f, SAP_UC* column) const
+{
+    const FlatField& field = fields_[f];
+    copySlices(rows + field.offset, rowLength_, column, field.length, rowCount, field.length);
+}
+
+void FlatStructureCodec::insertColumn(const SAP_UC* column, unsigned rowCount, unsigned f, SAP_UC* rows) const
+{
+    const FlatField& field = fields_[f];
+    copySlices(column, field.length, rows + field.offset, rowLength_, rowCount, field.length);
+}
+
+} // namespace nwrfc
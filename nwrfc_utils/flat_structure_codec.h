@@ -0,0 +1,149 @@
+#ifndef NWRFC_UTILS_FLAT_STRUCTURE_CODEC_H
+#define NWRFC_UTILS_FLAT_STRUCTURE_CODEC_H
+
+#include <vector>
+#include "sapnwrfc.h"
+
+namespace nwrfc {
+
+/** \struct FlatField
+ *
+ * Position of a char-like field within a row in ABAP layout.
+ */
+struct FlatField
+{
+    unsigned index;     ///< Field index within the row type
+    RFCTYPE type;       ///< RFCTYPE_CHAR, NUM, DATE or TIME
+    unsigned offset;    ///< Offset in SAP_UC from the start of the row (ucOffset / sizeof(SAP_UC))
+    unsigned length;    ///< Length in SAP_UC (ucLength / sizeof(SAP_UC))
+};
+
+/**
+ * \brief  Encodes and decodes rows of flat char-like structures as one ABAP-layout char buffer.
+ *
+ * The field positions are taken once from the RFC_FIELD_DESC offsets (ucOffset/ucLength). A row
+ * is then read with a single RfcGetStructureIntoCharBuffer() call and written with a single
+ * RfcSetStructureFromCharBuffer() call, the fields are plain fixed-offset slices of the buffer.
+ * Rows of a table are stored back to back with a stride of rowLength() SAP_UC, so whole columns
+ * can be sliced out with extractColumn() or merged in with insertColumn().
+ *
+ * \code
+ * nwrfc::FlatStructureCodec codec(rowType);
+ * std::vector<SAP_UC> rows;
+ * if (codec.decodeRows(table, 0, UINT_MAX, rows, &errorInfo) == RFC_OK)
+ * {
+ *     const unsigned matnr = 0;
+ *     const SAP_UC* first = codec.fieldAt(&rows[0], matnr);   // codec.fields()[matnr].length SAP_UC
+ * }
+ * \endcode
+ *
+ * The char buffer functions only accept row types made of CHAR, NUMC, DATS and TIMS fields. For
+ * other row types (isCharLike() returns false) the codec falls back to one getter/setter call
+ * per char-like field, using the same buffer layout. Fields of other types are not covered and
+ * keep their blank/initial area in the buffer.
+ */
+class FlatStructureCodec
+{
+public:
+    explicit FlatStructureCodec(RFC_TYPE_DESC_HANDLE typeDescHandle);
+
+    /**
+     * \brief  Reads the field layout. Called implicitly by all functions accessing data.
+     *
+     * \out *errorInfo More information in case the metadata cannot be read.
+     * \return RFC_RC
+     */
+    RFC_RC describe(RFC_ERROR_INFO* errorInfo);
+
+    /** \brief  True if all fields are char-like and the char buffer functions are used. */
+    bool isCharLike() const { return charLike_; }
+
+    /** \brief  Length of one row in SAP_UC. */
+    unsigned rowLength() const { return rowLength_; }
+
+    /** \brief  Char-like fields of the row type, in field order. */
+    const std::vector<FlatField>& fields() const { return fields_; }
+
+    /** \brief  Start of field f (index into fields()) within a row. */
+    const SAP_UC* fieldAt(const SAP_UC* row, unsigned f) const { return row + fields_[f].offset; }
+    SAP_UC* fieldAt(SAP_UC* row, unsigned f) const { return row + fields_[f].offset; }
+
+    /**
+     * \brief  Fills rows with initial values: blanks for CHAR and padding, zeros for NUMC, DATS and TIMS.
+     *
+     * \out *rows Buffer of rowCount * rowLength() SAP_UC.
+     * \in rowCount Number of rows.
+     */
+    void initRows(SAP_UC* rows, unsigned rowCount) const;
+
+    /**
+     * \brief  Reads a structure, or the current row of a table, into row.
+     *
+     * \in dataHandle Structure or table handle.
+     * \out *row Buffer of rowLength() SAP_UC.
+     * \out *errorInfo More information in case the data cannot be read.
+     * \return RFC_RC
+     */
+    RFC_RC decodeRow(DATA_CONTAINER_HANDLE dataHandle, SAP_UC* row, RFC_ERROR_INFO* errorInfo);
+
+    /**
+     * \brief  Writes row into a structure, or the current row of a table.
+     *
+     * \in dataHandle Structure or table handle.
+     * \in *row Buffer of rowLength() SAP_UC.
+     * \out *errorInfo More information in case the data cannot be set.
+     * \return RFC_RC
+     */
+    RFC_RC encodeRow(DATA_CONTAINER_HANDLE dataHandle, const SAP_UC* row, RFC_ERROR_INFO* errorInfo);
+
+    /**
+     * \brief  Reads the rows [fromRow, fromRow + numberOfRows) of a table.
+     *
+     * numberOfRows is clipped to the end of the table.
+     *
+     * \in tableHandle Table to read.
+     * \in fromRow First row to read.
+     * \in numberOfRows Maximum number of rows to read.
+     * \out &rows Receives the rows back to back, rowLength() SAP_UC each.
+     * \out *errorInfo More information in case the data cannot be read.
+     * \return RFC_RC
+     */
+    RFC_RC decodeRows(RFC_TABLE_HANDLE tableHandle, unsigned fromRow, unsigned numberOfRows,
+                      std::vector<SAP_UC>& rows, RFC_ERROR_INFO* errorInfo);
+
+    /**
+     * \brief  Appends rows to a table.
+     *
+     * \in tableHandle Table to append to.
+     * \in *rows rowCount rows back to back, rowLength() SAP_UC each.
+     * \in rowCount Number of rows to append.
+     * \out *errorInfo More information in case the data cannot be set.
+     * \return RFC_RC
+     */
+    RFC_RC appendRows(RFC_TABLE_HANDLE tableHandle, const SAP_UC* rows, unsigned rowCount, RFC_ERROR_INFO* errorInfo);
+
+    /**
+     * \brief  Copies field f of rowCount rows into a contiguous column of fields()[f].length SAP_UC per row.
+     */
+    void extractColumn(const SAP_UC* rows, unsigned rowCount, unsigned f, SAP_UC* column) const;
+
+    /**
+     * \brief  Copies a contiguous column of fields()[f].length SAP_UC per row into field f of rowCount rows.
+     */
+    void insertColumn(const SAP_UC* column, unsigned rowCount, unsigned f, SAP_UC* rows) const;
+
+private:
+    RFC_RC getField(DATA_CONTAINER_HANDLE dataHandle, const FlatField& field, SAP_UC* target, RFC_ERROR_INFO* errorInfo) const;
+    RFC_RC setField(DATA_CONTAINER_HANDLE dataHandle, const FlatField& field, const SAP_UC* source, RFC_ERROR_INFO* errorInfo) const;
+
+    RFC_TYPE_DESC_HANDLE typeDescHandle_;
+    std::vector<FlatField> fields_;
+    std::vector<SAP_UC> initialRow_;
+    unsigned rowLength_;
+    bool charLike_;
+    bool described_;
+};
+
+} // namespace nwrfc
+
+#endif // NWRFC_UTILS_FLAT_STRUCTURE_CODEC_H
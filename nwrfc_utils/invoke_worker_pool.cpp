@@ -0,0 +1,233 @@
+#include "invoke_worker_pool.h"
+
+#include <system_error>
+#include "rfc_error.h"
+
+namespace nwrfc {
+
+InvokeWorkerPool::InvokeWorkerPool(const RFC_CONNECTION_PARAMETER* connectionParams, unsigned paramCount,
+                                   const InvokeWorkerOptions& options)
+    : options_(options),
+      stopping_(false),
+      notifying_(true)
+{
+    parameterStrings_.reserve(2 * static_cast<size_t>(paramCount));
+    for (unsigned i = 0; i < paramCount; ++i)
+    {
+        parameterStrings_.push_back(connectionParams[i].name);
+        parameterStrings_.push_back(connectionParams[i].value);
+    }
+    for (unsigned i = 0; i < paramCount; ++i)
+    {
+        RFC_CONNECTION_PARAMETER parameter;
+        parameter.name = parameterStrings_[2 * i].c_str();
+        parameter.value = parameterStrings_[2 * i + 1].c_str();
+        parameters_.push_back(parameter);
+    }
+
+    const unsigned workers = options_.connections > 0 ? options_.connections : 1;
+    Worker idle = { NULL, false, false };
+    workers_.assign(workers, idle);
+    try
+    {
+        for (unsigned i = 0; i < workers; ++i)
+            threads_.push_back(std::thread(&InvokeWorkerPool::run, this, std::ref(workers_[i])));
+    }
+    catch (const std::system_error&)
+    {
+        // The workers already started must be gone before the half-built pool is destroyed.
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        queued_.notify_all();
+        for (size_t i = 0; i < threads_.size(); ++i)
+            threads_[i].join();
+        throw;
+    }
+}
+
+InvokeWorkerPool::~InvokeWorkerPool()
+{
+    // The consumer may already be gone, calls still completing must not signal it.
+    {
+        std::lock_guard<std::mutex> lock(completionMutex_);
+        notifying_ = false;
+    }
+    shutdown();
+}
+
+RFC_RC InvokeWorkerPool::submit(const InvokeJob& job, RFC_ERROR_INFO* errorInfo)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_)
+            return setError(errorInfo, RFC_ILLEGAL_STATE, cU("Worker pool is shut down"));
+        if (jobs_.size() >= options_.maxQueued)
+            return setError(errorInfo, RFC_ILLEGAL_STATE, cU("Too many calls queued"));
+        jobs_.push_back(job);
+    }
+    queued_.notify_one();
+    return clearError(errorInfo);
+}
+
+size_t InvokeWorkerPool::drain()
+{
+    std::vector<Completion> completions;
+    {
+        std::lock_guard<std::mutex> lock(completionMutex_);
+        completions.swap(completions_);
+    }
+    for (size_t i = 0; i < completions.size(); ++i)
+    {
+        if (completions[i].done)
+            completions[i].done(completions[i].rc, completions[i].errorInfo);
+    }
+    return completions.size();
+}
+
+void InvokeWorkerPool::cancel()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < workers_.size(); ++i)
+    {
+        // Outside RfcInvoke() the SDK refuses with RFC_ILLEGAL_STATE and keeps the connection open.
+        if (workers_[i].busy && workers_[i].connection != NULL && !workers_[i].canceled
+            && RfcCancel(workers_[i].connection, NULL) == RFC_OK)
+            workers_[i].canceled = true;
+    }
+}
+
+void InvokeWorkerPool::shutdown()
+{
+    std::deque<InvokeJob> canceled;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        canceled.swap(jobs_);
+    }
+    queued_.notify_all();
+    for (size_t i = 0; i < threads_.size(); ++i)
+    {
+        if (threads_[i].joinable())
+            threads_[i].join();
+    }
+    {
+        std::lock_guard<std::mutex> lock(completionMutex_);
+        notifying_ = false;
+    }
+
+    RFC_ERROR_INFO errorInfo;
+    setError(&errorInfo, RFC_CANCELED, cU("Worker pool shut down before the call started"));
+    for (size_t i = 0; i < canceled.size(); ++i)
+        complete(canceled[i], RFC_CANCELED, errorInfo);
+}
+
+void InvokeWorkerPool::run(Worker& worker)
+{
+    for (;;)
+    {
+        InvokeJob job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            queued_.wait(lock, [this]() { return stopping_ || !jobs_.empty(); });
+            if (jobs_.empty())
+                break;
+            job = jobs_.front();
+            jobs_.pop_front();
+            worker.busy = true;
+        }
+
+        RFC_ERROR_INFO errorInfo;
+        RFC_RC rc = execute(worker, job, &errorInfo);
+        bool canceled;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            worker.busy = false;
+            canceled = worker.canceled;
+            if (canceled)
+            {
+                // RfcCancel() closed the connection, the handle must not be used again.
+                worker.connection = NULL;
+                worker.canceled = false;
+            }
+        }
+
+        // Communication failures, ABAP messages and runtime errors close the connection.
+        RFC_ERROR_INFO validError;
+        int valid = 0;
+        if (rc != RFC_OK && !canceled && worker.connection != NULL
+            && (RfcIsConnectionHandleValid(worker.connection, &valid, &validError) != RFC_OK || !valid))
+            closeConnection(worker);
+        complete(job, rc, errorInfo);
+    }
+
+    closeConnection(worker);
+}
+
+RFC_RC InvokeWorkerPool::execute(Worker& worker, InvokeJob& job, RFC_ERROR_INFO* errorInfo)
+{
+    if (worker.connection == NULL)
+    {
+        RFC_CONNECTION_HANDLE connection = RfcOpenConnection(parameters_.data(), static_cast<unsigned>(parameters_.size()),
+                                                             errorInfo);
+        if (connection == NULL)
+            return errorInfo->code;
+        std::lock_guard<std::mutex> lock(mutex_);
+        worker.connection = connection;
+    }
+
+    RFC_RC rc = RFC_OK;
+    RFC_FUNCTION_HANDLE function = NULL;
+    RFC_FUNCTION_DESC_HANDLE funcDescHandle = RfcGetFunctionDesc(worker.connection, job.functionName.c_str(), errorInfo);
+    if (funcDescHandle == NULL)
+        rc = errorInfo->code;
+    if (rc == RFC_OK)
+    {
+        function = RfcCreateFunction(funcDescHandle, errorInfo);
+        if (function == NULL)
+            rc = errorInfo->code;
+    }
+    if (rc == RFC_OK && job.marshal)
+        rc = job.marshal(function, errorInfo);
+    if (rc == RFC_OK)
+        rc = RfcInvoke(worker.connection, function, errorInfo);
+    if (rc == RFC_OK && job.unmarshal)
+        rc = job.unmarshal(function, errorInfo);
+    if (function != NULL)
+        RfcDestroyFunction(function, NULL);
+    if (rc == RFC_OK)
+        return clearError(errorInfo);
+    return rc;
+}
+
+void InvokeWorkerPool::closeConnection(Worker& worker)
+{
+    // Detached under the lock first, so that cancel() never sees a closed handle.
+    RFC_CONNECTION_HANDLE connection;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        connection = worker.connection;
+        worker.connection = NULL;
+    }
+    if (connection != NULL)
+        RfcCloseConnection(connection, NULL);
+}
+
+void InvokeWorkerPool::complete(InvokeJob& job, RFC_RC rc, const RFC_ERROR_INFO& errorInfo)
+{
+    Completion completion;
+    completion.done.swap(job.done);
+    completion.rc = rc;
+    completion.errorInfo = errorInfo;
+    bool notify;
+    {
+        std::lock_guard<std::mutex> lock(completionMutex_);
+        completions_.push_back(completion);
+        notify = notifying_;
+    }
+    if (notify && options_.notify)
+        options_.notify();
+}
+
+} // namespace nwrfc
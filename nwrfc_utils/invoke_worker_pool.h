@@ -0,0 +1,156 @@
+#ifndef NWRFC_UTILS_INVOKE_WORKER_POOL_H
+#define NWRFC_UTILS_INVOKE_WORKER_POOL_H
+
+#include <stddef.h>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "sapnwrfc.h"
+
+namespace nwrfc {
+
+/** \struct InvokeWorkerOptions
+ *
+ * Size and signalling of InvokeWorkerPool.
+ */
+struct InvokeWorkerOptions
+{
+    unsigned connections;           ///< Worker threads, each with its own connection. Default: 4
+    unsigned maxQueued;             ///< Calls waiting for a worker before submit() refuses more. Default: 1024
+    std::function<void()> notify;   ///< Called on the worker thread after a call completed, e.g. uv_async_send(). Default: none
+
+    InvokeWorkerOptions() : connections(4), maxQueued(1024) {}
+};
+
+/** \struct InvokeJob
+ *
+ * One function module call. marshal and unmarshal run on the worker thread, done runs on the
+ * thread calling InvokeWorkerPool::drain().
+ */
+struct InvokeJob
+{
+    std::basic_string<SAP_UC> functionName;
+    std::function<RFC_RC(RFC_FUNCTION_HANDLE, RFC_ERROR_INFO*)> marshal;    ///< Fills the importing parameters, optional
+    std::function<RFC_RC(RFC_FUNCTION_HANDLE, RFC_ERROR_INFO*)> unmarshal;  ///< Reads the results into ready-built buffers, optional
+    std::function<void(RFC_RC, const RFC_ERROR_INFO&)> done;                ///< Completion, optional
+};
+
+/**
+ * \brief  Runs function module calls, including parameter marshalling, on a pool of worker threads.
+ *
+ * Every worker owns one connection, so the pool is the connection pool: at most connections calls
+ * run at the same time, further calls wait in a queue. A worker opens its connection on first use
+ * and again after it broke. The function handle only lives on the worker: marshal fills it,
+ * unmarshal converts the results into plain buffers (e.g. with exportTypedTable()), and done is
+ * handed the outcome on the consumer thread.
+ *
+ * For an event loop, notify wakes the loop and the loop calls drain(); nothing blocks the loop:
+ * \code
+ * nwrfc::InvokeWorkerOptions options;
+ * options.notify = [&async]() { uv_async_send(&async); };      // async.data = &pool, its callback calls drain()
+ * nwrfc::InvokeWorkerPool pool(params, paramCount, options);
+ * nwrfc::InvokeJob job;
+ * job.functionName = cU("RFC_READ_TABLE");
+ * job.marshal = [](RFC_FUNCTION_HANDLE f, RFC_ERROR_INFO* e) { return RfcSetChars(f, cU("QUERY_TABLE"), cU("T000"), 4, e); };
+ * job.unmarshal = [result](RFC_FUNCTION_HANDLE f, RFC_ERROR_INFO* e) { ... nwrfc::exportTypedTable(data, rowType, *result, e); };
+ * job.done = [result](RFC_RC rc, const RFC_ERROR_INFO& e) { ... resolve the promise with result ... };
+ * pool.submit(job, &errorInfo);
+ * \endcode
+ */
+class InvokeWorkerPool
+{
+public:
+    /**
+     * \brief  Starts the workers; the connections are opened on first use.
+     *
+     * \in *connectionParams Logon parameters as for RfcOpenConnection(), copied by the pool.
+     * \in paramCount Number of parameters.
+     * \in &options Pool size and completion signal.
+     * \throw std::system_error if a worker thread cannot be started; the workers already started
+     *        are stopped and joined first.
+     */
+    InvokeWorkerPool(const RFC_CONNECTION_PARAMETER* connectionParams, unsigned paramCount,
+                     const InvokeWorkerOptions& options = InvokeWorkerOptions());
+
+    /** \brief  shutdown() without calling notify, completions that were not drained are dropped. */
+    ~InvokeWorkerPool();
+
+    /**
+     * \brief  Queues a call for the next free worker.
+     *
+     * \in &job The call.
+     * \out *errorInfo RFC_ILLEGAL_STATE if the queue is full or the pool is shut down.
+     * \return RFC_RC
+     */
+    RFC_RC submit(const InvokeJob& job, RFC_ERROR_INFO* errorInfo);
+
+    /**
+     * \brief  Runs the done callbacks of all calls completed so far on the calling thread.
+     *
+     * \return Number of completions handled.
+     */
+    size_t drain();
+
+    /**
+     * \brief  Asks the backend to cancel all running calls, see RfcCancel(). Queued calls are not affected.
+     *
+     * Only a call that is inside RfcInvoke() is cancelled; RfcCancel() then closes the connection,
+     * the worker drops its handle and opens a new connection for its next call. Calls in another
+     * step (opening the connection, marshal, unmarshal) are not affected and complete normally.
+     */
+    void cancel();
+
+    /**
+     * \brief  Stops accepting calls and waits for the running ones.
+     *
+     * Queued calls that have not started complete with RFC_CANCELED without notify being called;
+     * call drain() afterwards to deliver them. The connections are closed.
+     */
+    void shutdown();
+
+    unsigned workerCount() const { return static_cast<unsigned>(threads_.size()); }
+
+private:
+    struct Worker
+    {
+        RFC_CONNECTION_HANDLE connection;
+        bool busy;
+        bool canceled;      // RfcCancel() closed the connection during the current call
+    };
+
+    struct Completion
+    {
+        std::function<void(RFC_RC, const RFC_ERROR_INFO&)> done;
+        RFC_RC rc;
+        RFC_ERROR_INFO errorInfo;
+    };
+
+    void run(Worker& worker);
+    RFC_RC execute(Worker& worker, InvokeJob& job, RFC_ERROR_INFO* errorInfo);
+    void closeConnection(Worker& worker);
+    void complete(InvokeJob& job, RFC_RC rc, const RFC_ERROR_INFO& errorInfo);
+
+    std::vector<std::basic_string<SAP_UC> > parameterStrings_;
+    std::vector<RFC_CONNECTION_PARAMETER> parameters_;
+    InvokeWorkerOptions options_;
+
+    std::mutex mutex_;                  // guards jobs_, workers_ and stopping_
+    std::condition_variable queued_;
+    std::deque<InvokeJob> jobs_;
+    std::vector<Worker> workers_;
+    bool stopping_;
+
+    std::mutex completionMutex_;        // guards completions_ and notifying_
+    std::vector<Completion> completions_;
+    bool notifying_;
+
+    std::vector<std::thread> threads_;
+};
+
+} // namespace nwrfc
+
+#endif // NWRFC_UTILS_INVOKE_WORKER_POOL_H
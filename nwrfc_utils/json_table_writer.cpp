@@ -0,0 +1,316 @@
+#include "json_table_writer.h"
+
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include "rfc_error.h"
+#include "sapuc_utils.h"
+
+namespace nwrfc {
+
+namespace {
+
+const char hexDigits[] = "0123456789ABCDEF";
+
+/* -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)? */
+bool isJsonNumber(const char* number, size_t length)
+{
+    size_t i = 0;
+    if (i < length && number[i] == '-')
+        ++i;
+    if (i == length || number[i] < '0' || number[i] > '9')
+        return false;
+    if (number[i] == '0' && i + 1 < length && number[i + 1] >= '0' && number[i + 1] <= '9')
+        return false;
+    while (i < length && number[i] >= '0' && number[i] <= '9')
+        ++i;
+    if (i < length && number[i] == '.')
+    {
+        if (++i == length || number[i] < '0' || number[i] > '9')
+            return false;
+        while (i < length && number[i] >= '0' && number[i] <= '9')
+            ++i;
+    }
+    if (i < length && (number[i] == 'e' || number[i] == 'E'))
+    {
+        if (++i < length && (number[i] == '+' || number[i] == '-'))
+            ++i;
+        if (i == length || number[i] < '0' || number[i] > '9')
+            return false;
+        while (i < length && number[i] >= '0' && number[i] <= '9')
+            ++i;
+    }
+    return i == length;
+}
+
+} // namespace
+
+JsonTableWriter::JsonTableWriter(const JsonWriterOptions& options)
+    : options_(options)
+{
+    if (options_.chunkRows == 0)
+        options_.chunkRows = 1;
+}
+
+RFC_RC JsonTableWriter::write(RFC_TABLE_HANDLE tableHandle, RFC_TYPE_DESC_HANDLE typeDescHandle,
+                              unsigned fromRow, unsigned numberOfRows, ByteSink& sink, RFC_ERROR_INFO* errorInfo)
+{
+    ColumnarTableReader reader(tableHandle, typeDescHandle);
+    RFC_RC rc = reader.describe(errorInfo);
+    if (rc != RFC_OK)
+        return rc;
+
+    const unsigned tableRows = reader.tableRowCount();
+    const unsigned first = std::min(fromRow, tableRows);
+    const unsigned rows = std::min(numberOfRows, tableRows - first);
+
+    out_.clear();
+    out_.reserve(options_.flushSize + 1024);
+    rc = writeHeader(reader, rows, errorInfo);
+    if (rc != RFC_OK)
+        return rc;
+    out_ += "\"data\":[";
+
+    for (unsigned done = 0; done < rows; )
+    {
+        rc = reader.read(first + done, std::min(options_.chunkRows, rows - done), errorInfo);
+        if (rc != RFC_OK)
+            return rc;
+        if (reader.rowCount() == 0)
+            return setError(errorInfo, RFC_ILLEGAL_STATE, cU("Table changed during JSON serialization"));
+
+        for (unsigned row = 0; row < reader.rowCount(); ++row)
+        {
+            if (done + row > 0)
+                out_ += ',';
+            rc = writeRow(reader, row, errorInfo);
+            if (rc == RFC_OK)
+                rc = flushIfFull(sink, errorInfo);
+            if (rc != RFC_OK)
+                return rc;
+        }
+        done += reader.rowCount();
+    }
+
+    out_ += "]}";
+    rc = sink.write(out_.data(), out_.size(), errorInfo);
+    out_.clear();
+    if (rc != RFC_OK)
+        return rc;
+    return sink.flush(errorInfo);
+}
+
+RFC_RC JsonTableWriter::write(RFC_TABLE_HANDLE tableHandle, RFC_TYPE_DESC_HANDLE typeDescHandle,
+                              ByteSink& sink, RFC_ERROR_INFO* errorInfo)
+{
+    return write(tableHandle, typeDescHandle, 0, UINT_MAX, sink, errorInfo);
+}
+
+RFC_RC JsonTableWriter::writeHeader(const ColumnarTableReader& reader, unsigned rows, RFC_ERROR_INFO* errorInfo)
+{
+    char number[32];
+    snprintf(number, sizeof(number), "%u", rows);
+    out_ += "{\"header\":{\"rows\":";
+    out_ += number;
+    out_ += ",\"fields\":[";
+
+    bool first = true;
+    for (unsigned i = 0; i < reader.columnCount(); ++i)
+    {
+        const Column& column = reader.column(i);
+        if (column.layout == COLUMN_SKIPPED)
+            continue;
+        if (!first)
+            out_ += ',';
+        first = false;
+
+        out_ += "{\"name\":";
+        RFC_RC rc = writeString(column.desc.name, static_cast<unsigned>(strlenU(column.desc.name)), errorInfo);
+        if (rc != RFC_OK)
+            return rc;
+        out_ += ",\"type\":";
+        const SAP_UC* typeName = RfcGetTypeAsString(column.desc.type);
+        rc = writeString(typeName, static_cast<unsigned>(strlenU(typeName)), errorInfo);
+        if (rc != RFC_OK)
+            return rc;
+        snprintf(number, sizeof(number), "%u", column.desc.nucLength);
+        out_ += ",\"length\":";
+        out_ += number;
+        snprintf(number, sizeof(number), "%u", column.desc.decimals);
+        out_ += ",\"decimals\":";
+        out_ += number;
+        out_ += '}';
+    }
+    out_ += "]},";
+    return RFC_OK;
+}
+
+RFC_RC JsonTableWriter::writeRow(const ColumnarTableReader& reader, unsigned row, RFC_ERROR_INFO* errorInfo)
+{
+    const bool objects = (options_.bitOptions & RFC_JSON_OBJECT_ARRAY) != 0;
+    out_ += objects ? '{' : '[';
+
+    bool first = true;
+    for (unsigned i = 0; i < reader.columnCount(); ++i)
+    {
+        const Column& column = reader.column(i);
+        if (column.layout == COLUMN_SKIPPED)
+            continue;
+        if (!first)
+            out_ += ',';
+        first = false;
+
+        RFC_RC rc;
+        if (objects)
+        {
+            rc = writeString(column.desc.name, static_cast<unsigned>(strlenU(column.desc.name)), errorInfo);
+            if (rc != RFC_OK)
+                return rc;
+            out_ += ':';
+        }
+        rc = writeValue(column, row, errorInfo);
+        if (rc != RFC_OK)
+            return rc;
+    }
+
+    out_ += objects ? '}' : ']';
+    return RFC_OK;
+}
+
+RFC_RC JsonTableWriter::writeValue(const Column& column, unsigned row, RFC_ERROR_INFO* errorInfo)
+{
+    char number[64];
+    size_t length = 0;
+
+    switch (column.desc.type)
+    {
+    case RFCTYPE_INT1:
+        length = static_cast<size_t>(snprintf(number, sizeof(number), "%u", column.values<RFC_INT1>()[row]));
+        break;
+    case RFCTYPE_INT2:
+        length = static_cast<size_t>(snprintf(number, sizeof(number), "%d", column.values<RFC_INT2>()[row]));
+        break;
+    case RFCTYPE_INT:
+        length = static_cast<size_t>(snprintf(number, sizeof(number), "%d", column.values<RFC_INT>()[row]));
+        break;
+    case RFCTYPE_INT8:
+    case RFCTYPE_UTCLONG:
+    case RFCTYPE_UTCSECOND:
+    case RFCTYPE_UTCMINUTE:
+        length = static_cast<size_t>(snprintf(number, sizeof(number), "%lld",
+                                              static_cast<long long>(column.values<RFC_INT8>()[row])));
+        break;
+    case RFCTYPE_FLOAT:
+        if (isfinite(column.values<RFC_FLOAT>()[row]))
+            length = formatDouble(column.values<RFC_FLOAT>()[row], number, sizeof(number));
+        break;
+    case RFCTYPE_DECF16:
+        length = formatDecFloat16(column.values<RFC_DECF16>()[row], number, sizeof(number));
+        break;
+    case RFCTYPE_DECF34:
+    case RFCTYPE_BCD:
+        length = formatDecFloat34(column.values<RFC_DECF34>()[row], number, sizeof(number));
+        break;
+    case RFCTYPE_CHAR:
+    {
+        unsigned charLength = column.charLength(row);
+        if (options_.trimChars)
+            charLength = trimmedLength(column.charsAt(row), charLength);
+        return writeString(column.charsAt(row), charLength, errorInfo);
+    }
+    case RFCTYPE_NUM:
+    case RFCTYPE_DATE:
+    case RFCTYPE_TIME:
+    case RFCTYPE_STRING:
+        return writeString(column.charsAt(row), column.charLength(row), errorInfo);
+    case RFCTYPE_BYTE:
+    case RFCTYPE_XSTRING:
+    {
+        const SAP_RAW* bytes = column.valueAt(row);
+        const unsigned byteLength = column.byteLength(row);
+        out_ += '"';
+        for (unsigned i = 0; i < byteLength; ++i)
+        {
+            out_ += hexDigits[bytes[i] >> 4];
+            out_ += hexDigits[bytes[i] & 0x0F];
+        }
+        out_ += '"';
+        return RFC_OK;
+    }
+    default:
+        break;
+    }
+
+    writeNumber(number, length);
+    return RFC_OK;
+}
+
+void JsonTableWriter::writeNumber(const char* number, size_t length)
+{
+    if (!isJsonNumber(number, length))
+    {
+        out_ += "null";
+        return;
+    }
+    // Like the library, RFC_JSON_OBJECT_ALL_STRING applies to the object format only.
+    const unsigned allString = RFC_JSON_OBJECT_ARRAY | RFC_JSON_OBJECT_ALL_STRING;
+    const bool quote = (options_.bitOptions & allString) == allString;
+    if (quote)
+        out_ += '"';
+    out_.append(number, length);
+    if (quote)
+        out_ += '"';
+}
+
+RFC_RC JsonTableWriter::writeString(const SAP_UC* chars, unsigned length, RFC_ERROR_INFO* errorInfo)
+{
+    scratch_.clear();
+    RFC_RC rc = appendUtf8(chars, length, scratch_, errorInfo);
+    if (rc != RFC_OK)
+        return rc;
+
+    out_ += '"';
+    size_t plain = 0;   // start of the bytes not yet copied
+    for (size_t i = 0; i < scratch_.size(); ++i)
+    {
+        const unsigned char c = static_cast<unsigned char>(scratch_[i]);
+        if (c >= 0x20 && c != '"' && c != '\\')
+            continue;
+
+        out_.append(scratch_, plain, i - plain);
+        plain = i + 1;
+        out_ += '\\';
+        switch (c)
+        {
+        case '"':  out_ += '"'; break;
+        case '\\': out_ += '\\'; break;
+        case '\b': out_ += 'b'; break;
+        case '\f': out_ += 'f'; break;
+        case '\n': out_ += 'n'; break;
+        case '\r': out_ += 'r'; break;
+        case '\t': out_ += 't'; break;
+        default:
+            out_ += "u00";
+            out_ += hexDigits[c >> 4];
+            out_ += hexDigits[c & 0x0F];
+            break;
+        }
+    }
+    out_.append(scratch_, plain, scratch_.size() - plain);
+    out_ += '"';
+    return RFC_OK;
+}
+
+RFC_RC JsonTableWriter::flushIfFull(ByteSink& sink, RFC_ERROR_INFO* errorInfo)
+{
+    if (out_.size() < options_.flushSize)
+        return RFC_OK;
+    RFC_RC rc = sink.write(out_.data(), out_.size(), errorInfo);
+    out_.clear();
+    return rc;
+}
+
+} // namespace nwrfc
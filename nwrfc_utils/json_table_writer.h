@@ -0,0 +1,86 @@
+#ifndef NWRFC_UTILS_JSON_TABLE_WRITER_H
+#define NWRFC_UTILS_JSON_TABLE_WRITER_H
+
+#include <stddef.h>
+#include <string>
+#include "sapnwrfc.h"
+#include "byte_sink.h"
+#include "columnar_table_reader.h"
+
+namespace nwrfc {
+
+/** \struct JsonWriterOptions
+ *
+ * Controls format and memory use of JsonTableWriter.
+ */
+struct JsonWriterOptions
+{
+    unsigned bitOptions;    ///< RFC_JSON_OPTIONS flags. Default: RFC_JSON_DEFAULT
+    unsigned chunkRows;     ///< Rows extracted per ColumnarTableReader window. Default: 4096
+    size_t flushSize;       ///< Output bytes collected before they are handed to the sink. Default: 64 KB
+    bool trimChars;         ///< Strip trailing blanks of RFCTYPE_CHAR fields. Default: true
+
+    JsonWriterOptions() : bitOptions(RFC_JSON_DEFAULT), chunkRows(4096), flushSize(64 * 1024), trimChars(true) {}
+};
+
+/**
+ * \brief  Streams an RFC table as UTF-8 JSON into a ByteSink.
+ *
+ * Replaces the RfcGetTableAsJson() loop of guessing a buffer size, retrying on overflow and
+ * converting the UTF-16 result to UTF-8 in a second pass. The table is extracted window by
+ * window with a ColumnarTableReader and every row is converted straight to UTF-8, so memory use
+ * is bounded by chunkRows rows plus flushSize bytes, independent of the table size.
+ *
+ * The document has the layout of RfcGetTableAsJson():
+ * \code
+ * { "header": { "rows": 2, "fields": [ { "name": "MATNR", "type": "RFCTYPE_CHAR", "length": 40, "decimals": 0 }, ... ] },
+ *   "data": [ ["000000000000000042", ...], ... ] }
+ * \endcode
+ * - RFC_JSON_DEFAULT: every row is an array of values in field order.
+ * - RFC_JSON_OBJECT_ARRAY: every row is an object keyed by field name.
+ * - RFC_JSON_OBJECT_ALL_STRING: numbers are written as strings, too; only together with
+ *   RFC_JSON_OBJECT_ARRAY, otherwise it is ignored.
+ *
+ * Integers, FLOAT, BCD and DECF16/34 are JSON numbers (decimals keep all their digits),
+ * non-finite values are null. CHAR, NUM, DATE, TIME and STRING are strings, BYTE and
+ * XSTRING hex strings. Nested structures and tables are left out.
+ */
+class JsonTableWriter
+{
+public:
+    explicit JsonTableWriter(const JsonWriterOptions& options = JsonWriterOptions());
+
+    /**
+     * \brief  Serializes the rows [fromRow, fromRow + numberOfRows) of a table.
+     *
+     * \in tableHandle Table to serialize.
+     * \in typeDescHandle Row type of the table.
+     * \in fromRow First row to serialize.
+     * \in numberOfRows Maximum number of rows to serialize, clipped to the table size.
+     * \inout &sink Receives the UTF-8 document in chunks of about flushSize bytes.
+     * \out *errorInfo More information in case the table cannot be read or the sink fails.
+     * \return RFC_RC
+     */
+    RFC_RC write(RFC_TABLE_HANDLE tableHandle, RFC_TYPE_DESC_HANDLE typeDescHandle,
+                 unsigned fromRow, unsigned numberOfRows, ByteSink& sink, RFC_ERROR_INFO* errorInfo);
+
+    /** \brief  Serializes the complete table. */
+    RFC_RC write(RFC_TABLE_HANDLE tableHandle, RFC_TYPE_DESC_HANDLE typeDescHandle,
+                 ByteSink& sink, RFC_ERROR_INFO* errorInfo);
+
+private:
+    RFC_RC writeHeader(const ColumnarTableReader& reader, unsigned rows, RFC_ERROR_INFO* errorInfo);
+    RFC_RC writeRow(const ColumnarTableReader& reader, unsigned row, RFC_ERROR_INFO* errorInfo);
+    RFC_RC writeValue(const Column& column, unsigned row, RFC_ERROR_INFO* errorInfo);
+    RFC_RC writeString(const SAP_UC* chars, unsigned length, RFC_ERROR_INFO* errorInfo);
+    void writeNumber(const char* number, size_t length);
+    RFC_RC flushIfFull(ByteSink& sink, RFC_ERROR_INFO* errorInfo);
+
+    JsonWriterOptions options_;
+    std::string out_;       // pending output
+    std::string scratch_;   // UTF-8 value before escaping
+};
+
+} // namespace nwrfc
+
+#endif // NWRFC_UTILS_JSON_TABLE_WRITER_H
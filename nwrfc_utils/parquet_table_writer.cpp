@@ -0,0 +1,715 @@
+#include "parquet_table_writer.h"
+
+#include <limits.h>
+#include <string.h>
+#include <algorithm>
+#include "sapdecf.h"
+#include "rfc_error.h"
+#include "sapuc_utils.h"
+
+namespace nwrfc {
+
+namespace {
+
+// parquet.thrift enumerations
+enum PhysicalType { TYPE_INT32 = 1, TYPE_INT64 = 2, TYPE_DOUBLE = 5, TYPE_BYTE_ARRAY = 6, TYPE_FIXED_LEN_BYTE_ARRAY = 7 };
+enum ConvertedType { CONVERTED_NONE = -1, CONVERTED_UTF8 = 0, CONVERTED_DECIMAL = 5, CONVERTED_DATE = 6,
+                     CONVERTED_TIME_MILLIS = 7, CONVERTED_UINT_8 = 11, CONVERTED_INT_16 = 16 };
+enum Repetition { REPETITION_REQUIRED = 0, REPETITION_OPTIONAL = 1 };
+enum Encoding { ENCODING_PLAIN = 0, ENCODING_RLE = 3, ENCODING_RLE_DICTIONARY = 8 };
+enum PageType { PAGE_DATA = 0, PAGE_DICTIONARY = 2 };
+const int32_t CODEC_UNCOMPRESSED = 0;
+
+/*
+ * Writer for the Thrift compact protocol, just enough for the Parquet footer and page headers.
+ * Fields must be written in ascending id order within a struct.
+ */
+class CompactProtocol
+{
+public:
+    enum Type { T_TRUE = 1, T_FALSE = 2, T_I32 = 5, T_I64 = 6, T_BINARY = 8, T_LIST = 9, T_STRUCT = 12 };
+
+    explicit CompactProtocol(std::string& out) : out_(out), lastField_(0) {}
+
+    void beginStruct()
+    {
+        stack_.push_back(lastField_);
+        lastField_ = 0;
+    }
+
+    void endStruct()
+    {
+        out_ += '\0';
+        lastField_ = stack_.back();
+        stack_.pop_back();
+    }
+
+    void fieldStruct(int16_t id)
+    {
+        fieldHeader(id, T_STRUCT);
+        beginStruct();
+    }
+
+    void fieldI32(int16_t id, int32_t value)
+    {
+        fieldHeader(id, T_I32);
+        i32(value);
+    }
+
+    void fieldI64(int16_t id, int64_t value)
+    {
+        fieldHeader(id, T_I64);
+        varint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+    }
+
+    void fieldBinary(int16_t id, const std::string& value)
+    {
+        fieldHeader(id, T_BINARY);
+        binary(value);
+    }
+
+    void fieldList(int16_t id, Type elementType, size_t size)
+    {
+        fieldHeader(id, T_LIST);
+        if (size < 15)
+        {
+            out_ += static_cast<char>((size << 4) | elementType);
+        }
+        else
+        {
+            out_ += static_cast<char>(0xF0 | elementType);
+            varint(size);
+        }
+    }
+
+    void i32(int32_t value)
+    {
+        varint((static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31));
+    }
+
+    void binary(const std::string& value)
+    {
+        varint(value.size());
+        out_ += value;
+    }
+
+private:
+    void fieldHeader(int16_t id, Type type)
+    {
+        if (id > lastField_ && id - lastField_ <= 15)
+        {
+            out_ += static_cast<char>(((id - lastField_) << 4) | type);
+        }
+        else
+        {
+            out_ += static_cast<char>(type);
+            i32(id);
+        }
+        lastField_ = id;
+    }
+
+    void varint(uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            out_ += static_cast<char>((value & 0x7F) | 0x80);
+            value >>= 7;
+        }
+        out_ += static_cast<char>(value);
+    }
+
+    std::string& out_;
+    std::vector<int16_t> stack_;
+    int16_t lastField_;
+};
+
+void appendVarint(std::string& out, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        out += static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    out += static_cast<char>(value);
+}
+
+// PLAIN values are little endian, independent of the platform.
+void appendLE(std::string& out, uint64_t value, unsigned bytes)
+{
+    for (unsigned i = 0; i < bytes; ++i)
+        out += static_cast<char>((value >> (8 * i)) & 0xFF);
+}
+
+void patchLE32(std::string& out, size_t at, uint32_t value)
+{
+    for (unsigned i = 0; i < 4; ++i)
+        out[at + i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+}
+
+void appendByteArray(std::string& out, const SAP_RAW* bytes, unsigned length)
+{
+    appendLE(out, length, 4);
+    out.append(reinterpret_cast<const char*>(bytes), length);
+}
+
+RFC_RC appendUtf8Value(std::string& out, const SAP_UC* chars, unsigned length, RFC_ERROR_INFO* errorInfo)
+{
+    const size_t start = out.size();
+    out.append(4, '\0');
+    RFC_RC rc = appendUtf8(chars, length, out, errorInfo);
+    if (rc != RFC_OK)
+    {
+        out.resize(start);
+        return rc;
+    }
+    patchLE32(out, start, static_cast<uint32_t>(out.size() - start - 4));
+    return RFC_OK;
+}
+
+/* Groups of 8 values, LSB first, the last group padded with zeros. */
+void appendBitPacked(std::string& out, const std::vector<uint32_t>& values, size_t begin, size_t end, unsigned bitWidth)
+{
+    if (begin == end)
+        return;
+    const size_t groups = (end - begin + 7) / 8;
+    appendVarint(out, (groups << 1) | 1);
+    uint64_t bits = 0;
+    unsigned bitCount = 0;
+    for (size_t i = begin; i < begin + groups * 8; ++i)
+    {
+        bits |= static_cast<uint64_t>(i < end ? values[i] : 0) << bitCount;
+        bitCount += bitWidth;
+        while (bitCount >= 8)
+        {
+            out += static_cast<char>(bits & 0xFF);
+            bits >>= 8;
+            bitCount -= 8;
+        }
+    }
+}
+
+/* RLE/bit-packing hybrid encoding: runs of at least 8 equal values are run length encoded. */
+void appendHybrid(std::string& out, const std::vector<uint32_t>& values, unsigned bitWidth)
+{
+    const unsigned valueBytes = (bitWidth + 7) / 8;
+    size_t literalStart = 0;
+    size_t i = 0;
+    while (i < values.size())
+    {
+        size_t runEnd = i + 1;
+        while (runEnd < values.size() && values[runEnd] == values[i])
+            ++runEnd;
+
+        // Bit-packed runs hold whole groups of 8, so a repeated run starts on a group boundary.
+        const size_t align = (8 - (i - literalStart) % 8) % 8;
+        if (runEnd - i >= align + 8)
+        {
+            i += align;
+            appendBitPacked(out, values, literalStart, i, bitWidth);
+            appendVarint(out, (runEnd - i) << 1);
+            appendLE(out, values[i], valueBytes);
+            literalStart = runEnd;
+        }
+        i = runEnd;
+    }
+    appendBitPacked(out, values, literalStart, values.size(), bitWidth);
+}
+
+bool dictionaryType(RFCTYPE type)
+{
+    return type == RFCTYPE_CHAR || type == RFCTYPE_NUM;
+}
+
+} // namespace
+
+ParquetTableWriter::ParquetTableWriter(ByteSink& sink, const ParquetWriterOptions& options)
+    : sink_(sink),
+      options_(options),
+      bufferedRows_(0),
+      position_(0)
+{
+    if (options_.rowGroupRows == 0)
+        options_.rowGroupRows = 1;
+}
+
+RFC_RC ParquetTableWriter::begin(const std::vector<Column>& columns, RFC_ERROR_INFO* errorInfo)
+{
+    columns_.clear();
+    rowGroups_.clear();
+    bufferedRows_ = 0;
+    position_ = 0;
+
+    for (size_t i = 0; i < columns.size(); ++i)
+    {
+        if (columns[i].layout == COLUMN_SKIPPED)
+            continue;
+
+        ColumnBuffer buffer;
+        buffer.index = static_cast<unsigned>(i);
+        buffer.desc = columns[i].desc;
+        buffer.convertedType = CONVERTED_NONE;
+        buffer.typeLength = 0;
+        buffer.precision = 0;
+        buffer.optional = false;
+        buffer.dictionary = options_.dictionary && dictionaryType(buffer.desc.type);
+        RFC_RC rc = appendUtf8(buffer.desc.name, static_cast<unsigned>(strlenU(buffer.desc.name)), buffer.name, errorInfo);
+        if (rc != RFC_OK)
+            return rc;
+
+        switch (buffer.desc.type)
+        {
+        case RFCTYPE_INT1:
+            buffer.physicalType = TYPE_INT32;
+            buffer.convertedType = CONVERTED_UINT_8;
+            break;
+        case RFCTYPE_INT2:
+            buffer.physicalType = TYPE_INT32;
+            buffer.convertedType = CONVERTED_INT_16;
+            break;
+        case RFCTYPE_INT:
+            buffer.physicalType = TYPE_INT32;
+            break;
+        case RFCTYPE_INT8:
+        case RFCTYPE_UTCLONG:
+        case RFCTYPE_UTCSECOND:
+        case RFCTYPE_UTCMINUTE:
+            buffer.physicalType = TYPE_INT64;
+            break;
+        case RFCTYPE_FLOAT:
+            buffer.physicalType = TYPE_DOUBLE;
+            break;
+        case RFCTYPE_BCD:
+            buffer.physicalType = TYPE_FIXED_LEN_BYTE_ARRAY;
+            buffer.convertedType = CONVERTED_DECIMAL;
+            buffer.typeLength = 16;
+            buffer.precision = static_cast<int32_t>(std::min(buffer.desc.nucLength * 2 - 1, 38u));
+            buffer.optional = true;
+            break;
+        case RFCTYPE_DATE:
+            buffer.physicalType = TYPE_INT32;
+            buffer.convertedType = CONVERTED_DATE;
+            buffer.optional = true;
+            break;
+        case RFCTYPE_TIME:
+            buffer.physicalType = TYPE_INT32;
+            buffer.convertedType = CONVERTED_TIME_MILLIS;
+            buffer.optional = true;
+            break;
+        case RFCTYPE_DECF16:
+        case RFCTYPE_DECF34:
+        case RFCTYPE_CHAR:
+        case RFCTYPE_NUM:
+        case RFCTYPE_STRING:
+            buffer.physicalType = TYPE_BYTE_ARRAY;
+            buffer.convertedType = CONVERTED_UTF8;
+            break;
+        case RFCTYPE_BYTE:
+        case RFCTYPE_XSTRING:
+            buffer.physicalType = TYPE_BYTE_ARRAY;
+            break;
+        default:
+            return setError(errorInfo, RFC_INVALID_PARAMETER,
+                            (std::basic_string<SAP_UC>(cU("Field ")) + buffer.desc.name + cU(" has no Parquet type")).c_str());
+        }
+        columns_.push_back(buffer);
+    }
+
+    std::string magic("PAR1");
+    return emit(magic, errorInfo);
+}
+
+RFC_RC ParquetTableWriter::write(const ColumnarTableReader& batch, RFC_ERROR_INFO* errorInfo)
+{
+    for (size_t i = 0; i < columns_.size(); ++i)
+    {
+        if (columns_[i].index >= batch.columnCount() || batch.column(columns_[i].index).desc.type != columns_[i].desc.type)
+            return setError(errorInfo, RFC_INVALID_PARAMETER, cU("Batch does not match the columns passed to begin()"));
+    }
+
+    for (unsigned row = 0; row < batch.rowCount(); )
+    {
+        const unsigned count = std::min(batch.rowCount() - row, options_.rowGroupRows - bufferedRows_);
+        for (size_t i = 0; i < columns_.size(); ++i)
+        {
+            RFC_RC rc = append(columns_[i], batch.column(columns_[i].index), row, row + count, errorInfo);
+            if (rc != RFC_OK)
+                return rc;
+        }
+        bufferedRows_ += count;
+        row += count;
+
+        if (bufferedRows_ >= options_.rowGroupRows || bufferedBytes() >= options_.rowGroupBytes)
+        {
+            RFC_RC rc = writeRowGroup(errorInfo);
+            if (rc != RFC_OK)
+                return rc;
+        }
+    }
+    return clearError(errorInfo);
+}
+
+RFC_RC ParquetTableWriter::append(ColumnBuffer& buffer, const Column& column, unsigned fromRow, unsigned toRow,
+                                  RFC_ERROR_INFO* errorInfo)
+{
+    std::string& out = buffer.values;
+    switch (column.desc.type)
+    {
+    case RFCTYPE_INT1:
+        for (unsigned row = fromRow; row < toRow; ++row)
+            appendLE(out, column.values<RFC_INT1>()[row], 4);
+        break;
+    case RFCTYPE_INT2:
+        for (unsigned row = fromRow; row < toRow; ++row)
+            appendLE(out, static_cast<uint32_t>(static_cast<int32_t>(column.values<RFC_INT2>()[row])), 4);
+        break;
+    case RFCTYPE_INT:
+        for (unsigned row = fromRow; row < toRow; ++row)
+            appendLE(out, static_cast<uint32_t>(column.values<RFC_INT>()[row]), 4);
+        break;
+    case RFCTYPE_INT8:
+    case RFCTYPE_UTCLONG:
+    case RFCTYPE_UTCSECOND:
+    case RFCTYPE_UTCMINUTE:
+        for (unsigned row = fromRow; row < toRow; ++row)
+            appendLE(out, static_cast<uint64_t>(column.values<RFC_INT8>()[row]), 8);
+        break;
+    case RFCTYPE_FLOAT:
+        for (unsigned row = fromRow; row < toRow; ++row)
+        {
+            uint64_t bits;
+            memcpy(&bits, &column.values<RFC_FLOAT>()[row], sizeof(bits));
+            appendLE(out, bits, 8);
+        }
+        break;
+    case RFCTYPE_BCD:
+        for (unsigned row = fromRow; row < toRow; ++row)
+        {
+            DecFloat34Buff buffer34;
+            uint64_t value[2];
+            DecFloat34ToString(column.values<RFC_DECF34>()[row], &buffer34);
+            const bool valid = decimalToInt128(buffer34, column.desc.decimals, value);
+            buffer.levels.push_back(valid ? 1 : 0);
+            if (!valid)
+                continue;
+            // FIXED_LEN_BYTE_ARRAY decimals are big endian.
+            for (int i = 15; i >= 0; --i)
+                out += static_cast<char>((value[i / 8] >> (8 * (i % 8))) & 0xFF);
+        }
+        break;
+    case RFCTYPE_DATE:
+    case RFCTYPE_TIME:
+        for (unsigned row = fromRow; row < toRow; ++row)
+        {
+            int32_t value = 0;
+            const bool valid = column.desc.type == RFCTYPE_DATE ? parseDate(column.charsAt(row), &value)
+                                                                : parseTime(column.charsAt(row), &value);
+            buffer.levels.push_back(valid ? 1 : 0);
+            if (valid)
+                appendLE(out, static_cast<uint32_t>(column.desc.type == RFCTYPE_DATE ? value : value * 1000), 4);
+        }
+        break;
+    case RFCTYPE_DECF16:
+    case RFCTYPE_DECF34:
+        for (unsigned row = fromRow; row < toRow; ++row)
+        {
+            char number[64];
+            const size_t length = column.desc.type == RFCTYPE_DECF16
+                ? formatDecFloat16(column.values<RFC_DECF16>()[row], number, sizeof(number))
+                : formatDecFloat34(column.values<RFC_DECF34>()[row], number, sizeof(number));
+            appendByteArray(out, reinterpret_cast<const SAP_RAW*>(number), static_cast<unsigned>(length));
+        }
+        break;
+    case RFCTYPE_CHAR:
+    case RFCTYPE_NUM:
+    case RFCTYPE_STRING:
+    {
+        const bool trim = options_.trimChars && column.desc.type == RFCTYPE_CHAR;
+        for (unsigned row = fromRow; row < toRow; ++row)
+        {
+            const unsigned length = trim ? trimmedLength(column.charsAt(row), column.charLength(row)) : column.charLength(row);
+            RFC_RC rc = appendText(buffer, column.charsAt(row), length, errorInfo);
+            if (rc != RFC_OK)
+                return rc;
+        }
+        break;
+    }
+    case RFCTYPE_BYTE:
+    case RFCTYPE_XSTRING:
+        for (unsigned row = fromRow; row < toRow; ++row)
+            appendByteArray(out, column.valueAt(row), column.byteLength(row));
+        break;
+    default:
+        break;
+    }
+    return RFC_OK;
+}
+
+RFC_RC ParquetTableWriter::appendText(ColumnBuffer& buffer, const SAP_UC* chars, unsigned length, RFC_ERROR_INFO* errorInfo)
+{
+    if (buffer.dictionary)
+    {
+        key_.assign(reinterpret_cast<const char*>(chars), length * sizeof(SAP_UC));
+        std::unordered_map<std::string, uint32_t>::const_iterator it = buffer.lookup.find(key_);
+        if (it != buffer.lookup.end())
+        {
+            buffer.indices.push_back(it->second);
+            return RFC_OK;
+        }
+        if (buffer.lookup.size() < options_.maxDictionaryEntries)
+        {
+            const uint32_t index = static_cast<uint32_t>(buffer.entryOffsets.size());
+            buffer.entryOffsets.push_back(buffer.dictionaryValues.size());
+            RFC_RC rc = appendUtf8Value(buffer.dictionaryValues, chars, length, errorInfo);
+            if (rc != RFC_OK)
+            {
+                buffer.entryOffsets.pop_back();
+                return rc;
+            }
+            buffer.lookup.insert(std::make_pair(key_, index));
+            buffer.indices.push_back(index);
+            return RFC_OK;
+        }
+        dropDictionary(buffer);
+    }
+    return appendUtf8Value(buffer.values, chars, length, errorInfo);
+}
+
+void ParquetTableWriter::dropDictionary(ColumnBuffer& buffer)
+{
+    // The dictionary entries are PLAIN encoded already, the rows so far just copy them.
+    for (size_t i = 0; i < buffer.indices.size(); ++i)
+    {
+        const uint32_t index = buffer.indices[i];
+        const size_t begin = buffer.entryOffsets[index];
+        const size_t end = index + 1 < buffer.entryOffsets.size() ? buffer.entryOffsets[index + 1] : buffer.dictionaryValues.size();
+        buffer.values.append(buffer.dictionaryValues, begin, end - begin);
+    }
+    buffer.dictionary = false;
+    buffer.lookup.clear();
+    buffer.indices.clear();
+    buffer.dictionaryValues.clear();
+    buffer.entryOffsets.clear();
+}
+
+size_t ParquetTableWriter::bufferedBytes() const
+{
+    size_t bytes = 0;
+    for (size_t i = 0; i < columns_.size(); ++i)
+    {
+        const ColumnBuffer& buffer = columns_[i];
+        bytes += buffer.values.size() + buffer.dictionaryValues.size() + buffer.indices.size() * sizeof(uint32_t)
+               + buffer.levels.size() / 8;
+    }
+    return bytes;
+}
+
+RFC_RC ParquetTableWriter::writeRowGroup(RFC_ERROR_INFO* errorInfo)
+{
+    RowGroupInfo group;
+    group.rows = bufferedRows_;
+    group.offset = position_;
+    for (size_t i = 0; i < columns_.size(); ++i)
+    {
+        ChunkInfo chunk;
+        RFC_RC rc = writeChunk(columns_[i], chunk, errorInfo);
+        if (rc != RFC_OK)
+            return rc;
+        group.chunks.push_back(chunk);
+    }
+    group.size = position_ - group.offset;
+    rowGroups_.push_back(group);
+    bufferedRows_ = 0;
+    return RFC_OK;
+}
+
+RFC_RC ParquetTableWriter::writeChunk(ColumnBuffer& buffer, ChunkInfo& chunk, RFC_ERROR_INFO* errorInfo)
+{
+    const int64_t start = position_;
+    const int32_t rows = static_cast<int32_t>(bufferedRows_);
+    chunk.dictionaryPageOffset = -1;
+    RFC_RC rc = RFC_OK;
+
+    if (buffer.dictionary)
+    {
+        if (buffer.dictionaryValues.size() > INT_MAX)
+            return setError(errorInfo, RFC_INVALID_PARAMETER, cU("Dictionary page exceeds 2 GB, reduce rowGroupRows"));
+        const int32_t size = static_cast<int32_t>(buffer.dictionaryValues.size());
+        header_.clear();
+        CompactProtocol header(header_);
+        header.beginStruct();
+        header.fieldI32(1, PAGE_DICTIONARY);
+        header.fieldI32(2, size);
+        header.fieldI32(3, size);
+        header.fieldStruct(7);
+        header.fieldI32(1, static_cast<int32_t>(buffer.entryOffsets.size()));
+        header.fieldI32(2, ENCODING_PLAIN);
+        header.endStruct();
+        header.endStruct();
+
+        chunk.dictionaryPageOffset = position_;
+        rc = emit(header_, errorInfo);
+        if (rc == RFC_OK)
+            rc = emit(buffer.dictionaryValues, errorInfo);
+        if (rc != RFC_OK)
+            return rc;
+    }
+
+    page_.clear();
+    if (buffer.optional)
+    {
+        page_.append(4, '\0');
+        appendHybrid(page_, buffer.levels, 1);
+        patchLE32(page_, 0, static_cast<uint32_t>(page_.size() - 4));
+    }
+    if (buffer.dictionary)
+    {
+        unsigned bitWidth = 1;
+        while (bitWidth < 32 && (1ULL << bitWidth) < buffer.entryOffsets.size())
+            ++bitWidth;
+        page_ += static_cast<char>(bitWidth);
+        appendHybrid(page_, buffer.indices, bitWidth);
+    }
+    else
+    {
+        page_ += buffer.values;
+    }
+    if (page_.size() > INT_MAX)
+        return setError(errorInfo, RFC_INVALID_PARAMETER, cU("Data page exceeds 2 GB, reduce rowGroupRows"));
+
+    const int32_t size = static_cast<int32_t>(page_.size());
+    header_.clear();
+    CompactProtocol header(header_);
+    header.beginStruct();
+    header.fieldI32(1, PAGE_DATA);
+    header.fieldI32(2, size);
+    header.fieldI32(3, size);
+    header.fieldStruct(5);
+    header.fieldI32(1, rows);
+    header.fieldI32(2, buffer.dictionary ? ENCODING_RLE_DICTIONARY : ENCODING_PLAIN);
+    header.fieldI32(3, ENCODING_RLE);
+    header.fieldI32(4, ENCODING_RLE);
+    header.endStruct();
+    header.endStruct();
+
+    chunk.dataPageOffset = position_;
+    rc = emit(header_, errorInfo);
+    if (rc == RFC_OK)
+        rc = emit(page_, errorInfo);
+    if (rc != RFC_OK)
+        return rc;
+
+    chunk.size = position_ - start;
+    chunk.encodings.clear();
+    chunk.encodings.push_back(ENCODING_PLAIN);
+    chunk.encodings.push_back(ENCODING_RLE);
+    if (buffer.dictionary)
+        chunk.encodings.push_back(ENCODING_RLE_DICTIONARY);
+
+    buffer.levels.clear();
+    buffer.values.clear();
+    buffer.lookup.clear();
+    buffer.indices.clear();
+    buffer.dictionaryValues.clear();
+    buffer.entryOffsets.clear();
+    buffer.dictionary = options_.dictionary && dictionaryType(buffer.desc.type);
+    return RFC_OK;
+}
+
+RFC_RC ParquetTableWriter::finish(RFC_ERROR_INFO* errorInfo)
+{
+    if (bufferedRows_ > 0)
+    {
+        RFC_RC rc = writeRowGroup(errorInfo);
+        if (rc != RFC_OK)
+            return rc;
+    }
+
+    int64_t rows = 0;
+    for (size_t i = 0; i < rowGroups_.size(); ++i)
+        rows += rowGroups_[i].rows;
+
+    std::string footer;
+    CompactProtocol meta(footer);
+    meta.beginStruct();
+    meta.fieldI32(1, 1);
+    meta.fieldList(2, CompactProtocol::T_STRUCT, columns_.size() + 1);
+    meta.beginStruct();
+    meta.fieldBinary(4, "schema");
+    meta.fieldI32(5, static_cast<int32_t>(columns_.size()));
+    meta.endStruct();
+    for (size_t i = 0; i < columns_.size(); ++i)
+    {
+        const ColumnBuffer& column = columns_[i];
+        meta.beginStruct();
+        meta.fieldI32(1, column.physicalType);
+        if (column.physicalType == TYPE_FIXED_LEN_BYTE_ARRAY)
+            meta.fieldI32(2, column.typeLength);
+        meta.fieldI32(3, column.optional ? REPETITION_OPTIONAL : REPETITION_REQUIRED);
+        meta.fieldBinary(4, column.name);
+        if (column.convertedType != CONVERTED_NONE)
+            meta.fieldI32(6, column.convertedType);
+        if (column.convertedType == CONVERTED_DECIMAL)
+        {
+            meta.fieldI32(7, static_cast<int32_t>(column.desc.decimals));
+            meta.fieldI32(8, column.precision);
+        }
+        meta.endStruct();
+    }
+    meta.fieldI64(3, rows);
+
+    meta.fieldList(4, CompactProtocol::T_STRUCT, rowGroups_.size());
+    for (size_t g = 0; g < rowGroups_.size(); ++g)
+    {
+        const RowGroupInfo& group = rowGroups_[g];
+        meta.beginStruct();
+        meta.fieldList(1, CompactProtocol::T_STRUCT, group.chunks.size());
+        for (size_t i = 0; i < group.chunks.size(); ++i)
+        {
+            const ChunkInfo& chunk = group.chunks[i];
+            const int64_t chunkOffset = chunk.dictionaryPageOffset >= 0 ? chunk.dictionaryPageOffset : chunk.dataPageOffset;
+            meta.beginStruct();
+            meta.fieldI64(2, chunkOffset);
+            meta.fieldStruct(3);
+            meta.fieldI32(1, columns_[i].physicalType);
+            meta.fieldList(2, CompactProtocol::T_I32, chunk.encodings.size());
+            for (size_t e = 0; e < chunk.encodings.size(); ++e)
+                meta.i32(chunk.encodings[e]);
+            meta.fieldList(3, CompactProtocol::T_BINARY, 1);
+            meta.binary(columns_[i].name);
+            meta.fieldI32(4, CODEC_UNCOMPRESSED);
+            meta.fieldI64(5, group.rows);
+            meta.fieldI64(6, chunk.size);
+            meta.fieldI64(7, chunk.size);
+            meta.fieldI64(9, chunk.dataPageOffset);
+            if (chunk.dictionaryPageOffset >= 0)
+                meta.fieldI64(11, chunk.dictionaryPageOffset);
+            meta.endStruct();
+            meta.endStruct();
+        }
+        meta.fieldI64(2, group.size);
+        meta.fieldI64(3, group.rows);
+        meta.fieldI64(5, group.offset);
+        meta.fieldI64(6, group.size);
+        meta.endStruct();
+    }
+    meta.fieldBinary(6, "nwrfc_utils");
+    meta.endStruct();
+
+    const size_t footerSize = footer.size();
+    appendLE(footer, footerSize, 4);
+    footer += "PAR1";
+    RFC_RC rc = emit(footer, errorInfo);
+    if (rc != RFC_OK)
+        return rc;
+    return sink_.flush(errorInfo);
+}
+
+RFC_RC ParquetTableWriter::emit(const std::string& bytes, RFC_ERROR_INFO* errorInfo)
+{
+    RFC_RC rc = sink_.write(bytes.data(), bytes.size(), errorInfo);
+    if (rc == RFC_OK)
+        position_ += static_cast<int64_t>(bytes.size());
+    return rc;
+}
+
+} // namespace nwrfc
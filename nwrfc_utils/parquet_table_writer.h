@@ -0,0 +1,130 @@
+#ifndef NWRFC_UTILS_PARQUET_TABLE_WRITER_H
+#define NWRFC_UTILS_PARQUET_TABLE_WRITER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "sapnwrfc.h"
+#include "byte_sink.h"
+#include "table_sink.h"
+
+namespace nwrfc {
+
+/** \struct ParquetWriterOptions
+ *
+ * Controls the layout and memory use of ParquetTableWriter.
+ */
+struct ParquetWriterOptions
+{
+    unsigned rowGroupRows;          ///< Rows per row group. Default: 131072
+    size_t rowGroupBytes;           ///< A row group also ends once its encoded columns reach this size. Default: 128 MB
+    bool dictionary;                ///< Dictionary encode CHAR and NUM columns. Default: true
+    unsigned maxDictionaryEntries;  ///< Distinct values per row group before a column falls back to PLAIN. Default: 65536
+    bool trimChars;                 ///< Strip trailing blanks of RFCTYPE_CHAR fields. Default: true
+
+    ParquetWriterOptions()
+        : rowGroupRows(131072), rowGroupBytes(128 * 1024 * 1024), dictionary(true), maxDictionaryEntries(65536),
+          trimChars(true) {}
+};
+
+/**
+ * \brief  Writes table batches as an Apache Parquet file into a ByteSink.
+ *
+ * \code
+ * nwrfc::FdSink file(fd);
+ * nwrfc::ParquetTableWriter parquet(file);
+ * rc = nwrfc::writeTable(table, RfcGetRowType(table, &errorInfo), parquet, &errorInfo);
+ * \endcode
+ *
+ * The schema follows the RFC_FIELD_DESC of every column:
+ * - RFCTYPE_INT1, INT2, INT: INT32 (UINT_8, INT_16)
+ * - RFCTYPE_INT8 and UTCxxx: INT64
+ * - RFCTYPE_FLOAT: DOUBLE
+ * - RFCTYPE_BCD: FIXED_LEN_BYTE_ARRAY(16) DECIMAL(min(2 * nucLength - 1, 38), decimals), null on overflow
+ * - RFCTYPE_DECF16/34: UTF8 strings with all digits
+ * - RFCTYPE_DATE: INT32 DATE, null for the initial and invalid dates
+ * - RFCTYPE_TIME: INT32 TIME_MILLIS, null for invalid times
+ * - RFCTYPE_CHAR, NUM, STRING: UTF8 strings
+ * - RFCTYPE_BYTE, XSTRING: BYTE_ARRAY
+ *
+ * CHAR and NUM columns are dictionary encoded per row group: a PLAIN dictionary page followed by
+ * an RLE_DICTIONARY data page. Dictionary lookups use the raw SAP_UC value, so only distinct
+ * values are converted to UTF-8. A column whose dictionary outgrows maxDictionaryEntries switches
+ * to PLAIN for the rest of the row group. Every column chunk is one uncompressed data page;
+ * column statistics are not written.
+ *
+ * Rows are buffered until a row group is complete, so memory use is bounded by one encoded row
+ * group, see rowGroupRows and rowGroupBytes.
+ */
+class ParquetTableWriter : public TableSink
+{
+public:
+    explicit ParquetTableWriter(ByteSink& sink, const ParquetWriterOptions& options = ParquetWriterOptions());
+
+    RFC_RC begin(const std::vector<Column>& columns, RFC_ERROR_INFO* errorInfo);
+    RFC_RC write(const ColumnarTableReader& batch, RFC_ERROR_INFO* errorInfo);
+    RFC_RC finish(RFC_ERROR_INFO* errorInfo);
+
+private:
+    /** \brief  Column chunk of a written row group, kept for the file footer. */
+    struct ChunkInfo
+    {
+        std::vector<int32_t> encodings;
+        int64_t dataPageOffset;
+        int64_t dictionaryPageOffset;   ///< -1 without dictionary page
+        int64_t size;
+    };
+
+    /** \brief  Written row group, kept for the file footer. */
+    struct RowGroupInfo
+    {
+        std::vector<ChunkInfo> chunks;
+        int64_t rows;
+        int64_t offset;
+        int64_t size;
+    };
+
+    /** \brief  Encoded values of one column of the current row group. */
+    struct ColumnBuffer
+    {
+        unsigned index;                     ///< Column index within the batches
+        RFC_FIELD_DESC desc;
+        std::string name;                   ///< UTF-8 field name
+        int32_t physicalType;
+        int32_t convertedType;              ///< -1 if none
+        int32_t typeLength;                 ///< FIXED_LEN_BYTE_ARRAY only
+        int32_t precision;                  ///< DECIMAL only
+        bool optional;                      ///< Has definition levels
+        bool dictionary;                    ///< Currently dictionary encoded
+        std::vector<uint32_t> levels;       ///< Definition level per row of optional columns
+        std::string values;                 ///< PLAIN encoded non-null values
+        std::unordered_map<std::string, uint32_t> lookup;   ///< Raw SAP_UC value -> dictionary index
+        std::vector<uint32_t> indices;      ///< Dictionary index per row
+        std::string dictionaryValues;       ///< PLAIN encoded dictionary
+        std::vector<size_t> entryOffsets;   ///< Start of every entry within dictionaryValues
+    };
+
+    RFC_RC append(ColumnBuffer& buffer, const Column& column, unsigned fromRow, unsigned toRow, RFC_ERROR_INFO* errorInfo);
+    RFC_RC appendText(ColumnBuffer& buffer, const SAP_UC* chars, unsigned length, RFC_ERROR_INFO* errorInfo);
+    void dropDictionary(ColumnBuffer& buffer);
+    size_t bufferedBytes() const;
+    RFC_RC writeRowGroup(RFC_ERROR_INFO* errorInfo);
+    RFC_RC writeChunk(ColumnBuffer& buffer, ChunkInfo& chunk, RFC_ERROR_INFO* errorInfo);
+    RFC_RC emit(const std::string& bytes, RFC_ERROR_INFO* errorInfo);
+
+    ByteSink& sink_;
+    ParquetWriterOptions options_;
+    std::vector<ColumnBuffer> columns_;
+    std::vector<RowGroupInfo> rowGroups_;
+    unsigned bufferedRows_;
+    int64_t position_;      // bytes written to the sink
+    std::string key_;       // dictionary lookup key
+    std::string page_;      // page under construction
+    std::string header_;    // page header under construction
+};
+
+} // namespace nwrfc
+
+#endif // NWRFC_UTILS_PARQUET_TABLE_WRITER_H
@@ -0,0 +1,105 @@
+#include "partitioned_table_reader.h"
+
+#include <limits.h>
+#include <algorithm>
+#include <atomic>
+#include <system_error>
+#include <thread>
+#include "rfc_error.h"
+
+namespace nwrfc {
+
+PartitionedTableReader::PartitionedTableReader(RFC_TABLE_HANDLE tableHandle, unsigned threadCount, unsigned partitionRows)
+    : tableHandle_(tableHandle),
+      threadCount_(threadCount > 0 ? threadCount : std::max(std::thread::hardware_concurrency(), 1u)),
+      partitionRows_(partitionRows > 0 ? partitionRows : 1)
+{
+}
+
+RFC_RC PartitionedTableReader::partitions(std::vector<RowRange>& ranges, RFC_ERROR_INFO* errorInfo) const
+{
+    unsigned rowCount = 0;
+    RFC_RC rc = RfcGetRowCount(tableHandle_, &rowCount, errorInfo);
+    if (rc != RFC_OK)
+        return rc;
+    ranges.clear();
+    for (unsigned fromRow = 0; fromRow < rowCount; fromRow += std::min(partitionRows_, rowCount - fromRow))
+    {
+        RowRange range;
+        range.partition = static_cast<unsigned>(ranges.size());
+        range.fromRow = fromRow;
+        range.rowCount = std::min(partitionRows_, rowCount - fromRow);
+        ranges.push_back(range);
+    }
+    return RFC_OK;
+}
+
+RFC_RC PartitionedTableReader::run(const PartitionFunction& decodePartition, RFC_ERROR_INFO* errorInfo) const
+{
+    std::vector<RowRange> ranges;
+    RFC_RC rc = partitions(ranges, errorInfo);
+    if (rc != RFC_OK)
+        return rc;
+
+    const unsigned workerCount = std::min(threadCount_, static_cast<unsigned>(ranges.size()));
+    if (workerCount <= 1)
+    {
+        for (size_t p = 0; p < ranges.size(); ++p)
+        {
+            rc = decodePartition(ranges[p], errorInfo);
+            if (rc != RFC_OK)
+                return rc;
+        }
+        return clearError(errorInfo);
+    }
+
+    // Partitions are handed out in row order. Once one fails, the partitions after it are not
+    // started; all partitions before it have been handed out already, so the lowest failing
+    // partition is always known after the join.
+    std::atomic<unsigned> nextPartition(0);
+    std::atomic<unsigned> firstFailed(UINT_MAX);
+    std::vector<RFC_RC> results(ranges.size(), RFC_OK);
+    std::vector<RFC_ERROR_INFO> errors(ranges.size());
+    const std::function<void()> worker = [&]() {
+        for (;;)
+        {
+            const unsigned p = nextPartition.fetch_add(1);
+            if (p >= ranges.size() || p > firstFailed.load())
+                return;
+            results[p] = decodePartition(ranges[p], &errors[p]);
+            if (results[p] == RFC_OK)
+                continue;
+            unsigned failed = firstFailed.load();
+            while (p < failed && !firstFailed.compare_exchange_weak(failed, p))
+                ;
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(workerCount - 1);
+    try
+    {
+        for (unsigned t = 1; t < workerCount; ++t)
+            threads.push_back(std::thread(worker));
+    }
+    catch (const std::system_error&)
+    {
+        // The threads already started finish their current partition and find no more work.
+        nextPartition.store(static_cast<unsigned>(ranges.size()));
+        for (size_t t = 0; t < threads.size(); ++t)
+            threads[t].join();
+        return setError(errorInfo, RFC_MEMORY_INSUFFICIENT, cU("Cannot start a thread for decoding partitions"));
+    }
+    worker();
+    for (size_t t = 0; t < threads.size(); ++t)
+        threads[t].join();
+
+    const unsigned failed = firstFailed.load();
+    if (failed == UINT_MAX)
+        return clearError(errorInfo);
+    if (errorInfo != NULL)
+        *errorInfo = errors[failed];
+    return results[failed];
+}
+
+} // namespace nwrfc
@@ -0,0 +1,176 @@
+#ifndef NWRFC_UTILS_PARTITIONED_TABLE_READER_H
+#define NWRFC_UTILS_PARTITIONED_TABLE_READER_H
+
+#include <functional>
+#include <vector>
+#include "sapnwrfc.h"
+#include "sapnwrfccloud.h"
+
+namespace nwrfc {
+
+/** \struct RowRange
+ *
+ * A contiguous range of table rows decoded by one task.
+ */
+struct RowRange
+{
+    unsigned partition;     ///< Position of the range in row order, 0-based
+    unsigned fromRow;       ///< First row of the range
+    unsigned rowCount;      ///< Number of rows in the range
+};
+
+/**
+ * \brief  One row of a table, read with the cursor-free RfcGet*ByIndexAndRow() functions.
+ *
+ * Unlike a table handle used as a structure, a TableRow does not depend on the current row of the
+ * table, so any number of threads can read different rows of the same table at the same time.
+ */
+class TableRow
+{
+public:
+    TableRow(RFC_TABLE_HANDLE tableHandle, unsigned row) : tableHandle_(tableHandle), row_(row) {}
+
+    RFC_TABLE_HANDLE table() const { return tableHandle_; }
+    unsigned row() const { return row_; }
+
+    RFC_RC getChars(unsigned index, RFC_CHAR* charBuffer, unsigned bufferLength, RFC_ERROR_INFO* errorInfo) const
+    { return RfcGetCharsByIndexAndRow(tableHandle_, index, row_, charBuffer, bufferLength, errorInfo); }
+    RFC_RC getNum(unsigned index, RFC_NUM* charBuffer, unsigned bufferLength, RFC_ERROR_INFO* errorInfo) const
+    { return RfcGetNumByIndexAndRow(tableHandle_, index, row_, charBuffer, bufferLength, errorInfo); }
+    RFC_RC getDate(unsigned index, RFC_DATE emptyDate, RFC_ERROR_INFO* errorInfo) const
+    { return RfcGetDateByIndexAndRow(tableHandle_, index, row_, emptyDate, errorInfo); }
+    RFC_RC getTime(unsigned index, RFC_TIME emptyTime, RFC_ERROR_INFO* errorInfo) const
+    { return RfcGetTimeByIndexAndRow(tableHandle_, index, row_, emptyTime, errorInfo); }
+    RFC_RC getString(unsigned index, SAP_UC* stringBuffer, unsigned bufferLength, unsigned* stringLength, RFC_ERROR_INFO* errorInfo) const
+    { return RfcGetStringByIndexAndRow(tableHandle_, index, row_, stringBuffer, bufferLength, stringLength, errorInfo); }
+    RFC_RC getStringLength(unsigned index, unsigned* stringLength, RFC_ERROR_INFO* errorInfo) const
+    { return RfcGetStringLengthByIndexAndRow(tableHandle_, index, row_, stringLength, errorInfo); }
+    RFC_RC getBytes(unsigned index, SAP_RAW* byteBuffer, unsigned bufferLength, RFC_ERROR_INFO* errorInfo) const
+    { return RfcGetBytesByIndexAndRow(tableHandle_, index, row_, byteBuffer, bufferLength, errorInfo); }
+    RFC_RC getXString(unsigned index, SAP_RAW* byteBuffer, unsigned bufferLength, unsigned* xstringLength, RFC_ERROR_INFO* errorInfo) const
+    { return RfcGetXStringByIndexAndRow(tableHandle_, index, row_, byteBuffer, bufferLength, xstringLength, errorInfo); }
+    RFC_RC getInt1(unsigned index, RFC_INT1* value, RFC_ERROR_INFO* errorInfo) const
+    { return RfcGetInt1ByIndexAndRow(tableHandle_, index, row_, value, errorInfo); }
+    RFC_RC getInt2(unsigned index, RFC_INT2* value, RFC_ERROR_INFO* errorInfo) const
+    { return RfcGetInt2ByIndexAndRow(tableHandle_, index, row_, value, errorInfo); }
+    RFC_RC getInt(unsigned index, RFC_INT* value, RFC_ERROR_INFO* errorInfo) const
+    { return RfcGetIntByIndexAndRow(tableHandle_, index, row_, value, errorInfo); }
+    RFC_RC getInt8(unsigned index, RFC_INT8* value, RFC_ERROR_INFO* errorInfo) const
+    { return RfcGetInt8ByIndexAndRow(tableHandle_, index, row_, value, errorInfo); }
+    RFC_RC getFloat(unsigned index, RFC_FLOAT* value, RFC_ERROR_INFO* errorInfo) const
+    { return RfcGetFloatByIndexAndRow(tableHandle_, index, row_, value, errorInfo); }
+    RFC_RC getDecF16(unsigned index, RFC_DECF16* value, RFC_ERROR_INFO* errorInfo) const
+    { return RfcGetDecF16ByIndexAndRow(tableHandle_, index, row_, value, errorInfo); }
+    RFC_RC getDecF34(unsigned index, RFC_DECF34* value, RFC_ERROR_INFO* errorInfo) const
+    { return RfcGetDecF34ByIndexAndRow(tableHandle_, index, row_, value, errorInfo); }
+    RFC_RC getStructure(unsigned index, RFC_STRUCTURE_HANDLE* structHandle, RFC_ERROR_INFO* errorInfo) const
+    { return RfcGetStructureByIndexAndRow(tableHandle_, index, row_, structHandle, errorInfo); }
+    RFC_RC getTable(unsigned index, RFC_TABLE_HANDLE* subTableHandle, RFC_ERROR_INFO* errorInfo) const
+    { return RfcGetTableByIndexAndRow(tableHandle_, index, row_, subTableHandle, errorInfo); }
+
+private:
+    RFC_TABLE_HANDLE tableHandle_;
+    unsigned row_;
+};
+
+/**
+ * \brief  Decodes the rows of one large table on several threads.
+ *
+ * The row range is cut into partitions of partitionRows rows. Worker threads take the next
+ * partition from a shared counter until all are done, so fast and slow partitions even out.
+ * The rows are read with the RfcGet*ByIndexAndRow() functions (see TableRow), never through the
+ * current row of the table, which makes concurrent reads possible.
+ *
+ * \code
+ * nwrfc::PartitionedTableReader reader(table);
+ * std::vector<Item> items;
+ * rc = reader.decode(items, [](const nwrfc::TableRow& row, Item& item, RFC_ERROR_INFO* errorInfo) {
+ *     RFC_RC rc = row.getChars(0, item.matnr, 18, errorInfo);
+ *     return rc == RFC_OK ? row.getInt(1, &item.quantity, errorInfo) : rc;
+ * }, &errorInfo);
+ * \endcode
+ *
+ * decode() writes the result of table row r to rows[r], so the output order is the table order
+ * regardless of which thread decoded a row. If decoding fails, the remaining partitions are
+ * skipped and the error of the failing partition with the lowest rows is returned.
+ *
+ * The table must not be modified while a decode is running. The reader does not own the table.
+ */
+class PartitionedTableReader
+{
+public:
+    /** Decodes one row range. Called concurrently for different ranges. */
+    typedef std::function<RFC_RC(const RowRange& range, RFC_ERROR_INFO* errorInfo)> PartitionFunction;
+
+    /**
+     * \in tableHandle Table to decode.
+     * \in threadCount Number of worker threads, 0 for one per hardware thread.
+     * \in partitionRows Number of rows per partition.
+     */
+    explicit PartitionedTableReader(RFC_TABLE_HANDLE tableHandle, unsigned threadCount = 0,
+                                    unsigned partitionRows = 16384);
+
+    /**
+     * \brief  The partitions of the current table content, in row order.
+     *
+     * \out &ranges Receives the partitions.
+     * \out *errorInfo More information in case the row count cannot be read.
+     * \return RFC_RC
+     */
+    RFC_RC partitions(std::vector<RowRange>& ranges, RFC_ERROR_INFO* errorInfo) const;
+
+    /**
+     * \brief  Calls decodePartition for every partition, on up to threadCount threads.
+     *
+     * Tables with a single partition are decoded on the calling thread. If a thread cannot be
+     * started, no further partitions are handed out and RFC_MEMORY_INSUFFICIENT is returned once
+     * the threads already started have finished.
+     *
+     * \in &decodePartition Decodes one partition.
+     * \out *errorInfo Error of the failing partition with the lowest rows.
+     * \return RFC_RC
+     */
+    RFC_RC run(const PartitionFunction& decodePartition, RFC_ERROR_INFO* errorInfo) const;
+
+    /**
+     * \brief  Decodes every row into rows[row], in table order.
+     *
+     * \out &rows Resized to the row count of the table; T must be default constructible.
+     * \in decodeRow Callable RFC_RC(const TableRow&, T&, RFC_ERROR_INFO*), called concurrently.
+     * \out *errorInfo More information in case a row cannot be decoded.
+     * \return RFC_RC
+     */
+    template <class T, class DecodeRow>
+    RFC_RC decode(std::vector<T>& rows, DecodeRow decodeRow, RFC_ERROR_INFO* errorInfo) const
+    {
+        unsigned rowCount = 0;
+        RFC_RC rc = RfcGetRowCount(tableHandle_, &rowCount, errorInfo);
+        if (rc != RFC_OK)
+            return rc;
+        rows.clear();
+        rows.resize(rowCount);
+        T* target = rows.empty() ? NULL : &rows[0];
+        const RFC_TABLE_HANDLE tableHandle = tableHandle_;
+        return run([target, tableHandle, &decodeRow](const RowRange& range, RFC_ERROR_INFO* partitionError) {
+            for (unsigned row = range.fromRow; row < range.fromRow + range.rowCount; ++row)
+            {
+                RFC_RC partitionRc = decodeRow(TableRow(tableHandle, row), target[row], partitionError);
+                if (partitionRc != RFC_OK)
+                    return partitionRc;
+            }
+            return RFC_OK;
+        }, errorInfo);
+    }
+
+    unsigned threadCount() const { return threadCount_; }
+    unsigned partitionRows() const { return partitionRows_; }
+
+private:
+    RFC_TABLE_HANDLE tableHandle_;
+    unsigned threadCount_;
+    unsigned partitionRows_;
+};
+
+} // namespace nwrfc
+
+#endif // NWRFC_UTILS_PARTITIONED_TABLE_READER_H
@@ -0,0 +1,56 @@
+#ifndef NWRFC_UTILS_RFC_ERROR_H
+#define NWRFC_UTILS_RFC_ERROR_H
+
+#include <string.h>
+#include "sapnwrfc.h"
+
+namespace nwrfc {
+
+/**
+ * \brief  Resets an RFC_ERROR_INFO to RFC_OK, the way the NW RFC library does on success.
+ *
+ * \out *errorInfo Error structure to reset. May be NULL.
+ * \return RFC_OK
+ */
+inline RFC_RC clearError(RFC_ERROR_INFO* errorInfo)
+{
+    if (errorInfo != NULL)
+    {
+        memset(errorInfo, 0, sizeof(RFC_ERROR_INFO));
+        errorInfo->code = RFC_OK;
+        errorInfo->group = OK;
+    }
+    return RFC_OK;
+}
+
+/**
+ * \brief  Fills an RFC_ERROR_INFO for errors detected by the utilities themselves.
+ *
+ * The message is truncated to fit RFC_ERROR_INFO::message and is always null-terminated.
+ *
+ * \out *errorInfo Error structure to fill. May be NULL.
+ * \in code Return code to report.
+ * \in *message Human readable error text.
+ * \in group Error group, EXTERNAL_RUNTIME_FAILURE by default.
+ * \return code
+ */
+inline RFC_RC setError(RFC_ERROR_INFO* errorInfo, RFC_RC code, const SAP_UC* message,
+                       RFC_ERROR_GROUP group = EXTERNAL_RUNTIME_FAILURE)
+{
+    if (errorInfo != NULL)
+    {
+        clearError(errorInfo);
+        errorInfo->code = code;
+        errorInfo->group = group;
+        const size_t maxLength = sizeof(errorInfo->message) / sizeof(SAP_UC) - 1;
+        size_t i = 0;
+        for (; message != NULL && message[i] != 0 && i < maxLength; ++i)
+            errorInfo->message[i] = message[i];
+        errorInfo->message[i] = 0;
+    }
+    return code;
+}
+
+} // namespace nwrfc
+
+#endif // NWRFC_UTILS_RFC_ERROR_H
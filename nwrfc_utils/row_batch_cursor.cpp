@@ -0,0 +1,146 @@
+#include "row_batch_cursor.h"
+
+#include <system_error>
+#include <utility>
+#include "rfc_error.h"
+
+namespace nwrfc {
+
+RowBatchCursor::RowBatchCursor(RFC_TABLE_HANDLE tableHandle, RFC_TYPE_DESC_HANDLE typeDescHandle,
+                               unsigned batchSize, bool prefetch)
+    : readers_{ ColumnarTableReader(tableHandle, typeDescHandle), ColumnarTableReader(tableHandle, typeDescHandle) },
+      current_(&readers_[0]),
+      spare_(&readers_[1]),
+      batchSize_(batchSize > 0 ? batchSize : 1),
+      prefetch_(prefetch),
+      nextRow_(0),
+      pending_(false),
+      requested_(false),
+      ready_(false),
+      stopping_(false),
+      prefetchRow_(0),
+      prefetchRc_(RFC_OK)
+{
+}
+
+RowBatchCursor::~RowBatchCursor()
+{
+    waitForPrefetch(NULL);
+    if (thread_.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        prefetchRequested_.notify_one();
+        thread_.join();
+    }
+}
+
+RFC_RC RowBatchCursor::next(RFC_ERROR_INFO* errorInfo)
+{
+    RFC_RC rc;
+    if (prefetch_)
+    {
+        if (!pending_)
+            startPrefetch(nextRow_);
+        rc = waitForPrefetch(errorInfo);
+        std::swap(current_, spare_);
+    }
+    else
+    {
+        rc = current_->read(nextRow_, batchSize_, errorInfo);
+    }
+    if (rc != RFC_OK)
+        return rc;
+
+    if (current_->rowCount() == 0)
+        return setError(errorInfo, RFC_TABLE_MOVE_EOF, cU("No more rows in the table"));
+
+    nextRow_ = current_->firstRow() + current_->rowCount();
+    if (prefetch_ && nextRow_ < current_->tableRowCount())
+        startPrefetch(nextRow_);
+    return RFC_OK;
+}
+
+void RowBatchCursor::rewind()
+{
+    waitForPrefetch(NULL);
+    nextRow_ = 0;
+}
+
+RFC_RC RowBatchCursor::selectColumns(const std::vector<std::basic_string<SAP_UC> >& names, RFC_ERROR_INFO* errorInfo)
+{
+    // A batch prefetched with the old selection is dropped and extracted again by next().
+    waitForPrefetch(NULL);
+    const unsigned rowCount = current_->rowCount();
+    RFC_RC rc = current_->selectColumns(names, errorInfo);
+    if (rc != RFC_OK)
+        return rc;
+    // Added fields drop the current batch, next() extracts its rows again.
+    if (rowCount > 0 && current_->rowCount() == 0)
+        nextRow_ = current_->firstRow();
+    return spare_->selectColumns(names, errorInfo);
+}
+
+void RowBatchCursor::startPrefetch(unsigned fromRow)
+{
+    pending_ = true;
+    if (!thread_.joinable())
+    {
+        try
+        {
+            thread_ = std::thread(&RowBatchCursor::runPrefetch, this);
+        }
+        catch (const std::system_error&)
+        {
+            // Without a thread the batch is extracted right away, next() takes it as if prefetched.
+            prefetchRc_ = spare_->read(fromRow, batchSize_, &prefetchError_);
+            ready_ = true;
+            return;
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        prefetchRow_ = fromRow;
+        requested_ = true;
+        ready_ = false;
+    }
+    prefetchRequested_.notify_one();
+}
+
+RFC_RC RowBatchCursor::waitForPrefetch(RFC_ERROR_INFO* errorInfo)
+{
+    if (!pending_)
+        return RFC_OK;
+    pending_ = false;
+    std::unique_lock<std::mutex> lock(mutex_);
+    prefetchFinished_.wait(lock, [this]() { return ready_; });
+    if (errorInfo != NULL)
+        *errorInfo = prefetchError_;
+    return prefetchRc_;
+}
+
+void RowBatchCursor::runPrefetch()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;)
+    {
+        prefetchRequested_.wait(lock, [this]() { return stopping_ || requested_; });
+        if (stopping_)
+            break;
+        requested_ = false;
+        ColumnarTableReader* reader = spare_;
+        const unsigned fromRow = prefetchRow_;
+        lock.unlock();
+        RFC_ERROR_INFO errorInfo;
+        RFC_RC rc = reader->read(fromRow, batchSize_, &errorInfo);
+        lock.lock();
+        prefetchRc_ = rc;
+        prefetchError_ = errorInfo;
+        ready_ = true;
+        prefetchFinished_.notify_one();
+    }
+}
+
+} // namespace nwrfc
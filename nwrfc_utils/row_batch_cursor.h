@@ -0,0 +1,115 @@
+#ifndef NWRFC_UTILS_ROW_BATCH_CURSOR_H
+#define NWRFC_UTILS_ROW_BATCH_CURSOR_H
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "sapnwrfc.h"
+#include "columnar_table_reader.h"
+
+namespace nwrfc {
+
+/**
+ * \brief  Iterates a table in fixed-size batches instead of row by row.
+ *
+ * Replaces the RfcMoveToFirstRow()/RfcMoveToNextRow()/RfcGetCurrentRow() loop, which costs one
+ * library call per row and field. Every batch is a struct-of-arrays view: one Column per field,
+ * filled by the RfcGet*ColumnByIndex() family.
+ *
+ * \code
+ * nwrfc::RowBatchCursor cursor(table, rowType, 4096, true);
+ * while (cursor.next(&errorInfo) == RFC_OK)
+ * {
+ *     const RFC_INT* quantities = cursor.column(2).values<RFC_INT>();
+ *     for (unsigned row = 0; row < cursor.rowCount(); ++row)
+ *         ...
+ * }
+ * if (errorInfo.code != RFC_TABLE_MOVE_EOF)
+ *     ...
+ * \endcode
+ *
+ * With prefetch enabled the next batch is extracted on a worker thread while the caller works on
+ * the current one. The thread is started with the first prefetch and kept until the cursor is
+ * destroyed. The table must not be modified or accessed by other threads while the cursor
+ * is in use. The cursor does not own the table or type description handle.
+ */
+class RowBatchCursor
+{
+public:
+    /**
+     * \in tableHandle Table to iterate.
+     * \in typeDescHandle Row type of the table.
+     * \in batchSize Maximum number of rows per batch.
+     * \in prefetch Extract the next batch on a worker thread.
+     */
+    RowBatchCursor(RFC_TABLE_HANDLE tableHandle, RFC_TYPE_DESC_HANDLE typeDescHandle,
+                   unsigned batchSize = 4096, bool prefetch = false);
+    ~RowBatchCursor();
+
+    /**
+     * \brief  Moves to the next batch. The first call moves to the first batch.
+     *
+     * The column buffers of the previous batch are invalidated.
+     *
+     * \out *errorInfo More information in case the batch cannot be extracted.
+     * \return RFC_OK, RFC_TABLE_MOVE_EOF after the last batch, or the error of the extraction.
+     */
+    RFC_RC next(RFC_ERROR_INFO* errorInfo);
+
+    /** \brief  Starts over with the first batch on the next call of next(). */
+    void rewind();
+
+    /**
+     * \brief  Extracts only the given fields from the next batch on, see ColumnarTableReader::selectColumns().
+     *
+     * Columns of the current batch that are no longer selected are released immediately. If fields
+     * are added, the current batch is dropped (rowCount() becomes 0) and the next call of next()
+     * extracts its rows again with the new selection.
+     *
+     * \in &names Field names of the row type, empty for all fields.
+     * \out *errorInfo RFC_INVALID_PARAMETER if a field does not exist.
+     * \return RFC_RC
+     */
+    RFC_RC selectColumns(const std::vector<std::basic_string<SAP_UC> >& names, RFC_ERROR_INFO* errorInfo);
+
+    /** \brief  Number of rows in the current batch. */
+    unsigned rowCount() const { return current_->rowCount(); }
+
+    /** \brief  Table row of the first row in the current batch. */
+    unsigned firstRow() const { return current_->firstRow(); }
+
+    unsigned columnCount() const { return current_->columnCount(); }
+    const Column& column(unsigned index) const { return current_->column(index); }
+
+    /** \brief  The reader holding the current batch. */
+    const ColumnarTableReader& batch() const { return *current_; }
+
+private:
+    void startPrefetch(unsigned fromRow);
+    RFC_RC waitForPrefetch(RFC_ERROR_INFO* errorInfo);
+    void runPrefetch();
+
+    ColumnarTableReader readers_[2];
+    ColumnarTableReader* current_;
+    ColumnarTableReader* spare_;
+    unsigned batchSize_;
+    bool prefetch_;
+    unsigned nextRow_;
+
+    bool pending_;                      // a batch was requested and not yet taken by next()
+
+    std::mutex mutex_;                  // guards the members below
+    std::condition_variable prefetchRequested_;
+    std::condition_variable prefetchFinished_;
+    bool requested_;                    // prefetchRow_ is to be extracted into spare_
+    bool ready_;                        // the requested batch is extracted
+    bool stopping_;
+    unsigned prefetchRow_;
+    RFC_RC prefetchRc_;
+    RFC_ERROR_INFO prefetchError_;
+    std::thread thread_;
+};
+
+} // namespace nwrfc
+
+#endif // NWRFC_UTILS_ROW_BATCH_CURSOR_H
@@ -0,0 +1,180 @@
+#ifndef NWRFC_UTILS_SAPUC_LITERAL_H
+#define NWRFC_UTILS_SAPUC_LITERAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "sapnwrfc.h"
+
+namespace nwrfc {
+
+/**
+ * \brief  FNV-1a over the SAP_UC code units of a name, the hash FieldIndex looks names up with.
+ *
+ * \in *name Start of the name.
+ * \in length Length of the name in SAP_UC.
+ * \return The hash; evaluated at compile time for UcLiteral.
+ */
+constexpr uint64_t nameHash(SAP_UC const* name, size_t length)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < length; ++i)
+    {
+        hash ^= static_cast<uint64_t>(name[i]);
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+namespace detail {
+
+/*
+ * Deliberately not constexpr: converting a non-ASCII narrow character fails in a constant
+ * expression. At runtime, i.e. for a UcLiteral that is not initialized as constexpr before
+ * C++20, it yields U+FFFD.
+ */
+inline SAP_UC nonAsciiCharacter()
+{
+    return static_cast<SAP_UC>(0xFFFD);
+}
+
+constexpr SAP_UC toSapuc(char c)
+{
+    return static_cast<unsigned char>(c) < 0x80 ? static_cast<SAP_UC>(c) : nonAsciiCharacter();
+}
+
+constexpr SAP_UC toSapuc(SAP_UC c)
+{
+    return c;
+}
+
+constexpr bool isAscii(char c)
+{
+    return static_cast<unsigned char>(c) < 0x80;
+}
+
+constexpr bool isAscii(SAP_UC)
+{
+    return true;
+}
+
+} // namespace detail
+
+// The UcLiteral constructor is consteval where available, so every UcLiteral is checked at compile time.
+#if defined(__cpp_consteval) && __cpp_consteval >= 201811L
+#define NWRFC_UC_LITERAL_CONSTRUCTOR consteval
+#else
+#define NWRFC_UC_LITERAL_CONSTRUCTOR constexpr
+#endif
+
+/** \struct UcLiteral
+ *
+ * Null-terminated SAP_UC string of N characters whose length and nameHash() are compile-time
+ * constants, for field and parameter names that are known when the handler is written:
+ *
+ * \code
+ * using namespace nwrfc::literals;
+ *
+ * constexpr auto MATNR = "MATNR"_uc;                  // or nwrfc::UcLiteral MATNR("MATNR");
+ * static_assert(MATNR.size() == 5, "");
+ *
+ * row.getChars(MATNR, matnr, 18, &errorInfo);          // FieldAccessor: no strlen, no hashing
+ * if (fieldDesc.name == MATNR) ...                     // compares the characters
+ * RfcGetChars(structure, MATNR, matnr, 18, &errorInfo);
+ * \endcode
+ *
+ * Narrow literals must be ASCII, which DDIC names are; cU() literals are taken as they are.
+ * A non-ASCII narrow literal does not compile with _uc. With the constructor it does not compile
+ * in C++20, where the constructor is consteval, or if the UcLiteral is initialized as constexpr;
+ * a non-constexpr UcLiteral in C++17 gets U+FFFD for such characters instead.
+ * A UcLiteral converts to SAP_UC const*, so it can be passed to the SDK functions directly.
+ */
+template <size_t N>
+struct UcLiteral
+{
+    SAP_UC chars[N + 1];    ///< The characters, null-terminated
+    uint64_t hash;          ///< nameHash() of the characters
+
+    /** \in &text Narrow ASCII or SAP_UC string literal. */
+    template <class CharT>
+    NWRFC_UC_LITERAL_CONSTRUCTOR UcLiteral(const CharT (&text)[N + 1])
+        : chars(),
+          hash(0)
+    {
+        for (size_t i = 0; i < N; ++i)
+            chars[i] = detail::toSapuc(text[i]);
+        chars[N] = 0;
+        hash = nameHash(chars, N);
+    }
+
+    /** \brief  Length in SAP_UC, without the terminator. */
+    static constexpr size_t size() { return N; }
+
+    constexpr SAP_UC const* c_str() const { return chars; }
+
+    constexpr operator SAP_UC const*() const { return chars; }
+
+    /** \brief  True if a null-terminated string equals the literal; value is read up to the first difference only. */
+    constexpr bool matches(SAP_UC const* value) const
+    {
+        for (size_t i = 0; i < N; ++i)
+        {
+            if (value[i] != chars[i])
+                return false;
+        }
+        return value[N] == 0;
+    }
+};
+
+template <class CharT, size_t M>
+UcLiteral(const CharT (&)[M]) -> UcLiteral<M - 1>;
+
+// Without these, a comparison with a SAP_UC pointer would compare the addresses.
+template <size_t N>
+constexpr bool operator==(const UcLiteral<N>& literal, SAP_UC const* value) { return literal.matches(value); }
+template <size_t N>
+constexpr bool operator==(SAP_UC const* value, const UcLiteral<N>& literal) { return literal.matches(value); }
+template <size_t N>
+constexpr bool operator!=(const UcLiteral<N>& literal, SAP_UC const* value) { return !literal.matches(value); }
+template <size_t N>
+constexpr bool operator!=(SAP_UC const* value, const UcLiteral<N>& literal) { return !literal.matches(value); }
+
+namespace literals {
+
+/*
+ * "MATNR"_uc: a standard literal operator template in C++20, the string literal operator
+ * template extension of GCC and Clang in C++17. Both reject non-ASCII narrow literals at compile
+ * time. NWRFC_UC_LITERAL is defined if available; otherwise use the UcLiteral constructor.
+ */
+#if defined(__cpp_nontype_template_args) && __cpp_nontype_template_args >= 201911L
+#define NWRFC_UC_LITERAL 1
+
+template <UcLiteral Text>
+constexpr auto operator""_uc()
+{
+    return Text;
+}
+
+#elif defined(__GNUC__) || defined(__clang__)
+#define NWRFC_UC_LITERAL 1
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#ifdef __clang__
+#pragma GCC diagnostic ignored "-Wgnu-string-literal-operator-template"
+#endif
+
+template <class CharT, CharT... Chars>
+constexpr UcLiteral<sizeof...(Chars)> operator""_uc()
+{
+    static_assert((detail::isAscii(Chars) && ...), "narrow _uc literals must be ASCII");
+    const CharT text[] = { Chars..., 0 };
+    return UcLiteral<sizeof...(Chars)>(text);
+}
+
+#pragma GCC diagnostic pop
+#endif
+
+} // namespace literals
+
+} // namespace nwrfc
+
+#endif // NWRFC_UTILS_SAPUC_LITERAL_H
@@ -0,0 +1,341 @@
+#ifndef NWRFC_UTILS_SAPUC_STRING_SIMD_H
+#define NWRFC_UTILS_SAPUC_STRING_SIMD_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "sapnwrfc.h"
+
+/*
+ * Header-only replacements for the null-terminated SAP_UC string functions of sapucrfc.h
+ * (strlenU, strnlenU, strcmpU, strncmpU, strchrU, strrchrU, strcpyU, strncpyU, strcatU, strstrU).
+ * On x86-64 they compare 8 SAP_UC per SSE2 instruction, elsewhere they are plain loops.
+ *
+ * The functions are always available in namespace nwrfc::sapuc. Defining NWRFC_SIMD_SAPUC_STRINGS
+ * before including this header additionally redirects the sapucrfc.h macros to them, so that
+ * existing code picks them up without changes:
+ *
+ * \code
+ * #define NWRFC_SIMD_SAPUC_STRINGS
+ * #include "sapuc_string_simd.h"
+ *
+ * if (strcmpU(fieldName, cU("MATNR")) == 0) ...    // nwrfc::sapuc::compare()
+ * \endcode
+ *
+ * Loads never cross a 4 KiB page boundary, so reading up to 7 SAP_UC beyond the terminator cannot
+ * fault. AddressSanitizer would still report these reads, the functions are therefore excluded
+ * from instrumentation. Results match the library functions; for strcmpU and strncmpU only the
+ * sign of the result is defined.
+ */
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define NWRFC_SAPUC_STRING_SSE2 1
+#include <emmintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define NWRFC_SAPUC_STRING_NO_ASAN __attribute__((no_sanitize_address))
+#else
+#define NWRFC_SAPUC_STRING_NO_ASAN
+#endif
+
+namespace nwrfc {
+namespace sapuc {
+
+#ifdef NWRFC_SAPUC_STRING_SSE2
+namespace detail {
+
+/* True if 8 SAP_UC can be loaded from chars without touching the next page. */
+inline bool blockFits(const SAP_UC* chars)
+{
+    return (reinterpret_cast<uintptr_t>(chars) & 4095) <= 4096 - 16;
+}
+
+NWRFC_SAPUC_STRING_NO_ASAN inline __m128i loadBlock(const SAP_UC* chars)
+{
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(chars));
+}
+
+/* Index of the first SAP_UC flagged in a _mm_movemask_epi8() result that is not 0. */
+inline unsigned firstChar(int mask)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long bit;
+    _BitScanForward(&bit, static_cast<unsigned long>(mask));
+    return static_cast<unsigned>(bit) / 2;
+#else
+    return static_cast<unsigned>(__builtin_ctz(static_cast<unsigned>(mask))) / 2;
+#endif
+}
+
+/* Index of the last SAP_UC flagged in a _mm_movemask_epi8() result that is not 0. */
+inline unsigned lastChar(int mask)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long bit;
+    _BitScanReverse(&bit, static_cast<unsigned long>(mask));
+    return static_cast<unsigned>(bit) / 2;
+#else
+    return (31 - static_cast<unsigned>(__builtin_clz(static_cast<unsigned>(mask)))) / 2;
+#endif
+}
+
+/* Flags the positions where left and right differ or left ends. */
+NWRFC_SAPUC_STRING_NO_ASAN inline int mismatchMask(const SAP_UC* left, const SAP_UC* right)
+{
+    const __m128i l = loadBlock(left);
+    const __m128i equal = _mm_cmpeq_epi16(l, loadBlock(right));
+    const __m128i end = _mm_cmpeq_epi16(l, _mm_setzero_si128());
+    return _mm_movemask_epi8(_mm_or_si128(_mm_andnot_si128(equal, _mm_set1_epi8(-1)), end));
+}
+
+} // namespace detail
+#endif
+
+/** \brief  Replacement for strlenU(): number of SAP_UC before the terminator. */
+NWRFC_SAPUC_STRING_NO_ASAN inline size_t length(const SAP_UC* chars)
+{
+    const SAP_UC* position = chars;
+#ifdef NWRFC_SAPUC_STRING_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    for (;;)
+    {
+        if (detail::blockFits(position))
+        {
+            const int mask = _mm_movemask_epi8(_mm_cmpeq_epi16(detail::loadBlock(position), zero));
+            if (mask != 0)
+                return static_cast<size_t>(position - chars) + detail::firstChar(mask);
+            position += 8;
+        }
+        else if (*position == 0)
+            return static_cast<size_t>(position - chars);
+        else
+            ++position;
+    }
+#else
+    while (*position != 0)
+        ++position;
+    return static_cast<size_t>(position - chars);
+#endif
+}
+
+/** \brief  Replacement for strnlenU(): like length(), but looks at most at maxLength SAP_UC. */
+NWRFC_SAPUC_STRING_NO_ASAN inline size_t boundedLength(const SAP_UC* chars, size_t maxLength)
+{
+    size_t i = 0;
+#ifdef NWRFC_SAPUC_STRING_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    while (i < maxLength)
+    {
+        if (detail::blockFits(chars + i))
+        {
+            const int mask = _mm_movemask_epi8(_mm_cmpeq_epi16(detail::loadBlock(chars + i), zero));
+            if (mask != 0)
+            {
+                i += detail::firstChar(mask);
+                return i < maxLength ? i : maxLength;
+            }
+            i += 8;
+        }
+        else if (chars[i] == 0)
+            return i;
+        else
+            ++i;
+    }
+    return maxLength;
+#else
+    while (i < maxLength && chars[i] != 0)
+        ++i;
+    return i;
+#endif
+}
+
+/** \brief  Replacement for strcmpU(): compares the SAP_UC as unsigned values; only the sign is defined. */
+NWRFC_SAPUC_STRING_NO_ASAN inline int compare(const SAP_UC* left, const SAP_UC* right)
+{
+    size_t i = 0;
+#ifdef NWRFC_SAPUC_STRING_SSE2
+    for (;;)
+    {
+        if (detail::blockFits(left + i) && detail::blockFits(right + i))
+        {
+            const int mask = detail::mismatchMask(left + i, right + i);
+            if (mask != 0)
+            {
+                i += detail::firstChar(mask);
+                return static_cast<int>(left[i]) - static_cast<int>(right[i]);
+            }
+            i += 8;
+        }
+        else if (left[i] != right[i] || left[i] == 0)
+            return static_cast<int>(left[i]) - static_cast<int>(right[i]);
+        else
+            ++i;
+    }
+#else
+    while (left[i] == right[i] && left[i] != 0)
+        ++i;
+    return static_cast<int>(left[i]) - static_cast<int>(right[i]);
+#endif
+}
+
+/** \brief  Replacement for strncmpU(): like compare(), but compares at most count SAP_UC. */
+NWRFC_SAPUC_STRING_NO_ASAN inline int compare(const SAP_UC* left, const SAP_UC* right, size_t count)
+{
+    size_t i = 0;
+    while (i < count)
+    {
+#ifdef NWRFC_SAPUC_STRING_SSE2
+        if (detail::blockFits(left + i) && detail::blockFits(right + i))
+        {
+            const int mask = detail::mismatchMask(left + i, right + i);
+            if (mask != 0)
+            {
+                i += detail::firstChar(mask);
+                return i < count ? static_cast<int>(left[i]) - static_cast<int>(right[i]) : 0;
+            }
+            i += 8;
+            continue;
+        }
+#endif
+        if (left[i] != right[i])
+            return static_cast<int>(left[i]) - static_cast<int>(right[i]);
+        if (left[i] == 0)
+            return 0;
+        ++i;
+    }
+    return 0;
+}
+
+/** \brief  Replacement for strchrU(): first occurrence of c, the terminator included, or NULL. */
+NWRFC_SAPUC_STRING_NO_ASAN inline SAP_UC* find(const SAP_UC* chars, SAP_UC c)
+{
+#ifdef NWRFC_SAPUC_STRING_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i wanted = _mm_set1_epi16(static_cast<short>(c));
+#endif
+    for (;;)
+    {
+#ifdef NWRFC_SAPUC_STRING_SSE2
+        if (detail::blockFits(chars))
+        {
+            const __m128i block = detail::loadBlock(chars);
+            const int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi16(block, wanted), _mm_cmpeq_epi16(block, zero)));
+            if (mask != 0)
+            {
+                chars += detail::firstChar(mask);
+                return *chars == c ? const_cast<SAP_UC*>(chars) : NULL;
+            }
+            chars += 8;
+            continue;
+        }
+#endif
+        if (*chars == c)
+            return const_cast<SAP_UC*>(chars);
+        if (*chars == 0)
+            return NULL;
+        ++chars;
+    }
+}
+
+/** \brief  Replacement for strrchrU(): last occurrence of c, the terminator included, or NULL. */
+NWRFC_SAPUC_STRING_NO_ASAN inline SAP_UC* findLast(const SAP_UC* chars, SAP_UC c)
+{
+    const SAP_UC* last = NULL;
+#ifdef NWRFC_SAPUC_STRING_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i wanted = _mm_set1_epi16(static_cast<short>(c));
+#endif
+    for (;;)
+    {
+#ifdef NWRFC_SAPUC_STRING_SSE2
+        if (detail::blockFits(chars))
+        {
+            const __m128i block = detail::loadBlock(chars);
+            int matches = _mm_movemask_epi8(_mm_cmpeq_epi16(block, wanted));
+            const int end = _mm_movemask_epi8(_mm_cmpeq_epi16(block, zero));
+            if (end != 0)
+                matches &= (1 << (2 * detail::firstChar(end) + 2)) - 1;     // up to the terminator
+            if (matches != 0)
+                last = chars + detail::lastChar(matches);
+            if (end != 0)
+                return const_cast<SAP_UC*>(last);
+            chars += 8;
+            continue;
+        }
+#endif
+        if (*chars == c)
+            last = chars;
+        if (*chars == 0)
+            return const_cast<SAP_UC*>(last);
+        ++chars;
+    }
+}
+
+/** \brief  Replacement for strcpyU(). */
+inline SAP_UC* copy(SAP_UC* target, const SAP_UC* source)
+{
+    memcpy(target, source, (length(source) + 1) * sizeof(SAP_UC));
+    return target;
+}
+
+/** \brief  Replacement for strncpyU(): copies at most count SAP_UC and pads target with 0 up to count. */
+inline SAP_UC* copy(SAP_UC* target, const SAP_UC* source, size_t count)
+{
+    const size_t copied = boundedLength(source, count);
+    memcpy(target, source, copied * sizeof(SAP_UC));
+    memset(target + copied, 0, (count - copied) * sizeof(SAP_UC));
+    return target;
+}
+
+/** \brief  Replacement for strcatU(). */
+inline SAP_UC* append(SAP_UC* target, const SAP_UC* source)
+{
+    copy(target + length(target), source);
+    return target;
+}
+
+/** \brief  Replacement for strstrU(): first occurrence of needle in haystack, haystack for an empty needle, or NULL. */
+inline SAP_UC* search(const SAP_UC* haystack, const SAP_UC* needle)
+{
+    if (*needle == 0)
+        return const_cast<SAP_UC*>(haystack);
+    const size_t needleLength = length(needle);
+    for (SAP_UC* candidate = find(haystack, *needle); candidate != NULL; candidate = find(candidate + 1, *needle))
+    {
+        if (compare(candidate, needle, needleLength) == 0)
+            return candidate;
+    }
+    return NULL;
+}
+
+} // namespace sapuc
+} // namespace nwrfc
+
+#ifdef NWRFC_SIMD_SAPUC_STRINGS
+#undef strlenU
+#undef strnlenU
+#undef strcmpU
+#undef strncmpU
+#undef strchrU
+#undef strrchrU
+#undef strcpyU
+#undef strncpyU
+#undef strcatU
+#undef strstrU
+#define strlenU                 nwrfc::sapuc::length
+#define strnlenU(s, maxLength)  nwrfc::sapuc::boundedLength(s, maxLength)
+#define strcmpU(s1, s2)         nwrfc::sapuc::compare(s1, s2)
+#define strncmpU(s1, s2, n)     nwrfc::sapuc::compare(s1, s2, n)
+#define strchrU(s, c)           nwrfc::sapuc::find(s, U_CHAR(c))
+#define strrchrU(s, c)          nwrfc::sapuc::findLast(s, U_CHAR(c))
+#define strcpyU(dest, src)      nwrfc::sapuc::copy(dest, src)
+#define strncpyU(dest, src, n)  nwrfc::sapuc::copy(dest, src, n)
+#define strcatU                 nwrfc::sapuc::append
+#define strstrU                 nwrfc::sapuc::search
+#endif
+
+#endif // NWRFC_UTILS_SAPUC_STRING_SIMD_H
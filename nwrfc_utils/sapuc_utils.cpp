@@ -0,0 +1,282 @@
+#include "sapuc_utils.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include "sapdecf.h"
+#include "utf8_transcoder.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define NWRFC_SSE2_KERNELS 1
+#include <emmintrin.h>
+#endif
+
+namespace nwrfc {
+
+namespace {
+
+int digit(SAP_UC c)
+{
+    return c >= cU('0') && c <= cU('9') ? c - cU('0') : -1;
+}
+
+int parseNumber(const SAP_UC* chars, unsigned length)
+{
+    int value = 0;
+    for (unsigned i = 0; i < length; ++i)
+    {
+        int d = digit(chars[i]);
+        if (d < 0)
+            return -1;
+        value = value * 10 + d;
+    }
+    return value;
+}
+
+// Days since 1970-01-01 of a proleptic Gregorian date, see H. Hinnant, "chrono-Compatible Low-Level Date Algorithms".
+int32_t daysFromCivil(int year, int month, int day)
+{
+    year -= month <= 2;
+    const int era = (year >= 0 ? year : year - 399) / 400;
+    const int yearOfEra = year - era * 400;
+    const int dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    const int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+size_t asciiFromSAPUC(const SAP_UC* chars, char* target, size_t maxLength)
+{
+    size_t length = 0;
+    for (; chars[length] != 0 && length < maxLength; ++length)
+        target[length] = chars[length] < 0x80 ? static_cast<char>(chars[length]) : '?';
+    return length;
+}
+
+const uint64_t PRIME1 = 0x9E3779B185EBCA87ULL;
+const uint64_t PRIME2 = 0xC2B2AE3D27D4EB4FULL;
+const uint64_t PRIME3 = 0x165667B19E3779F9ULL;
+const uint64_t PRIME4 = 0x85EBCA77C2B2AE63ULL;
+const uint64_t PRIME5 = 0x27D4EB2F165667C5ULL;
+
+inline uint64_t rotate(uint64_t value, unsigned bits)
+{
+    return (value << bits) | (value >> (64 - bits));
+}
+
+inline uint64_t load64(const SAP_RAW* bytes)
+{
+    uint64_t value;
+    memcpy(&value, bytes, sizeof(value));
+    return value;
+}
+
+inline uint64_t hashRound(uint64_t accumulator, uint64_t input)
+{
+    return rotate(accumulator + input * PRIME2, 31) * PRIME1;
+}
+
+inline uint64_t mergeRound(uint64_t accumulator, uint64_t lane)
+{
+    return (accumulator ^ hashRound(0, lane)) * PRIME1 + PRIME4;
+}
+
+} // namespace
+
+bool isCharLikeType(RFCTYPE type)
+{
+    return type == RFCTYPE_CHAR || type == RFCTYPE_NUM || type == RFCTYPE_DATE || type == RFCTYPE_TIME;
+}
+
+unsigned trimmedLength(const SAP_UC* value, unsigned length)
+{
+#ifdef NWRFC_SSE2_KERNELS
+    // Whole blocks of 8 blanks are dropped at once, the scalar loop finishes the last block.
+    const __m128i blank = _mm_set1_epi16(' ');
+    for (; length >= 8; length -= 8)
+    {
+        const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(value + length - 8));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(chars, blank)) != 0xFFFF)
+            break;
+    }
+#endif
+    while (length > 0 && value[length - 1] == cU(' '))
+        --length;
+    return length;
+}
+
+RFC_RC appendUtf8(const SAP_UC* value, unsigned length, std::string& target, RFC_ERROR_INFO* errorInfo)
+{
+    return sapucToUtf8(value, length, target, errorInfo);
+}
+
+bool parseDate(const SAP_UC* chars, int32_t* days)
+{
+    static const int daysInMonth[] = { 31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    const int year = parseNumber(chars, 4);
+    const int month = parseNumber(chars + 4, 2);
+    const int day = parseNumber(chars + 6, 2);
+    if (year <= 0 || month < 1 || month > 12 || day < 1 || day > daysInMonth[month - 1])
+        return false;
+    if (month == 2 && day == 29 && !(year % 4 == 0 && (year % 100 != 0 || year % 400 == 0)))
+        return false;
+    *days = daysFromCivil(year, month, day);
+    return true;
+}
+
+bool parseTime(const SAP_UC* chars, int32_t* seconds)
+{
+    const int hours = parseNumber(chars, 2);
+    const int minutes = parseNumber(chars + 2, 2);
+    const int secs = parseNumber(chars + 4, 2);
+    if (hours < 0 || hours > 23 || minutes < 0 || minutes > 59 || secs < 0 || secs > 59)
+        return false;
+    *seconds = hours * 3600 + minutes * 60 + secs;
+    return true;
+}
+
+bool decimalToInt128(const SAP_UC* chars, unsigned scale, uint64_t* result)
+{
+    bool negative = false;
+    std::string digits;
+    int exponent = 0;
+    unsigned i = 0;
+    if (chars[i] == cU('-') || chars[i] == cU('+'))
+        negative = chars[i++] == cU('-');
+    bool fraction = false;
+    for (; chars[i] != 0; ++i)
+    {
+        if (chars[i] == cU('.'))
+            fraction = true;
+        else if (digit(chars[i]) >= 0)
+        {
+            digits += static_cast<char>('0' + digit(chars[i]));
+            if (fraction)
+                --exponent;
+        }
+        else
+            break;
+    }
+    if (chars[i] == cU('E') || chars[i] == cU('e'))
+    {
+        ++i;
+        bool negativeExponent = chars[i] == cU('-');
+        if (chars[i] == cU('-') || chars[i] == cU('+'))
+            ++i;
+        int value = 0;
+        for (; digit(chars[i]) >= 0; ++i)
+            value = value * 10 + digit(chars[i]);
+        exponent += negativeExponent ? -value : value;
+    }
+    if (chars[i] != 0 || digits.empty())
+        return false;
+
+    // Rescale to the requested number of decimals. BCD values never carry more decimals than the field.
+    const int shift = exponent + static_cast<int>(scale);
+    if (shift > 0)
+        digits.append(static_cast<size_t>(shift), '0');
+    else if (-shift >= static_cast<int>(digits.size()))
+        digits = "0";
+    else
+        digits.resize(digits.size() - static_cast<size_t>(-shift));
+    const size_t firstDigit = digits.find_first_not_of('0');
+    digits.erase(0, firstDigit == std::string::npos ? digits.size() - 1 : firstDigit);
+    if (digits.size() > 38)
+        return false;
+
+    uint64_t low = 0;
+    uint64_t high = 0;
+    for (size_t k = 0; k < digits.size(); ++k)
+    {
+        // (high:low) = (high:low) * 10 + digit, using 32 bit limbs for the carry.
+        uint64_t carry = static_cast<uint64_t>(digits[k] - '0');
+        uint64_t limbs[4] = { low & 0xFFFFFFFFu, low >> 32, high & 0xFFFFFFFFu, high >> 32 };
+        for (int l = 0; l < 4; ++l)
+        {
+            uint64_t value = limbs[l] * 10 + carry;
+            limbs[l] = value & 0xFFFFFFFFu;
+            carry = value >> 32;
+        }
+        low = limbs[0] | (limbs[1] << 32);
+        high = limbs[2] | (limbs[3] << 32);
+    }
+    if (negative)
+    {
+        low = ~low + 1;
+        high = ~high + (low == 0 ? 1 : 0);
+    }
+    result[0] = low;
+    result[1] = high;
+    return true;
+}
+
+size_t formatDouble(double value, char* target, size_t size)
+{
+    int length = snprintf(target, size, "%.15g", value);
+    if (strtod(target, NULL) != value)
+        length = snprintf(target, size, "%.17g", value);
+    return static_cast<size_t>(length);
+}
+
+size_t formatDecFloat16(RFC_DECF16 value, char* target, size_t size)
+{
+    DecFloat16Buff buffer;
+    DecFloat16ToString(value, &buffer);
+    return asciiFromSAPUC(buffer, target, size - 1);
+}
+
+size_t formatDecFloat34(RFC_DECF34 value, char* target, size_t size)
+{
+    DecFloat34Buff buffer;
+    DecFloat34ToString(value, &buffer);
+    return asciiFromSAPUC(buffer, target, size - 1);
+}
+
+uint64_t hashBytes(const SAP_RAW* bytes, size_t length, uint64_t seed)
+{
+    const SAP_RAW* const end = bytes + length;
+    uint64_t hash;
+    if (length >= 32)
+    {
+        uint64_t lane1 = seed + PRIME1 + PRIME2;
+        uint64_t lane2 = seed + PRIME2;
+        uint64_t lane3 = seed;
+        uint64_t lane4 = seed - PRIME1;
+        do
+        {
+            lane1 = hashRound(lane1, load64(bytes));
+            lane2 = hashRound(lane2, load64(bytes + 8));
+            lane3 = hashRound(lane3, load64(bytes + 16));
+            lane4 = hashRound(lane4, load64(bytes + 24));
+            bytes += 32;
+        } while (bytes + 32 <= end);
+        hash = rotate(lane1, 1) + rotate(lane2, 7) + rotate(lane3, 12) + rotate(lane4, 18);
+        hash = mergeRound(hash, lane1);
+        hash = mergeRound(hash, lane2);
+        hash = mergeRound(hash, lane3);
+        hash = mergeRound(hash, lane4);
+    }
+    else
+        hash = seed + PRIME5;
+    hash += length;
+
+    for (; bytes + 8 <= end; bytes += 8)
+        hash = rotate(hash ^ hashRound(0, load64(bytes)), 27) * PRIME1 + PRIME4;
+    if (bytes + 4 <= end)
+    {
+        uint32_t word;
+        memcpy(&word, bytes, sizeof(word));
+        hash = rotate(hash ^ (word * PRIME1), 23) * PRIME2 + PRIME3;
+        bytes += 4;
+    }
+    for (; bytes < end; ++bytes)
+        hash = rotate(hash ^ (*bytes * PRIME5), 11) * PRIME1;
+
+    hash ^= hash >> 33;
+    hash *= PRIME2;
+    hash ^= hash >> 29;
+    hash *= PRIME3;
+    return hash ^ (hash >> 32);
+}
+
+} // namespace nwrfc
@@ -0,0 +1,99 @@
+#ifndef NWRFC_UTILS_SAPUC_UTILS_H
+#define NWRFC_UTILS_SAPUC_UTILS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include "sapnwrfc.h"
+
+namespace nwrfc {
+
+/**
+ * \brief  True for the fixed-length char-like types CHAR, NUM, DATE and TIME, whose values are
+ *         ucLength SAP_UC without terminator.
+ */
+bool isCharLikeType(RFCTYPE type);
+
+/**
+ * \brief  Length of a blank padded RFC_CHAR value without its trailing blanks.
+ *
+ * \in *value Start of the value.
+ * \in length Length of the value in SAP_UC.
+ * \return Number of SAP_UC up to and including the last non-blank character.
+ */
+unsigned trimmedLength(const SAP_UC* value, unsigned length);
+
+/**
+ * \brief  Converts SAP_UC data to UTF-8 and appends it to target, see sapucToUtf8().
+ *
+ * The result is not null-terminated. On error target keeps its previous content.
+ *
+ * \in *value SAP_UC data to convert.
+ * \in length Number of SAP_UC to convert.
+ * \inout &target String the UTF-8 bytes are appended to.
+ * \out *errorInfo More information in case the data cannot be converted.
+ * \return RFC_RC
+ */
+RFC_RC appendUtf8(const SAP_UC* value, unsigned length, std::string& target, RFC_ERROR_INFO* errorInfo);
+
+/**
+ * \brief  Days since 1970-01-01 of an RFC_DATE (YYYYMMDD, proleptic Gregorian calendar).
+ *
+ * \in *chars The 8 characters of the date.
+ * \out *days Days since 1970-01-01.
+ * \return false for the initial date 00000000 and invalid dates.
+ */
+bool parseDate(const SAP_UC* chars, int32_t* days);
+
+/**
+ * \brief  Seconds since midnight of an RFC_TIME (HHMMSS).
+ *
+ * \in *chars The 6 characters of the time.
+ * \out *seconds Seconds since midnight.
+ * \return false for invalid times.
+ */
+bool parseTime(const SAP_UC* chars, int32_t* seconds);
+
+/**
+ * \brief  Converts the decimal string of DecFloat34ToString() ("-123.45", "1.5E+3", ...) into
+ *         value * 10^scale as a two's complement 128 bit integer.
+ *
+ * \in *chars Null-terminated decimal string.
+ * \in scale Number of decimals of the result.
+ * \out *result Two 64 bit words, least significant first.
+ * \return false if the string is not a number or the value needs more than 38 digits.
+ */
+bool decimalToInt128(const SAP_UC* chars, unsigned scale, uint64_t* result);
+
+/**
+ * \brief  Formats a double with the shorter of %.15g and %.17g that reads back as the same value.
+ *
+ * \return Length of the text written to target.
+ */
+size_t formatDouble(double value, char* target, size_t size);
+
+/**
+ * \brief  Formats a decimal float as ASCII text, see DecFloat16ToString()/DecFloat34ToString().
+ *
+ * \return Length of the text written to target, which is not null-terminated.
+ */
+size_t formatDecFloat16(RFC_DECF16 value, char* target, size_t size);
+size_t formatDecFloat34(RFC_DECF34 value, char* target, size_t size);
+
+/**
+ * \brief  64 bit hash of a byte range in the manner of XXH64.
+ *
+ * Values of 32 bytes and more are consumed by four independent lanes, which keeps the multipliers
+ * of the CPU busy in parallel; shorter values, i.e. most fields, take one multiply per 8 bytes.
+ * Chaining the hash of one field as seed of the next hashes a row column by column.
+ *
+ * \in *bytes Start of the value.
+ * \in length Length of the value in bytes.
+ * \in seed Initial value, e.g. the hash of the previous field.
+ * \return The hash.
+ */
+uint64_t hashBytes(const SAP_RAW* bytes, size_t length, uint64_t seed);
+
+} // namespace nwrfc
+
+#endif // NWRFC_UTILS_SAPUC_UTILS_H
@@ -0,0 +1,138 @@
+#include "serialization_policy.h"
+
+#include "sapnwrfccloud.h"
+#include "rfc_error.h"
+
+namespace nwrfc {
+
+namespace {
+
+RFC_RC functionName(RFC_FUNCTION_HANDLE function, std::basic_string<SAP_UC>& name, RFC_ERROR_INFO* errorInfo)
+{
+    RFC_ERROR_INFO localError;
+    RFC_ERROR_INFO* info = errorInfo != NULL ? errorInfo : &localError;
+    RFC_FUNCTION_DESC_HANDLE funcDescHandle = RfcDescribeFunction(function, info);
+    if (funcDescHandle == NULL)
+        return info->code;
+    RFC_ABAP_NAME buffer;
+    RFC_RC rc = RfcGetFunctionName(funcDescHandle, buffer, errorInfo);
+    if (rc == RFC_OK)
+        name = buffer;
+    return rc;
+}
+
+} // namespace
+
+SerializationPolicy::SerializationPolicy(RFC_CONNECTION_HANDLE connection, const SerializationPolicyOptions& options)
+    : connection_(connection),
+      options_(options),
+      columnBased_(false),
+      supported_(true)
+{
+}
+
+RFC_RC SerializationPolicy::largestTable(RFC_FUNCTION_HANDLE function, TableShape& shape, RFC_ERROR_INFO* errorInfo)
+{
+    shape = TableShape();
+    RFC_ERROR_INFO localError;
+    RFC_ERROR_INFO* info = errorInfo != NULL ? errorInfo : &localError;
+    RFC_FUNCTION_DESC_HANDLE funcDescHandle = RfcDescribeFunction(function, info);
+    if (funcDescHandle == NULL)
+        return info->code;
+
+    unsigned parameterCount = 0;
+    RFC_RC rc = RfcGetParameterCount(funcDescHandle, &parameterCount, errorInfo);
+    for (unsigned i = 0; i < parameterCount && rc == RFC_OK; ++i)
+    {
+        RFC_PARAMETER_DESC desc;
+        rc = RfcGetParameterDescByIndex(funcDescHandle, i, &desc, errorInfo);
+        if (rc != RFC_OK || desc.type != RFCTYPE_TABLE)
+            continue;
+        int active = 0;
+        rc = RfcIsParameterActive(function, desc.name, &active, errorInfo);
+        if (rc != RFC_OK || !active)
+            continue;
+
+        TableShape table;
+        RFC_TABLE_HANDLE tableHandle = NULL;
+        rc = RfcGetTable(function, desc.name, &tableHandle, errorInfo);
+        if (rc == RFC_OK)
+            rc = RfcGetRowCount(tableHandle, &table.rows, errorInfo);
+        if (rc == RFC_OK)
+            rc = RfcGetFieldCount(desc.typeDescHandle, &table.columns, errorInfo);
+        if (rc == RFC_OK && table.cells() > shape.cells())
+            shape = table;
+    }
+    return rc;
+}
+
+bool SerializationPolicy::pays(const TableShape& shape) const
+{
+    return shape.rows >= options_.minRows && shape.cells() >= options_.minCells;
+}
+
+RFC_RC SerializationPolicy::select(bool columnBased, RFC_ERROR_INFO* errorInfo)
+{
+    if (columnBased == columnBased_ || (columnBased && !supported_))
+        return RFC_OK;
+
+    RFC_ERROR_INFO enableError;
+    RFC_RC rc = RfcEnableColumnBasedSerialization(connection_, columnBased ? options_.format : cU("OFF"), &enableError);
+    if (rc == RFC_OK)
+    {
+        columnBased_ = columnBased;
+        return RFC_OK;
+    }
+    if (columnBased && rc == RFC_NOT_SUPPORTED)
+    {
+        // The backend does not support it: keep row-based serialization for good.
+        supported_ = false;
+        return RFC_OK;
+    }
+    if (errorInfo != NULL)
+        *errorInfo = enableError;
+    return rc;
+}
+
+RFC_RC SerializationPolicy::prepare(RFC_FUNCTION_HANDLE function, RFC_ERROR_INFO* errorInfo)
+{
+    TableShape sent;
+    RFC_RC rc = largestTable(function, sent, errorInfo);
+    if (rc != RFC_OK)
+        return rc;
+
+    bool columnBased = pays(sent);
+    if (!columnBased && !expected_.empty())
+    {
+        std::basic_string<SAP_UC> name;
+        rc = functionName(function, name, errorInfo);
+        if (rc != RFC_OK)
+            return rc;
+        std::map<std::basic_string<SAP_UC>, TableShape>::const_iterator it = expected_.find(name);
+        columnBased = it != expected_.end() && pays(it->second);
+    }
+    rc = select(columnBased, errorInfo);
+    return rc != RFC_OK ? rc : clearError(errorInfo);
+}
+
+RFC_RC SerializationPolicy::learn(RFC_FUNCTION_HANDLE function, RFC_ERROR_INFO* errorInfo)
+{
+    std::basic_string<SAP_UC> name;
+    RFC_RC rc = functionName(function, name, errorInfo);
+    TableShape received;
+    if (rc == RFC_OK)
+        rc = largestTable(function, received, errorInfo);
+    if (rc == RFC_OK)
+        expected_[name] = received;
+    return rc;
+}
+
+RFC_RC SerializationPolicy::invoke(RFC_FUNCTION_HANDLE function, RFC_ERROR_INFO* errorInfo)
+{
+    RFC_RC rc = prepare(function, errorInfo);
+    if (rc == RFC_OK)
+        rc = RfcInvoke(connection_, function, errorInfo);
+    return rc != RFC_OK ? rc : learn(function, errorInfo);
+}
+
+} // namespace nwrfc
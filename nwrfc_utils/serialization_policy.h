@@ -0,0 +1,123 @@
+#ifndef NWRFC_UTILS_SERIALIZATION_POLICY_H
+#define NWRFC_UTILS_SERIALIZATION_POLICY_H
+
+#include <map>
+#include <string>
+#include "sapnwrfc.h"
+
+namespace nwrfc {
+
+/** \struct SerializationPolicyOptions
+ *
+ * Thresholds of SerializationPolicy. tools/serialization_benchmark.cpp measures where column-based
+ * serialization starts to pay off for a given backend and network.
+ */
+struct SerializationPolicyOptions
+{
+    const SAP_UC* format;   ///< Format passed to RfcEnableColumnBasedSerialization() for large tables. Default: LAN
+    unsigned minRows;       ///< Rows the largest table of a call needs at least. Default: 1000
+    SAP_ULLONG minCells;    ///< Rows x columns the largest table of a call needs at least. Default: 100000
+
+    SerializationPolicyOptions() : format(cU("LAN")), minRows(1000), minCells(100000) {}
+};
+
+/** \struct TableShape
+ *
+ * Size of the largest table parameter of a call.
+ */
+struct TableShape
+{
+    unsigned rows;
+    unsigned columns;
+
+    TableShape() : rows(0), columns(0) {}
+    SAP_ULLONG cells() const { return static_cast<SAP_ULLONG>(rows) * columns; }
+};
+
+/**
+ * \brief  Switches a connection between row-based and column-based serialization per call.
+ *
+ * Column-based serialization only pays off for large tables; for small calls its setup costs more
+ * than it saves. The policy decides before every call from the shape of the largest table
+ * parameter: the rows already in the tables sent to the backend, and the shape of the tables the
+ * same function module returned last time. RfcEnableColumnBasedSerialization() is only called when
+ * the decision changes. If the backend does not support column-based serialization
+ * (RFC_NOT_SUPPORTED), the connection stays row-based without an error; other errors of the
+ * switch are returned.
+ *
+ * \code
+ * nwrfc::SerializationPolicy policy(connection);
+ * ...
+ * rc = policy.invoke(function, &errorInfo);   // instead of RfcInvoke(connection, function, &errorInfo)
+ * \endcode
+ *
+ * One policy per connection. Like the connection, a policy must not be used by several threads
+ * at the same time. The policy does not own the connection.
+ */
+class SerializationPolicy
+{
+public:
+    explicit SerializationPolicy(RFC_CONNECTION_HANDLE connection,
+                                 const SerializationPolicyOptions& options = SerializationPolicyOptions());
+
+    /**
+     * \brief  prepare(), RfcInvoke() and learn() in one call.
+     *
+     * \in function Function module to call.
+     * \out *errorInfo Error of the call.
+     * \return RFC_RC
+     */
+    RFC_RC invoke(RFC_FUNCTION_HANDLE function, RFC_ERROR_INFO* errorInfo);
+
+    /**
+     * \brief  Selects the serialization for the next call of function on the connection.
+     *
+     * \in function Function module with its importing tables filled.
+     * \out *errorInfo More information in case the metadata cannot be read or the serialization
+     *                  cannot be switched.
+     * \return RFC_RC
+     */
+    RFC_RC prepare(RFC_FUNCTION_HANDLE function, RFC_ERROR_INFO* errorInfo);
+
+    /**
+     * \brief  Records the shape of the tables returned by a call, for the next prepare().
+     *
+     * \in function Function module after RfcInvoke().
+     * \out *errorInfo More information in case the tables cannot be read.
+     * \return RFC_RC
+     */
+    RFC_RC learn(RFC_FUNCTION_HANDLE function, RFC_ERROR_INFO* errorInfo);
+
+    /** \brief  Sets the expected result shape of a function module, e.g. from earlier runs. */
+    void expect(const SAP_UC* functionName, const TableShape& shape) { expected_[functionName] = shape; }
+
+    /** \brief  Whether the connection currently uses column-based serialization. */
+    bool columnBased() const { return columnBased_; }
+
+    /** \brief  False once the backend has rejected column-based serialization. */
+    bool supported() const { return supported_; }
+
+    /**
+     * \brief  Finds the active table parameter with the most cells.
+     *
+     * \in function Function module.
+     * \out &shape Rows and columns of that table, 0 x 0 without tables.
+     * \out *errorInfo More information in case the metadata cannot be read.
+     * \return RFC_RC
+     */
+    static RFC_RC largestTable(RFC_FUNCTION_HANDLE function, TableShape& shape, RFC_ERROR_INFO* errorInfo);
+
+private:
+    bool pays(const TableShape& shape) const;
+    RFC_RC select(bool columnBased, RFC_ERROR_INFO* errorInfo);
+
+    RFC_CONNECTION_HANDLE connection_;
+    SerializationPolicyOptions options_;
+    std::map<std::basic_string<SAP_UC>, TableShape> expected_;
+    bool columnBased_;
+    bool supported_;
+};
+
+} // namespace nwrfc
+
+#endif // NWRFC_UTILS_SERIALIZATION_POLICY_H
@@ -0,0 +1,49 @@
+#include "shared_table.h"
+
+#include <atomic>
+#include "rfc_error.h"
+
+namespace nwrfc {
+
+SharedTable::Holder::~Holder()
+{
+    if (owned)
+        RfcDestroyTable(tableHandle, NULL);
+}
+
+SharedTable::SharedTable(RFC_TABLE_HANDLE tableHandle, bool owned)
+{
+    if (tableHandle != NULL)
+        holder_ = std::make_shared<Holder>(tableHandle, owned);
+}
+
+bool SharedTable::shared() const
+{
+    if (!holder_)
+        return false;
+    if (!holder_->owned || holder_.use_count() > 1)
+        return true;
+    // Last holder: the reads of holders released on other threads happen before our writes.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return false;
+}
+
+RFC_TABLE_HANDLE SharedTable::mutableHandle(RFC_ERROR_INFO* errorInfo)
+{
+    if (!holder_)
+    {
+        clearError(errorInfo);
+        return NULL;
+    }
+    if (shared())
+    {
+        RFC_TABLE_HANDLE copy = RfcCloneTable(holder_->tableHandle, errorInfo);
+        if (copy == NULL)
+            return NULL;
+        holder_ = std::make_shared<Holder>(copy, true);
+    }
+    clearError(errorInfo);
+    return holder_->tableHandle;
+}
+
+} // namespace nwrfc
@@ -0,0 +1,88 @@
+#ifndef NWRFC_UTILS_SHARED_TABLE_H
+#define NWRFC_UTILS_SHARED_TABLE_H
+
+#include <memory>
+#include "sapnwrfc.h"
+
+namespace nwrfc {
+
+/**
+ * \brief  Reference-counted table handle with copy-on-write semantics.
+ *
+ * Copying a SharedTable copies a pointer, not the table: any number of consumers can hold the same
+ * result table instead of one RfcCloneTable() each. A consumer that wants to change the table asks
+ * for mutableHandle(), which clones the table only if someone else still holds it.
+ *
+ * \code
+ * nwrfc::SharedTable items(RfcCloneTable(resultTable, &errorInfo));   // or a table from RfcCreateTable()
+ * std::thread writer([items]() { ... nwrfc::writeTable(items.handle(), rowType, sink, &e); });
+ * std::thread index([items]() { ... nwrfc::ColumnarTableReader reader(items.handle(), rowType); ... });
+ * nwrfc::SharedTable mine = items;
+ * RFC_TABLE_HANDLE rows = mine.mutableHandle(&errorInfo);              // private copy, the threads are not disturbed
+ * RfcDeleteCurrentRow(rows, &errorInfo);
+ * \endcode
+ *
+ * While a table is shared, handle() may only be used with the functions that do not depend on the
+ * current row: ColumnarTableReader, TableRow and the other RfcGet*ByIndexAndRow() based readers.
+ * Moving the cursor (RfcMoveTo(), RfcGetCurrentRow() & co) changes the table for every holder.
+ *
+ * Different SharedTable objects referring to the same table can be used and destroyed on different
+ * threads. A single SharedTable object is not thread-safe.
+ */
+class SharedTable
+{
+public:
+    SharedTable() {}
+
+    /**
+     * \brief  Starts sharing a table.
+     *
+     * \in tableHandle The table, NULL for an empty SharedTable.
+     * \in owned true if the table was created by RfcCreateTable() or RfcCloneTable(); it is destroyed
+     *     together with the last SharedTable. false for a table owned by a function, structure or
+     *     table, which must outlive all copies; mutableHandle() then always clones it first.
+     */
+    explicit SharedTable(RFC_TABLE_HANDLE tableHandle, bool owned = true);
+
+    /** \brief  The table for reading, NULL if empty. */
+    RFC_TABLE_HANDLE handle() const { return holder_ ? holder_->tableHandle : NULL; }
+
+    /**
+     * \brief  The table for modification, cloned first if other SharedTable objects or an owner hold it.
+     *
+     * Afterwards this SharedTable refers to its private copy until it is copied again.
+     *
+     * \out *errorInfo More information in case the table cannot be cloned.
+     * \return Table handle, NULL in case of error or if empty.
+     */
+    RFC_TABLE_HANDLE mutableHandle(RFC_ERROR_INFO* errorInfo);
+
+    /** \brief  true if the table is held elsewhere too, i.e. mutableHandle() would clone it. */
+    bool shared() const;
+
+    /** \brief  Number of SharedTable objects holding the table. */
+    long useCount() const { return holder_.use_count(); }
+
+    /** \brief  Releases the table, destroying it if this was the last owning reference. */
+    void reset() { holder_.reset(); }
+
+private:
+    struct Holder
+    {
+        RFC_TABLE_HANDLE tableHandle;
+        bool owned;
+
+        Holder(RFC_TABLE_HANDLE table, bool own) : tableHandle(table), owned(own) {}
+        ~Holder();
+
+    private:
+        Holder(const Holder&);
+        Holder& operator=(const Holder&);
+    };
+
+    std::shared_ptr<Holder> holder_;
+};
+
+} // namespace nwrfc
+
+#endif // NWRFC_UTILS_SHARED_TABLE_H
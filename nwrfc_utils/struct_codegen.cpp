@@ -0,0 +1,365 @@
+#include "struct_codegen.h"
+
+#include <stdio.h>
+#include <vector>
+#include "rfc_error.h"
+#include "sapuc_utils.h"
+
+namespace nwrfc {
+
+namespace {
+
+/* One generated member: a field of a structure or a parameter of a function module. */
+struct Member
+{
+    std::string abapName;
+    std::string ident;
+    RFCTYPE type;
+    unsigned nucLength;
+    unsigned ucLength;
+    unsigned decimals;
+    unsigned direction;         // RFC_DIRECTION for parameters, 0 for structure fields
+    std::string nestedType;     // C++ name of the row type of STRUCTURE/TABLE members
+};
+
+const char* typeConstant(RFCTYPE type)
+{
+    switch (type)
+    {
+    case RFCTYPE_CHAR:      return "RFCTYPE_CHAR";
+    case RFCTYPE_DATE:      return "RFCTYPE_DATE";
+    case RFCTYPE_BCD:       return "RFCTYPE_BCD";
+    case RFCTYPE_TIME:      return "RFCTYPE_TIME";
+    case RFCTYPE_BYTE:      return "RFCTYPE_BYTE";
+    case RFCTYPE_TABLE:     return "RFCTYPE_TABLE";
+    case RFCTYPE_NUM:       return "RFCTYPE_NUM";
+    case RFCTYPE_FLOAT:     return "RFCTYPE_FLOAT";
+    case RFCTYPE_INT:       return "RFCTYPE_INT";
+    case RFCTYPE_INT2:      return "RFCTYPE_INT2";
+    case RFCTYPE_INT1:      return "RFCTYPE_INT1";
+    case RFCTYPE_STRUCTURE: return "RFCTYPE_STRUCTURE";
+    case RFCTYPE_DECF16:    return "RFCTYPE_DECF16";
+    case RFCTYPE_DECF34:    return "RFCTYPE_DECF34";
+    case RFCTYPE_STRING:    return "RFCTYPE_STRING";
+    case RFCTYPE_XSTRING:   return "RFCTYPE_XSTRING";
+    case RFCTYPE_INT8:      return "RFCTYPE_INT8";
+    case RFCTYPE_UTCLONG:   return "RFCTYPE_UTCLONG";
+    case RFCTYPE_UTCSECOND: return "RFCTYPE_UTCSECOND";
+    case RFCTYPE_UTCMINUTE: return "RFCTYPE_UTCMINUTE";
+    default:                return NULL;
+    }
+}
+
+std::string toString(unsigned value)
+{
+    char buffer[16];
+    snprintf(buffer, sizeof(buffer), "%u", value);
+    return buffer;
+}
+
+/* ABAP names may contain namespace slashes and other characters that are not valid in C++. */
+std::string identifier(const std::string& abapName)
+{
+    std::string ident;
+    for (size_t i = 0; i < abapName.size(); ++i)
+    {
+        const char c = abapName[i];
+        const bool valid = (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '_';
+        ident += valid ? c : '_';
+    }
+    if (ident.empty() || (ident[0] >= '0' && ident[0] <= '9'))
+        ident.insert(0, "_");
+    return ident;
+}
+
+RFC_RC abapName(const SAP_UC* name, std::string& target, RFC_ERROR_INFO* errorInfo)
+{
+    target.clear();
+    return appendUtf8(name, static_cast<unsigned>(strlenU(name)), target, errorInfo);
+}
+
+/* Declaration of the member, or an empty string if the type is not supported. */
+std::string declaration(const Member& m)
+{
+    const std::string chars = toString(m.ucLength / sizeof(SAP_UC));
+    switch (m.type)
+    {
+    case RFCTYPE_CHAR:      return "SAP_UC " + m.ident + "[" + chars + "];";
+    case RFCTYPE_NUM:       return "RFC_NUM " + m.ident + "[" + chars + "];";
+    case RFCTYPE_DATE:      return "RFC_DATE " + m.ident + ";";
+    case RFCTYPE_TIME:      return "RFC_TIME " + m.ident + ";";
+    case RFCTYPE_BYTE:      return "SAP_RAW " + m.ident + "[" + toString(m.nucLength) + "];";
+    case RFCTYPE_INT1:      return "RFC_INT1 " + m.ident + ";";
+    case RFCTYPE_INT2:      return "RFC_INT2 " + m.ident + ";";
+    case RFCTYPE_INT:       return "RFC_INT " + m.ident + ";";
+    case RFCTYPE_INT8:
+    case RFCTYPE_UTCLONG:
+    case RFCTYPE_UTCSECOND:
+    case RFCTYPE_UTCMINUTE: return "RFC_INT8 " + m.ident + ";";
+    case RFCTYPE_FLOAT:     return "RFC_FLOAT " + m.ident + ";";
+    case RFCTYPE_DECF16:    return "RFC_DECF16 " + m.ident + ";";
+    case RFCTYPE_DECF34:
+    case RFCTYPE_BCD:       return "RFC_DECF34 " + m.ident + ";";
+    case RFCTYPE_STRING:    return "nwrfc::codegen::ucstring " + m.ident + ";";
+    case RFCTYPE_XSTRING:   return "std::vector<SAP_RAW> " + m.ident + ";";
+    case RFCTYPE_STRUCTURE: return m.nestedType + " " + m.ident + ";";
+    case RFCTYPE_TABLE:     return "std::vector<" + m.nestedType + "> " + m.ident + ";";
+    default:                return std::string();
+    }
+}
+
+/* Statement reading member m of v from handle h, in the form "rc = ...;". */
+std::string getter(const Member& m, const std::string& index)
+{
+    const std::string args = "h, " + index + ", ";
+    const std::string chars = toString(m.ucLength / sizeof(SAP_UC));
+    switch (m.type)
+    {
+    case RFCTYPE_CHAR:      return "rc = RfcGetCharsByIndex(" + args + "v." + m.ident + ", " + chars + ", e);";
+    case RFCTYPE_NUM:       return "rc = RfcGetNumByIndex(" + args + "v." + m.ident + ", " + chars + ", e);";
+    case RFCTYPE_DATE:      return "rc = RfcGetDateByIndex(" + args + "v." + m.ident + ", e);";
+    case RFCTYPE_TIME:      return "rc = RfcGetTimeByIndex(" + args + "v." + m.ident + ", e);";
+    case RFCTYPE_BYTE:      return "rc = RfcGetBytesByIndex(" + args + "v." + m.ident + ", " + toString(m.nucLength) + ", e);";
+    case RFCTYPE_INT1:      return "rc = RfcGetInt1ByIndex(" + args + "&v." + m.ident + ", e);";
+    case RFCTYPE_INT2:      return "rc = RfcGetInt2ByIndex(" + args + "&v." + m.ident + ", e);";
+    case RFCTYPE_INT:       return "rc = RfcGetIntByIndex(" + args + "&v." + m.ident + ", e);";
+    case RFCTYPE_INT8:
+    case RFCTYPE_UTCLONG:
+    case RFCTYPE_UTCSECOND:
+    case RFCTYPE_UTCMINUTE: return "rc = RfcGetInt8ByIndex(" + args + "&v." + m.ident + ", e);";
+    case RFCTYPE_FLOAT:     return "rc = RfcGetFloatByIndex(" + args + "&v." + m.ident + ", e);";
+    case RFCTYPE_DECF16:    return "rc = RfcGetDecF16ByIndex(" + args + "&v." + m.ident + ", e);";
+    case RFCTYPE_DECF34:
+    case RFCTYPE_BCD:       return "rc = RfcGetDecF34ByIndex(" + args + "&v." + m.ident + ", e);";
+    case RFCTYPE_STRING:    return "rc = nwrfc::codegen::getString(" + args + "v." + m.ident + ", e);";
+    case RFCTYPE_XSTRING:   return "rc = nwrfc::codegen::getXString(" + args + "v." + m.ident + ", e);";
+    case RFCTYPE_STRUCTURE:
+        return "{ RFC_STRUCTURE_HANDLE s = NULL; rc = RfcGetStructureByIndex(" + args + "&s, e);"
+               " if (rc == RFC_OK) rc = unmarshal(s, v." + m.ident + ", e); }";
+    case RFCTYPE_TABLE:
+        return "{ RFC_TABLE_HANDLE t = NULL; rc = RfcGetTableByIndex(" + args + "&t, e);"
+               " if (rc == RFC_OK) rc = nwrfc::codegen::getTable(t, v." + m.ident + ", e); }";
+    default:
+        return std::string();
+    }
+}
+
+/* Statement writing member m of v to handle h, in the form "rc = ...;". */
+std::string setter(const Member& m, const std::string& index)
+{
+    const std::string args = "h, " + index + ", ";
+    const std::string chars = toString(m.ucLength / sizeof(SAP_UC));
+    switch (m.type)
+    {
+    case RFCTYPE_CHAR:      return "rc = RfcSetCharsByIndex(" + args + "v." + m.ident + ", " + chars + ", e);";
+    case RFCTYPE_NUM:       return "rc = RfcSetNumByIndex(" + args + "v." + m.ident + ", " + chars + ", e);";
+    case RFCTYPE_DATE:      return "rc = RfcSetDateByIndex(" + args + "v." + m.ident + ", e);";
+    case RFCTYPE_TIME:      return "rc = RfcSetTimeByIndex(" + args + "v." + m.ident + ", e);";
+    case RFCTYPE_BYTE:      return "rc = RfcSetBytesByIndex(" + args + "v." + m.ident + ", " + toString(m.nucLength) + ", e);";
+    case RFCTYPE_INT1:      return "rc = RfcSetInt1ByIndex(" + args + "v." + m.ident + ", e);";
+    case RFCTYPE_INT2:      return "rc = RfcSetInt2ByIndex(" + args + "v." + m.ident + ", e);";
+    case RFCTYPE_INT:       return "rc = RfcSetIntByIndex(" + args + "v." + m.ident + ", e);";
+    case RFCTYPE_INT8:
+    case RFCTYPE_UTCLONG:
+    case RFCTYPE_UTCSECOND:
+    case RFCTYPE_UTCMINUTE: return "rc = RfcSetInt8ByIndex(" + args + "v." + m.ident + ", e);";
+    case RFCTYPE_FLOAT:     return "rc = RfcSetFloatByIndex(" + args + "v." + m.ident + ", e);";
+    case RFCTYPE_DECF16:    return "rc = RfcSetDecF16ByIndex(" + args + "v." + m.ident + ", e);";
+    case RFCTYPE_DECF34:
+    case RFCTYPE_BCD:       return "rc = RfcSetDecF34ByIndex(" + args + "v." + m.ident + ", e);";
+    case RFCTYPE_STRING:    return "rc = nwrfc::codegen::setString(" + args + "v." + m.ident + ", e);";
+    case RFCTYPE_XSTRING:   return "rc = nwrfc::codegen::setXString(" + args + "v." + m.ident + ", e);";
+    case RFCTYPE_STRUCTURE:
+        return "{ RFC_STRUCTURE_HANDLE s = NULL; rc = RfcGetStructureByIndex(" + args + "&s, e);"
+               " if (rc == RFC_OK) rc = marshal(s, v." + m.ident + ", e); }";
+    case RFCTYPE_TABLE:
+        return "{ RFC_TABLE_HANDLE t = NULL; rc = RfcGetTableByIndex(" + args + "&t, e);"
+               " if (rc == RFC_OK) rc = nwrfc::codegen::setTable(t, v." + m.ident + ", e); }";
+    default:
+        return std::string();
+    }
+}
+
+/*
+ * Emits struct, Idx constants, FieldInfo array and marshal/unmarshal functions. For function
+ * modules (isFunction) marshal() only covers importing and unmarshal() only exporting parameters.
+ */
+std::string emitStruct(const std::string& cppName, const std::string& abapName,
+                       const std::vector<Member>& members, bool isFunction)
+{
+    std::string out;
+    out += "/* " + std::string(isFunction ? "Function module " : "") + abapName + " */\n";
+    out += "struct " + cppName + "\n{\n";
+    out += "    static constexpr const char* abapName = \"" + abapName + "\";\n";
+    out += "    static constexpr unsigned fieldCount = " + toString(static_cast<unsigned>(members.size())) + ";\n\n";
+
+    out += "    struct Idx\n    {\n";
+    for (size_t i = 0; i < members.size(); ++i)
+        out += "        static constexpr unsigned " + members[i].ident + " = " + toString(static_cast<unsigned>(i)) + ";\n";
+    out += "    };\n\n";
+
+    if (!members.empty())
+    {
+        out += "    static constexpr nwrfc::codegen::FieldInfo fields[fieldCount] = {\n";
+        for (size_t i = 0; i < members.size(); ++i)
+        {
+            const char* type = typeConstant(members[i].type);
+            const std::string typeExpr = type != NULL ? type : "static_cast<RFCTYPE>(" + toString(members[i].type) + ")";
+            out += "        { \"" + members[i].abapName + "\", " + typeExpr + ", "
+                   + toString(members[i].nucLength) + ", " + toString(members[i].ucLength) + ", "
+                   + toString(members[i].decimals) + " },\n";
+        }
+        out += "    };\n\n";
+    }
+
+    for (size_t i = 0; i < members.size(); ++i)
+    {
+        const std::string decl = declaration(members[i]);
+        if (decl.empty())
+            out += "    // " + members[i].abapName + ": type not supported\n";
+        else
+            out += "    " + decl + "\n";
+    }
+    out += "};\n\n";
+
+    for (int write = 0; write < 2; ++write)
+    {
+        if (write)
+            out += "inline RFC_RC marshal(DATA_CONTAINER_HANDLE h, const " + cppName + "& v, RFC_ERROR_INFO* e)\n{\n";
+        else
+            out += "inline RFC_RC unmarshal(DATA_CONTAINER_HANDLE h, " + cppName + "& v, RFC_ERROR_INFO* e)\n{\n";
+        out += "    RFC_RC rc = RFC_OK;\n";
+        for (size_t i = 0; i < members.size(); ++i)
+        {
+            const unsigned needed = write ? RFC_IMPORT : RFC_EXPORT;
+            if (isFunction && (members[i].direction & needed) == 0)
+                continue;
+            const std::string index = cppName + "::Idx::" + members[i].ident;
+            const std::string statement = write ? setter(members[i], index) : getter(members[i], index);
+            if (!statement.empty())
+                out += "    if (rc == RFC_OK) " + statement + "\n";
+        }
+        out += "    return rc;\n}\n\n";
+    }
+    return out;
+}
+
+} // namespace
+
+StructCodegen::StructCodegen(const std::string& namespaceName)
+    : namespaceName_(namespaceName)
+{
+}
+
+RFC_RC StructCodegen::addType(RFC_TYPE_DESC_HANDLE typeDescHandle, RFC_ERROR_INFO* errorInfo)
+{
+    RFC_ABAP_NAME name;
+    RFC_RC rc = RfcGetTypeName(typeDescHandle, name, errorInfo);
+    std::string typeName;
+    if (rc == RFC_OK)
+        rc = abapName(name, typeName, errorInfo);
+    if (rc != RFC_OK)
+        return rc;
+    if (!generated_.insert("T:" + typeName).second)
+        return RFC_OK;
+
+    unsigned fieldCount = 0;
+    rc = RfcGetFieldCount(typeDescHandle, &fieldCount, errorInfo);
+    if (rc != RFC_OK)
+        return rc;
+
+    std::vector<Member> members(fieldCount);
+    for (unsigned i = 0; i < fieldCount; ++i)
+    {
+        RFC_FIELD_DESC desc;
+        rc = RfcGetFieldDescByIndex(typeDescHandle, i, &desc, errorInfo);
+        if (rc == RFC_OK)
+            rc = abapName(desc.name, members[i].abapName, errorInfo);
+        if (rc != RFC_OK)
+            return rc;
+        members[i].ident = identifier(members[i].abapName);
+        members[i].type = desc.type;
+        members[i].nucLength = desc.nucLength;
+        members[i].ucLength = desc.ucLength;
+        members[i].decimals = desc.decimals;
+        members[i].direction = 0;
+        if (desc.type == RFCTYPE_STRUCTURE || desc.type == RFCTYPE_TABLE)
+        {
+            rc = addType(desc.typeDescHandle, errorInfo);
+            if (rc == RFC_OK)
+                rc = RfcGetTypeName(desc.typeDescHandle, name, errorInfo);
+            if (rc == RFC_OK)
+                rc = abapName(name, members[i].nestedType, errorInfo);
+            if (rc != RFC_OK)
+                return rc;
+            members[i].nestedType = identifier(members[i].nestedType);
+        }
+    }
+
+    body_ += emitStruct(identifier(typeName), typeName, members, false);
+    return clearError(errorInfo);
+}
+
+RFC_RC StructCodegen::addFunction(RFC_FUNCTION_DESC_HANDLE funcDescHandle, RFC_ERROR_INFO* errorInfo)
+{
+    RFC_ABAP_NAME name;
+    RFC_RC rc = RfcGetFunctionName(funcDescHandle, name, errorInfo);
+    std::string functionName;
+    if (rc == RFC_OK)
+        rc = abapName(name, functionName, errorInfo);
+    if (rc != RFC_OK)
+        return rc;
+    if (!generated_.insert("F:" + functionName).second)
+        return RFC_OK;
+
+    unsigned parameterCount = 0;
+    rc = RfcGetParameterCount(funcDescHandle, &parameterCount, errorInfo);
+    if (rc != RFC_OK)
+        return rc;
+
+    std::vector<Member> members(parameterCount);
+    for (unsigned i = 0; i < parameterCount; ++i)
+    {
+        RFC_PARAMETER_DESC desc;
+        rc = RfcGetParameterDescByIndex(funcDescHandle, i, &desc, errorInfo);
+        if (rc == RFC_OK)
+            rc = abapName(desc.name, members[i].abapName, errorInfo);
+        if (rc != RFC_OK)
+            return rc;
+        members[i].ident = identifier(members[i].abapName);
+        members[i].type = desc.type;
+        members[i].nucLength = desc.nucLength;
+        members[i].ucLength = desc.ucLength;
+        members[i].decimals = desc.decimals;
+        members[i].direction = desc.direction;
+        if (desc.type == RFCTYPE_STRUCTURE || desc.type == RFCTYPE_TABLE)
+        {
+            rc = addType(desc.typeDescHandle, errorInfo);
+            if (rc == RFC_OK)
+                rc = RfcGetTypeName(desc.typeDescHandle, name, errorInfo);
+            if (rc == RFC_OK)
+                rc = abapName(name, members[i].nestedType, errorInfo);
+            if (rc != RFC_OK)
+                return rc;
+            members[i].nestedType = identifier(members[i].nestedType);
+        }
+    }
+
+    body_ += emitStruct(identifier(functionName), functionName, members, true);
+    return clearError(errorInfo);
+}
+
+std::string StructCodegen::header(const std::string& guard) const
+{
+    std::string out;
+    out += "/* Generated by struct_codegen, do not edit. */\n";
+    out += "#ifndef " + guard + "\n#define " + guard + "\n\n";
+    out += "#include <string>\n#include <vector>\n#include \"sapnwrfc.h\"\n#include \"codegen_support.h\"\n\n";
+    out += "namespace " + namespaceName_ + " {\n\n";
+    out += body_;
+    out += "} // namespace " + namespaceName_ + "\n\n";
+    out += "#endif // " + guard + "\n";
+    return out;
+}
+
+} // namespace nwrfc
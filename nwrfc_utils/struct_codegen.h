@@ -0,0 +1,68 @@
+#ifndef NWRFC_UTILS_STRUCT_CODEGEN_H
+#define NWRFC_UTILS_STRUCT_CODEGEN_H
+
+#include <set>
+#include <string>
+#include "sapnwrfc.h"
+
+namespace nwrfc {
+
+/**
+ * \brief  Generates typed C++ structs with marshal/unmarshal functions from RFC metadata.
+ *
+ * For every structure or table row type a plain struct is generated with
+ * - one member per field (fixed arrays for CHAR/NUMC/DATS/TIMS/RAW, RFC_INT & co for numbers,
+ *   ucstring/std::vector for STRING/XSTRING, nested structs and std::vector for tables),
+ * - a nested struct Idx with the field indices as static constexpr unsigned constants,
+ * - a static constexpr nwrfc::codegen::FieldInfo array with name, type, lengths and decimals,
+ * - unmarshal()/marshal() free functions that call RfcGet*ByIndex()/RfcSet*ByIndex() with these
+ *   constant indices, so no field name is looked up at runtime.
+ *
+ * For a function module the struct holds all parameters, marshal() sets the importing, changing
+ * and tables parameters of an RFC_FUNCTION_HANDLE, unmarshal() reads the exporting, changing and
+ * tables parameters.
+ *
+ * Nested row types are generated once, before the types using them. The metadata can come from
+ * a live connection (RfcGetFunctionDesc()) or from a repository dump loaded with
+ * RfcLoadRepository(); tools/struct_codegen.cpp wraps both.
+ */
+class StructCodegen
+{
+public:
+    /** \in &namespaceName C++ namespace of the generated code. */
+    explicit StructCodegen(const std::string& namespaceName = "rfcgen");
+
+    /**
+     * \brief  Generates the struct for a structure or table row type and all types it uses.
+     *
+     * \in typeDescHandle Type to generate.
+     * \out *errorInfo More information in case the metadata cannot be read.
+     * \return RFC_RC
+     */
+    RFC_RC addType(RFC_TYPE_DESC_HANDLE typeDescHandle, RFC_ERROR_INFO* errorInfo);
+
+    /**
+     * \brief  Generates the parameter struct of a function module and all types it uses.
+     *
+     * \in funcDescHandle Function module to generate.
+     * \out *errorInfo More information in case the metadata cannot be read.
+     * \return RFC_RC
+     */
+    RFC_RC addFunction(RFC_FUNCTION_DESC_HANDLE funcDescHandle, RFC_ERROR_INFO* errorInfo);
+
+    /**
+     * \brief  The complete header with include guard, includes and all generated types.
+     *
+     * \in &guard Name of the include guard macro.
+     */
+    std::string header(const std::string& guard) const;
+
+private:
+    std::string namespaceName_;
+    std::string body_;
+    std::set<std::string> generated_;
+};
+
+} // namespace nwrfc
+
+#endif // NWRFC_UTILS_STRUCT_CODEGEN_H
@@ -0,0 +1,218 @@
+#include "table_delta.h"
+
+#include <string.h>
+#include <algorithm>
+#include "rfc_error.h"
+#include "sapuc_utils.h"
+
+namespace nwrfc {
+
+TableDelta::TableDelta(const std::vector<std::basic_string<SAP_UC> >& keyFields)
+    : keyFields_(keyFields),
+      keyLength_(0)
+{
+}
+
+void TableDelta::reset()
+{
+    std::vector<Entry>().swap(previous_);
+    std::vector<SAP_UC>().swap(previousKeys_);
+    std::vector<SAP_UC>().swap(deletedKeys_);
+}
+
+size_t TableDelta::memoryUsage() const
+{
+    return previous_.capacity() * sizeof(Entry) + previousKeys_.capacity() * sizeof(SAP_UC);
+}
+
+RFC_RC TableDelta::resolveKeys(const ColumnarTableReader& reader, RFC_ERROR_INFO* errorInfo)
+{
+    RFC_RC rc = findKeyColumns(reader, keyFields_, keyColumns_, errorInfo);
+    if (rc != RFC_OK)
+        return rc;
+    unsigned keyLength = 0;
+    for (size_t k = 0; k < keyColumns_.size(); ++k)
+        keyLength += reader.column(keyColumns_[k]).width / sizeof(SAP_UC);
+
+    // A snapshot taken with other keys cannot be compared.
+    if (keyLength != keyLength_)
+        reset();
+    keyLength_ = keyLength;
+    return RFC_OK;
+}
+
+void TableDelta::hashValues(const ColumnarTableReader& reader)
+{
+    // Column by column, so that every pass runs over one contiguous buffer.
+    const unsigned rows = reader.rowCount();
+    valueHashes_.assign(rows, 0);
+    for (unsigned i = 0; i < reader.columnCount(); ++i)
+    {
+        const Column& column = reader.column(i);
+        if (column.layout == COLUMN_SKIPPED || std::find(keyColumns_.begin(), keyColumns_.end(), i) != keyColumns_.end())
+            continue;
+        if (column.layout == COLUMN_FIXED)
+        {
+            const SAP_RAW* value = column.data.data();
+            for (unsigned row = 0; row < rows; ++row, value += column.width)
+                valueHashes_[row] = hashBytes(value, column.width, valueHashes_[row]);
+        }
+        else
+        {
+            for (unsigned row = 0; row < rows; ++row)
+                valueHashes_[row] = hashBytes(column.valueAt(row), column.byteLength(row), valueHashes_[row]);
+        }
+    }
+}
+
+bool TableDelta::sameKey(const std::vector<SAP_UC>& keys, unsigned index, const SAP_UC* key) const
+{
+    // Without key fields the value hash is the key.
+    return keyLength_ == 0 || memcmp(&keys[static_cast<size_t>(index) * keyLength_], key, keyLength_ * sizeof(SAP_UC)) == 0;
+}
+
+bool TableDelta::findCurrent(uint64_t keyHash, const SAP_UC* key) const
+{
+    typedef std::unordered_multimap<uint64_t, unsigned>::const_iterator Iterator;
+    std::pair<Iterator, Iterator> range = currentIndex_.equal_range(keyHash);
+    for (Iterator it = range.first; it != range.second; ++it)
+    {
+        if (sameKey(currentKeys_, current_[it->second].key, key))
+            return true;
+    }
+    return false;
+}
+
+size_t TableDelta::findPrevious(uint64_t keyHash, const SAP_UC* key) const
+{
+    size_t low = 0, high = previous_.size();
+    while (low < high)
+    {
+        const size_t middle = low + (high - low) / 2;
+        if (previous_[middle].keyHash < keyHash)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    for (; low < previous_.size() && previous_[low].keyHash == keyHash; ++low)
+    {
+        if (sameKey(previousKeys_, previous_[low].key, key))
+            return low;
+    }
+    return previous_.size();
+}
+
+RFC_RC TableDelta::extract(ColumnarTableReader& reader, TableSink* changes, unsigned chunkRows, RFC_ERROR_INFO* errorInfo)
+{
+    RFC_RC rc = reader.describe(errorInfo);
+    if (rc == RFC_OK)
+        rc = resolveKeys(reader, errorInfo);
+    if (rc == RFC_OK && changes != NULL)
+        rc = changes->begin(reader.columns(), errorInfo);
+    if (rc != RFC_OK)
+        return rc;
+
+    statistics_ = DeltaStatistics();
+    current_.clear();
+    currentKeys_.clear();
+    currentIndex_.clear();
+    seen_.assign(previous_.size(), false);
+    key_.resize(keyLength_);
+
+    const unsigned rows = reader.tableRowCount();
+    const unsigned windowRows = chunkRows > 0 ? chunkRows : 1;
+    std::vector<unsigned> changed;
+    for (unsigned done = 0; done < rows; )
+    {
+        rc = reader.read(done, std::min(windowRows, rows - done), errorInfo);
+        if (rc != RFC_OK)
+            return rc;
+        const unsigned windowCount = reader.rowCount();
+        if (windowCount == 0)
+            return setError(errorInfo, RFC_ILLEGAL_STATE, cU("Table changed while it was compared"));
+
+        hashValues(reader);
+        changed.clear();
+        for (unsigned row = 0; row < windowCount; ++row)
+        {
+            uint64_t keyHash = valueHashes_[row];
+            if (keyLength_ > 0)
+            {
+                SAP_UC* key = key_.data();
+                for (size_t k = 0; k < keyColumns_.size(); ++k)
+                {
+                    const Column& column = reader.column(keyColumns_[k]);
+                    memcpy(key, column.valueAt(row), column.width);
+                    key += column.width / sizeof(SAP_UC);
+                }
+                keyHash = hashBytes(reinterpret_cast<const SAP_RAW*>(key_.data()), keyLength_ * sizeof(SAP_UC), 0);
+            }
+
+            if (findCurrent(keyHash, key_.data()))
+            {
+                ++statistics_.duplicates;
+                continue;
+            }
+            Entry entry = { keyHash, valueHashes_[row], static_cast<unsigned>(current_.size()) };
+            currentIndex_.insert(std::make_pair(keyHash, static_cast<unsigned>(current_.size())));
+            current_.push_back(entry);
+            currentKeys_.insert(currentKeys_.end(), key_.begin(), key_.end());
+
+            const size_t previous = findPrevious(keyHash, key_.data());
+            if (previous == previous_.size())
+            {
+                ++statistics_.inserted;
+                changed.push_back(row);
+            }
+            else
+            {
+                seen_[previous] = true;
+                if (previous_[previous].valueHash != valueHashes_[row])
+                {
+                    ++statistics_.updated;
+                    changed.push_back(row);
+                }
+                else
+                    ++statistics_.unchanged;
+            }
+        }
+
+        if (changes != NULL && !changed.empty())
+        {
+            reader.retainRows(changed);
+            rc = changes->write(reader, errorInfo);
+            if (rc != RFC_OK)
+                return rc;
+        }
+        done += windowCount;
+        statistics_.rows += windowCount;
+    }
+
+    deletedKeys_.clear();
+    for (size_t i = 0; i < previous_.size(); ++i)
+    {
+        if (seen_[i])
+            continue;
+        ++statistics_.deleted;
+        const std::vector<SAP_UC>::const_iterator key = previousKeys_.begin() + static_cast<size_t>(previous_[i].key) * keyLength_;
+        deletedKeys_.insert(deletedKeys_.end(), key, key + keyLength_);
+    }
+
+    if (changes != NULL)
+    {
+        rc = changes->finish(errorInfo);
+        if (rc != RFC_OK)
+            return rc;
+    }
+
+    std::sort(current_.begin(), current_.end(),
+              [](const Entry& left, const Entry& right) { return left.keyHash < right.keyHash; });
+    previous_.swap(current_);
+    previousKeys_.swap(currentKeys_);
+    std::vector<Entry>().swap(current_);
+    std::vector<SAP_UC>().swap(currentKeys_);
+    currentIndex_.clear();
+    return clearError(errorInfo);
+}
+
+} // namespace nwrfc
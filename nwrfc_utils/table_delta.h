@@ -0,0 +1,122 @@
+#ifndef NWRFC_UTILS_TABLE_DELTA_H
+#define NWRFC_UTILS_TABLE_DELTA_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "sapnwrfc.h"
+#include "columnar_table_reader.h"
+#include "table_sink.h"
+
+namespace nwrfc {
+
+/** \struct DeltaStatistics
+ *
+ * Outcome of one TableDelta::extract().
+ */
+struct DeltaStatistics
+{
+    unsigned rows;          ///< Rows of the snapshot
+    unsigned inserted;      ///< Rows with a key that was not in the previous snapshot
+    unsigned updated;       ///< Rows whose key was there with different values
+    unsigned unchanged;     ///< Rows identical to the previous snapshot
+    unsigned deleted;       ///< Keys of the previous snapshot that are gone
+    unsigned duplicates;    ///< Further rows with a key already seen in this snapshot, not passed on
+
+    DeltaStatistics() : rows(0), inserted(0), updated(0), unchanged(0), deleted(0), duplicates(0) {}
+};
+
+/**
+ * \brief  Detects the rows that changed between repeated extracts of the same table.
+ *
+ * Every row is hashed from the column buffers of a ColumnarTableReader, column by column, with a
+ * 64 bit hash of four independent lanes. The previous snapshot is kept as a compact index of
+ * (key hash, value hash) pairs sorted by key, plus the key values themselves, so memory use is
+ * 24 bytes plus the key per row, independent of the row width.
+ *
+ * \code
+ * nwrfc::TableDelta delta(keyFields);       // e.g. MANDT, MATNR
+ * ...every few minutes:
+ * nwrfc::ColumnarTableReader reader(table, rowType);
+ * rc = delta.extract(reader, &upsertWriter, 4096, &errorInfo);
+ * for (unsigned i = 0; i < delta.statistics().deleted; ++i)
+ *     ... delete delta.deletedKey(i) downstream ...
+ * \endcode
+ *
+ * Keys are compared exactly; values are compared by their 64 bit hash. Without key fields the
+ * whole row is the key: the engine then deduplicates rows and reports rows that appeared or
+ * disappeared, deleted rows are counted but have no key.
+ */
+class TableDelta
+{
+public:
+    /**
+     * \in &keyFields Fields identifying a row, CHAR, NUM, DATE or TIME. Empty for whole-row identity.
+     */
+    explicit TableDelta(const std::vector<std::basic_string<SAP_UC> >& keyFields = std::vector<std::basic_string<SAP_UC> >());
+
+    /**
+     * \brief  Reads a complete snapshot and passes its inserted and updated rows to a sink.
+     *
+     * The sink receives begin() with all columns, write() with the changed rows of every window and
+     * finish(). Afterwards the snapshot becomes the previous one; if an error occurs, the previous
+     * snapshot is kept.
+     *
+     * \inout &reader Reader of the table, optionally restricted with selectColumns(); its buffers are compacted.
+     * \inout *changes Receives the inserted and updated rows, NULL to only collect statistics.
+     * \in chunkRows Rows extracted per window.
+     * \out *errorInfo RFC_INVALID_PARAMETER for an unknown or unsuitable key field, or the error of the reader or sink.
+     * \return RFC_RC
+     */
+    RFC_RC extract(ColumnarTableReader& reader, TableSink* changes, unsigned chunkRows, RFC_ERROR_INFO* errorInfo);
+
+    const DeltaStatistics& statistics() const { return statistics_; }
+
+    /** \brief  Key of the i-th row deleted by the last extract(): the key fields back to back, keyLength() SAP_UC. */
+    const SAP_UC* deletedKey(unsigned i) const { return &deletedKeys_[static_cast<size_t>(i) * keyLength_]; }
+
+    /** \brief  Length of a key in SAP_UC, 0 without key fields. */
+    unsigned keyLength() const { return keyLength_; }
+
+    /** \brief  Forgets the previous snapshot, the next extract() reports every row as inserted. */
+    void reset();
+
+    /** \brief  Bytes held for the previous snapshot. */
+    size_t memoryUsage() const;
+
+private:
+    struct Entry
+    {
+        uint64_t keyHash;
+        uint64_t valueHash;
+        unsigned key;       ///< Index of the key in the key arena
+    };
+
+    RFC_RC resolveKeys(const ColumnarTableReader& reader, RFC_ERROR_INFO* errorInfo);
+    void hashValues(const ColumnarTableReader& reader);
+    bool sameKey(const std::vector<SAP_UC>& keys, unsigned index, const SAP_UC* key) const;
+    bool findCurrent(uint64_t keyHash, const SAP_UC* key) const;
+    size_t findPrevious(uint64_t keyHash, const SAP_UC* key) const;
+
+    std::vector<std::basic_string<SAP_UC> > keyFields_;
+    std::vector<unsigned> keyColumns_;          // column indices of the key fields
+    unsigned keyLength_;
+
+    std::vector<Entry> previous_;               // sorted by keyHash
+    std::vector<SAP_UC> previousKeys_;
+    std::vector<Entry> current_;
+    std::vector<SAP_UC> currentKeys_;
+    std::unordered_multimap<uint64_t, unsigned> currentIndex_;  // keyHash -> entry of current_
+    std::vector<bool> seen_;                    // per entry of previous_
+    std::vector<SAP_UC> deletedKeys_;
+
+    std::vector<uint64_t> valueHashes_;         // per row of the window
+    std::vector<SAP_UC> key_;                   // key of the row being classified
+    DeltaStatistics statistics_;
+};
+
+} // namespace nwrfc
+
+#endif // NWRFC_UTILS_TABLE_DELTA_H
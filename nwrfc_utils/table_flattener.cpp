@@ -0,0 +1,360 @@
+#include "table_flattener.h"
+
+#include <limits.h>
+#include <string.h>
+#include "rfc_error.h"
+#include "sapnwrfccloud.h"
+
+namespace nwrfc {
+
+namespace {
+
+typedef std::basic_string<SAP_UC> ucstring;
+
+ucstring componentName(const ucstring& prefix, const SAP_UC* name)
+{
+    if (prefix.empty())
+        return ucstring(name);
+    ucstring result(prefix);
+    result += cU('-');
+    result += name;
+    return result;
+}
+
+/* Appends the column buffers of a ColumnarTableReader column to a batch column of the same layout. */
+void appendColumn(Column& target, const Column& source)
+{
+    const size_t base = target.data.size();
+    target.data.insert(target.data.end(), source.data.begin(), source.data.end());
+    if (target.layout != COLUMN_VARIABLE)
+        return;
+    for (size_t i = 1; i < source.offsets.size(); ++i)
+        target.offsets.push_back(base + source.offsets[i]);
+}
+
+template <class T>
+void store(SAP_RAW* target, const T& value)
+{
+    memcpy(target, &value, sizeof(T));
+}
+
+/* Appends the value of field column.index of a structure, in the layout of ColumnarTableReader. */
+RFC_RC appendValue(Column& column, DATA_CONTAINER_HANDLE structHandle, RFC_ERROR_INFO* errorInfo)
+{
+    const size_t start = column.data.size();
+    RFC_RC rc = RFC_OK;
+    if (column.layout == COLUMN_VARIABLE)
+    {
+        unsigned length = 0;
+        unsigned written = 0;
+        rc = RfcGetStringLengthByIndex(structHandle, column.index, &length, errorInfo);
+        if (rc == RFC_OK && column.desc.type == RFCTYPE_STRING)
+        {
+            column.data.resize(start + (length + 1) * sizeof(SAP_UC));
+            rc = RfcGetStringByIndex(structHandle, column.index, reinterpret_cast<SAP_UC*>(&column.data[start]),
+                                     length + 1, &written, errorInfo);
+            column.data.resize(start + written * sizeof(SAP_UC));
+        }
+        else if (rc == RFC_OK && length > 0)
+        {
+            column.data.resize(start + length);
+            rc = RfcGetXStringByIndex(structHandle, column.index, &column.data[start], length, &written, errorInfo);
+            column.data.resize(start + written);
+        }
+        column.offsets.push_back(column.data.size());
+        return rc;
+    }
+
+    column.data.resize(start + column.width);
+    SAP_RAW* target = &column.data[start];
+    switch (column.desc.type)
+    {
+    case RFCTYPE_INT1:
+    {
+        RFC_INT1 value = 0;
+        rc = RfcGetInt1ByIndex(structHandle, column.index, &value, errorInfo);
+        store(target, value);
+        break;
+    }
+    case RFCTYPE_INT2:
+    {
+        RFC_INT2 value = 0;
+        rc = RfcGetInt2ByIndex(structHandle, column.index, &value, errorInfo);
+        store(target, value);
+        break;
+    }
+    case RFCTYPE_INT:
+    {
+        RFC_INT value = 0;
+        rc = RfcGetIntByIndex(structHandle, column.index, &value, errorInfo);
+        store(target, value);
+        break;
+    }
+    case RFCTYPE_INT8:
+    case RFCTYPE_UTCLONG:
+    case RFCTYPE_UTCSECOND:
+    case RFCTYPE_UTCMINUTE:
+    {
+        RFC_INT8 value = 0;
+        rc = RfcGetInt8ByIndex(structHandle, column.index, &value, errorInfo);
+        store(target, value);
+        break;
+    }
+    case RFCTYPE_FLOAT:
+    {
+        RFC_FLOAT value = 0;
+        rc = RfcGetFloatByIndex(structHandle, column.index, &value, errorInfo);
+        store(target, value);
+        break;
+    }
+    case RFCTYPE_DECF16:
+    {
+        RFC_DECF16 value;
+        memset(&value, 0, sizeof(value));
+        rc = RfcGetDecF16ByIndex(structHandle, column.index, &value, errorInfo);
+        store(target, value);
+        break;
+    }
+    case RFCTYPE_DECF34:
+    case RFCTYPE_BCD:
+    {
+        RFC_DECF34 value;
+        memset(&value, 0, sizeof(value));
+        rc = RfcGetDecF34ByIndex(structHandle, column.index, &value, errorInfo);
+        store(target, value);
+        break;
+    }
+    case RFCTYPE_DATE:
+        rc = RfcGetDateByIndex(structHandle, column.index, reinterpret_cast<SAP_UC*>(target), errorInfo);
+        break;
+    case RFCTYPE_TIME:
+        rc = RfcGetTimeByIndex(structHandle, column.index, reinterpret_cast<SAP_UC*>(target), errorInfo);
+        break;
+    case RFCTYPE_NUM:
+        rc = RfcGetNumByIndex(structHandle, column.index, reinterpret_cast<SAP_UC*>(target),
+                              column.width / sizeof(SAP_UC), errorInfo);
+        break;
+    case RFCTYPE_BYTE:
+        rc = RfcGetBytesByIndex(structHandle, column.index, target, column.width, errorInfo);
+        break;
+    default: // RFCTYPE_CHAR
+        rc = RfcGetCharsByIndex(structHandle, column.index, reinterpret_cast<SAP_UC*>(target),
+                                column.width / sizeof(SAP_UC), errorInfo);
+        break;
+    }
+    return rc;
+}
+
+} // namespace
+
+TableFlattener::TableFlattener(RFC_TYPE_DESC_HANDLE typeDescHandle, unsigned maxDepth)
+    : typeDescHandle_(typeDescHandle),
+      maxDepth_(maxDepth),
+      described_(false)
+{
+}
+
+RFC_RC TableFlattener::describe(RFC_ERROR_INFO* errorInfo)
+{
+    if (described_)
+        return RFC_OK;
+    plans_.clear();
+    batches_.clear();
+    RFC_RC rc = planTable(typeDescHandle_, ucstring(), -1, 0, errorInfo);
+    if (rc != RFC_OK)
+        return rc;
+    described_ = true;
+    return clearError(errorInfo);
+}
+
+RFC_RC TableFlattener::planTable(RFC_TYPE_DESC_HANDLE rowType, const ucstring& path, int parent, unsigned depth,
+                                 RFC_ERROR_INFO* errorInfo)
+{
+    if (depth > maxDepth_)
+        return setError(errorInfo, RFC_INVALID_PARAMETER, cU("Nested types exceed the maximum depth"));
+    unsigned fieldCount = 0;
+    RFC_RC rc = RfcGetFieldCount(rowType, &fieldCount, errorInfo);
+    if (rc != RFC_OK)
+        return rc;
+
+    // plans_ and batches_ grow while nested tables are planned, so they are only accessed by index.
+    const unsigned batch = static_cast<unsigned>(plans_.size());
+    plans_.push_back(TablePlan(rowType));
+    batches_.push_back(FlatBatch());
+    batches_[batch].path = path;
+    batches_[batch].parent = parent;
+    batches_[batch].rowCount = 0;
+    plans_[batch].readerColumns.assign(fieldCount, UINT_MAX);
+
+    for (unsigned i = 0; i < fieldCount && rc == RFC_OK; ++i)
+    {
+        Column column;
+        rc = RfcGetFieldDescByIndex(rowType, i, &column.desc, errorInfo);
+        if (rc != RFC_OK)
+            break;
+        if (column.desc.type == RFCTYPE_STRUCTURE)
+        {
+            StructurePlan structure;
+            structure.index = i;
+            rc = planStructure(column.desc.typeDescHandle, batch, column.desc.name, depth + 1, structure, errorInfo);
+            plans_[batch].row.structures.push_back(structure);
+        }
+        else if (column.desc.type == RFCTYPE_TABLE)
+        {
+            const unsigned child = static_cast<unsigned>(plans_.size());
+            rc = planTable(column.desc.typeDescHandle, componentName(path, column.desc.name), static_cast<int>(batch),
+                           depth + 1, errorInfo);
+            plans_[batch].row.tables.push_back(std::make_pair(i, child));
+        }
+        else
+        {
+            column.index = i;
+            classifyColumn(column);
+            if (column.layout == COLUMN_SKIPPED)
+                continue;
+            plans_[batch].readerColumns[i] = static_cast<unsigned>(batches_[batch].columns.size());
+            batches_[batch].columnNames.push_back(column.desc.name);
+            batches_[batch].columns.push_back(column);
+        }
+    }
+    return rc;
+}
+
+RFC_RC TableFlattener::planStructure(RFC_TYPE_DESC_HANDLE typeDescHandle, unsigned batch, const ucstring& prefix,
+                                     unsigned depth, StructurePlan& plan, RFC_ERROR_INFO* errorInfo)
+{
+    if (depth > maxDepth_)
+        return setError(errorInfo, RFC_INVALID_PARAMETER, cU("Nested types exceed the maximum depth"));
+    unsigned fieldCount = 0;
+    RFC_RC rc = RfcGetFieldCount(typeDescHandle, &fieldCount, errorInfo);
+    for (unsigned i = 0; i < fieldCount && rc == RFC_OK; ++i)
+    {
+        Column column;
+        rc = RfcGetFieldDescByIndex(typeDescHandle, i, &column.desc, errorInfo);
+        if (rc != RFC_OK)
+            break;
+        const ucstring name = componentName(prefix, column.desc.name);
+        if (column.desc.type == RFCTYPE_STRUCTURE)
+        {
+            StructurePlan structure;
+            structure.index = i;
+            rc = planStructure(column.desc.typeDescHandle, batch, name, depth + 1, structure, errorInfo);
+            plan.structures.push_back(structure);
+        }
+        else if (column.desc.type == RFCTYPE_TABLE)
+        {
+            const unsigned child = static_cast<unsigned>(plans_.size());
+            rc = planTable(column.desc.typeDescHandle, componentName(batches_[batch].path, name.c_str()),
+                           static_cast<int>(batch), depth + 1, errorInfo);
+            plan.tables.push_back(std::make_pair(i, child));
+        }
+        else
+        {
+            column.index = i;
+            classifyColumn(column);
+            if (column.layout == COLUMN_SKIPPED)
+                continue;
+            plan.leafColumns.push_back(static_cast<unsigned>(batches_[batch].columns.size()));
+            batches_[batch].columnNames.push_back(name);
+            batches_[batch].columns.push_back(column);
+        }
+    }
+    return rc;
+}
+
+RFC_RC TableFlattener::flatten(RFC_TABLE_HANDLE tableHandle, RFC_ERROR_INFO* errorInfo)
+{
+    RFC_RC rc = describe(errorInfo);
+    if (rc != RFC_OK)
+        return rc;
+    for (size_t b = 0; b < batches_.size(); ++b)
+    {
+        FlatBatch& batch = batches_[b];
+        batch.rowCount = 0;
+        batch.parentRows.clear();
+        for (size_t c = 0; c < batch.columns.size(); ++c)
+        {
+            batch.columns[c].data.clear();
+            batch.columns[c].offsets.clear();
+            if (batch.columns[c].layout == COLUMN_VARIABLE)
+                batch.columns[c].offsets.push_back(0);
+        }
+    }
+    rc = readTable(0, tableHandle, 0, errorInfo);
+    return rc == RFC_OK ? clearError(errorInfo) : rc;
+}
+
+RFC_RC TableFlattener::readTable(unsigned batchIndex, RFC_TABLE_HANDLE tableHandle, unsigned parentRow,
+                                 RFC_ERROR_INFO* errorInfo)
+{
+    TablePlan& plan = plans_[batchIndex];
+    FlatBatch& batch = batches_[batchIndex];
+    plan.reader.setTableHandle(tableHandle);
+    RFC_RC rc = plan.reader.read(errorInfo);
+    if (rc != RFC_OK)
+        return rc;
+
+    const unsigned firstRow = batch.rowCount;
+    const unsigned rowCount = plan.reader.rowCount();
+    for (unsigned c = 0; c < plan.reader.columnCount(); ++c)
+    {
+        if (plan.readerColumns[c] != UINT_MAX)
+            appendColumn(batch.columns[plan.readerColumns[c]], plan.reader.column(c));
+    }
+    if (batch.parent >= 0)
+        batch.parentRows.insert(batch.parentRows.end(), rowCount, parentRow);
+    batch.rowCount += rowCount;
+
+    // Deep structures and nested tables are visited row by row, nested tables append to their own batch.
+    const StructurePlan& row = plan.row;
+    if (row.structures.empty() && row.tables.empty())
+        return RFC_OK;
+    for (unsigned r = 0; r < rowCount; ++r)
+    {
+        for (size_t s = 0; s < row.structures.size(); ++s)
+        {
+            RFC_STRUCTURE_HANDLE structHandle = NULL;
+            rc = RfcGetStructureByIndexAndRow(tableHandle, row.structures[s].index, r, &structHandle, errorInfo);
+            if (rc == RFC_OK)
+                rc = readStructure(batchIndex, row.structures[s], structHandle, firstRow + r, errorInfo);
+            if (rc != RFC_OK)
+                return rc;
+        }
+        for (size_t t = 0; t < row.tables.size(); ++t)
+        {
+            RFC_TABLE_HANDLE subTable = NULL;
+            rc = RfcGetTableByIndexAndRow(tableHandle, row.tables[t].first, r, &subTable, errorInfo);
+            if (rc == RFC_OK)
+                rc = readTable(row.tables[t].second, subTable, firstRow + r, errorInfo);
+            if (rc != RFC_OK)
+                return rc;
+        }
+    }
+    return RFC_OK;
+}
+
+RFC_RC TableFlattener::readStructure(unsigned batchIndex, const StructurePlan& plan, DATA_CONTAINER_HANDLE structHandle,
+                                     unsigned row, RFC_ERROR_INFO* errorInfo)
+{
+    FlatBatch& batch = batches_[batchIndex];
+    RFC_RC rc = RFC_OK;
+    for (size_t l = 0; l < plan.leafColumns.size() && rc == RFC_OK; ++l)
+        rc = appendValue(batch.columns[plan.leafColumns[l]], structHandle, errorInfo);
+    for (size_t s = 0; s < plan.structures.size() && rc == RFC_OK; ++s)
+    {
+        RFC_STRUCTURE_HANDLE nested = NULL;
+        rc = RfcGetStructureByIndex(structHandle, plan.structures[s].index, &nested, errorInfo);
+        if (rc == RFC_OK)
+            rc = readStructure(batchIndex, plan.structures[s], nested, row, errorInfo);
+    }
+    for (size_t t = 0; t < plan.tables.size() && rc == RFC_OK; ++t)
+    {
+        RFC_TABLE_HANDLE subTable = NULL;
+        rc = RfcGetTableByIndex(structHandle, plan.tables[t].first, &subTable, errorInfo);
+        if (rc == RFC_OK)
+            rc = readTable(plan.tables[t].second, subTable, row, errorInfo);
+    }
+    return rc;
+}
+
+} // namespace nwrfc
@@ -0,0 +1,121 @@
+#ifndef NWRFC_UTILS_TABLE_FLATTENER_H
+#define NWRFC_UTILS_TABLE_FLATTENER_H
+
+#include <string>
+#include <vector>
+#include "sapnwrfc.h"
+#include "columnar_table_reader.h"
+
+namespace nwrfc {
+
+/** \struct FlatBatch
+ *
+ * The rows of one level of a nested table, normalized into columns.
+ *
+ * Fields of (nested) structures become columns named with the ABAP component selector, e.g.
+ * "ADDRESS-CITY". Every row of a child batch carries the row of its parent batch in parentRows,
+ * the rows of a child batch are grouped by parent row in parent order.
+ */
+struct FlatBatch
+{
+    std::basic_string<SAP_UC> path;                     ///< Empty for the root table, e.g. "ITEMS-SCHEDULES" for a child
+    int parent;                                         ///< Index of the parent batch, -1 for the root table
+    std::vector<std::basic_string<SAP_UC> > columnNames;
+    std::vector<Column> columns;                        ///< Same value layout as ColumnarTableReader
+    std::vector<unsigned> parentRows;                   ///< Parent batch row of every row, empty for the root table
+    unsigned rowCount;
+};
+
+/**
+ * \brief  Flattens a table with nested structures and tables into one FlatBatch per table level.
+ *
+ * The traversal plan is computed once from the row type: which fields are read as columns of the
+ * table itself (RfcGet*ColumnByIndex(), see ColumnarTableReader), which are components of deep
+ * structures (read through RfcGetStructureByIndexAndRow()) and which are nested tables
+ * (RfcGetTableByIndexAndRow()). The table handle is never moved, and the rows of a nested table
+ * are extracted column-wise as well, so no handle is needed per nested row.
+ *
+ * \code
+ * nwrfc::TableFlattener flattener(RfcGetRowType(orders, &errorInfo));
+ * if (flattener.flatten(orders, &errorInfo) == RFC_OK)
+ * {
+ *     const nwrfc::FlatBatch& items = flattener.batch(1);
+ *     for (unsigned row = 0; row < items.rowCount; ++row)
+ *         ... items.parentRows[row] is the row of the order in flattener.batch(0)
+ * }
+ * \endcode
+ *
+ * Batch 0 is the root table, children follow their parents in depth-first field order. Nested
+ * types deeper than maxDepth levels (e.g. recursive types) are rejected by describe(). The
+ * flattener does not own any handle and is not thread-safe.
+ */
+class TableFlattener
+{
+public:
+    /**
+     * \in typeDescHandle Row type of the tables to flatten.
+     * \in maxDepth Maximum nesting of structures and tables.
+     */
+    explicit TableFlattener(RFC_TYPE_DESC_HANDLE typeDescHandle, unsigned maxDepth = 16);
+
+    /**
+     * \brief  Computes the traversal plan and the batch layout. Called implicitly by flatten().
+     *
+     * \out *errorInfo More information in case the metadata cannot be read.
+     * \return RFC_RC
+     */
+    RFC_RC describe(RFC_ERROR_INFO* errorInfo);
+
+    /**
+     * \brief  Flattens all rows of a table, replacing the content of all batches.
+     *
+     * \in tableHandle Table with the row type given in the constructor.
+     * \out *errorInfo More information in case the data cannot be read.
+     * \return RFC_RC
+     */
+    RFC_RC flatten(RFC_TABLE_HANDLE tableHandle, RFC_ERROR_INFO* errorInfo);
+
+    unsigned batchCount() const { return static_cast<unsigned>(batches_.size()); }
+    const FlatBatch& batch(unsigned index) const { return batches_[index]; }
+
+    /** \brief  Mutable access, e.g. to move the column buffers out instead of copying them. */
+    FlatBatch& batch(unsigned index) { return batches_[index]; }
+
+private:
+    /* Components of a structure field, read through the structure handle of the row. */
+    struct StructurePlan
+    {
+        unsigned index;                                 ///< Field index in the containing type
+        std::vector<unsigned> leafColumns;              ///< Batch columns of the scalar fields, Column::index is the field index
+        std::vector<StructurePlan> structures;
+        std::vector<std::pair<unsigned, unsigned> > tables;     ///< Field index, child batch
+    };
+
+    /* One table level: direct columns via ColumnarTableReader, the rest via the plan. */
+    struct TablePlan
+    {
+        TablePlan(RFC_TYPE_DESC_HANDLE rowType) : reader(NULL, rowType) { row.index = 0; }
+
+        ColumnarTableReader reader;
+        std::vector<unsigned> readerColumns;            ///< Batch column of every reader column, UINT_MAX if skipped
+        StructurePlan row;                              ///< Deep structures and nested tables of the row
+    };
+
+    RFC_RC planTable(RFC_TYPE_DESC_HANDLE rowType, const std::basic_string<SAP_UC>& path, int parent, unsigned depth,
+                     RFC_ERROR_INFO* errorInfo);
+    RFC_RC planStructure(RFC_TYPE_DESC_HANDLE typeDescHandle, unsigned batch, const std::basic_string<SAP_UC>& prefix,
+                         unsigned depth, StructurePlan& plan, RFC_ERROR_INFO* errorInfo);
+    RFC_RC readTable(unsigned batch, RFC_TABLE_HANDLE tableHandle, unsigned parentRow, RFC_ERROR_INFO* errorInfo);
+    RFC_RC readStructure(unsigned batch, const StructurePlan& plan, DATA_CONTAINER_HANDLE structHandle, unsigned row,
+                         RFC_ERROR_INFO* errorInfo);
+
+    RFC_TYPE_DESC_HANDLE typeDescHandle_;
+    unsigned maxDepth_;
+    std::vector<TablePlan> plans_;
+    std::vector<FlatBatch> batches_;
+    bool described_;
+};
+
+} // namespace nwrfc
+
+#endif // NWRFC_UTILS_TABLE_FLATTENER_H
@@ -0,0 +1,245 @@
+#include "table_index.h"
+
+#include <string.h>
+#include <algorithm>
+#include "rfc_error.h"
+#include "sapuc_utils.h"
+
+namespace nwrfc {
+
+namespace {
+
+int compareKeys(const SAP_UC* left, const SAP_UC* right, size_t length)
+{
+    return std::char_traits<SAP_UC>::compare(left, right, length);
+}
+
+} // namespace
+
+RFC_RC TableIndex::extractKeys(const ColumnarTableReader& reader, const std::vector<std::basic_string<SAP_UC> >& keyFields,
+                               RFC_ERROR_INFO* errorInfo)
+{
+    fieldTypes_.clear();
+    fieldLengths_.clear();
+    keyLength_ = 0;
+    keys_.clear();
+    rows_.clear();
+    if (keyFields.empty())
+        return setError(errorInfo, RFC_INVALID_PARAMETER, cU("An index needs at least one key field"));
+
+    std::vector<unsigned> indices;
+    RFC_RC rc = findKeyColumns(reader, keyFields, indices, errorInfo);
+    if (rc != RFC_OK)
+        return rc;
+    std::vector<const Column*> columns;
+    for (size_t k = 0; k < indices.size(); ++k)
+    {
+        columns.push_back(&reader.column(indices[k]));
+        fieldTypes_.push_back(columns.back()->desc.type);
+        fieldLengths_.push_back(columns.back()->width / sizeof(SAP_UC));
+        keyLength_ += fieldLengths_.back();
+    }
+
+    const unsigned rows = reader.rowCount();
+    keys_.resize(static_cast<size_t>(rows) * keyLength_);
+    unsigned offset = 0;
+    for (size_t k = 0; k < columns.size(); ++k)
+    {
+        const SAP_RAW* value = columns[k]->data.data();
+        SAP_UC* key = keys_.data() + offset;
+        for (unsigned row = 0; row < rows; ++row, value += columns[k]->width, key += keyLength_)
+            memcpy(key, value, columns[k]->width);
+        offset += fieldLengths_[k];
+    }
+    rows_.resize(rows);
+    for (unsigned row = 0; row < rows; ++row)
+        rows_[row] = reader.firstRow() + row;
+    return clearError(errorInfo);
+}
+
+RFC_RC TableIndex::extractKeys(RFC_TABLE_HANDLE tableHandle, RFC_TYPE_DESC_HANDLE typeDescHandle,
+                               const std::vector<std::basic_string<SAP_UC> >& keyFields, RFC_ERROR_INFO* errorInfo)
+{
+    ColumnarTableReader reader(tableHandle, typeDescHandle);
+    RFC_RC rc = reader.selectColumns(keyFields, errorInfo);
+    if (rc == RFC_OK)
+        rc = reader.read(errorInfo);
+    if (rc != RFC_OK)
+        return rc;
+    return extractKeys(reader, keyFields, errorInfo);
+}
+
+void TableIndex::makeKey(const std::vector<std::basic_string<SAP_UC> >& values, std::basic_string<SAP_UC>& key) const
+{
+    key.clear();
+    for (size_t k = 0; k < values.size() && k < fieldLengths_.size(); ++k)
+    {
+        const size_t length = std::min(values[k].size(), static_cast<size_t>(fieldLengths_[k]));
+        const size_t padding = fieldLengths_[k] - length;
+        if (fieldTypes_[k] == RFCTYPE_NUM)
+            key.append(padding, cU('0')).append(values[k], 0, length);
+        else
+            key.append(values[k], 0, length).append(padding, cU(' '));
+    }
+}
+
+RFC_RC SortedTableIndex::build(const ColumnarTableReader& reader, const std::vector<std::basic_string<SAP_UC> >& keyFields,
+                               RFC_ERROR_INFO* errorInfo)
+{
+    RFC_RC rc = extractKeys(reader, keyFields, errorInfo);
+    if (rc == RFC_OK)
+        sortKeys();
+    return rc;
+}
+
+RFC_RC SortedTableIndex::build(RFC_TABLE_HANDLE tableHandle, RFC_TYPE_DESC_HANDLE typeDescHandle,
+                               const std::vector<std::basic_string<SAP_UC> >& keyFields, RFC_ERROR_INFO* errorInfo)
+{
+    RFC_RC rc = extractKeys(tableHandle, typeDescHandle, keyFields, errorInfo);
+    if (rc == RFC_OK)
+        sortKeys();
+    return rc;
+}
+
+void SortedTableIndex::sortKeys()
+{
+    std::vector<unsigned> order(rows_.size());
+    for (unsigned i = 0; i < order.size(); ++i)
+        order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [this](unsigned left, unsigned right) {
+        return compareKeys(keyAt(left), keyAt(right), keyLength_) < 0;
+    });
+
+    // Keys and rows in sorted order, so that a lookup only touches contiguous memory.
+    std::vector<SAP_UC> keys(keys_.size());
+    std::vector<unsigned> rows(rows_.size());
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        memcpy(&keys[i * keyLength_], keyAt(order[i]), keyLength_ * sizeof(SAP_UC));
+        rows[i] = rows_[order[i]];
+    }
+    keys_.swap(keys);
+    rows_.swap(rows);
+}
+
+IndexRange SortedTableIndex::find(const SAP_UC* key, size_t length) const
+{
+    length = std::min(length, static_cast<size_t>(keyLength_));
+    unsigned low = 0, high = rowCount();
+    while (low < high)
+    {
+        const unsigned middle = low + (high - low) / 2;
+        if (compareKeys(keyAt(middle), key, length) < 0)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    unsigned last = low;
+    high = rowCount();
+    while (last < high)
+    {
+        const unsigned middle = last + (high - last) / 2;
+        if (compareKeys(keyAt(middle), key, length) == 0)
+            last = middle + 1;
+        else
+            high = middle;
+    }
+    IndexRange range = { rows_.data() + low, rows_.data() + last };
+    return range;
+}
+
+IndexRange SortedTableIndex::all() const
+{
+    IndexRange range = { rows_.data(), rows_.data() + rows_.size() };
+    return range;
+}
+
+RFC_RC HashTableIndex::build(const ColumnarTableReader& reader, const std::vector<std::basic_string<SAP_UC> >& keyFields,
+                             RFC_ERROR_INFO* errorInfo)
+{
+    slots_.clear();
+    groupStarts_.clear();
+    RFC_RC rc = extractKeys(reader, keyFields, errorInfo);
+    if (rc == RFC_OK)
+        hashKeys();
+    return rc;
+}
+
+RFC_RC HashTableIndex::build(RFC_TABLE_HANDLE tableHandle, RFC_TYPE_DESC_HANDLE typeDescHandle,
+                             const std::vector<std::basic_string<SAP_UC> >& keyFields, RFC_ERROR_INFO* errorInfo)
+{
+    slots_.clear();
+    groupStarts_.clear();
+    RFC_RC rc = extractKeys(tableHandle, typeDescHandle, keyFields, errorInfo);
+    if (rc == RFC_OK)
+        hashKeys();
+    return rc;
+}
+
+size_t HashTableIndex::probe(const SAP_UC* key, uint64_t hash) const
+{
+    const uint32_t tag = static_cast<uint32_t>(hash >> 32);
+    size_t slot = static_cast<size_t>(hash) & mask_;
+    while (slots_[slot].group != 0)
+    {
+        if (slots_[slot].tag == tag
+            && memcmp(keyAt(groupKeys_[slots_[slot].group - 1]), key, keyLength_ * sizeof(SAP_UC)) == 0)
+            break;
+        slot = (slot + 1) & mask_;
+    }
+    return slot;
+}
+
+void HashTableIndex::hashKeys()
+{
+    const unsigned rows = rowCount();
+    size_t capacity = 16;
+    while (capacity < 2 * static_cast<size_t>(rows))
+        capacity *= 2;
+    Slot empty = { 0, 0 };
+    slots_.assign(capacity, empty);
+    mask_ = capacity - 1;
+    groupKeys_.clear();
+
+    // Assign every row to the group of its key, then lay out the rows group by group.
+    std::vector<unsigned> groups(rows);
+    for (unsigned position = 0; position < rows; ++position)
+    {
+        const uint64_t hash = hashBytes(reinterpret_cast<const SAP_RAW*>(keyAt(position)), keyLength_ * sizeof(SAP_UC), 0);
+        Slot& slot = slots_[probe(keyAt(position), hash)];
+        if (slot.group == 0)
+        {
+            groupKeys_.push_back(position);
+            slot.tag = static_cast<uint32_t>(hash >> 32);
+            slot.group = static_cast<uint32_t>(groupKeys_.size());
+        }
+        groups[position] = slot.group - 1;
+    }
+
+    groupStarts_.assign(groupKeys_.size() + 1, 0);
+    for (unsigned position = 0; position < rows; ++position)
+        ++groupStarts_[groups[position] + 1];
+    for (size_t group = 1; group < groupStarts_.size(); ++group)
+        groupStarts_[group] += groupStarts_[group - 1];
+    std::vector<unsigned> next(groupStarts_.begin(), groupStarts_.end() - 1);
+    std::vector<unsigned> grouped(rows);
+    for (unsigned position = 0; position < rows; ++position)
+        grouped[next[groups[position]]++] = rows_[position];
+    rows_.swap(grouped);
+}
+
+IndexRange HashTableIndex::find(const SAP_UC* key) const
+{
+    IndexRange range = { NULL, NULL };
+    if (slots_.empty())
+        return range;
+    const uint64_t hash = hashBytes(reinterpret_cast<const SAP_RAW*>(key), keyLength_ * sizeof(SAP_UC), 0);
+    const Slot& slot = slots_[probe(key, hash)];
+    if (slot.group == 0)
+        return range;
+    range.first = rows_.data() + groupStarts_[slot.group - 1];
+    range.last = rows_.data() + groupStarts_[slot.group];
+    return range;
+}
+
+} // namespace nwrfc
@@ -0,0 +1,167 @@
+#ifndef NWRFC_UTILS_TABLE_INDEX_H
+#define NWRFC_UTILS_TABLE_INDEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "sapnwrfc.h"
+#include "columnar_table_reader.h"
+
+namespace nwrfc {
+
+/** \struct IndexRange
+ *
+ * Table rows found by an index lookup, [first, last).
+ */
+struct IndexRange
+{
+    const unsigned* first;
+    const unsigned* last;
+
+    unsigned size() const { return static_cast<unsigned>(last - first); }
+    bool empty() const { return first == last; }
+};
+
+/**
+ * \brief  Key columns of a table, copied into one contiguous buffer for the indexes below.
+ *
+ * A key is the concatenation of its fields in their full, padded width, i.e. for the key fields
+ * WERKS (CHAR 4) and MATNR (CHAR 40) a key is 44 SAP_UC. Keys are compared as raw SAP_UC, which is
+ * the binary order ABAP uses for SORT on Unicode systems. Key fields must be CHAR, NUM, DATE or TIME.
+ */
+class TableIndex
+{
+public:
+    /** \brief  Length of a key in SAP_UC. */
+    unsigned keyLength() const { return keyLength_; }
+
+    /** \brief  Number of indexed rows. */
+    unsigned rowCount() const { return static_cast<unsigned>(rows_.size()); }
+
+    /**
+     * \brief  Builds a key from field values, padding CHAR values with trailing blanks and NUM
+     *         values with leading zeros to the field width.
+     *
+     * \in &values Values of the first values.size() key fields, not longer than the fields.
+     * \out &key The key, or a key prefix if fewer values than key fields are given.
+     */
+    void makeKey(const std::vector<std::basic_string<SAP_UC> >& values, std::basic_string<SAP_UC>& key) const;
+
+protected:
+    TableIndex() : keyLength_(0) {}
+
+    RFC_RC extractKeys(const ColumnarTableReader& reader, const std::vector<std::basic_string<SAP_UC> >& keyFields,
+                       RFC_ERROR_INFO* errorInfo);
+    RFC_RC extractKeys(RFC_TABLE_HANDLE tableHandle, RFC_TYPE_DESC_HANDLE typeDescHandle,
+                       const std::vector<std::basic_string<SAP_UC> >& keyFields, RFC_ERROR_INFO* errorInfo);
+
+    const SAP_UC* keyAt(unsigned position) const { return &keys_[static_cast<size_t>(position) * keyLength_]; }
+
+    std::vector<RFCTYPE> fieldTypes_;
+    std::vector<unsigned> fieldLengths_;    // in SAP_UC
+    unsigned keyLength_;
+    std::vector<SAP_UC> keys_;              // keyLength_ SAP_UC per row
+    std::vector<unsigned> rows_;            // table row of every key
+};
+
+/**
+ * \brief  Sorted index on key columns of a table, for exact and prefix lookups.
+ *
+ * The keys are stored sorted and back to back next to their row numbers, so a lookup is a binary
+ * search over one contiguous buffer. Rows with equal keys keep their table order.
+ *
+ * \code
+ * nwrfc::SortedTableIndex byPlant;
+ * rc = byPlant.build(marc, marcType, fields, &errorInfo);     // fields WERKS, MATNR
+ * std::basic_string<SAP_UC> key;
+ * byPlant.makeKey(values, key);                              // values "1000"
+ * nwrfc::IndexRange rows = byPlant.find(key.data(), key.size());
+ * for (const unsigned* row = rows.first; row != rows.last; ++row)
+ *     ... nwrfc::TableRow(marc, *row) ...
+ * \endcode
+ */
+class SortedTableIndex : public TableIndex
+{
+public:
+    /**
+     * \brief  Indexes the rows held by a reader.
+     *
+     * \in &reader Reader after read(); the index holds table rows, i.e. firstRow() + buffer row.
+     * \in &keyFields Key fields, most significant first.
+     * \out *errorInfo RFC_INVALID_PARAMETER for a field that is not extracted or not char-like.
+     * \return RFC_RC
+     */
+    RFC_RC build(const ColumnarTableReader& reader, const std::vector<std::basic_string<SAP_UC> >& keyFields,
+                 RFC_ERROR_INFO* errorInfo);
+
+    /** \brief  Indexes a whole table, extracting only the key columns. */
+    RFC_RC build(RFC_TABLE_HANDLE tableHandle, RFC_TYPE_DESC_HANDLE typeDescHandle,
+                 const std::vector<std::basic_string<SAP_UC> >& keyFields, RFC_ERROR_INFO* errorInfo);
+
+    /**
+     * \brief  Rows whose key starts with the given SAP_UC, in key order.
+     *
+     * \in *key Key or key prefix, see makeKey().
+     * \in length Length of key in SAP_UC, at most keyLength(). keyLength() for an exact match.
+     * \return The matching rows, empty if there are none.
+     */
+    IndexRange find(const SAP_UC* key, size_t length) const;
+
+    /** \brief  All rows in key order. */
+    IndexRange all() const;
+
+private:
+    void sortKeys();
+};
+
+/**
+ * \brief  Hash index on key columns of a table, for exact lookups.
+ *
+ * Open addressing with linear probing over slots of 8 bytes, filled to at most one half, so a
+ * lookup typically reads one cache line of slots and compares one key. Rows with equal keys are
+ * grouped, in table order.
+ */
+class HashTableIndex : public TableIndex
+{
+public:
+    HashTableIndex() : mask_(0) {}
+
+    /** \brief  Indexes the rows held by a reader, see SortedTableIndex::build(). */
+    RFC_RC build(const ColumnarTableReader& reader, const std::vector<std::basic_string<SAP_UC> >& keyFields,
+                 RFC_ERROR_INFO* errorInfo);
+
+    /** \brief  Indexes a whole table, extracting only the key columns. */
+    RFC_RC build(RFC_TABLE_HANDLE tableHandle, RFC_TYPE_DESC_HANDLE typeDescHandle,
+                 const std::vector<std::basic_string<SAP_UC> >& keyFields, RFC_ERROR_INFO* errorInfo);
+
+    /**
+     * \brief  Rows with the given key, in table order.
+     *
+     * \in *key Full key of keyLength() SAP_UC, see makeKey().
+     * \return The matching rows, empty if there are none.
+     */
+    IndexRange find(const SAP_UC* key) const;
+
+    /** \brief  Number of distinct keys. */
+    unsigned keyCount() const { return static_cast<unsigned>(groupStarts_.empty() ? 0 : groupStarts_.size() - 1); }
+
+private:
+    struct Slot
+    {
+        uint32_t tag;       ///< Upper half of the key hash
+        uint32_t group;     ///< Key group + 1, 0 for an empty slot
+    };
+
+    void hashKeys();
+    size_t probe(const SAP_UC* key, uint64_t hash) const;
+
+    std::vector<Slot> slots_;
+    size_t mask_;
+    std::vector<unsigned> groupStarts_;     // first position of every group in rows_, plus the end
+    std::vector<unsigned> groupKeys_;       // position of the key of every group in keys_
+};
+
+} // namespace nwrfc
+
+#endif // NWRFC_UTILS_TABLE_INDEX_H
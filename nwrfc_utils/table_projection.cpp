@@ -0,0 +1,339 @@
+#include "table_projection.h"
+
+#include <string.h>
+#include <algorithm>
+#include <string_view>
+#include <type_traits>
+#include "rfc_error.h"
+
+namespace nwrfc {
+
+namespace {
+
+typedef std::basic_string<SAP_UC> UcString;
+typedef std::basic_string_view<SAP_UC> UcView;
+
+enum ValueClass
+{
+    CLASS_INTEGER,
+    CLASS_FLOAT,
+    CLASS_CHARS,
+    CLASS_UNSUPPORTED
+};
+
+ValueClass classOf(RFCTYPE type)
+{
+    switch (type)
+    {
+    case RFCTYPE_INT1:
+    case RFCTYPE_INT2:
+    case RFCTYPE_INT:
+    case RFCTYPE_INT8:
+    case RFCTYPE_UTCLONG:
+    case RFCTYPE_UTCSECOND:
+    case RFCTYPE_UTCMINUTE:
+        return CLASS_INTEGER;
+    case RFCTYPE_FLOAT:
+        return CLASS_FLOAT;
+    case RFCTYPE_CHAR:
+    case RFCTYPE_NUM:
+    case RFCTYPE_DATE:
+    case RFCTYPE_TIME:
+    case RFCTYPE_STRING:
+        return CLASS_CHARS;
+    default:
+        return CLASS_UNSUPPORTED;
+    }
+}
+
+RFC_RC fieldError(RFC_ERROR_INFO* errorInfo, const UcString& field, const SAP_UC* reason)
+{
+    UcString message(cU("Field "));
+    message += field;
+    message += reason;
+    return setError(errorInfo, RFC_INVALID_PARAMETER, message.c_str());
+}
+
+/* Keeps the rows whose value passes test; rows stays ascending. */
+template <class T, class Test>
+void filterValues(const Column& column, const Test& test, std::vector<unsigned>& rows)
+{
+    const T* values = column.values<T>();
+    size_t kept = 0;
+    for (size_t i = 0; i < rows.size(); ++i)
+    {
+        if (test(values[rows[i]]))
+            rows[kept++] = rows[i];
+    }
+    rows.resize(kept);
+}
+
+template <class T>
+void filterNumbers(const Column& column, const std::vector<FilterValue>& values, bool isRange, std::vector<unsigned>& rows)
+{
+    // Integer fields with integer values compare exactly, everything else as RFC_FLOAT.
+    bool exact = std::is_integral<T>::value;
+    for (size_t i = 0; i < values.size(); ++i)
+        exact = exact && values[i].kind == FilterValue::INTEGER;
+
+    if (exact && isRange)
+    {
+        const RFC_INT8 low = values[0].integer;
+        const RFC_INT8 high = values[1].integer;
+        filterValues<T>(column, [low, high](T value) { return low <= value && value <= high; }, rows);
+    }
+    else if (exact)
+    {
+        std::vector<RFC_INT8> sorted;
+        for (size_t i = 0; i < values.size(); ++i)
+            sorted.push_back(values[i].integer);
+        std::sort(sorted.begin(), sorted.end());
+        filterValues<T>(column, [&sorted](T value) {
+            return std::binary_search(sorted.begin(), sorted.end(), static_cast<RFC_INT8>(value));
+        }, rows);
+    }
+    else if (isRange)
+    {
+        const RFC_FLOAT low = values[0].floating;
+        const RFC_FLOAT high = values[1].floating;
+        filterValues<T>(column, [low, high](T value) {
+            return low <= static_cast<RFC_FLOAT>(value) && static_cast<RFC_FLOAT>(value) <= high;
+        }, rows);
+    }
+    else
+    {
+        std::vector<RFC_FLOAT> sorted;
+        for (size_t i = 0; i < values.size(); ++i)
+            sorted.push_back(values[i].floating);
+        std::sort(sorted.begin(), sorted.end());
+        filterValues<T>(column, [&sorted](T value) {
+            return std::binary_search(sorted.begin(), sorted.end(), static_cast<RFC_FLOAT>(value));
+        }, rows);
+    }
+}
+
+/* ABAP comparison of char-like values: the shorter operand counts as blank padded. */
+int comparePadded(UcView left, UcView right)
+{
+    const size_t common = std::min(left.size(), right.size());
+    for (size_t i = 0; i < common; ++i)
+    {
+        if (left[i] != right[i])
+            return left[i] < right[i] ? -1 : 1;
+    }
+    for (size_t i = common; i < left.size(); ++i)
+    {
+        if (left[i] != cU(' '))
+            return left[i] < cU(' ') ? -1 : 1;
+    }
+    for (size_t i = common; i < right.size(); ++i)
+    {
+        if (right[i] != cU(' '))
+            return right[i] < cU(' ') ? 1 : -1;
+    }
+    return 0;
+}
+
+/* Blank padded values are equal exactly if they are equal without trailing blanks. */
+UcView trimTrailing(UcView value)
+{
+    size_t length = value.size();
+    while (length > 0 && value[length - 1] == cU(' '))
+        --length;
+    return value.substr(0, length);
+}
+
+/* NUM fields hold digits with leading zeros, the way ABAP converts a shorter value. */
+UcString normalize(const Column& column, const UcString& value)
+{
+    const size_t width = column.width / sizeof(SAP_UC);
+    if (column.desc.type != RFCTYPE_NUM || value.size() >= width)
+        return value;
+    for (size_t i = 0; i < value.size(); ++i)
+    {
+        if (value[i] < cU('0') || value[i] > cU('9'))
+            return value;
+    }
+    return UcString(width - value.size(), cU('0')) + value;
+}
+
+template <class Test>
+void filterChars(const Column& column, const Test& test, std::vector<unsigned>& rows)
+{
+    size_t kept = 0;
+    for (size_t i = 0; i < rows.size(); ++i)
+    {
+        if (test(UcView(column.charsAt(rows[i]), column.charLength(rows[i]))))
+            rows[kept++] = rows[i];
+    }
+    rows.resize(kept);
+}
+
+void filterStrings(const Column& column, const std::vector<FilterValue>& values, bool isRange, std::vector<unsigned>& rows)
+{
+    std::vector<UcString> normalized;
+    for (size_t i = 0; i < values.size(); ++i)
+        normalized.push_back(normalize(column, values[i].chars));
+
+    if (isRange)
+    {
+        const UcString& low = normalized[0];
+        const UcString& high = normalized[1];
+        filterChars(column, [&low, &high](UcView value) {
+            return comparePadded(low, value) <= 0 && comparePadded(value, high) <= 0;
+        }, rows);
+        return;
+    }
+
+    const size_t width = column.width / sizeof(SAP_UC);
+    if (column.layout == COLUMN_FIXED && normalized.size() == 1)
+    {
+        // Equality on a fixed width column: one comparison of the padded value per row.
+        UcView trimmed = trimTrailing(normalized[0]);
+        if (trimmed.size() > width)
+        {
+            rows.clear();
+            return;
+        }
+        UcString padded(trimmed);
+        padded.resize(width, cU(' '));
+        const size_t bytes = column.width;
+        filterChars(column, [&padded, bytes](UcView value) { return memcmp(value.data(), padded.data(), bytes) == 0; },
+                    rows);
+        return;
+    }
+
+    std::vector<UcString> sorted;
+    for (size_t i = 0; i < normalized.size(); ++i)
+        sorted.push_back(UcString(trimTrailing(normalized[i])));
+    std::sort(sorted.begin(), sorted.end());
+    filterChars(column, [&sorted](UcView value) {
+        const UcView trimmed = trimTrailing(value);
+        std::vector<UcString>::const_iterator it = std::lower_bound(
+            sorted.begin(), sorted.end(), trimmed, [](const UcString& left, UcView right) { return UcView(left) < right; });
+        return it != sorted.end() && UcView(*it) == trimmed;
+    }, rows);
+}
+
+} // namespace
+
+RFC_RC activateParameters(RFC_FUNCTION_HANDLE functionHandle, const std::vector<std::basic_string<SAP_UC> >& names,
+                          RFC_ERROR_INFO* errorInfo)
+{
+    RFC_ERROR_INFO localError;
+    RFC_ERROR_INFO* info = errorInfo != NULL ? errorInfo : &localError;
+    RFC_FUNCTION_DESC_HANDLE funcDescHandle = RfcDescribeFunction(functionHandle, info);
+    if (funcDescHandle == NULL)
+        return info->code;
+
+    unsigned parameterCount = 0;
+    RFC_RC rc = RfcGetParameterCount(funcDescHandle, &parameterCount, errorInfo);
+    for (unsigned i = 0; i < parameterCount && rc == RFC_OK; ++i)
+    {
+        RFC_PARAMETER_DESC desc;
+        rc = RfcGetParameterDescByIndex(funcDescHandle, i, &desc, errorInfo);
+        if (rc != RFC_OK || (desc.direction != RFC_EXPORT && desc.direction != RFC_TABLES))
+            continue;
+        const bool active = std::find(names.begin(), names.end(), desc.name) != names.end();
+        rc = RfcSetParameterActive(functionHandle, desc.name, active ? 1 : 0, errorInfo);
+    }
+    return rc;
+}
+
+void RowFilter::addEquals(const SAP_UC* field, const FilterValue& value)
+{
+    Predicate predicate;
+    predicate.field = field;
+    predicate.op = OPERATOR_EQUALS;
+    predicate.values.push_back(value);
+    predicates_.push_back(predicate);
+}
+
+void RowFilter::addRange(const SAP_UC* field, const FilterValue& low, const FilterValue& high)
+{
+    Predicate predicate;
+    predicate.field = field;
+    predicate.op = OPERATOR_RANGE;
+    predicate.values.push_back(low);
+    predicate.values.push_back(high);
+    predicates_.push_back(predicate);
+}
+
+void RowFilter::addInList(const SAP_UC* field, const std::vector<FilterValue>& values)
+{
+    Predicate predicate;
+    predicate.field = field;
+    predicate.op = OPERATOR_IN_LIST;
+    predicate.values = values;
+    predicates_.push_back(predicate);
+}
+
+std::vector<std::basic_string<SAP_UC> > RowFilter::fields() const
+{
+    std::vector<std::basic_string<SAP_UC> > names;
+    for (size_t p = 0; p < predicates_.size(); ++p)
+    {
+        if (std::find(names.begin(), names.end(), predicates_[p].field) == names.end())
+            names.push_back(predicates_[p].field);
+    }
+    return names;
+}
+
+RFC_RC RowFilter::evaluate(const ColumnarTableReader& reader, std::vector<unsigned>& rows, RFC_ERROR_INFO* errorInfo) const
+{
+    rows.resize(reader.rowCount());
+    for (unsigned row = 0; row < reader.rowCount(); ++row)
+        rows[row] = row;
+
+    for (size_t p = 0; p < predicates_.size(); ++p)
+    {
+        const Predicate& predicate = predicates_[p];
+        unsigned c = 0;
+        while (c < reader.columnCount() && predicate.field != reader.column(c).desc.name)
+            ++c;
+        if (c == reader.columnCount())
+            return fieldError(errorInfo, predicate.field, cU(" not found"));
+        const Column& column = reader.column(c);
+        if (column.layout == COLUMN_SKIPPED)
+            return fieldError(errorInfo, predicate.field, cU(" is not selected"));
+
+        const ValueClass valueClass = classOf(column.desc.type);
+        if (valueClass == CLASS_UNSUPPORTED)
+            return fieldError(errorInfo, predicate.field, cU(" cannot be filtered"));
+        for (size_t v = 0; v < predicate.values.size(); ++v)
+        {
+            if ((predicate.values[v].kind == FilterValue::CHARS) != (valueClass == CLASS_CHARS))
+                return fieldError(errorInfo, predicate.field, cU(": filter value of the wrong kind"));
+        }
+
+        const bool isRange = predicate.op == OPERATOR_RANGE;
+        switch (column.desc.type)
+        {
+        case RFCTYPE_INT1:  filterNumbers<RFC_INT1>(column, predicate.values, isRange, rows); break;
+        case RFCTYPE_INT2:  filterNumbers<RFC_INT2>(column, predicate.values, isRange, rows); break;
+        case RFCTYPE_INT:   filterNumbers<RFC_INT>(column, predicate.values, isRange, rows); break;
+        case RFCTYPE_FLOAT: filterNumbers<RFC_FLOAT>(column, predicate.values, isRange, rows); break;
+        case RFCTYPE_INT8:
+        case RFCTYPE_UTCLONG:
+        case RFCTYPE_UTCSECOND:
+        case RFCTYPE_UTCMINUTE:
+            filterNumbers<RFC_INT8>(column, predicate.values, isRange, rows);
+            break;
+        default:
+            filterStrings(column, predicate.values, isRange, rows);
+            break;
+        }
+    }
+    return clearError(errorInfo);
+}
+
+RFC_RC RowFilter::apply(ColumnarTableReader& reader, RFC_ERROR_INFO* errorInfo) const
+{
+    std::vector<unsigned> rows;
+    RFC_RC rc = evaluate(reader, rows, errorInfo);
+    if (rc == RFC_OK && rows.size() < reader.rowCount())
+        reader.retainRows(rows);
+    return rc;
+}
+
+} // namespace nwrfc
@@ -0,0 +1,139 @@
+#ifndef NWRFC_UTILS_TABLE_PROJECTION_H
+#define NWRFC_UTILS_TABLE_PROJECTION_H
+
+#include <string>
+#include <vector>
+#include "sapnwrfc.h"
+#include "columnar_table_reader.h"
+
+namespace nwrfc {
+
+/**
+ * \brief  Deactivates every EXPORT and TABLES parameter of a function module that is not listed.
+ *
+ * Inactive parameters are not transferred (see RfcSetParameterActive()), so results the caller
+ * does not need are neither serialized by the backend nor deserialized by the library. Other
+ * parameters are left untouched. Tables filled by the caller as input must be listed as well.
+ *
+ * \in functionHandle Function module before RfcInvoke().
+ * \in &names EXPORT and TABLES parameters to keep active.
+ * \out *errorInfo More information in case the metadata cannot be read.
+ * \return RFC_RC
+ */
+RFC_RC activateParameters(RFC_FUNCTION_HANDLE functionHandle, const std::vector<std::basic_string<SAP_UC> >& names,
+                          RFC_ERROR_INFO* errorInfo);
+
+/** \struct FilterValue
+ *
+ * Operand of a RowFilter predicate. Integer and float values apply to numeric fields, char values
+ * to CHAR, NUM, DATE, TIME and STRING fields.
+ */
+struct FilterValue
+{
+    enum Kind
+    {
+        INTEGER,
+        FLOATING,
+        CHARS
+    };
+
+    Kind kind;
+    RFC_INT8 integer;
+    RFC_FLOAT floating;
+    std::basic_string<SAP_UC> chars;
+
+    FilterValue(int value) : kind(INTEGER), integer(value), floating(value) {}
+    FilterValue(long value) : kind(INTEGER), integer(value), floating(static_cast<RFC_FLOAT>(value)) {}
+    FilterValue(long long value) : kind(INTEGER), integer(value), floating(static_cast<RFC_FLOAT>(value)) {}
+    FilterValue(double value) : kind(FLOATING), integer(0), floating(value) {}
+    FilterValue(const SAP_UC* value) : kind(CHARS), integer(0), floating(0), chars(value) {}
+    FilterValue(const std::basic_string<SAP_UC>& value) : kind(CHARS), integer(0), floating(0), chars(value) {}
+};
+
+/**
+ * \brief  Client-side row selection on the column buffers of a ColumnarTableReader.
+ *
+ * Predicates are combined with AND and evaluated in the order they were added, one column at a
+ * time: each predicate only visits the rows the previous ones accepted. Add the most selective
+ * predicate first. Char-like values compare like ABAP: the shorter operand is padded with blanks,
+ * and a NUM value with fewer digits than the field is padded with leading zeros.
+ *
+ * Together with ColumnarTableReader::selectColumns() only the projected and filtered values are
+ * ever decoded or materialized:
+ *
+ * \code
+ * nwrfc::RowFilter filter;
+ * filter.addEquals(cU("BUKRS"), cU("1000"));
+ * filter.addRange(cU("BUDAT"), cU("20240101"), cU("20241231"));
+ * filter.addInList(cU("BLART"), { cU("SA"), cU("KR") });
+ *
+ * std::vector<std::basic_string<SAP_UC> > fields = filter.fields();
+ * fields.push_back(cU("DMBTR"));
+ * reader.selectColumns(fields, &errorInfo);
+ * if (reader.read(&errorInfo) == RFC_OK && filter.apply(reader, &errorInfo) == RFC_OK)
+ *     ... reader.rowCount() rows passed the filter
+ * \endcode
+ *
+ * DECFLOAT, BCD, raw and nested fields cannot be filtered.
+ */
+class RowFilter
+{
+public:
+    /** \brief  Field equals value. */
+    void addEquals(const SAP_UC* field, const FilterValue& value);
+
+    /** \brief  low <= field <= high, like an ABAP BT range. */
+    void addRange(const SAP_UC* field, const FilterValue& low, const FilterValue& high);
+
+    /** \brief  Field equals one of the values. */
+    void addInList(const SAP_UC* field, const std::vector<FilterValue>& values);
+
+    /** \brief  Removes all predicates. */
+    void clear() { predicates_.clear(); }
+
+    bool empty() const { return predicates_.empty(); }
+
+    /** \brief  Fields referenced by the predicates, each once, to be included in the projection. */
+    std::vector<std::basic_string<SAP_UC> > fields() const;
+
+    /**
+     * \brief  Computes the buffer rows of the reader that satisfy all predicates.
+     *
+     * \in &reader Reader after read(), with all referenced fields selected.
+     * \out &rows Ascending row numbers within the column buffers.
+     * \out *errorInfo RFC_INVALID_PARAMETER for unknown, unselected or unsupported fields and
+     *      values of the wrong kind.
+     * \return RFC_RC
+     */
+    RFC_RC evaluate(const ColumnarTableReader& reader, std::vector<unsigned>& rows, RFC_ERROR_INFO* errorInfo) const;
+
+    /**
+     * \brief  Evaluates the predicates and compacts the reader to the accepted rows.
+     *
+     * \in &reader Reader after read().
+     * \out *errorInfo See evaluate().
+     * \return RFC_RC
+     */
+    RFC_RC apply(ColumnarTableReader& reader, RFC_ERROR_INFO* errorInfo) const;
+
+private:
+    enum Operator
+    {
+        OPERATOR_EQUALS,
+        OPERATOR_RANGE,
+        OPERATOR_IN_LIST
+    };
+
+    struct Predicate
+    {
+        std::basic_string<SAP_UC> field;
+        Operator op;
+        std::vector<FilterValue> values;
+    };
+
+    std::vector<Predicate> predicates_;
+};
+
+} // namespace nwrfc
+
+#endif // NWRFC_UTILS_TABLE_PROJECTION_H
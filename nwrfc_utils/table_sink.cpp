@@ -0,0 +1,40 @@
+#include "table_sink.h"
+
+#include <algorithm>
+#include "rfc_error.h"
+
+namespace nwrfc {
+
+RFC_RC writeTable(ColumnarTableReader& reader, TableSink& sink, unsigned chunkRows, RFC_ERROR_INFO* errorInfo)
+{
+    RFC_RC rc = reader.describe(errorInfo);
+    if (rc == RFC_OK)
+        rc = sink.begin(reader.columns(), errorInfo);
+    if (rc != RFC_OK)
+        return rc;
+
+    const unsigned rows = reader.tableRowCount();
+    const unsigned windowRows = chunkRows > 0 ? chunkRows : 1;
+    for (unsigned done = 0; done < rows; )
+    {
+        rc = reader.read(done, std::min(windowRows, rows - done), errorInfo);
+        if (rc != RFC_OK)
+            return rc;
+        if (reader.rowCount() == 0)
+            return setError(errorInfo, RFC_ILLEGAL_STATE, cU("Table changed while it was written"));
+        rc = sink.write(reader, errorInfo);
+        if (rc != RFC_OK)
+            return rc;
+        done += reader.rowCount();
+    }
+    return sink.finish(errorInfo);
+}
+
+RFC_RC writeTable(RFC_TABLE_HANDLE tableHandle, RFC_TYPE_DESC_HANDLE typeDescHandle, TableSink& sink,
+                  RFC_ERROR_INFO* errorInfo, unsigned chunkRows)
+{
+    ColumnarTableReader reader(tableHandle, typeDescHandle);
+    return writeTable(reader, sink, chunkRows, errorInfo);
+}
+
+} // namespace nwrfc
@@ -0,0 +1,69 @@
+#ifndef NWRFC_UTILS_TABLE_SINK_H
+#define NWRFC_UTILS_TABLE_SINK_H
+
+#include <vector>
+#include "sapnwrfc.h"
+#include "columnar_table_reader.h"
+
+namespace nwrfc {
+
+/**
+ * \brief  Destination of a table that is extracted window by window, e.g. a file format writer.
+ *
+ * A sink sees the rows as column batches of a ColumnarTableReader, never as a row object model:
+ * begin() once with the column descriptions, write() for every batch, finish() at the end.
+ * COLUMN_SKIPPED columns are not part of the output, so a reader restricted with
+ * ColumnarTableReader::selectColumns() writes only the selected fields.
+ */
+class TableSink
+{
+public:
+    virtual ~TableSink() {}
+
+    /**
+     * \brief  Starts the output, e.g. writes a header.
+     *
+     * \in &columns Columns of the batches that follow; descriptions only, the buffers may be empty.
+     * \out *errorInfo More information in case the output cannot be started.
+     * \return RFC_RC
+     */
+    virtual RFC_RC begin(const std::vector<Column>& columns, RFC_ERROR_INFO* errorInfo) = 0;
+
+    /**
+     * \brief  Appends the rows held by a reader.
+     *
+     * \in &batch Reader after a read(), with the columns passed to begin().
+     * \out *errorInfo More information in case the rows cannot be written.
+     * \return RFC_RC
+     */
+    virtual RFC_RC write(const ColumnarTableReader& batch, RFC_ERROR_INFO* errorInfo) = 0;
+
+    /**
+     * \brief  Completes the output and flushes it.
+     *
+     * \out *errorInfo More information in case the output cannot be completed.
+     * \return RFC_RC
+     */
+    virtual RFC_RC finish(RFC_ERROR_INFO* errorInfo) = 0;
+};
+
+/**
+ * \brief  Streams all rows of a table into a sink, chunkRows rows at a time.
+ *
+ * Memory use is bounded by one window of chunkRows rows plus whatever the sink buffers.
+ *
+ * \in &reader Reader of the table, optionally restricted with selectColumns().
+ * \inout &sink Receives begin(), one write() per window and finish().
+ * \in chunkRows Rows extracted per window.
+ * \out *errorInfo More information in case the table cannot be read or the sink fails.
+ * \return RFC_RC
+ */
+RFC_RC writeTable(ColumnarTableReader& reader, TableSink& sink, unsigned chunkRows, RFC_ERROR_INFO* errorInfo);
+
+/** \brief  Streams all fields of a table into a sink, see above. */
+RFC_RC writeTable(RFC_TABLE_HANDLE tableHandle, RFC_TYPE_DESC_HANDLE typeDescHandle, TableSink& sink,
+                  RFC_ERROR_INFO* errorInfo, unsigned chunkRows = 4096);
+
+} // namespace nwrfc
+
+#endif // NWRFC_UTILS_TABLE_SINK_H
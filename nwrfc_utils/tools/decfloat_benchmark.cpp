@@ -0,0 +1,328 @@
+/*
+ * decfloat_benchmark: compares the per-value functions of sapdecf.h with the batch conversions of
+ * decfloat_batch.h, and checks that both give the same results on this platform.
+ *
+ * Usage:
+ *   decfloat_benchmark [-n 100000] [-r 5] [-b 16,6]
+ *
+ * The values are created by StringToDecFloat16/34 from random amounts with up to 15 (RFC_DECF16)
+ * or 30 (RFC_DECF34) digits and 0 to 6 decimal places; one in 32 has a large exponent instead.
+ * -n is the number of values, -r the number of repetitions of which the fastest counts, -b the
+ * length and decimals of the packed numbers for the BCD conversions. One tab-separated line per
+ * format and conversion is printed: nanoseconds per value of the library loop and of the batch
+ * call, the speedup, and the number of values whose result or return code differs, which must be 0.
+ * The exit code is 1 if any value differs.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include "sapnwrfc.h"
+#include "sapdecf.h"
+#include "decfloat_batch.h"
+
+namespace {
+
+typedef std::basic_string<SAP_UC> ucstring;
+
+struct Options
+{
+    size_t count;
+    unsigned repetitions;
+    unsigned bcdLength;
+    unsigned bcdDecimals;
+};
+
+/* The per-value and the batch functions of one format. */
+struct Format16
+{
+    typedef RFC_DECF16 Value;
+    typedef DecFloat16Buff Buffer;
+    static const char* name() { return "DECF16"; }
+    static unsigned digits() { return 15; }
+
+    static DECF_RETURN toString(const Value& value, Buffer* buffer) { return DecFloat16ToString(value, buffer); }
+    static DECF_RETURN fromString(const SAP_UC* text, Value* value) { return StringToDecFloat16(text, value); }
+    static DECF_RETURN toDouble(RFC_FLOAT* number, const Value& value) { return DecFloat16ToSAP_DOUBLE(number, value); }
+    static DECF_RETURN fromDouble(Value* value, RFC_FLOAT number) { return SAP_DOUBLEToDecFloat16(value, number); }
+    static DECF_RETURN toBcd(SAP_RAW* bcd, const Value& value, unsigned length, unsigned decimals)
+    { return DecFloat16ToBCD(bcd, value, static_cast<intR>(length), static_cast<intR>(decimals)); }
+    static DECF_RETURN fromBcd(Value* value, const SAP_RAW* bcd, unsigned length, unsigned decimals)
+    { return BCDToDecFloat16(value, const_cast<SAP_RAW*>(bcd), static_cast<intR>(length), static_cast<intR>(decimals)); }
+
+    static void toStrings(const Value* values, size_t count, Buffer* strings)
+    { nwrfc::decFloat16ToStrings(values, count, strings, NULL); }
+    static void fromStrings(const SAP_UC* const* strings, size_t count, Value* values, DECF_RETURN* codes)
+    { nwrfc::stringsToDecFloat16(strings, count, values, codes, NULL); }
+    static void toDoubles(const Value* values, size_t count, RFC_FLOAT* doubles, DECF_RETURN* codes)
+    { nwrfc::decFloat16ToDoubles(values, count, doubles, codes, NULL); }
+    static void fromDoubles(const RFC_FLOAT* doubles, size_t count, Value* values, DECF_RETURN* codes)
+    { nwrfc::doublesToDecFloat16(doubles, count, values, codes, NULL); }
+    static void toBcds(const Value* values, size_t count, SAP_RAW* bcd, unsigned length, unsigned decimals, DECF_RETURN* codes)
+    { nwrfc::decFloat16ToBCD(values, count, bcd, length, decimals, codes, NULL); }
+    static void fromBcds(const SAP_RAW* bcd, size_t count, unsigned length, unsigned decimals, Value* values, DECF_RETURN* codes)
+    { nwrfc::bcdToDecFloat16(bcd, count, length, decimals, values, codes, NULL); }
+};
+
+struct Format34
+{
+    typedef RFC_DECF34 Value;
+    typedef DecFloat34Buff Buffer;
+    static const char* name() { return "DECF34"; }
+    static unsigned digits() { return 30; }
+
+    static DECF_RETURN toString(const Value& value, Buffer* buffer) { return DecFloat34ToString(value, buffer); }
+    static DECF_RETURN fromString(const SAP_UC* text, Value* value) { return StringToDecFloat34(text, value); }
+    static DECF_RETURN toDouble(RFC_FLOAT* number, const Value& value) { return DecFloat34ToSAP_DOUBLE(number, value); }
+    static DECF_RETURN fromDouble(Value* value, RFC_FLOAT number) { return SAP_DOUBLEToDecFloat34(value, number); }
+    static DECF_RETURN toBcd(SAP_RAW* bcd, const Value& value, unsigned length, unsigned decimals)
+    { return DecFloat34ToBCD(bcd, value, static_cast<intR>(length), static_cast<intR>(decimals)); }
+    static DECF_RETURN fromBcd(Value* value, const SAP_RAW* bcd, unsigned length, unsigned decimals)
+    { return BCDToDecFloat34(value, const_cast<SAP_RAW*>(bcd), static_cast<intR>(length), static_cast<intR>(decimals)); }
+
+    static void toStrings(const Value* values, size_t count, Buffer* strings)
+    { nwrfc::decFloat34ToStrings(values, count, strings, NULL); }
+    static void fromStrings(const SAP_UC* const* strings, size_t count, Value* values, DECF_RETURN* codes)
+    { nwrfc::stringsToDecFloat34(strings, count, values, codes, NULL); }
+    static void toDoubles(const Value* values, size_t count, RFC_FLOAT* doubles, DECF_RETURN* codes)
+    { nwrfc::decFloat34ToDoubles(values, count, doubles, codes, NULL); }
+    static void fromDoubles(const RFC_FLOAT* doubles, size_t count, Value* values, DECF_RETURN* codes)
+    { nwrfc::doublesToDecFloat34(doubles, count, values, codes, NULL); }
+    static void toBcds(const Value* values, size_t count, SAP_RAW* bcd, unsigned length, unsigned decimals, DECF_RETURN* codes)
+    { nwrfc::decFloat34ToBCD(values, count, bcd, length, decimals, codes, NULL); }
+    static void fromBcds(const SAP_RAW* bcd, size_t count, unsigned length, unsigned decimals, Value* values, DECF_RETURN* codes)
+    { nwrfc::bcdToDecFloat34(bcd, count, length, decimals, values, codes, NULL); }
+};
+
+typedef std::chrono::steady_clock Clock;
+
+double nanoseconds(Clock::time_point start, Clock::time_point end)
+{
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+}
+
+bool almostFine(DECF_RETURN code)
+{
+    return code == DECF_OK || code == DECF_INEXACT || code == DECF_UNDERFLOW;
+}
+
+bool sameString(const SAP_UC* left, const SAP_UC* right)
+{
+    for (; *left != 0 && *left == *right; ++left, ++right)
+        ;
+    return *left == *right;
+}
+
+/* Random amount like "-12345.678", or "1.5E+123" for one in 32. */
+ucstring randomAmount(std::mt19937_64& random, unsigned maxDigits)
+{
+    std::string text;
+    if (random() % 2 == 0)
+        text += '-';
+    const unsigned digits = 1 + static_cast<unsigned>(random() % maxDigits);
+    const unsigned decimals = static_cast<unsigned>(random() % 7);
+    for (unsigned i = 0; i < digits; ++i)
+    {
+        if (decimals > 0 && i + decimals == digits)
+            text += i == 0 ? "0." : ".";
+        text += static_cast<char>('0' + random() % 10);
+    }
+    if (random() % 32 == 0)
+    {
+        char exponent[16];
+        snprintf(exponent, sizeof(exponent), "E%+d", static_cast<int>(random() % 601) - 300);
+        text += exponent;
+    }
+    return ucstring(text.begin(), text.end());
+}
+
+void report(const char* format, const char* conversion, double library, double batch, size_t count, size_t differences)
+{
+    printf("%s\t%s\t%.1f\t%.1f\t%.2fx\t%lu\n", format, conversion, library / count, batch / count,
+           batch > 0 ? library / batch : 0.0, static_cast<unsigned long>(differences));
+}
+
+/* Runs every conversion of one format; returns the number of differing values. */
+template <class Format>
+size_t benchmark(const Options& options)
+{
+    typedef typename Format::Value Value;
+    typedef typename Format::Buffer Buffer;
+    const size_t count = options.count;
+    const unsigned length = options.bcdLength;
+    const unsigned decimals = options.bcdDecimals;
+    std::mt19937_64 random(42);
+
+    std::vector<ucstring> texts(count);
+    std::vector<const SAP_UC*> pointers(count);
+    std::vector<Value> values(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        texts[i] = randomAmount(random, Format::digits());
+        pointers[i] = texts[i].c_str();
+        Format::fromString(pointers[i], &values[i]);
+    }
+
+    std::vector<Buffer> libraryStrings(count), batchStrings(count);
+    std::vector<RFC_FLOAT> libraryDoubles(count), batchDoubles(count);
+    std::vector<Value> libraryValues(count), batchValues(count);
+    std::vector<SAP_RAW> libraryBcd(count * length), batchBcd(count * length);
+    std::vector<DECF_RETURN> libraryCodes(count), batchCodes(count);
+    double library[6], batch[6];
+    for (int c = 0; c < 6; ++c)
+        library[c] = batch[c] = 1e300;
+    size_t differences[6] = { 0, 0, 0, 0, 0, 0 };
+
+    for (unsigned repetition = 0; repetition < options.repetitions; ++repetition)
+    {
+        Clock::time_point start = Clock::now();
+        for (size_t i = 0; i < count; ++i)
+            Format::toString(values[i], &libraryStrings[i]);
+        Clock::time_point middle = Clock::now();
+        Format::toStrings(values.data(), count, batchStrings.data());
+        Clock::time_point end = Clock::now();
+        library[0] = std::min(library[0], nanoseconds(start, middle));
+        batch[0] = std::min(batch[0], nanoseconds(middle, end));
+
+        start = Clock::now();
+        for (size_t i = 0; i < count; ++i)
+            libraryCodes[i] = Format::fromString(pointers[i], &libraryValues[i]);
+        middle = Clock::now();
+        Format::fromStrings(pointers.data(), count, batchValues.data(), batchCodes.data());
+        end = Clock::now();
+        library[1] = std::min(library[1], nanoseconds(start, middle));
+        batch[1] = std::min(batch[1], nanoseconds(middle, end));
+        differences[1] = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (libraryCodes[i] != batchCodes[i]
+                || (almostFine(libraryCodes[i]) && memcmp(&libraryValues[i], &batchValues[i], sizeof(Value)) != 0))
+                ++differences[1];
+        }
+
+        start = Clock::now();
+        for (size_t i = 0; i < count; ++i)
+            libraryCodes[i] = Format::toDouble(&libraryDoubles[i], values[i]);
+        middle = Clock::now();
+        Format::toDoubles(values.data(), count, batchDoubles.data(), batchCodes.data());
+        end = Clock::now();
+        library[2] = std::min(library[2], nanoseconds(start, middle));
+        batch[2] = std::min(batch[2], nanoseconds(middle, end));
+        differences[2] = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (libraryCodes[i] != batchCodes[i] || memcmp(&libraryDoubles[i], &batchDoubles[i], sizeof(RFC_FLOAT)) != 0)
+                ++differences[2];
+        }
+
+        start = Clock::now();
+        for (size_t i = 0; i < count; ++i)
+            libraryCodes[i] = Format::fromDouble(&libraryValues[i], libraryDoubles[i]);
+        middle = Clock::now();
+        Format::fromDoubles(libraryDoubles.data(), count, batchValues.data(), batchCodes.data());
+        end = Clock::now();
+        library[3] = std::min(library[3], nanoseconds(start, middle));
+        batch[3] = std::min(batch[3], nanoseconds(middle, end));
+        differences[3] = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (libraryCodes[i] != batchCodes[i]
+                || (almostFine(libraryCodes[i]) && memcmp(&libraryValues[i], &batchValues[i], sizeof(Value)) != 0))
+                ++differences[3];
+        }
+
+        start = Clock::now();
+        for (size_t i = 0; i < count; ++i)
+            libraryCodes[i] = Format::toBcd(&libraryBcd[i * length], values[i], length, decimals);
+        middle = Clock::now();
+        Format::toBcds(values.data(), count, batchBcd.data(), length, decimals, batchCodes.data());
+        end = Clock::now();
+        library[4] = std::min(library[4], nanoseconds(start, middle));
+        batch[4] = std::min(batch[4], nanoseconds(middle, end));
+        differences[4] = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (libraryCodes[i] != batchCodes[i]
+                || (almostFine(libraryCodes[i]) && memcmp(&libraryBcd[i * length], &batchBcd[i * length], length) != 0))
+                ++differences[4];
+        }
+
+        start = Clock::now();
+        for (size_t i = 0; i < count; ++i)
+            libraryCodes[i] = Format::fromBcd(&libraryValues[i], &libraryBcd[i * length], length, decimals);
+        middle = Clock::now();
+        Format::fromBcds(libraryBcd.data(), count, length, decimals, batchValues.data(), batchCodes.data());
+        end = Clock::now();
+        library[5] = std::min(library[5], nanoseconds(start, middle));
+        batch[5] = std::min(batch[5], nanoseconds(middle, end));
+        differences[5] = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (libraryCodes[i] != batchCodes[i]
+                || (almostFine(libraryCodes[i]) && memcmp(&libraryValues[i], &batchValues[i], sizeof(Value)) != 0))
+                ++differences[5];
+        }
+    }
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (!sameString(libraryStrings[i], batchStrings[i]))
+            ++differences[0];
+    }
+
+    const char* const conversions[6] = { "toString", "fromString", "toDouble", "fromDouble", "toBCD", "fromBCD" };
+    size_t total = 0;
+    for (int c = 0; c < 6; ++c)
+    {
+        report(Format::name(), conversions[c], library[c], batch[c], count, differences[c]);
+        total += differences[c];
+    }
+    return total;
+}
+
+void usage()
+{
+    fprintf(stderr, "usage: decfloat_benchmark [-n values] [-r repetitions] [-b length,decimals]\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Options options = { 100000, 5, 16, 6 };
+    for (int i = 1; i < argc; ++i)
+    {
+        const bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "-n") == 0 && hasValue)
+            options.count = static_cast<size_t>(strtoul(argv[++i], NULL, 10));
+        else if (strcmp(argv[i], "-r") == 0 && hasValue)
+            options.repetitions = static_cast<unsigned>(strtoul(argv[++i], NULL, 10));
+        else if (strcmp(argv[i], "-b") == 0 && hasValue)
+        {
+            char* next = argv[++i];
+            options.bcdLength = static_cast<unsigned>(strtoul(next, &next, 10));
+            options.bcdDecimals = *next == ',' ? static_cast<unsigned>(strtoul(next + 1, NULL, 10)) : 0;
+        }
+        else
+        {
+            usage();
+            return 2;
+        }
+    }
+    if (options.count == 0 || options.repetitions == 0 || options.bcdLength == 0 || options.bcdLength > 16)
+    {
+        usage();
+        return 2;
+    }
+
+    printf("# kernels %s, %lu values, packed numbers of %u bytes with %u decimals\n",
+           nwrfc::decFloatKernelsAvailable() ? "used" : "not used (no BID encoding)",
+           static_cast<unsigned long>(options.count), options.bcdLength, options.bcdDecimals);
+    printf("format\tconversion\tlibrary ns/value\tbatch ns/value\tspeedup\tdifferences\n");
+    const size_t differences = benchmark<Format16>(options) + benchmark<Format34>(options);
+    return differences == 0 ? 0 : 1;
+}
@@ -0,0 +1,290 @@
+/*
+ * sapuc_string_check: differential test of the nwrfc::sapuc functions of sapuc_string_simd.h
+ * against plain scalar loops.
+ *
+ * Usage:
+ *   sapuc_string_check [-n 400000] [-s 42]
+ *
+ * Every iteration builds two random strings from a small alphabet (including surrogates, 0x8000
+ * and 0xFFFF, so that signed comparisons would show), each ending right before an inaccessible
+ * guard page, at varying distances to the 16-byte alignment; on x86 also at odd byte addresses.
+ * All functions are called with these strings, searched characters including 0, and random
+ * counts, and their results are compared with the reference loops. -n is the number of
+ * iterations, -s the seed. The exit code is 1 if any result differs.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <random>
+#include "sapnwrfc.h"
+#include "sapuc_string_simd.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const size_t MAX_LENGTH = 70;
+
+/* Two accessible pages, each followed by an inaccessible one. */
+class GuardedPages
+{
+public:
+    GuardedPages() : memory_(NULL), pageSize_(0)
+    {
+#ifdef _WIN32
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        pageSize_ = info.dwPageSize;
+        memory_ = static_cast<char*>(VirtualAlloc(NULL, 4 * pageSize_, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE));
+        DWORD previous;
+        if (memory_ != NULL
+            && (!VirtualProtect(memory_ + pageSize_, pageSize_, PAGE_NOACCESS, &previous)
+                || !VirtualProtect(memory_ + 3 * pageSize_, pageSize_, PAGE_NOACCESS, &previous)))
+            memory_ = NULL;
+#else
+        pageSize_ = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        void* memory = mmap(NULL, 4 * pageSize_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        memory_ = memory == MAP_FAILED ? NULL : static_cast<char*>(memory);
+        if (memory_ != NULL
+            && (mprotect(memory_ + pageSize_, pageSize_, PROT_NONE) != 0
+                || mprotect(memory_ + 3 * pageSize_, pageSize_, PROT_NONE) != 0))
+            memory_ = NULL;
+#endif
+    }
+
+    bool valid() const { return memory_ != NULL; }
+
+    /* End of the first or second accessible page, i.e. the start of its guard page. */
+    char* guard(unsigned index) const { return memory_ + (2 * index + 1) * pageSize_; }
+
+private:
+    char* memory_;
+    size_t pageSize_;
+};
+
+int sign(int value)
+{
+    return (value > 0) - (value < 0);
+}
+
+size_t referenceLength(const SAP_UC* chars)
+{
+    size_t i = 0;
+    while (chars[i] != 0)
+        ++i;
+    return i;
+}
+
+size_t referenceBoundedLength(const SAP_UC* chars, size_t maxLength)
+{
+    size_t i = 0;
+    while (i < maxLength && chars[i] != 0)
+        ++i;
+    return i;
+}
+
+int referenceCompare(const SAP_UC* left, const SAP_UC* right, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (left[i] != right[i])
+            return sign(static_cast<int>(left[i]) - static_cast<int>(right[i]));
+        if (left[i] == 0)
+            return 0;
+    }
+    return 0;
+}
+
+const SAP_UC* referenceFind(const SAP_UC* chars, SAP_UC c)
+{
+    for (;; ++chars)
+    {
+        if (*chars == c)
+            return chars;
+        if (*chars == 0)
+            return NULL;
+    }
+}
+
+const SAP_UC* referenceFindLast(const SAP_UC* chars, SAP_UC c)
+{
+    const SAP_UC* last = NULL;
+    for (;; ++chars)
+    {
+        if (*chars == c)
+            last = chars;
+        if (*chars == 0)
+            return last;
+    }
+}
+
+const SAP_UC* referenceSearch(const SAP_UC* haystack, const SAP_UC* needle)
+{
+    const size_t needleLength = referenceLength(needle);
+    for (;; ++haystack)
+    {
+        if (referenceCompare(haystack, needle, needleLength) == 0)
+            return haystack;
+        if (*haystack == 0)
+            return NULL;
+    }
+}
+
+const SAP_UC ALPHABET[] = { cU('a'), cU('b'), cU('c'), 0xD800, 0xFFFF, cU(' '), 0x8000 };
+
+void fill(std::mt19937& random, SAP_UC* chars, size_t length, unsigned letters)
+{
+    for (size_t i = 0; i < length; ++i)
+        chars[i] = ALPHABET[random() % letters];
+    chars[length] = 0;
+}
+
+/* Space for length SAP_UC and the terminator, which ends at most 15 SAP_UC before the guard page. */
+SAP_UC* place(std::mt19937& random, char* guard, size_t length)
+{
+    char* end = guard - (random() % 2 == 0 ? 0 : (random() % 16) * sizeof(SAP_UC));
+#ifdef NWRFC_SAPUC_STRING_SSE2
+    if (random() % 4 == 0)
+        end -= 1;   // odd byte address
+#endif
+    return reinterpret_cast<SAP_UC*>(end - (length + 1) * sizeof(SAP_UC));
+}
+
+class Checker
+{
+public:
+    Checker() : checks_(0), failures_(0) {}
+
+    void check(bool passed, const char* function, size_t leftLength, size_t rightLength)
+    {
+        ++checks_;
+        if (!passed && ++failures_ <= 20)
+            printf("mismatch in %s, lengths %lu and %lu\n", function, static_cast<unsigned long>(leftLength),
+                   static_cast<unsigned long>(rightLength));
+    }
+
+    unsigned long checks() const { return checks_; }
+    unsigned long failures() const { return failures_; }
+
+private:
+    unsigned long checks_;
+    unsigned long failures_;
+};
+
+void iterate(std::mt19937& random, const GuardedPages& pages, Checker& checker)
+{
+    const size_t leftLength = random() % MAX_LENGTH;
+    const size_t rightLength = random() % MAX_LENGTH;
+    const unsigned letters = 1 + random() % (sizeof(ALPHABET) / sizeof(ALPHABET[0]));
+    SAP_UC* left = place(random, pages.guard(0), leftLength);
+    SAP_UC* right = place(random, pages.guard(1), rightLength);
+    fill(random, left, leftLength, letters);
+    fill(random, right, rightLength, letters);
+    if (random() % 3 == 0)
+    {
+        // Common prefix, so that comparisons run deep.
+        const size_t common = leftLength < rightLength ? leftLength : rightLength;
+        memmove(right, left, (random() % (common + 1)) * sizeof(SAP_UC));
+    }
+    const SAP_UC c = random() % 10 == 0 ? 0 : ALPHABET[random() % (sizeof(ALPHABET) / sizeof(ALPHABET[0]))];
+    const size_t count = random() % (MAX_LENGTH + 10);
+
+    checker.check(nwrfc::sapuc::length(left) == referenceLength(left), "length", leftLength, rightLength);
+    checker.check(nwrfc::sapuc::boundedLength(left, count) == referenceBoundedLength(left, count), "boundedLength",
+                  leftLength, rightLength);
+    checker.check(sign(nwrfc::sapuc::compare(left, right)) == referenceCompare(left, right, static_cast<size_t>(-1)),
+                  "compare", leftLength, rightLength);
+    checker.check(sign(nwrfc::sapuc::compare(left, right, count)) == referenceCompare(left, right, count),
+                  "compare with count", leftLength, rightLength);
+    checker.check(nwrfc::sapuc::find(left, c) == referenceFind(left, c), "find", leftLength, rightLength);
+    checker.check(nwrfc::sapuc::findLast(left, c) == referenceFindLast(left, c), "findLast", leftLength, rightLength);
+
+    // Needle: a substring of left, or a short random string.
+    SAP_UC needle[MAX_LENGTH + 1];
+    size_t needleLength;
+    if (leftLength > 0 && random() % 2 == 0)
+    {
+        const size_t start = random() % leftLength;
+        needleLength = random() % (leftLength - start + 1);
+        memcpy(needle, left + start, needleLength * sizeof(SAP_UC));
+        needle[needleLength] = 0;
+    }
+    else
+    {
+        needleLength = random() % 5;
+        fill(random, needle, needleLength, letters);
+    }
+    checker.check(nwrfc::sapuc::search(left, needle) == referenceSearch(left, needle), "search", leftLength, rightLength);
+
+    // Copies: the target is prefilled, nothing beyond the copied part may change.
+    SAP_UC actual[3 * MAX_LENGTH + 16], expected[3 * MAX_LENGTH + 16];
+    const size_t targetSize = sizeof(actual) / sizeof(SAP_UC);
+    for (size_t i = 0; i < targetSize; ++i)
+        actual[i] = expected[i] = 0x1234;
+    nwrfc::sapuc::copy(actual, left, count);
+    const size_t copied = referenceBoundedLength(left, count);
+    for (size_t i = 0; i < count; ++i)
+        expected[i] = i < copied ? left[i] : 0;
+    checker.check(memcmp(actual, expected, sizeof(actual)) == 0, "copy with count", leftLength, rightLength);
+
+    for (size_t i = 0; i < targetSize; ++i)
+        actual[i] = expected[i] = 0x1234;
+    nwrfc::sapuc::copy(actual, left);
+    memcpy(expected, left, (leftLength + 1) * sizeof(SAP_UC));
+    checker.check(memcmp(actual, expected, sizeof(actual)) == 0, "copy", leftLength, rightLength);
+
+    nwrfc::sapuc::append(actual, right);
+    memcpy(expected + leftLength, right, (rightLength + 1) * sizeof(SAP_UC));
+    checker.check(memcmp(actual, expected, sizeof(actual)) == 0, "append", leftLength, rightLength);
+}
+
+void usage()
+{
+    fprintf(stderr, "usage: sapuc_string_check [-n iterations] [-s seed]\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    unsigned long iterations = 400000;
+    unsigned long seed = 42;
+    for (int i = 1; i < argc; ++i)
+    {
+        const bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "-n") == 0 && hasValue)
+            iterations = strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "-s") == 0 && hasValue)
+            seed = strtoul(argv[++i], NULL, 10);
+        else
+        {
+            usage();
+            return 2;
+        }
+    }
+
+    GuardedPages pages;
+    if (!pages.valid())
+    {
+        fprintf(stderr, "cannot set up the guard pages\n");
+        return 2;
+    }
+    std::mt19937 random(static_cast<std::mt19937::result_type>(seed));
+    Checker checker;
+    for (unsigned long i = 0; i < iterations; ++i)
+        iterate(random, pages, checker);
+    printf("%s kernels: %lu checks, %lu mismatches\n",
+#ifdef NWRFC_SAPUC_STRING_SSE2
+           "SSE2",
+#else
+           "scalar",
+#endif
+           checker.checks(), checker.failures());
+    return checker.failures() == 0 ? 0 : 1;
+}
@@ -0,0 +1,315 @@
+/*
+ * serialization_benchmark: compares row-based and column-based serialization on synthetic tables,
+ * to choose the thresholds of nwrfc::SerializationPolicy.
+ *
+ * Usage:
+ *   serialization_benchmark -p ashost=... -p sysnr=00 -p client=100 -p user=... -p passwd=...
+ *                           [-f STFC_STRUCTURE] [-t RFCTABLE] [-r 1000,10000,100000] [-n 3] [-m OFF -m LAN -m WAN]
+ *
+ * The function module must send the table back, like STFC_STRUCTURE does with RFCTABLE. The
+ * table is filled with the given numbers of synthetic rows and sent with every format (OFF is
+ * row-based). One tab-separated line per row count and format is printed, with the fastest of the
+ * repetitions, in milliseconds and bytes as reported by the throughput object.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "sapnwrfc.h"
+#include "sapnwrfccloud.h"
+
+namespace {
+
+typedef std::basic_string<SAP_UC> ucstring;
+
+struct Measurement
+{
+    SAP_ULLONG totalTime;
+    SAP_ULLONG serializationTime;
+    SAP_ULLONG deserializationTime;
+    SAP_ULLONG sentBytes;
+    SAP_ULLONG receivedBytes;
+};
+
+ucstring fromUtf8(const char* text)
+{
+    RFC_ERROR_INFO errorInfo;
+    const unsigned length = static_cast<unsigned>(strlen(text));
+    unsigned size = length + 1;
+    unsigned resultLength = 0;
+    std::vector<SAP_UC> buffer(size);
+    if (RfcUTF8ToSAPUC(reinterpret_cast<const RFC_BYTE*>(text), length, &buffer[0], &size, &resultLength, &errorInfo) != RFC_OK)
+        return ucstring();
+    return ucstring(&buffer[0], resultLength);
+}
+
+void printError(const char* context, const RFC_ERROR_INFO& errorInfo)
+{
+    fprintf(stderr, "%s: ", context);
+    printfU(cU("%s: %s\n"), errorInfo.key, errorInfo.message);
+}
+
+void usage()
+{
+    fprintf(stderr,
+            "usage: serialization_benchmark -p key=value ... [-f FUNCTION] [-t TABLE] [-r rows,rows,...] "
+            "[-n repetitions] [-m FORMAT ...]\n");
+}
+
+/* Digits of value, repeated to the given length, so that values neither compress to nothing nor are random. */
+ucstring digits(unsigned value, unsigned length)
+{
+    SAP_UC text[16];
+    unsigned count = 0;
+    do
+    {
+        text[count++] = static_cast<SAP_UC>(cU('0') + value % 10);
+        value /= 10;
+    } while (value > 0);
+    ucstring result;
+    while (result.size() < length)
+        result.push_back(text[result.size() % count]);
+    return result;
+}
+
+RFC_RC setField(RFC_STRUCTURE_HANDLE row, unsigned index, const RFC_FIELD_DESC& field, unsigned rowNumber,
+                RFC_ERROR_INFO* errorInfo)
+{
+    const unsigned value = rowNumber * 31 + index;
+    switch (field.type)
+    {
+    case RFCTYPE_CHAR:
+    case RFCTYPE_NUM:
+    {
+        const ucstring text = digits(value, field.nucLength);
+        return RfcSetCharsByIndex(row, index, text.c_str(), static_cast<unsigned>(text.size()), errorInfo);
+    }
+    case RFCTYPE_STRING:
+    {
+        const ucstring text = digits(value, 20);
+        return RfcSetStringByIndex(row, index, text.c_str(), static_cast<unsigned>(text.size()), errorInfo);
+    }
+    case RFCTYPE_DATE:
+        return RfcSetDateByIndex(row, index, cU("20240229"), errorInfo);
+    case RFCTYPE_TIME:
+        return RfcSetTimeByIndex(row, index, cU("235959"), errorInfo);
+    case RFCTYPE_INT1:
+        return RfcSetInt1ByIndex(row, index, static_cast<RFC_INT1>(value), errorInfo);
+    case RFCTYPE_INT2:
+        return RfcSetInt2ByIndex(row, index, static_cast<RFC_INT2>(value), errorInfo);
+    case RFCTYPE_INT:
+        return RfcSetIntByIndex(row, index, static_cast<RFC_INT>(value), errorInfo);
+    case RFCTYPE_INT8:
+        return RfcSetInt8ByIndex(row, index, static_cast<RFC_INT8>(value) * 1000003, errorInfo);
+    case RFCTYPE_FLOAT:
+        return RfcSetFloatByIndex(row, index, value * 0.25, errorInfo);
+    case RFCTYPE_BCD:
+    case RFCTYPE_DECF16:
+    case RFCTYPE_DECF34:
+    {
+        ucstring text = digits(value, 5);
+        text += cU(".5");
+        return RfcSetStringByIndex(row, index, text.c_str(), static_cast<unsigned>(text.size()), errorInfo);
+    }
+    case RFCTYPE_BYTE:
+    case RFCTYPE_XSTRING:
+    {
+        std::vector<SAP_RAW> bytes(field.type == RFCTYPE_BYTE ? field.nucLength : 16);
+        for (size_t i = 0; i < bytes.size(); ++i)
+            bytes[i] = static_cast<SAP_RAW>(value + i);
+        return field.type == RFCTYPE_BYTE
+            ? RfcSetBytesByIndex(row, index, bytes.data(), static_cast<unsigned>(bytes.size()), errorInfo)
+            : RfcSetXStringByIndex(row, index, bytes.data(), static_cast<unsigned>(bytes.size()), errorInfo);
+    }
+    default:
+        return RFC_OK; // nested structures and tables stay initial
+    }
+}
+
+RFC_RC fillTable(RFC_TABLE_HANDLE table, RFC_TYPE_DESC_HANDLE rowType, unsigned rows, RFC_ERROR_INFO* errorInfo)
+{
+    unsigned fieldCount = 0;
+    RFC_RC rc = RfcDeleteAllRows(table, errorInfo);
+    if (rc == RFC_OK)
+        rc = RfcGetFieldCount(rowType, &fieldCount, errorInfo);
+    std::vector<RFC_FIELD_DESC> fields(fieldCount);
+    for (unsigned i = 0; i < fieldCount && rc == RFC_OK; ++i)
+        rc = RfcGetFieldDescByIndex(rowType, i, &fields[i], errorInfo);
+    for (unsigned r = 0; r < rows && rc == RFC_OK; ++r)
+    {
+        RFC_STRUCTURE_HANDLE row = RfcAppendNewRow(table, errorInfo);
+        if (row == NULL)
+            return errorInfo->code;
+        for (unsigned i = 0; i < fieldCount && rc == RFC_OK; ++i)
+            rc = setField(row, i, fields[i], r, errorInfo);
+    }
+    return rc;
+}
+
+RFC_RC measure(RFC_THROUGHPUT_HANDLE throughput, Measurement& result, RFC_ERROR_INFO* errorInfo)
+{
+    RFC_RC rc = RfcGetTotalTime(throughput, &result.totalTime, errorInfo);
+    if (rc == RFC_OK)
+        rc = RfcGetSerializationTime(throughput, &result.serializationTime, errorInfo);
+    if (rc == RFC_OK)
+        rc = RfcGetDeserializationTime(throughput, &result.deserializationTime, errorInfo);
+    if (rc == RFC_OK)
+        rc = RfcGetSentBytes(throughput, &result.sentBytes, errorInfo);
+    if (rc == RFC_OK)
+        rc = RfcGetReceivedBytes(throughput, &result.receivedBytes, errorInfo);
+    return rc;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::vector<std::pair<ucstring, ucstring> > parameters;
+    ucstring functionName = cU("STFC_STRUCTURE");
+    ucstring tableName = cU("RFCTABLE");
+    std::vector<unsigned> rowCounts;
+    std::vector<std::string> formats;
+    unsigned repetitions = 3;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "-f") == 0 && hasValue)
+            functionName = fromUtf8(argv[++i]);
+        else if (strcmp(argv[i], "-t") == 0 && hasValue)
+            tableName = fromUtf8(argv[++i]);
+        else if (strcmp(argv[i], "-n") == 0 && hasValue)
+            repetitions = static_cast<unsigned>(strtoul(argv[++i], NULL, 10));
+        else if (strcmp(argv[i], "-m") == 0 && hasValue)
+            formats.push_back(argv[++i]);
+        else if (strcmp(argv[i], "-r") == 0 && hasValue)
+        {
+            for (char* next = argv[++i]; *next != 0;)
+            {
+                rowCounts.push_back(static_cast<unsigned>(strtoul(next, &next, 10)));
+                if (*next == ',')
+                    ++next;
+                else if (*next != 0)
+                    break;
+            }
+        }
+        else if (strcmp(argv[i], "-p") == 0 && hasValue && strchr(argv[i + 1], '=') != NULL)
+        {
+            const std::string parameter = argv[++i];
+            const size_t equals = parameter.find('=');
+            parameters.push_back(std::make_pair(fromUtf8(parameter.substr(0, equals).c_str()),
+                                                fromUtf8(parameter.substr(equals + 1).c_str())));
+        }
+        else
+        {
+            usage();
+            return 2;
+        }
+    }
+    if (parameters.empty() || repetitions == 0)
+    {
+        usage();
+        return 2;
+    }
+    if (rowCounts.empty())
+    {
+        rowCounts.push_back(1000);
+        rowCounts.push_back(10000);
+        rowCounts.push_back(100000);
+    }
+    if (formats.empty())
+    {
+        formats.push_back("OFF");
+        formats.push_back("LAN");
+        formats.push_back("WAN");
+    }
+
+    RFC_ERROR_INFO errorInfo;
+    std::vector<RFC_CONNECTION_PARAMETER> connectionParams(parameters.size());
+    for (size_t i = 0; i < parameters.size(); ++i)
+    {
+        connectionParams[i].name = parameters[i].first.c_str();
+        connectionParams[i].value = parameters[i].second.c_str();
+    }
+    RFC_CONNECTION_HANDLE connection = RfcOpenConnection(&connectionParams[0], static_cast<unsigned>(connectionParams.size()), &errorInfo);
+    if (connection == NULL)
+    {
+        printError("RfcOpenConnection", errorInfo);
+        return 1;
+    }
+
+    int exitCode = 0;
+    RFC_FUNCTION_DESC_HANDLE funcDesc = RfcGetFunctionDesc(connection, functionName.c_str(), &errorInfo);
+    RFC_PARAMETER_DESC tableDesc;
+    unsigned columns = 0;
+    if (funcDesc == NULL
+        || RfcGetParameterDescByName(funcDesc, tableName.c_str(), &tableDesc, &errorInfo) != RFC_OK
+        || RfcGetFieldCount(tableDesc.typeDescHandle, &columns, &errorInfo) != RFC_OK)
+    {
+        printError("metadata", errorInfo);
+        RfcCloseConnection(connection, &errorInfo);
+        return 1;
+    }
+    RFC_THROUGHPUT_HANDLE throughput = RfcCreateThroughput(&errorInfo);
+    RFC_FUNCTION_HANDLE function = RfcCreateFunction(funcDesc, &errorInfo);
+    if (throughput == NULL || function == NULL
+        || RfcSetThroughputOnConnection(connection, throughput, &errorInfo) != RFC_OK)
+    {
+        printError("setup", errorInfo);
+        exitCode = 1;
+    }
+
+    printf("rows\tcolumns\tformat\ttotal_ms\tserialization_ms\tdeserialization_ms\tsent_bytes\treceived_bytes\n");
+    for (size_t r = 0; r < rowCounts.size() && exitCode == 0; ++r)
+    {
+        for (size_t f = 0; f < formats.size() && exitCode == 0; ++f)
+        {
+            const ucstring format = fromUtf8(formats[f].c_str());
+            if (RfcEnableColumnBasedSerialization(connection, format.c_str(), &errorInfo) != RFC_OK)
+            {
+                printf("%u\t%u\t%s\tunsupported\n", rowCounts[r], columns, formats[f].c_str());
+                continue;
+            }
+
+            Measurement best = Measurement();
+            for (unsigned n = 0; n < repetitions && exitCode == 0; ++n)
+            {
+                // Refilled every time, since the function module may change the table.
+                RFC_TABLE_HANDLE table = NULL;
+                Measurement current = Measurement();
+                if (RfcGetTable(function, tableName.c_str(), &table, &errorInfo) != RFC_OK
+                    || fillTable(table, tableDesc.typeDescHandle, rowCounts[r], &errorInfo) != RFC_OK
+                    || RfcResetThroughput(throughput, &errorInfo) != RFC_OK
+                    || RfcInvoke(connection, function, &errorInfo) != RFC_OK
+                    || measure(throughput, current, &errorInfo) != RFC_OK)
+                {
+                    printError("call", errorInfo);
+                    exitCode = 1;
+                }
+                else if (n == 0 || current.totalTime < best.totalTime)
+                {
+                    best = current;
+                }
+            }
+            if (exitCode == 0)
+                printf("%u\t%u\t%s\t%llu\t%llu\t%llu\t%llu\t%llu\n", rowCounts[r], columns, formats[f].c_str(),
+                       static_cast<unsigned long long>(best.totalTime),
+                       static_cast<unsigned long long>(best.serializationTime),
+                       static_cast<unsigned long long>(best.deserializationTime),
+                       static_cast<unsigned long long>(best.sentBytes),
+                       static_cast<unsigned long long>(best.receivedBytes));
+        }
+    }
+
+    if (function != NULL)
+        RfcDestroyFunction(function, &errorInfo);
+    if (throughput != NULL)
+    {
+        RfcRemoveThroughputFromConnection(connection, &errorInfo);
+        RfcDestroyThroughput(throughput, &errorInfo);
+    }
+    RfcCloseConnection(connection, &errorInfo);
+    return exitCode;
+}
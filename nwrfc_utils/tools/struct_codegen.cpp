@@ -0,0 +1,186 @@
+/*
+ * struct_codegen: generates a C++ header with typed structs and marshal/unmarshal functions for
+ * RFC function modules and structures, see nwrfc::StructCodegen.
+ *
+ * Usage:
+ *   struct_codegen [-o out.h] [-n namespace] -p ashost=... -p sysnr=00 -p client=100 -p user=... -p passwd=... NAME...
+ *   struct_codegen [-o out.h] [-n namespace] -r repository.json [-i repositoryID] NAME...
+ *
+ * NAMEs are function modules, names following -t are structures/table types.
+ * -r reads the metadata from a file written by RfcSaveRepository() instead of connecting.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "sapnwrfc.h"
+#include "struct_codegen.h"
+
+namespace {
+
+typedef std::basic_string<SAP_UC> ucstring;
+
+ucstring fromUtf8(const char* text)
+{
+    RFC_ERROR_INFO errorInfo;
+    const unsigned length = static_cast<unsigned>(strlen(text));
+    unsigned size = length + 1;
+    unsigned resultLength = 0;
+    std::vector<SAP_UC> buffer(size);
+    if (RfcUTF8ToSAPUC(reinterpret_cast<const RFC_BYTE*>(text), length, &buffer[0], &size, &resultLength, &errorInfo) != RFC_OK)
+        return ucstring();
+    return ucstring(&buffer[0], resultLength);
+}
+
+void printError(const char* context, const RFC_ERROR_INFO& errorInfo)
+{
+    fprintf(stderr, "%s: ", context);
+    printfU(cU("%s: %s\n"), errorInfo.key, errorInfo.message);
+}
+
+void usage()
+{
+    fprintf(stderr,
+            "usage: struct_codegen [-o out.h] [-n namespace] (-p key=value ... | -r repository.json [-i id]) "
+            "FUNCTION... [-t TYPE...]\n");
+}
+
+std::string guardFor(const std::string& path)
+{
+    std::string guard;
+    const size_t slash = path.find_last_of("/\\");
+    for (size_t i = slash == std::string::npos ? 0 : slash + 1; i < path.size(); ++i)
+    {
+        const char c = path[i];
+        guard += (c >= 'a' && c <= 'z') ? static_cast<char>(c - 'a' + 'A')
+               : ((c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')) ? c : '_';
+    }
+    return guard.empty() ? "RFC_GENERATED_H" : guard;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::string output;
+    std::string namespaceName = "rfcgen";
+    const char* repositoryFile = NULL;
+    const char* repositoryID = NULL;
+    std::vector<std::pair<ucstring, ucstring> > parameters;
+    std::vector<ucstring> functions;
+    std::vector<ucstring> types;
+    bool typeNames = false;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "-o") == 0 && hasValue)
+            output = argv[++i];
+        else if (strcmp(argv[i], "-n") == 0 && hasValue)
+            namespaceName = argv[++i];
+        else if (strcmp(argv[i], "-r") == 0 && hasValue)
+            repositoryFile = argv[++i];
+        else if (strcmp(argv[i], "-i") == 0 && hasValue)
+            repositoryID = argv[++i];
+        else if (strcmp(argv[i], "-p") == 0 && hasValue && strchr(argv[i + 1], '=') != NULL)
+        {
+            const std::string parameter = argv[++i];
+            const size_t equals = parameter.find('=');
+            parameters.push_back(std::make_pair(fromUtf8(parameter.substr(0, equals).c_str()),
+                                                fromUtf8(parameter.substr(equals + 1).c_str())));
+        }
+        else if (strcmp(argv[i], "-t") == 0)
+            typeNames = true;
+        else if (argv[i][0] == '-')
+        {
+            usage();
+            return 2;
+        }
+        else
+            (typeNames ? types : functions).push_back(fromUtf8(argv[i]));
+    }
+    if ((functions.empty() && types.empty()) || (repositoryFile == NULL && parameters.empty()))
+    {
+        usage();
+        return 2;
+    }
+
+    RFC_ERROR_INFO errorInfo;
+    RFC_CONNECTION_HANDLE connection = NULL;
+    ucstring repository = repositoryID != NULL ? fromUtf8(repositoryID) : ucstring();
+    const SAP_UC* repositoryName = repositoryID != NULL ? repository.c_str() : NULL;
+
+    if (repositoryFile != NULL)
+    {
+        FILE* file = fopen(repositoryFile, "r");
+        if (file == NULL)
+        {
+            fprintf(stderr, "Cannot open %s\n", repositoryFile);
+            return 1;
+        }
+        RFC_RC rc = RfcLoadRepository(repositoryName, file, &errorInfo);
+        fclose(file);
+        if (rc != RFC_OK)
+        {
+            printError("RfcLoadRepository", errorInfo);
+            return 1;
+        }
+    }
+    else
+    {
+        std::vector<RFC_CONNECTION_PARAMETER> connectionParams(parameters.size());
+        for (size_t i = 0; i < parameters.size(); ++i)
+        {
+            connectionParams[i].name = parameters[i].first.c_str();
+            connectionParams[i].value = parameters[i].second.c_str();
+        }
+        connection = RfcOpenConnection(&connectionParams[0], static_cast<unsigned>(connectionParams.size()), &errorInfo);
+        if (connection == NULL)
+        {
+            printError("RfcOpenConnection", errorInfo);
+            return 1;
+        }
+    }
+
+    nwrfc::StructCodegen codegen(namespaceName);
+    int exitCode = 0;
+    for (size_t i = 0; i < functions.size() && exitCode == 0; ++i)
+    {
+        RFC_FUNCTION_DESC_HANDLE funcDesc = connection != NULL
+            ? RfcGetFunctionDesc(connection, functions[i].c_str(), &errorInfo)
+            : RfcGetCachedFunctionDesc(repositoryName, functions[i].c_str(), &errorInfo);
+        if (funcDesc == NULL || codegen.addFunction(funcDesc, &errorInfo) != RFC_OK)
+        {
+            printError("function module", errorInfo);
+            exitCode = 1;
+        }
+    }
+    for (size_t i = 0; i < types.size() && exitCode == 0; ++i)
+    {
+        RFC_TYPE_DESC_HANDLE typeDesc = connection != NULL
+            ? RfcGetTypeDesc(connection, types[i].c_str(), &errorInfo)
+            : RfcGetCachedTypeDesc(repositoryName, types[i].c_str(), &errorInfo);
+        if (typeDesc == NULL || codegen.addType(typeDesc, &errorInfo) != RFC_OK)
+        {
+            printError("type", errorInfo);
+            exitCode = 1;
+        }
+    }
+    if (connection != NULL)
+        RfcCloseConnection(connection, &errorInfo);
+    if (exitCode != 0)
+        return exitCode;
+
+    const std::string header = codegen.header(guardFor(output.empty() ? "rfc_generated.h" : output));
+    FILE* target = output.empty() ? stdout : fopen(output.c_str(), "w");
+    if (target == NULL)
+    {
+        fprintf(stderr, "Cannot write %s\n", output.c_str());
+        return 1;
+    }
+    fwrite(header.data(), 1, header.size(), target);
+    if (target != stdout)
+        fclose(target);
+    return 0;
+}
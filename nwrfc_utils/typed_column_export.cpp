@@ -0,0 +1,188 @@
+#include "typed_column_export.h"
+
+#include <limits.h>
+#include <stdint.h>
+#include <string.h>
+#include "rfc_error.h"
+#include "sapuc_utils.h"
+#include "utf8_transcoder.h"
+
+namespace nwrfc {
+
+namespace {
+
+/* Collects variable length values into a data buffer and Int32Array offsets. */
+class OffsetBuilder
+{
+public:
+    explicit OffsetBuilder(unsigned rows)
+    {
+        offsets_.reserve(static_cast<size_t>(rows) + 1);
+        offsets_.push_back(0);
+    }
+
+    std::string& data() { return data_; }
+
+    bool endValue()
+    {
+        if (data_.size() > INT_MAX)
+            return false;
+        offsets_.push_back(static_cast<int32_t>(data_.size()));
+        return true;
+    }
+
+    void moveTo(TypedColumn& column)
+    {
+        column.values.reset(new ExternalBuffer(data_));
+        std::vector<SAP_RAW> offsets(offsets_.size() * sizeof(int32_t));
+        memcpy(offsets.data(), offsets_.data(), offsets.size());
+        column.offsets.reset(new ExternalBuffer(offsets));
+    }
+
+private:
+    std::string data_;
+    std::vector<int32_t> offsets_;
+};
+
+RFC_RC tooLarge(const Column& column, RFC_ERROR_INFO* errorInfo)
+{
+    return setError(errorInfo, RFC_BUFFER_TOO_SMALL,
+                    (std::basic_string<SAP_UC>(cU("Column ")) + column.desc.name + cU(" exceeds 2 GB")).c_str());
+}
+
+RFC_RC exportColumn(Column& column, unsigned rows, bool trimChars, TypedColumn& target, RFC_ERROR_INFO* errorInfo)
+{
+    target.rfcType = column.desc.type;
+    target.length = rows;
+    target.kind = TYPED_NUMBERS;
+
+    switch (column.desc.type)
+    {
+    case RFCTYPE_INT1:
+    case RFCTYPE_INT2:
+    case RFCTYPE_INT:
+    case RFCTYPE_INT8:
+    case RFCTYPE_UTCLONG:
+    case RFCTYPE_UTCSECOND:
+    case RFCTYPE_UTCMINUTE:
+    case RFCTYPE_FLOAT:
+        if (column.desc.type == RFCTYPE_INT1)
+            target.type = TYPED_UINT8;
+        else if (column.desc.type == RFCTYPE_INT2)
+            target.type = TYPED_INT16;
+        else if (column.desc.type == RFCTYPE_INT)
+            target.type = TYPED_INT32;
+        else if (column.desc.type == RFCTYPE_FLOAT)
+            target.type = TYPED_FLOAT64;
+        else
+            target.type = TYPED_BIGINT64;
+        column.data.resize(static_cast<size_t>(rows) * column.width);
+        target.values.reset(new ExternalBuffer(column.data));
+        return RFC_OK;
+
+    case RFCTYPE_DECF16:
+    case RFCTYPE_DECF34:
+    case RFCTYPE_BCD:
+    {
+        target.kind = TYPED_STRINGS;
+        target.type = TYPED_UINT8;
+        OffsetBuilder builder(rows);
+        for (unsigned row = 0; row < rows; ++row)
+        {
+            char number[64];
+            const size_t length = column.desc.type == RFCTYPE_DECF16
+                ? formatDecFloat16(column.values<RFC_DECF16>()[row], number, sizeof(number))
+                : formatDecFloat34(column.values<RFC_DECF34>()[row], number, sizeof(number));
+            builder.data().append(number, length);
+            if (!builder.endValue())
+                return tooLarge(column, errorInfo);
+        }
+        builder.moveTo(target);
+        return RFC_OK;
+    }
+
+    case RFCTYPE_CHAR:
+    case RFCTYPE_NUM:
+    case RFCTYPE_DATE:
+    case RFCTYPE_TIME:
+    case RFCTYPE_STRING:
+    {
+        target.kind = TYPED_STRINGS;
+        target.type = TYPED_UINT8;
+        std::string data;
+        std::vector<size_t> ends;
+        RFC_RC rc = appendUtf8Column(column, rows, trimChars, data, ends, errorInfo);
+        if (rc != RFC_OK)
+            return rc;
+        if (data.size() > INT_MAX)
+            return tooLarge(column, errorInfo);
+        std::vector<SAP_RAW> offsets(ends.size() * sizeof(int32_t));
+        int32_t* offset = reinterpret_cast<int32_t*>(offsets.data());
+        for (size_t row = 0; row < ends.size(); ++row)
+            offset[row] = static_cast<int32_t>(ends[row]);
+        target.offsets.reset(new ExternalBuffer(offsets));
+        target.values.reset(new ExternalBuffer(data));
+        return RFC_OK;
+    }
+
+    case RFCTYPE_BYTE:
+    case RFCTYPE_XSTRING:
+    {
+        target.kind = TYPED_BYTES;
+        target.type = TYPED_UINT8;
+        const size_t size = column.layout == COLUMN_FIXED ? static_cast<size_t>(rows) * column.width : column.offsets[rows];
+        if (size > INT_MAX)
+            return tooLarge(column, errorInfo);
+        std::vector<SAP_RAW> offsets((static_cast<size_t>(rows) + 1) * sizeof(int32_t));
+        int32_t* offset = reinterpret_cast<int32_t*>(offsets.data());
+        for (unsigned row = 0; row <= rows; ++row)
+            offset[row] = static_cast<int32_t>(column.layout == COLUMN_FIXED ? static_cast<size_t>(row) * column.width : column.offsets[row]);
+        target.offsets.reset(new ExternalBuffer(offsets));
+        // The bytes are laid out back to back in both layouts already.
+        column.data.resize(size);
+        target.values.reset(new ExternalBuffer(column.data));
+        return RFC_OK;
+    }
+
+    default:
+        return setError(errorInfo, RFC_NOT_SUPPORTED, cU("Column type cannot be exported as typed array"));
+    }
+}
+
+} // namespace
+
+RFC_RC exportTypedColumns(ColumnarTableReader& reader, std::vector<TypedColumn>& columns, bool trimChars,
+                          RFC_ERROR_INFO* errorInfo)
+{
+    columns.clear();
+    for (unsigned i = 0; i < reader.columnCount(); ++i)
+    {
+        Column& column = reader.column(i);
+        if (column.layout == COLUMN_SKIPPED)
+            continue;
+
+        columns.push_back(TypedColumn());
+        TypedColumn& target = columns.back();
+        RFC_RC rc = appendUtf8(column.desc.name, static_cast<unsigned>(strlenU(column.desc.name)), target.name, errorInfo);
+        if (rc == RFC_OK)
+            rc = exportColumn(column, reader.rowCount(), trimChars, target, errorInfo);
+        if (rc != RFC_OK)
+        {
+            columns.clear();
+            return rc;
+        }
+    }
+    return clearError(errorInfo);
+}
+
+RFC_RC exportTypedTable(RFC_TABLE_HANDLE tableHandle, RFC_TYPE_DESC_HANDLE typeDescHandle,
+                        std::vector<TypedColumn>& columns, RFC_ERROR_INFO* errorInfo)
+{
+    ColumnarTableReader reader(tableHandle, typeDescHandle);
+    RFC_RC rc = reader.read(errorInfo);
+    if (rc != RFC_OK)
+        return rc;
+    return exportTypedColumns(reader, columns, true, errorInfo);
+}
+
+} // namespace nwrfc
@@ -0,0 +1,126 @@
+#ifndef NWRFC_UTILS_TYPED_COLUMN_EXPORT_H
+#define NWRFC_UTILS_TYPED_COLUMN_EXPORT_H
+
+#include <stddef.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "sapnwrfc.h"
+#include "columnar_table_reader.h"
+
+namespace nwrfc {
+
+/** \enum TypedArrayType
+ *
+ * Element type of an exported buffer. The values are those of napi_typedarray_type, so a Node.js
+ * addon can pass them to napi_create_typedarray() as they are.
+ */
+enum TypedArrayType
+{
+    TYPED_UINT8 = 1,
+    TYPED_INT16 = 3,
+    TYPED_INT32 = 5,
+    TYPED_FLOAT64 = 8,
+    TYPED_BIGINT64 = 9
+};
+
+/** \enum TypedColumnKind
+ *
+ * How the buffers of a TypedColumn are to be read.
+ */
+enum TypedColumnKind
+{
+    TYPED_NUMBERS,  ///< values holds one element per row
+    TYPED_STRINGS,  ///< Row i is the UTF-8 text values[offsets[i], offsets[i+1])
+    TYPED_BYTES     ///< Row i is the binary value values[offsets[i], offsets[i+1])
+};
+
+/**
+ * \brief  Memory of one exported buffer, meant to become an external ArrayBuffer.
+ *
+ * The buffer stays valid until it is deleted, i.e. the consumer releases a buffer and deletes it
+ * from the finalizer of the ArrayBuffer that wraps it:
+ * \code
+ * nwrfc::ExternalBuffer* buffer = column.values.release();
+ * napi_create_external_arraybuffer(env, buffer->data(), buffer->size(),
+ *     [](napi_env, void*, void* hint) { nwrfc::ExternalBuffer::destroy(hint); }, buffer, &arrayBuffer);
+ * \endcode
+ */
+class ExternalBuffer
+{
+public:
+    /** \brief  Takes over the memory of bytes, which is empty afterwards. */
+    explicit ExternalBuffer(std::vector<SAP_RAW>& bytes) { bytes_.swap(bytes); }
+
+    /** \brief  Takes over the memory of text, which is empty afterwards. */
+    explicit ExternalBuffer(std::string& text) { text_.swap(text); }
+
+    void* data() { return !text_.empty() ? static_cast<void*>(&text_[0]) : bytes_.empty() ? NULL : bytes_.data(); }
+    size_t size() const { return text_.size() + bytes_.size(); }
+
+    /** \brief  Deletes a released buffer, usable as C finalizer callback. */
+    static void destroy(void* buffer) { delete static_cast<ExternalBuffer*>(buffer); }
+
+private:
+    ExternalBuffer(const ExternalBuffer&);
+    ExternalBuffer& operator=(const ExternalBuffer&);
+
+    std::vector<SAP_RAW> bytes_;
+    std::string text_;
+};
+
+/** \struct TypedColumn
+ *
+ * One table column as buffers that map 1:1 onto JavaScript typed arrays.
+ */
+struct TypedColumn
+{
+    std::string name;                       ///< UTF-8 field name
+    RFCTYPE rfcType;                        ///< Type of the field
+    TypedColumnKind kind;
+    TypedArrayType type;                    ///< Element type of values
+    unsigned length;                        ///< Number of rows
+    std::unique_ptr<ExternalBuffer> values; ///< Numbers, UTF-8 text or bytes
+    std::unique_ptr<ExternalBuffer> offsets;///< rows + 1 TYPED_INT32 offsets into values, NULL for TYPED_NUMBERS
+};
+
+/**
+ * \brief  Exports the columns extracted by a ColumnarTableReader as typed array buffers.
+ *
+ * Instead of one JavaScript object per row and one property per field, a table becomes one
+ * typed array per column. Type mapping:
+ * - RFCTYPE_INT1: Uint8Array; INT2: Int16Array; INT: Int32Array
+ * - RFCTYPE_INT8 and UTCxxx: BigInt64Array
+ * - RFCTYPE_FLOAT: Float64Array
+ * - RFCTYPE_CHAR, NUM, DATE, TIME, STRING: UTF-8 data plus Int32Array offsets
+ * - RFCTYPE_BCD and DECF16/34: decimal strings with all digits, as the Node.js addon returns them
+ * - RFCTYPE_BYTE and XSTRING: Uint8Array data plus Int32Array offsets
+ *
+ * Numeric and byte buffers are moved out of the reader without copying, its column buffers are empty
+ * afterwards. The export does not touch any JavaScript value, so an addon can run it together
+ * with RfcInvoke() on a worker thread and only wrap the buffers on the event loop.
+ *
+ * \inout &reader Reader after read(); its numeric and byte buffers are moved into the result.
+ * \out &columns One TypedColumn per extracted (not COLUMN_SKIPPED) column.
+ * \in trimChars Strip trailing blanks of RFCTYPE_CHAR fields.
+ * \out *errorInfo More information in case a value cannot be converted or a column exceeds 2 GB.
+ * \return RFC_RC
+ */
+RFC_RC exportTypedColumns(ColumnarTableReader& reader, std::vector<TypedColumn>& columns, bool trimChars,
+                          RFC_ERROR_INFO* errorInfo);
+
+/**
+ * \brief  Extracts a complete table and exports it with exportTypedColumns(), trimming CHAR fields.
+ *
+ * \in tableHandle Table to export.
+ * \in typeDescHandle Row type of the table.
+ * \out &columns One TypedColumn per field with a supported type.
+ * \out *errorInfo More information in case the table cannot be read.
+ * \return RFC_RC
+ */
+RFC_RC exportTypedTable(RFC_TABLE_HANDLE tableHandle, RFC_TYPE_DESC_HANDLE typeDescHandle,
+                        std::vector<TypedColumn>& columns, RFC_ERROR_INFO* errorInfo);
+
+} // namespace nwrfc
+
+#endif // NWRFC_UTILS_TYPED_COLUMN_EXPORT_H
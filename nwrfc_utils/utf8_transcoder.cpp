@@ -0,0 +1,449 @@
+#include "utf8_transcoder.h"
+
+#include <limits.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include "rfc_error.h"
+#include "sapuc_utils.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define NWRFC_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+namespace nwrfc {
+
+namespace {
+
+const size_t INVALID = static_cast<size_t>(-1);
+
+/*
+ * Scalar conversion of chars [position, end). A surrogate pair starting before end is completed
+ * even if its low half is at end, so the SIMD kernels can hand over any block boundary.
+ */
+inline bool encodeScalar(const SAP_UC* chars, size_t length, size_t& position, size_t end, unsigned char*& out)
+{
+    while (position < end)
+    {
+        const unsigned c = chars[position++];
+        if (c < 0x80)
+            *out++ = static_cast<unsigned char>(c);
+        else if (c < 0x800)
+        {
+            *out++ = static_cast<unsigned char>(0xC0 | (c >> 6));
+            *out++ = static_cast<unsigned char>(0x80 | (c & 0x3F));
+        }
+        else if (c < 0xD800 || c > 0xDFFF)
+        {
+            *out++ = static_cast<unsigned char>(0xE0 | (c >> 12));
+            *out++ = static_cast<unsigned char>(0x80 | ((c >> 6) & 0x3F));
+            *out++ = static_cast<unsigned char>(0x80 | (c & 0x3F));
+        }
+        else
+        {
+            if (c > 0xDBFF || position == length)
+                return false;
+            const unsigned low = chars[position];
+            if (low < 0xDC00 || low > 0xDFFF)
+                return false;
+            ++position;
+            const unsigned codePoint = 0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00);
+            *out++ = static_cast<unsigned char>(0xF0 | (codePoint >> 18));
+            *out++ = static_cast<unsigned char>(0x80 | ((codePoint >> 12) & 0x3F));
+            *out++ = static_cast<unsigned char>(0x80 | ((codePoint >> 6) & 0x3F));
+            *out++ = static_cast<unsigned char>(0x80 | (codePoint & 0x3F));
+        }
+    }
+    return true;
+}
+
+inline bool isContinuation(unsigned byte)
+{
+    return (byte & 0xC0) == 0x80;
+}
+
+/* Scalar conversion of bytes [position, end), strict: shortest form, no surrogates, at most U+10FFFF. */
+inline bool decodeScalar(const unsigned char* bytes, size_t length, size_t& position, size_t end, SAP_UC*& out)
+{
+    while (position < end)
+    {
+        const unsigned b0 = bytes[position];
+        if (b0 < 0x80)
+        {
+            *out++ = static_cast<SAP_UC>(b0);
+            ++position;
+        }
+        else if (b0 >= 0xC2 && b0 <= 0xDF)
+        {
+            if (length - position < 2 || !isContinuation(bytes[position + 1]))
+                return false;
+            *out++ = static_cast<SAP_UC>(((b0 & 0x1F) << 6) | (bytes[position + 1] & 0x3F));
+            position += 2;
+        }
+        else if (b0 >= 0xE0 && b0 <= 0xEF)
+        {
+            if (length - position < 3)
+                return false;
+            const unsigned b1 = bytes[position + 1];
+            const unsigned b2 = bytes[position + 2];
+            if (b1 < (b0 == 0xE0 ? 0xA0u : 0x80u) || b1 > (b0 == 0xED ? 0x9Fu : 0xBFu) || !isContinuation(b2))
+                return false;
+            *out++ = static_cast<SAP_UC>(((b0 & 0x0F) << 12) | ((b1 & 0x3F) << 6) | (b2 & 0x3F));
+            position += 3;
+        }
+        else if (b0 >= 0xF0 && b0 <= 0xF4)
+        {
+            if (length - position < 4)
+                return false;
+            const unsigned b1 = bytes[position + 1];
+            const unsigned b2 = bytes[position + 2];
+            const unsigned b3 = bytes[position + 3];
+            if (b1 < (b0 == 0xF0 ? 0x90u : 0x80u) || b1 > (b0 == 0xF4 ? 0x8Fu : 0xBFu) || !isContinuation(b2)
+                || !isContinuation(b3))
+                return false;
+            const unsigned codePoint = (((b0 & 0x07) << 18) | ((b1 & 0x3F) << 12) | ((b2 & 0x3F) << 6) | (b3 & 0x3F)) - 0x10000;
+            *out++ = static_cast<SAP_UC>(0xD800 + (codePoint >> 10));
+            *out++ = static_cast<SAP_UC>(0xDC00 + (codePoint & 0x3FF));
+            position += 4;
+        }
+        else
+            return false;
+    }
+    return true;
+}
+
+size_t encodePortable(const SAP_UC* chars, size_t length, unsigned char* out)
+{
+    unsigned char* const start = out;
+    size_t position = 0;
+    return encodeScalar(chars, length, position, length, out) ? static_cast<size_t>(out - start) : INVALID;
+}
+
+size_t decodePortable(const unsigned char* bytes, size_t length, SAP_UC* out)
+{
+    SAP_UC* const start = out;
+    size_t position = 0;
+    return decodeScalar(bytes, length, position, length, out) ? static_cast<size_t>(out - start) : INVALID;
+}
+
+#ifdef NWRFC_X86_KERNELS
+
+/*
+ * The kernels copy blocks of ASCII characters with SIMD instructions and give the first block
+ * that contains anything else to the scalar code, then try SIMD again.
+ */
+
+size_t encodeSse2(const SAP_UC* chars, size_t length, unsigned char* out)
+{
+    unsigned char* const start = out;
+    const __m128i nonAscii = _mm_set1_epi16(static_cast<short>(0xFF80));
+    const __m128i zero = _mm_setzero_si128();
+    size_t position = 0;
+    while (position < length)
+    {
+        for (; position + 16 <= length; position += 16, out += 16)
+        {
+            const __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(chars + position));
+            const __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(chars + position + 8));
+            const __m128i test = _mm_and_si128(_mm_or_si128(low, high), nonAscii);
+            if (_mm_movemask_epi8(_mm_cmpeq_epi16(test, zero)) != 0xFFFF)
+                break;
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_packus_epi16(low, high));
+        }
+        if (!encodeScalar(chars, length, position, std::min(position + 16, length), out))
+            return INVALID;
+    }
+    return static_cast<size_t>(out - start);
+}
+
+__attribute__((target("avx2")))
+size_t encodeAvx2(const SAP_UC* chars, size_t length, unsigned char* out)
+{
+    unsigned char* const start = out;
+    const __m256i nonAscii = _mm256_set1_epi16(static_cast<short>(0xFF80));
+    size_t position = 0;
+    while (position < length)
+    {
+        for (; position + 32 <= length; position += 32, out += 32)
+        {
+            const __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(chars + position));
+            const __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(chars + position + 16));
+            if (!_mm256_testz_si256(_mm256_or_si256(low, high), nonAscii))
+                break;
+            // packus interleaves the 128 bit lanes of both inputs, the permutation restores the order.
+            const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(low, high), 0xD8);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), packed);
+        }
+        if (!encodeScalar(chars, length, position, std::min(position + 32, length), out))
+            return INVALID;
+    }
+    return static_cast<size_t>(out - start);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+size_t encodeAvx512(const SAP_UC* chars, size_t length, unsigned char* out)
+{
+    unsigned char* const start = out;
+    const __m512i nonAscii = _mm512_set1_epi16(static_cast<short>(0xFF80));
+    size_t position = 0;
+    while (position < length)
+    {
+        for (; position + 32 <= length; position += 32, out += 32)
+        {
+            const __m512i value = _mm512_loadu_si512(chars + position);
+            if (_mm512_test_epi16_mask(value, nonAscii) != 0)
+                break;
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm512_maskz_cvtepi16_epi8(0xFFFFFFFF, value));
+        }
+        if (!encodeScalar(chars, length, position, std::min(position + 32, length), out))
+            return INVALID;
+    }
+    return static_cast<size_t>(out - start);
+}
+
+size_t decodeSse2(const unsigned char* bytes, size_t length, SAP_UC* out)
+{
+    SAP_UC* const start = out;
+    const __m128i zero = _mm_setzero_si128();
+    size_t position = 0;
+    while (position < length)
+    {
+        for (; position + 16 <= length; position += 16, out += 16)
+        {
+            const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + position));
+            if (_mm_movemask_epi8(value) != 0)
+                break;
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi8(value, zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 8), _mm_unpackhi_epi8(value, zero));
+        }
+        if (!decodeScalar(bytes, length, position, std::min(position + 16, length), out))
+            return INVALID;
+    }
+    return static_cast<size_t>(out - start);
+}
+
+__attribute__((target("avx2")))
+size_t decodeAvx2(const unsigned char* bytes, size_t length, SAP_UC* out)
+{
+    SAP_UC* const start = out;
+    size_t position = 0;
+    while (position < length)
+    {
+        for (; position + 32 <= length; position += 32, out += 32)
+        {
+            const __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes + position));
+            if (_mm256_movemask_epi8(value) != 0)
+                break;
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_cvtepu8_epi16(_mm256_castsi256_si128(value)));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 16), _mm256_cvtepu8_epi16(_mm256_extracti128_si256(value, 1)));
+        }
+        if (!decodeScalar(bytes, length, position, std::min(position + 32, length), out))
+            return INVALID;
+    }
+    return static_cast<size_t>(out - start);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+size_t decodeAvx512(const unsigned char* bytes, size_t length, SAP_UC* out)
+{
+    SAP_UC* const start = out;
+    size_t position = 0;
+    while (position < length)
+    {
+        for (; position + 64 <= length; position += 64, out += 64)
+        {
+            const __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes + position));
+            const __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes + position + 32));
+            if (_mm256_movemask_epi8(_mm256_or_si256(low, high)) != 0)
+                break;
+            _mm512_storeu_si512(out, _mm512_cvtepu8_epi16(low));
+            _mm512_storeu_si512(out + 32, _mm512_cvtepu8_epi16(high));
+        }
+        if (!decodeScalar(bytes, length, position, std::min(position + 64, length), out))
+            return INVALID;
+    }
+    return static_cast<size_t>(out - start);
+}
+
+#endif // NWRFC_X86_KERNELS
+
+TranscoderLevel detectLevel()
+{
+#ifdef NWRFC_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+        return TRANSCODER_AVX512;
+    if (__builtin_cpu_supports("avx2"))
+        return TRANSCODER_AVX2;
+    return TRANSCODER_SSE2;
+#else
+    return TRANSCODER_SCALAR;
+#endif
+}
+
+std::atomic<int> selectedLevel(-1);     // -1: detectedTranscoderLevel()
+
+/* Writes at most 3 bytes per SAP_UC to out, returns the bytes written or INVALID. */
+size_t encode(const SAP_UC* chars, size_t length, unsigned char* out)
+{
+    switch (transcoderLevel())
+    {
+#ifdef NWRFC_X86_KERNELS
+    case TRANSCODER_AVX512:
+        return encodeAvx512(chars, length, out);
+    case TRANSCODER_AVX2:
+        return encodeAvx2(chars, length, out);
+    case TRANSCODER_SSE2:
+        return encodeSse2(chars, length, out);
+#endif
+    default:
+        return encodePortable(chars, length, out);
+    }
+}
+
+/* Writes at most one SAP_UC per byte to out, returns the SAP_UC written or INVALID. */
+size_t decode(const unsigned char* bytes, size_t length, SAP_UC* out)
+{
+    switch (transcoderLevel())
+    {
+#ifdef NWRFC_X86_KERNELS
+    case TRANSCODER_AVX512:
+        return decodeAvx512(bytes, length, out);
+    case TRANSCODER_AVX2:
+        return decodeAvx2(bytes, length, out);
+    case TRANSCODER_SSE2:
+        return decodeSse2(bytes, length, out);
+#endif
+    default:
+        return decodePortable(bytes, length, out);
+    }
+}
+
+RFC_RC libraryToUtf8(const SAP_UC* chars, size_t length, std::string& target, RFC_ERROR_INFO* errorInfo)
+{
+    // A UTF-16 code unit never needs more than 3 UTF-8 bytes, plus the terminating null.
+    if (length > (UINT_MAX - 1) / 3)
+        return setError(errorInfo, RFC_BUFFER_TOO_SMALL, cU("Value too long for UTF-8 conversion"));
+    const size_t oldSize = target.size();
+    unsigned utf8Size = static_cast<unsigned>(length * 3 + 1);
+    unsigned resultLength = 0;
+    target.resize(oldSize + utf8Size);
+    RFC_RC rc = RfcSAPUCToUTF8(chars, static_cast<unsigned>(length), reinterpret_cast<RFC_BYTE*>(&target[oldSize]),
+                               &utf8Size, &resultLength, errorInfo);
+    target.resize(rc == RFC_OK ? oldSize + resultLength : oldSize);
+    return rc;
+}
+
+} // namespace
+
+TranscoderLevel detectedTranscoderLevel()
+{
+    static const TranscoderLevel detected = detectLevel();
+    return detected;
+}
+
+TranscoderLevel transcoderLevel()
+{
+    const int level = selectedLevel.load(std::memory_order_relaxed);
+    return level < 0 ? detectedTranscoderLevel() : static_cast<TranscoderLevel>(level);
+}
+
+TranscoderLevel setTranscoderLevel(TranscoderLevel level)
+{
+    const TranscoderLevel effective = std::min(level, detectedTranscoderLevel());
+    selectedLevel.store(effective, std::memory_order_relaxed);
+    return effective;
+}
+
+RFC_RC sapucToUtf8(const SAP_UC* chars, size_t length, std::string& target, RFC_ERROR_INFO* errorInfo)
+{
+    if (length == 0)
+        return RFC_OK;
+    const size_t oldSize = target.size();
+    target.resize(oldSize + 3 * length);
+    const size_t written = encode(chars, length, reinterpret_cast<unsigned char*>(&target[oldSize]));
+    if (written != INVALID)
+    {
+        target.resize(oldSize + written);
+        return RFC_OK;
+    }
+    target.resize(oldSize);
+    return libraryToUtf8(chars, length, target, errorInfo);
+}
+
+RFC_RC utf8ToSapuc(const char* bytes, size_t length, std::basic_string<SAP_UC>& target, RFC_ERROR_INFO* errorInfo)
+{
+    if (length == 0)
+        return RFC_OK;
+    const size_t oldSize = target.size();
+    target.resize(oldSize + length);
+    const size_t written = decode(reinterpret_cast<const unsigned char*>(bytes), length, &target[oldSize]);
+    if (written != INVALID)
+    {
+        target.resize(oldSize + written);
+        return RFC_OK;
+    }
+
+    // Not valid UTF-8; the library decides and reports the error.
+    if (length >= UINT_MAX)
+    {
+        target.resize(oldSize);
+        return setError(errorInfo, RFC_BUFFER_TOO_SMALL, cU("Value too long for UTF-8 conversion"));
+    }
+    unsigned sapucSize = static_cast<unsigned>(length + 1);
+    unsigned resultLength = 0;
+    target.resize(oldSize + sapucSize);
+    RFC_RC rc = RfcUTF8ToSAPUC(reinterpret_cast<const RFC_BYTE*>(bytes), static_cast<unsigned>(length), &target[oldSize],
+                               &sapucSize, &resultLength, errorInfo);
+    target.resize(rc == RFC_OK ? oldSize + resultLength : oldSize);
+    return rc;
+}
+
+RFC_RC appendUtf8Column(const Column& column, unsigned rows, bool trimChars, std::string& target,
+                        std::vector<size_t>& offsets, RFC_ERROR_INFO* errorInfo)
+{
+    const bool trim = trimChars && column.desc.type == RFCTYPE_CHAR;
+    const size_t oldSize = target.size();
+    offsets.resize(static_cast<size_t>(rows) + 1);
+    offsets[0] = oldSize;
+
+    size_t used = oldSize;
+    std::string converted;
+    for (unsigned row = 0; row < rows; ++row)
+    {
+        const SAP_UC* chars = column.charsAt(row);
+        unsigned length = column.charLength(row);
+        if (trim)
+            length = trimmedLength(chars, length);
+        if (length > 0)
+        {
+            // Room for the worst case, grown geometrically so that a column is resized a few times only.
+            const size_t needed = used + 3 * static_cast<size_t>(length);
+            if (needed > target.size())
+                target.resize(std::max(needed, target.size() + target.size() / 2));
+            size_t written = encode(chars, length, reinterpret_cast<unsigned char*>(&target[used]));
+            if (written == INVALID)
+            {
+                converted.clear();
+                RFC_RC rc = libraryToUtf8(chars, length, converted, errorInfo);
+                if (rc != RFC_OK)
+                {
+                    target.resize(oldSize);
+                    offsets.clear();
+                    return rc;
+                }
+                if (used + converted.size() > target.size())
+                    target.resize(used + converted.size());
+                memcpy(&target[used], converted.data(), converted.size());
+                written = converted.size();
+            }
+            used += written;
+        }
+        offsets[row + 1] = used;
+    }
+    target.resize(used);
+    return RFC_OK;
+}
+
+} // namespace nwrfc
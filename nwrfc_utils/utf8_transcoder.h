@@ -0,0 +1,92 @@
+#ifndef NWRFC_UTILS_UTF8_TRANSCODER_H
+#define NWRFC_UTILS_UTF8_TRANSCODER_H
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+#include "sapnwrfc.h"
+#include "columnar_table_reader.h"
+
+namespace nwrfc {
+
+/** \enum TranscoderLevel
+ *
+ * Instruction set used by the transcoder kernels.
+ */
+enum TranscoderLevel
+{
+    TRANSCODER_SCALAR,
+    TRANSCODER_SSE2,
+    TRANSCODER_AVX2,
+    TRANSCODER_AVX512   ///< AVX-512 F and BW
+};
+
+/**
+ * \brief  The best level supported by the CPU, detected once.
+ *
+ * SIMD kernels are available for x86-64 with GCC and Clang, elsewhere the level is TRANSCODER_SCALAR.
+ */
+TranscoderLevel detectedTranscoderLevel();
+
+/** \brief  The level the kernels currently run with. */
+TranscoderLevel transcoderLevel();
+
+/**
+ * \brief  Limits the kernels to a level, e.g. to compare the levels in a benchmark.
+ *
+ * \in level Highest level to use; levels above detectedTranscoderLevel() are ignored.
+ * \return The level now in use.
+ */
+TranscoderLevel setTranscoderLevel(TranscoderLevel level);
+
+/**
+ * \brief  Converts SAP_UC data to UTF-8 and appends it to target, replacing RfcSAPUCToUTF8() on hot paths.
+ *
+ * Blocks of ASCII characters are converted with SIMD instructions, everything else including
+ * surrogate pairs by the scalar code. Input that is not valid UTF-16, such as an unpaired
+ * surrogate, is handed to RfcSAPUCToUTF8(), so the result and the error are always those of the
+ * library. The result is not null-terminated. On error target keeps its previous content.
+ * errorInfo is only written in case of an error, which keeps per-value calls cheap.
+ *
+ * \in *chars SAP_UC data to convert.
+ * \in length Number of SAP_UC to convert.
+ * \inout &target String the UTF-8 bytes are appended to.
+ * \out *errorInfo More information in case the data cannot be converted.
+ * \return RFC_RC
+ */
+RFC_RC sapucToUtf8(const SAP_UC* chars, size_t length, std::string& target, RFC_ERROR_INFO* errorInfo);
+
+/**
+ * \brief  Converts UTF-8 data to SAP_UC and appends it to target, replacing RfcUTF8ToSAPUC().
+ *
+ * Overlong encodings, encoded surrogates and code points above U+10FFFF are not converted by the
+ * kernels but handed to RfcUTF8ToSAPUC(). On error target keeps its previous content.
+ *
+ * \in *bytes UTF-8 data to convert.
+ * \in length Number of bytes to convert.
+ * \inout &target String the SAP_UC are appended to.
+ * \out *errorInfo More information in case the data cannot be converted.
+ * \return RFC_RC
+ */
+RFC_RC utf8ToSapuc(const char* bytes, size_t length, std::basic_string<SAP_UC>& target, RFC_ERROR_INFO* errorInfo);
+
+/**
+ * \brief  Converts the values of a char-like column (CHAR, NUM, DATE, TIME, STRING) to UTF-8 in one pass.
+ *
+ * The values are appended to target back to back; value i occupies [offsets[i], offsets[i+1]).
+ * One call per column instead of one library call per value keeps the kernels on long runs.
+ *
+ * \in &column Extracted column.
+ * \in rows Number of rows to convert.
+ * \in trimChars Strip trailing blanks of RFCTYPE_CHAR values.
+ * \inout &target String the UTF-8 bytes are appended to.
+ * \out &offsets rows + 1 byte offsets into target; offsets[0] is the size of target before the call.
+ * \out *errorInfo More information in case a value cannot be converted.
+ * \return RFC_RC
+ */
+RFC_RC appendUtf8Column(const Column& column, unsigned rows, bool trimChars, std::string& target,
+                        std::vector<size_t>& offsets, RFC_ERROR_INFO* errorInfo);
+
+} // namespace nwrfc
+
+#endif // NWRFC_UTILS_UTF8_TRANSCODER_H